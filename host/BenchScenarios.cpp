@@ -0,0 +1,238 @@
+/* Catálogo de ensayos y métricas de calidad de control (ver "BenchScenarios.h") */
+
+// BenchScenarios.cpp
+#include "BenchScenarios.h"
+#include "TrmsSim.h"
+#include "Profiler.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+const BenchScenario BENCH_SCENARIOS[] = {
+    // Escalones verticales que cruzan la banda de reposo (-37..-36)
+    { "v_up_across_rest",   AXIS_V,          -45.0f, 0.0f,  -20.0f,   0.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    { "v_down_across_rest", AXIS_V,          -20.0f, 0.0f,  -45.0f,   0.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    { "v_into_rest_band",   AXIS_V,          -20.0f, 0.0f,  -36.5f,   0.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    { "v_up_above_rest",    AXIS_V,            0.0f, 0.0f,   15.0f,   0.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    // Escalones horizontales de ±35°
+    { "h_step_pos35",       AXIS_H,            0.0f, 0.0f,    0.0f,  35.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    { "h_step_neg35",       AXIS_H,            0.0f, 0.0f,    0.0f, -35.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    // Movimiento combinado
+    { "vh_combined",        AXIS_V | AXIS_H,   0.0f, 0.0f,   10.0f,  30.0f,  0.0f,   0.0f,  0.0f, 10.0f, 40.0f },
+    // Rechazo de perturbaciones (pulso de par de 2 s)
+    { "dist_pitch",         AXIS_V,            0.0f, 0.0f,    0.0f,   0.0f,  0.03f,  0.0f,  2.0f, 10.0f, 40.0f },
+    { "dist_yaw",           AXIS_H,            0.0f, 0.0f,    0.0f,   0.0f,  0.0f,   0.01f, 2.0f, 10.0f, 40.0f },
+};
+
+const size_t BENCH_SCENARIO_COUNT = sizeof(BENCH_SCENARIOS) / sizeof(BENCH_SCENARIOS[0]);
+
+const BenchMode BENCH_MODES[] = {
+    { PIDMode::MIMO_FULL,       "mimo_full",       AXIS_V | AXIS_H },
+    { PIDMode::VERTICAL_ONLY,   "vertical_only",   AXIS_V },
+    { PIDMode::HORIZONTAL_ONLY, "horizontal_only", AXIS_H },
+    { PIDMode::STATE_FEEDBACK,  "state_feedback",  AXIS_V | AXIS_H },
+};
+
+const size_t BENCH_MODE_COUNT = sizeof(BENCH_MODES) / sizeof(BENCH_MODES[0]);
+
+// Banda de establecimiento: 2% del salto, como mínimo 0.5°
+static float settleBand(float stepDeg)
+{
+    float b = 0.02f * fabsf(stepDeg);
+    return (b > 0.5f) ? b : 0.5f;
+}
+
+/**
+ * @brief
+ * Calcula las métricas de un eje a partir de la traza grabada.
+ */
+static AxisMetrics axisMetrics(const float *t, const float *y, size_t n,
+                               float y0, float r0, float r1, float dtS)
+{
+    AxisMetrics m;
+    const float step = r1 - y0;
+    const float dir  = (step >= 0.0f) ? 1.0f : -1.0f;
+
+    m.stepDeg      = r1 - r0;
+    m.riseS        = NAN;
+    m.overshootPct = 0.0f;
+    m.settleS      = 0.0f;
+    m.peakErrDeg   = 0.0f;
+    m.iae          = 0.0;
+    m.itae         = 0.0;
+
+    // Valor final: media del último segundo
+    size_t tail = (size_t)(1.0f / dtS);
+    if (tail == 0 || tail > n) tail = n;
+    double sumTail = 0.0, sumErrTail = 0.0;
+    for (size_t i = n - tail; i < n; i++) {
+        sumTail    += y[i];
+        sumErrTail += r1 - y[i];
+    }
+    const float yFinal = (float)(sumTail / tail);
+    m.finalErrDeg = (float)(sumErrTail / tail);
+
+    float t10 = NAN, t90 = NAN;
+    float maxOver = 0.0f;
+    const bool isStep = fabsf(m.stepDeg) > 1e-3f;
+    const float band = settleBand(m.stepDeg);
+
+    for (size_t i = 0; i < n; i++) {
+        float e = r1 - y[i];
+        m.iae  += fabsf(e) * dtS;
+        m.itae += t[i] * fabsf(e) * dtS;
+        if (fabsf(e) > m.peakErrDeg) m.peakErrDeg = fabsf(e);
+
+        if (isStep) {
+            float frac = (y[i] - y0) / step;
+            if (isnan(t10) && frac >= 0.1f) t10 = t[i];
+            if (isnan(t90) && frac >= 0.9f) t90 = t[i];
+
+            float over = dir * (y[i] - r1);
+            if (over > maxOver) maxOver = over;
+        }
+
+        if (fabsf(y[i] - yFinal) > band) m.settleS = t[i] + dtS;
+    }
+
+    if (isStep) {
+        if (!isnan(t90)) m.riseS = t90 - t10;
+        m.overshootPct = 100.0f * maxOver / fabsf(step);
+    }
+    if (m.settleS > t[n - 1]) m.settleS = NAN;
+
+    return m;
+}
+
+bool Bench_appliesTo(const BenchScenario &sc, const BenchMode &md)
+{
+    // Solo los ensayos que mueven algún eje controlado por el modo
+    if (!(sc.axes & md.axes)) return false;
+    // El combinado solo tiene sentido con los dos ejes
+    if (sc.axes == (AXIS_V | AXIS_H) && md.axes != (AXIS_V | AXIS_H)) return false;
+    return true;
+}
+
+/**
+ * @brief
+ * Ejecuta un ensayo en un modo y añade una fila por eje medido.
+ * @note
+ * Cada ensayo arranca en frío: simulador nuevo, ganancias por defecto (u opt.gains),
+ * integradores y bases aprendidas a cero. El mapa de equilibrio vertical no se
+ * toca aquí (ver --ffwarm). Los primeros tEventS segundos sirven
+ * para asentar el lazo en ref0; luego se graba la traza hasta durationS.
+ */
+size_t Bench_runScenario(const BenchScenario &sc, const BenchMode &md, uint32_t rateHz,
+                         const BenchOptions &opt, BenchResult *out)
+{
+    TrmsSimConfig cfg = TrmsSim_defaultConfig();
+    cfg.rateHz = rateHz;
+    if (opt.observer || md.mode == PIDMode::STATE_FEEDBACK) cfg.observer = &OBSERVER_DEFAULT_CONFIG;
+    if (!TrmsSim_begin(cfg)) return 0;
+
+    PID_LoadDefaults();
+    if (opt.gains) g_pidCurr = *opt.gains;
+    if (opt.derivOnMeas >= 0) g_pidCurr.DerivOnMeasCurr = (opt.derivOnMeas != 0);
+    if (opt.tfS >= 0.0f) {
+        g_pidCurr.TfvCurr = opt.tfS;
+        g_pidCurr.TfhCurr = opt.tfS;
+    }
+    if (opt.ktV >= 0.0f) {
+        g_pidCurr.KtvvCurr = opt.ktV;
+        g_pidCurr.KthvCurr = opt.ktV;
+    }
+    if (opt.ktH >= 0.0f) {
+        g_pidCurr.KthhCurr = opt.ktH;
+        g_pidCurr.KtvhCurr = opt.ktH;
+    }
+    PID4_LoadFromCurr(g_pidCurr);
+    PID4_SetMode(md.mode);
+    PID4_SetObserverDerivative(opt.observer);
+    PID4_ResetShapingState();
+    const TrajLimits off = { 0.0f, 0.0f, 0.0f };
+    PID4_SetTrajectoryLimits(opt.traj ? PID4_TRAJ_DEFAULT_VERT : off, opt.traj ? PID4_TRAJ_DEFAULT_HOR : off);
+    PID4_SetReferences(sc.refV0, sc.refH0);
+    PID4_SetEnabled(true);
+
+    TrmsSim_run(sc.tEventS);
+
+    const float dtS = 1.0f / (float)rateHz;
+    const size_t n = (size_t)((sc.durationS - sc.tEventS) * (float)rateHz);
+
+    float *t  = (float *)malloc(n * sizeof(float));
+    float *yV = (float *)malloc(n * sizeof(float));
+    float *yH = (float *)malloc(n * sizeof(float));
+
+    TrmsPlant &plant = TrmsSim_plant();
+    const float y0V = TrmsPlant_pitchDeg(plant);
+    const float y0H = TrmsPlant_yawDeg(plant);
+
+    PID4_SetReferences(sc.refV1, sc.refH1);
+    if (sc.refV1 != sc.refV0 || sc.refH1 != sc.refH0) {
+        PID4_HandleReferenceChange();   // como main.cpp al mover la consigna
+    }
+    plant.distPitch = sc.distPitch;
+    plant.distYaw   = sc.distYaw;
+
+    Profiler_reset();
+
+    TelemetryRecord rec;
+    uint32_t travelMP = 0, travelRDC = 0;
+    uint32_t satMP = 0, satRDC = 0;
+    int16_t lastMP = 0, lastRDC = 0;
+    bool distOn = (sc.distS > 0.0f);
+
+    for (size_t i = 0; i < n; i++) {
+        float tRel = (float)i * dtS;
+        if (distOn && tRel >= sc.distS) {
+            plant.distPitch = 0.0f;
+            plant.distYaw   = 0.0f;
+            distOn = false;
+        }
+
+        TrmsSim_step(rec);
+
+        // Ángulos reales del modelo (sin cuantizar)
+        t[i]  = tRel;
+        yV[i] = TrmsPlant_pitchDeg(plant);
+        yH[i] = TrmsPlant_yawDeg(plant);
+
+        if (i > 0) {
+            travelMP  += (uint32_t)abs(rec.regMP  - lastMP);
+            travelRDC += (uint32_t)abs(rec.regRDC - lastRDC);
+        }
+        lastMP  = rec.regMP;
+        lastRDC = rec.regRDC;
+        if (rec.satMP)  satMP++;
+        if (rec.satRDC) satRDC++;
+    }
+    TrmsSim_end();
+
+    ProfStageStats pid;
+    Profiler_getStageStats(PROF_PID, pid);
+
+    size_t count = 0;
+    const uint8_t axes = sc.axes & md.axes;
+    for (int a = 0; a < 2; a++) {
+        uint8_t bit = (a == 0) ? AXIS_V : AXIS_H;
+        if (!(axes & bit)) continue;
+
+        BenchResult &r = out[count++];
+        r.mode      = md.name;
+        r.scenario  = sc.name;
+        r.axis      = (a == 0) ? 'v' : 'h';
+        r.m         = (a == 0) ? axisMetrics(t, yV, n, y0V, sc.refV0, sc.refV1, dtS)
+                               : axisMetrics(t, yH, n, y0H, sc.refH0, sc.refH1, dtS);
+        r.travelMP  = travelMP;
+        r.travelRDC = travelRDC;
+        r.satMPPct  = 100.0f * (float)satMP  / (float)n;
+        r.satRDCPct = 100.0f * (float)satRDC / (float)n;
+        r.nsPerStep = pid.avgUs * 1000.0f;
+        r.nsP99     = pid.p99Us * 1000.0f;
+    }
+
+    free(t);
+    free(yV);
+    free(yH);
+    return count;
+}
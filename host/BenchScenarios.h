@@ -0,0 +1,117 @@
+/* Catálogo de ensayos en lazo cerrado contra el modelo del TRMS (TrmsSim) y sus métricas de calidad
+de control. Junto con "BenchScenarios.cpp" lo comparten la batería de ensayos (trms_bench) y el
+optimizador de ganancias (trms_tune): cada ensayo arranca un simulador nuevo, así que dos ejecuciones
+con las mismas ganancias y opciones dan el mismo resultado */
+
+// BenchScenarios.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PID_Control.h"
+#include "PID_Parameters.h"
+
+// Ejes que mueve (o perturba) cada ensayo
+enum BenchAxis : uint8_t {
+    AXIS_V = 1,
+    AXIS_H = 2
+};
+
+/**
+ * @brief Ensayo del catálogo.
+ *
+ * Consignas ref0 hasta tEventS y ref1 después. Los pares de perturbación
+ * [N m] se aplican en [tEventS, tEventS + distS). Las métricas se miden
+ * desde tEventS hasta durationS.
+ */
+struct BenchScenario {
+    const char *name;
+    uint8_t     axes;       // AXIS_V | AXIS_H
+    float       refV0, refH0;
+    float       refV1, refH1;
+    float       distPitch, distYaw;
+    float       distS;
+    float       tEventS;
+    float       durationS;
+};
+
+extern const BenchScenario BENCH_SCENARIOS[];
+extern const size_t        BENCH_SCENARIO_COUNT;
+
+struct BenchMode {
+    PIDMode     mode;
+    const char *name;
+    uint8_t     axes;       // ejes que controla el modo
+};
+
+extern const BenchMode BENCH_MODES[];
+extern const size_t    BENCH_MODE_COUNT;
+
+/**
+ * @brief Métricas de un eje en un ensayo.
+ *
+ * @param stepDeg       Salto de consigna (0 en perturbaciones)
+ * @param riseS         10%..90% del recorrido desde la posición inicial hasta
+ *                      la nueva consigna (NAN si no llega al 90%)
+ * @param overshootPct  Exceso sobre la consigna en el sentido del salto [% del salto]
+ * @param settleS       Último instante fuera de la banda alrededor del valor final
+ *                      (NAN si al final sigue fuera)
+ * @param peakErrDeg    Máximo |error| tras el evento
+ * @param finalErrDeg   Error medio en el último segundo
+ * @param iae, itae     Integral de |e| y de t*|e| [deg s, deg s^2]
+ */
+struct AxisMetrics {
+    float  stepDeg;
+    float  riseS;
+    float  overshootPct;
+    float  settleS;
+    float  peakErrDeg;
+    float  finalErrDeg;
+    double iae;
+    double itae;
+};
+
+struct BenchResult {
+    const char *mode;
+    const char *scenario;
+    char        axis;       // 'v' / 'h'
+    AxisMetrics m;
+    uint32_t    travelMP;   // suma de |Δregistro| en la ventana de medida
+    uint32_t    travelRDC;
+    float       satMPPct;   // % de pasos con la salida recortada (satMP / satRDC)
+    float       satRDCPct;
+    float       nsPerStep;  // media del paso de PID (perfilador, etapa "pid")
+    float       nsP99;
+};
+
+/**
+ * @brief Cambios sobre PID_LoadDefaults para todos los ensayos.
+ *
+ * @param gains        Ganancias en lugar de las de por defecto (nullptr = PID_LoadDefaults)
+ * @param derivOnMeas  DerivOnMeasCurr (-1 = sin cambio)
+ * @param tfS          TfvCurr / TfhCurr (< 0 = sin cambio)
+ * @param ktV, ktH     Kt de los PID que forman Uv / Uh (< 0 = sin cambio)
+ * @param traj         Consignas con la trayectoria por defecto del firmware
+ * @param observer     Observador de estado (STATE_FEEDBACK lo lleva siempre)
+ */
+struct BenchOptions {
+    const PID_CURR *gains       = nullptr;
+    int             derivOnMeas = -1;
+    float           tfS         = -1.0f;
+    float           ktV         = -1.0f;
+    float           ktH         = -1.0f;
+    bool            traj        = false;
+    bool            observer    = false;
+};
+
+// El ensayo tiene sentido en el modo (mueve algún eje que controla; el combinado, los dos)
+bool Bench_appliesTo(const BenchScenario &sc, const BenchMode &md);
+
+/**
+ * @brief Ejecuta un ensayo en un modo y escribe una fila por eje medido.
+ *
+ * @param out  Hueco para 2 filas como máximo
+ * @return número de filas escritas (0 si el simulador no arranca)
+ */
+size_t Bench_runScenario(const BenchScenario &sc, const BenchMode &md, uint32_t rateHz,
+                         const BenchOptions &opt, BenchResult *out);
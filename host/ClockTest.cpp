@@ -0,0 +1,131 @@
+/* Prueba del reloj simulado (Clock.h) y del cálculo del periodo de muestreo: primera muestra, reloj
+que no avanza, jitter mínimo / máximo y sellado de Encoders_readSample en el punto medio de la
+lectura. El backend de la HAL responde a las lecturas I2C avanzando el reloj, como el bus real:
+
+   trms_clock_test
+
+Devuelve 1 si alguna comprobación falla */
+
+// ClockTest.cpp
+#include "Clock.h"
+#include "Encoders.h"
+#include "HAL.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static int s_failures = 0;
+
+static void check(bool cond, const char *what)
+{
+    printf("%-52s %s\n", what, cond ? "ok" : "FALLO");
+    if (!cond) s_failures++;
+}
+
+static bool nearUs(float dtS, int64_t us)
+{
+    return fabsf(dtS - (float)us * 1e-6f) < 1e-7f;
+}
+
+// Cada lectura I2C del TCA9539 tarda I2C_READ_US y devuelve un byte fijo
+static const int64_t I2C_READ_US = 120;
+static const uint8_t I2C_BYTE    = 0x12;
+
+static bool testI2cReadReg(uint8_t addr, uint8_t reg, uint8_t &value)
+{
+    (void)addr;
+    (void)reg;
+    Clock_mockAdvanceUs(I2C_READ_US);
+    value = I2C_BYTE;
+    return true;
+}
+
+static void testSamplePeriod()
+{
+    const uint32_t nominalUs = 5000;
+    SamplePeriod sp;
+    SamplePeriod_init(sp, nominalUs);
+
+    Clock_mockSetUs(1000000);
+
+    // Primera muestra: no hay intervalo, se devuelve el nominal sin tocar las estadísticas
+    float dt = SamplePeriod_update(sp, Clock_nowUs());
+    check(nearUs(dt, nominalUs), "primera muestra: dt nominal");
+    check(sp.samples == 0, "primera muestra: sin intervalos");
+    check(sp.lastUs == 1000000, "primera muestra: instante guardado");
+
+    // Periodo exacto
+    Clock_mockAdvanceUs(nominalUs);
+    dt = SamplePeriod_update(sp, Clock_nowUs());
+    check(nearUs(dt, nominalUs), "periodo exacto: dt medido");
+    check(sp.samples == 1 && sp.lastJitterUs == 0, "periodo exacto: jitter 0");
+
+    // Reloj parado y reloj hacia atrás: nominal, sin intervalo nuevo
+    dt = SamplePeriod_update(sp, Clock_nowUs());
+    check(nearUs(dt, nominalUs) && sp.samples == 1, "reloj parado: dt nominal");
+    const int64_t before = Clock_nowUs();
+    dt = SamplePeriod_update(sp, before - 300);
+    check(nearUs(dt, nominalUs) && sp.samples == 1, "reloj hacia atras: dt nominal");
+
+    // Desde el instante anterior (before - 300): tarde +250 us, pronto -400 us, tarde +75 us
+    Clock_mockSetUs(before - 300 + nominalUs + 250);
+    dt = SamplePeriod_update(sp, Clock_nowUs());
+    check(nearUs(dt, nominalUs + 250) && sp.lastJitterUs == 250, "muestra tarde: dt y jitter");
+
+    Clock_mockAdvanceUs(nominalUs - 400);
+    dt = SamplePeriod_update(sp, Clock_nowUs());
+    check(nearUs(dt, nominalUs - 400) && sp.lastJitterUs == -400, "muestra pronto: dt y jitter");
+
+    Clock_mockAdvanceUs(nominalUs + 75);
+    SamplePeriod_update(sp, Clock_nowUs());
+    check(sp.samples == 4, "intervalos contados");
+    check(sp.minJitterUs == -400 && sp.maxJitterUs == 250, "jitter minimo / maximo");
+    check(sp.lastJitterUs == 75, "ultimo jitter");
+
+    // init borra la historia
+    SamplePeriod_init(sp, 2500);
+    dt = SamplePeriod_update(sp, Clock_nowUs());
+    check(nearUs(dt, 2500) && sp.samples == 0, "tras init: primera muestra otra vez");
+}
+
+static void testReadSample()
+{
+    HalHostBackend backend = {};
+    backend.i2cReadReg = testI2cReadReg;
+    HAL_hostSetBackend(&backend);
+
+    Clock_mockSetUs(2000000);
+    const int64_t t0 = Clock_nowUs();
+
+    EncoderSample smp = {};
+    const bool ok = Encoders_readSample(smp);
+    const int64_t t1 = Clock_nowUs();
+
+    check(ok, "lectura de encoders");
+    check(smp.countV == (int16_t)((I2C_BYTE << 8) | I2C_BYTE), "cuentas leidas");
+    check(t1 - t0 >= 4 * I2C_READ_US, "la lectura avanza el reloj");
+    check(smp.readUs == (uint32_t)(t1 - t0), "readUs = duracion de la lectura");
+    check(smp.tUs == t0 + (t1 - t0) / 2, "instante = punto medio de la lectura");
+
+    HAL_hostSetBackend(nullptr);
+
+    // Sin dispositivo la lectura falla pero la muestra queda sellada igual
+    Clock_mockSetUs(3000000);
+    check(!Encoders_readSample(smp), "sin dispositivo: lectura fallida");
+    check(smp.tUs == 3000000 + smp.readUs / 2, "sin dispositivo: instante sellado");
+}
+
+int main()
+{
+    HAL_hostSetLogEnabled(false);
+
+    testSamplePeriod();
+    testReadSample();
+
+    if (s_failures) {
+        printf("FALLO: %d comprobaciones\n", s_failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
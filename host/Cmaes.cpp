@@ -0,0 +1,209 @@
+/* CMA-ES (ver "Cmaes.h"): muestreo, recombinación ponderada y adaptación de la covarianza */
+
+// Cmaes.cpp
+#include "Cmaes.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief
+ * Autovalores y autovectores de una matriz simétrica (Jacobi cíclico).
+ * @note
+ * A se destruye; V recibe los autovectores por columnas y d los autovalores.
+ * Para n <= 32 converge en pocas pasadas.
+ */
+static void eigenSym(int n, double *A, double *V, double *d)
+{
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) V[i * n + j] = (i == j) ? 1.0 : 0.0;
+    }
+
+    for (int sweep = 0; sweep < 100; sweep++) {
+        double off = 0.0;
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) off += A[p * n + q] * A[p * n + q];
+        }
+        if (off < 1e-30) break;
+
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                const double apq = A[p * n + q];
+                if (fabs(apq) < 1e-300) continue;
+                const double theta = (A[q * n + q] - A[p * n + p]) / (2.0 * apq);
+                const double t = ((theta >= 0.0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                const double c = 1.0 / sqrt(t * t + 1.0);
+                const double s = t * c;
+
+                for (int k = 0; k < n; k++) {
+                    const double akp = A[k * n + p], akq = A[k * n + q];
+                    A[k * n + p] = c * akp - s * akq;
+                    A[k * n + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < n; k++) {
+                    const double apk = A[p * n + k], aqk = A[q * n + k];
+                    A[p * n + k] = c * apk - s * aqk;
+                    A[q * n + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < n; k++) {
+                    const double vkp = V[k * n + p], vkq = V[k * n + q];
+                    V[k * n + p] = c * vkp - s * vkq;
+                    V[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) d[i] = A[i * n + i];
+}
+
+// B y D a partir de C (D = raíz de los autovalores, sin negativos por redondeo)
+static void decompose(Cmaes &es)
+{
+    const int n = es.n;
+    double A[CMAES_MAX_N * CMAES_MAX_N], ev[CMAES_MAX_N];
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) A[i * n + j] = 0.5 * (es.C[i * CMAES_MAX_N + j] + es.C[j * CMAES_MAX_N + i]);
+    }
+    double V[CMAES_MAX_N * CMAES_MAX_N];
+    eigenSym(n, A, V, ev);
+    for (int i = 0; i < n; i++) {
+        es.D[i] = sqrt(fmax(ev[i], 1e-20));
+        for (int j = 0; j < n; j++) es.B[i * CMAES_MAX_N + j] = V[i * n + j];
+    }
+}
+
+bool Cmaes_init(Cmaes &es, int n, const double *mean, double sigma, int lambda, uint32_t seed)
+{
+    if (n < 1 || n > CMAES_MAX_N) return false;
+    if (lambda <= 0) lambda = 4 + (int)floor(3.0 * log((double)n));
+    if (lambda < 2 || lambda > CMAES_MAX_LAMBDA) return false;
+
+    es.n      = n;
+    es.lambda = lambda;
+    es.mu     = lambda / 2;
+
+    // Pesos log-decrecientes, normalizados a suma 1
+    double sw = 0.0, sw2 = 0.0;
+    for (int i = 0; i < es.mu; i++) {
+        es.w[i] = log(es.mu + 0.5) - log(i + 1.0);
+        sw += es.w[i];
+    }
+    for (int i = 0; i < es.mu; i++) {
+        es.w[i] /= sw;
+        sw2 += es.w[i] * es.w[i];
+    }
+    es.muEff = 1.0 / sw2;
+
+    const double dn = (double)n;
+    es.cSigma = (es.muEff + 2.0) / (dn + es.muEff + 5.0);
+    es.dSigma = 1.0 + 2.0 * fmax(0.0, sqrt((es.muEff - 1.0) / (dn + 1.0)) - 1.0) + es.cSigma;
+    es.cc     = (4.0 + es.muEff / dn) / (dn + 4.0 + 2.0 * es.muEff / dn);
+    es.c1     = 2.0 / ((dn + 1.3) * (dn + 1.3) + es.muEff);
+    es.cMu    = fmin(1.0 - es.c1,
+                     2.0 * (es.muEff - 2.0 + 1.0 / es.muEff) / ((dn + 2.0) * (dn + 2.0) + es.muEff));
+    es.chiN   = sqrt(dn) * (1.0 - 1.0 / (4.0 * dn) + 1.0 / (21.0 * dn * dn));
+
+    es.sigma = sigma;
+    memset(es.C, 0, sizeof(es.C));
+    memset(es.B, 0, sizeof(es.B));
+    for (int i = 0; i < n; i++) {
+        es.mean[i]   = mean[i];
+        es.pSigma[i] = 0.0;
+        es.pc[i]     = 0.0;
+        es.C[i * CMAES_MAX_N + i] = 1.0;
+        es.B[i * CMAES_MAX_N + i] = 1.0;
+        es.D[i]      = 1.0;
+    }
+    es.gen = 0;
+    es.rng.seed(seed);
+    return true;
+}
+
+void Cmaes_ask(Cmaes &es, double *X)
+{
+    const int n = es.n;
+    std::normal_distribution<double> gauss(0.0, 1.0);
+
+    for (int k = 0; k < es.lambda; k++) {
+        double z[CMAES_MAX_N];
+        for (int i = 0; i < n; i++) z[i] = es.D[i] * gauss(es.rng);
+        for (int i = 0; i < n; i++) {
+            double s = 0.0;
+            for (int j = 0; j < n; j++) s += es.B[i * CMAES_MAX_N + j] * z[j];
+            es.y[k][i]   = s;
+            X[k * n + i] = es.mean[i] + es.sigma * s;
+        }
+    }
+}
+
+void Cmaes_tell(Cmaes &es, const double *cost)
+{
+    const int n = es.n;
+
+    // Orden de los candidatos por coste (inserción: lambda es pequeño)
+    int idx[CMAES_MAX_LAMBDA];
+    for (int k = 0; k < es.lambda; k++) {
+        int j = k;
+        while (j > 0 && cost[idx[j - 1]] > cost[k]) {
+            idx[j] = idx[j - 1];
+            j--;
+        }
+        idx[j] = k;
+    }
+
+    // Paso medio ponderado de los mu mejores
+    double yw[CMAES_MAX_N];
+    for (int i = 0; i < n; i++) {
+        double s = 0.0;
+        for (int r = 0; r < es.mu; r++) s += es.w[r] * es.y[idx[r]][i];
+        yw[i] = s;
+        es.mean[i] += es.sigma * s;
+    }
+
+    // C^(-1/2) * yw = B * D^-1 * B' * yw
+    double t[CMAES_MAX_N], cinv[CMAES_MAX_N];
+    for (int j = 0; j < n; j++) {
+        double s = 0.0;
+        for (int i = 0; i < n; i++) s += es.B[i * CMAES_MAX_N + j] * yw[i];
+        t[j] = s / es.D[j];
+    }
+    for (int i = 0; i < n; i++) {
+        double s = 0.0;
+        for (int j = 0; j < n; j++) s += es.B[i * CMAES_MAX_N + j] * t[j];
+        cinv[i] = s;
+    }
+
+    const double kSigma = sqrt(es.cSigma * (2.0 - es.cSigma) * es.muEff);
+    double normPs = 0.0;
+    for (int i = 0; i < n; i++) {
+        es.pSigma[i] = (1.0 - es.cSigma) * es.pSigma[i] + kSigma * cinv[i];
+        normPs += es.pSigma[i] * es.pSigma[i];
+    }
+    normPs = sqrt(normPs);
+
+    es.gen++;
+    const double decay = 1.0 - pow(1.0 - es.cSigma, 2.0 * es.gen);
+    const bool hSigma = normPs / sqrt(decay) / es.chiN < 1.4 + 2.0 / (n + 1.0);
+
+    const double kc = sqrt(es.cc * (2.0 - es.cc) * es.muEff);
+    for (int i = 0; i < n; i++) {
+        es.pc[i] = (1.0 - es.cc) * es.pc[i] + (hSigma ? kc * yw[i] : 0.0);
+    }
+
+    // Rango uno (camino pc) + rango mu (pasos de los mejores)
+    const double dh = hSigma ? 0.0 : es.cc * (2.0 - es.cc);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j <= i; j++) {
+            double rankMu = 0.0;
+            for (int r = 0; r < es.mu; r++) rankMu += es.w[r] * es.y[idx[r]][i] * es.y[idx[r]][j];
+            double &c = es.C[i * CMAES_MAX_N + j];
+            c = (1.0 - es.c1 - es.cMu) * c
+              + es.c1 * (es.pc[i] * es.pc[j] + dh * c)
+              + es.cMu * rankMu;
+            es.C[j * CMAES_MAX_N + i] = c;
+        }
+    }
+
+    es.sigma *= exp((es.cSigma / es.dSigma) * (normPs / es.chiN - 1.0));
+    decompose(es);
+}
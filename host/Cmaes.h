@@ -0,0 +1,49 @@
+/* CMA-ES (Covariance Matrix Adaptation Evolution Strategy) para el optimizador de ganancias del host.
+Junto con "Cmaes.cpp" implementa la versión (mu/mu_w, lambda) con adaptación de rango uno y rango mu
+y control de paso por camino acumulado (Hansen, "The CMA Evolution Strategy: A Tutorial"). Funciona
+como pregunta/respuesta: Cmaes_ask da una generación de candidatos y Cmaes_tell recibe sus costes,
+así que quien llama puede evaluar la generación entera en paralelo */
+
+// Cmaes.h
+#pragma once
+
+#include <stdint.h>
+#include <random>
+
+static const int CMAES_MAX_N      = 32;   // dimensión máxima
+static const int CMAES_MAX_LAMBDA = 64;   // candidatos por generación como máximo
+
+struct Cmaes {
+    int    n;
+    int    lambda;
+    int    mu;
+    double w[CMAES_MAX_LAMBDA];         // pesos de recombinación
+    double muEff;
+    double cSigma, dSigma, cc, c1, cMu, chiN;
+
+    double mean[CMAES_MAX_N];
+    double sigma;
+    double pSigma[CMAES_MAX_N];
+    double pc[CMAES_MAX_N];
+    double C[CMAES_MAX_N * CMAES_MAX_N];   // covarianza (por filas)
+    double B[CMAES_MAX_N * CMAES_MAX_N];   // autovectores de C (columnas)
+    double D[CMAES_MAX_N];                 // raíces de los autovalores
+    double y[CMAES_MAX_LAMBDA][CMAES_MAX_N];   // pasos de la última generación (x - mean) / sigma
+    int    gen;
+
+    std::mt19937 rng;
+};
+
+/**
+ * @brief Prepara la búsqueda.
+ *
+ * @param lambda  Candidatos por generación (<= 0: 4 + 3 ln n, el valor por defecto)
+ * @return false si n o lambda se salen de los máximos
+ */
+bool Cmaes_init(Cmaes &es, int n, const double *mean, double sigma, int lambda, uint32_t seed);
+
+// Candidatos de la generación: X[k * n + i], k < lambda
+void Cmaes_ask(Cmaes &es, double *X);
+
+// Costes de los candidatos de Cmaes_ask (menor es mejor); actualiza media, paso y covarianza
+void Cmaes_tell(Cmaes &es, const double *cost);
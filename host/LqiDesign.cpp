@@ -0,0 +1,421 @@
+/* Diseño fuera de línea del controlador LQI del modo STATE_FEEDBACK (PIDMode::STATE_FEEDBACK). Linealiza
+el modelo de "TrmsPlant.h" en un punto de equilibrio, lo discretiza con retenedor de orden cero al periodo
+del lazo, le añade la integral de los errores de ángulo y resuelve la ecuación de Riccati discreta.
+Escribe las ganancias como cabecera C++ con arrays constexpr (lib/Custom_Libraries/StateFeedbackGains.h):
+
+   trms_lqi_design [--out FICHERO.h] [--theta DEG] [--rate HZ] [--rpm RPM]
+                   [--angv DEG] [--angh DEG] [--ratev DEG/S] [--rateh DEG/S]
+                   [--intv DEG*S] [--inth DEG*S] [--umain U] [--utail U]
+
+Estado en las unidades del firmware: [cabeceo deg, deg/s, guiñada deg, deg/s, rotor principal,
+rotor de cola (velocidades normalizadas, rpm / RPM)] más las integrales [deg*s]; entradas en U
+(tensión normalizada con U_max = 1). Los pesos son los de Bryson: Q = 1 / (desviación admisible)^2
+para cada estado y R = 1 / U^2 para cada entrada. Los rotores no se penalizan */
+
+// LqiDesign.cpp
+#include "TrmsPlant.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double DEG_PER_RAD = 57.29577951308232;
+
+static const int NX = 6;            // estado de la planta
+static const int NZ = 2;            // integrales (cabeceo, guiñada)
+static const int NA = NX + NZ;      // estado aumentado
+static const int NU = 2;            // entradas (principal, cola)
+
+struct DesignArgs {
+    const char *outPath = nullptr;
+    double thetaDeg = 0.0;
+    double rateHz   = 200.0;
+    double rpm      = 6000.0;
+    double angV     = 2.0;
+    double angH     = 4.0;
+    double rateV    = 40.0;
+    double rateH    = 60.0;
+    double intV     = 1.0;
+    double intH     = 2.0;
+    double uMain    = 0.5;
+    double uTail    = 0.5;
+};
+
+// ---------------------------------------------------------------------------
+// Álgebra densa mínima (matrices pequeñas, por filas)
+// ---------------------------------------------------------------------------
+
+// C (n x m) = A (n x k) * B (k x m)
+static void matMul(const double *A, const double *B, double *C, int n, int k, int m)
+{
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) {
+            double s = 0.0;
+            for (int l = 0; l < k; l++) s += A[i * k + l] * B[l * m + j];
+            C[i * m + j] = s;
+        }
+    }
+}
+
+// At (m x n) = A' (A es n x m)
+static void matT(const double *A, double *At, int n, int m)
+{
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) At[j * n + i] = A[i * m + j];
+    }
+}
+
+/**
+ * @brief
+ * exp(M) de una matriz n x n (n <= 16) por escalado y cuadrado.
+ * @note
+ * Taylor de orden 16 sobre M / 2^s con ||M / 2^s|| <= 0.5: de sobra para las
+ * matrices de un paso de control.
+ */
+static void matExp(const double *M, double *E, int n)
+{
+    double norm = 0.0;
+    for (int i = 0; i < n; i++) {
+        double r = 0.0;
+        for (int j = 0; j < n; j++) r += fabs(M[i * n + j]);
+        if (r > norm) norm = r;
+    }
+    int s = 0;
+    while (norm > 0.5) { norm *= 0.5; s++; }
+    const double scale = ldexp(1.0, -s);
+
+    double A[256], T[256], tmp[256];
+    for (int i = 0; i < n * n; i++) A[i] = M[i] * scale;
+    for (int i = 0; i < n * n; i++) { E[i] = (i % (n + 1) == 0) ? 1.0 : 0.0; T[i] = E[i]; }
+
+    for (int k = 1; k <= 16; k++) {
+        matMul(T, A, tmp, n, n, n);
+        for (int i = 0; i < n * n; i++) { T[i] = tmp[i] / k; E[i] += T[i]; }
+    }
+    for (int k = 0; k < s; k++) {
+        matMul(E, E, tmp, n, n, n);
+        memcpy(E, tmp, sizeof(double) * n * n);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Modelo
+// ---------------------------------------------------------------------------
+
+// Aceleraciones de la viga con los rotores en régimen (u = w)
+static void accelAt(TrmsPlant &plant, const TrmsPlantState &x, double &ddTheta, double &ddPhi)
+{
+    TrmsPlantState dx;
+    plant.uMain = (float)x.wMain;
+    plant.uTail = (float)x.wTail;
+    TrmsPlant_derivatives(plant, x, dx);
+    ddTheta = dx.thetaDot;
+    ddPhi   = dx.phiDot;
+}
+
+/**
+ * @brief
+ * Velocidades de los rotores que dejan la viga quieta en (theta, 0).
+ * @note
+ * Newton en 2D con jacobiano numérico. El rotor de cola compensa la reacción
+ * del principal sobre la guiñada, así que en equilibrio gira hacia atrás.
+ */
+static bool equilibrium(TrmsPlant &plant, double thetaRad, TrmsPlantState &x)
+{
+    x = {};
+    x.thetaRad = thetaRad;
+    x.wMain    = 0.5;
+    x.wTail    = -0.3;
+
+    for (int it = 0; it < 50; it++) {
+        double f0, g0;
+        accelAt(plant, x, f0, g0);
+        if (fabs(f0) < 1e-12 && fabs(g0) < 1e-12) return true;
+
+        const double h = 1e-6;
+        double J[4], fa, ga;
+        TrmsPlantState xp = x;
+        xp.wMain += h;
+        accelAt(plant, xp, fa, ga);
+        J[0] = (fa - f0) / h;
+        J[2] = (ga - g0) / h;
+        xp = x;
+        xp.wTail += h;
+        accelAt(plant, xp, fa, ga);
+        J[1] = (fa - f0) / h;
+        J[3] = (ga - g0) / h;
+
+        const double det = J[0] * J[3] - J[1] * J[2];
+        if (fabs(det) < 1e-15) return false;
+        x.wMain -= ( J[3] * f0 - J[1] * g0) / det;
+        x.wTail -= (-J[2] * f0 + J[0] * g0) / det;
+    }
+    double f0, g0;
+    accelAt(plant, x, f0, g0);
+    return fabs(f0) < 1e-9 && fabs(g0) < 1e-9;
+}
+
+static double *field(TrmsPlantState &x, int i)
+{
+    double *f[NX] = { &x.thetaRad, &x.thetaDot, &x.phiRad, &x.phiDot, &x.wMain, &x.wTail };
+    return f[i];
+}
+
+/**
+ * @brief
+ * Jacobianos A (NX x NX) y B (NX x NU) en el equilibrio, en unidades del firmware.
+ * @note
+ * Diferencias centradas sobre TrmsPlant_derivatives; después se pasan los
+ * ángulos y velocidades de la viga de rad a grados.
+ */
+static void linearize(TrmsPlant &plant, const TrmsPlantState &x0, double A[NX * NX], double B[NX * NU])
+{
+    const double h = 1e-6;
+    TrmsPlantState xp, xm, dp, dm;
+
+    plant.uMain = (float)x0.wMain;
+    plant.uTail = (float)x0.wTail;
+    for (int j = 0; j < NX; j++) {
+        xp = x0;
+        xm = x0;
+        *field(xp, j) += h;
+        *field(xm, j) -= h;
+        TrmsPlant_derivatives(plant, xp, dp);
+        TrmsPlant_derivatives(plant, xm, dm);
+        for (int i = 0; i < NX; i++) A[i * NX + j] = (*field(dp, i) - *field(dm, i)) / (2.0 * h);
+    }
+
+    // Las entradas solo entran en los rotores: (u - w) / tau
+    memset(B, 0, sizeof(double) * NX * NU);
+    B[4 * NU + 0] = 1.0 / plant.p.tauMain;
+    B[5 * NU + 1] = 1.0 / plant.p.tauTail;
+
+    const double s[NX] = { DEG_PER_RAD, DEG_PER_RAD, DEG_PER_RAD, DEG_PER_RAD, 1.0, 1.0 };
+    for (int i = 0; i < NX; i++) {
+        for (int j = 0; j < NX; j++) A[i * NX + j] *= s[i] / s[j];
+        for (int k = 0; k < NU; k++) B[i * NU + k] *= s[i];
+    }
+}
+
+/**
+ * @brief
+ * Modelo aumentado con las integrales y discretizado (retenedor de orden cero).
+ * @note
+ * dz/dt = ángulo - consigna (en desviaciones: los ángulos del estado). Se
+ * discretiza todo junto con la exponencial de [[A B]; [0 0]] * dt.
+ */
+static void discretize(const double A[NX * NX], const double B[NX * NU], double dt,
+                       double Ad[NA * NA], double Bd[NA * NU])
+{
+    const int N = NA + NU;
+    double M[N * N], E[N * N];
+    memset(M, 0, sizeof(M));
+    for (int i = 0; i < NX; i++) {
+        for (int j = 0; j < NX; j++) M[i * N + j] = A[i * NX + j] * dt;
+        for (int k = 0; k < NU; k++) M[i * N + NA + k] = B[i * NU + k] * dt;
+    }
+    M[(NX + 0) * N + 0] = dt;   // integral del cabeceo
+    M[(NX + 1) * N + 2] = dt;   // integral de la guiñada
+
+    matExp(M, E, N);
+    for (int i = 0; i < NA; i++) {
+        for (int j = 0; j < NA; j++) Ad[i * NA + j] = E[i * N + j];
+        for (int k = 0; k < NU; k++) Bd[i * NU + k] = E[i * N + NA + k];
+    }
+}
+
+/**
+ * @brief
+ * LQR discreto: itera la ecuación de Riccati hasta que P no cambia.
+ * @note
+ * P = Q + A'PA - A'PB (R + B'PB)^-1 B'PA, K = (R + B'PB)^-1 B'PA (2 entradas:
+ * la inversa es la de una 2x2). Devuelve false si no converge.
+ */
+static bool dlqr(const double A[NA * NA], const double B[NA * NU], const double Q[NA],
+                 const double R[NU], double K[NU * NA])
+{
+    double P[NA * NA], At[NA * NA], Bt[NU * NA];
+    double PA[NA * NA], PB[NA * NU], BtPA[NU * NA], BtPB[NU * NU], AtPA[NA * NA], AtPB[NA * NU];
+    matT(A, At, NA, NA);
+    matT(B, Bt, NA, NU);
+
+    memset(P, 0, sizeof(P));
+    for (int i = 0; i < NA; i++) P[i * NA + i] = Q[i];
+
+    for (int it = 0; it < 200000; it++) {
+        matMul(P, A, PA, NA, NA, NA);
+        matMul(P, B, PB, NA, NA, NU);
+        matMul(Bt, PA, BtPA, NU, NA, NA);
+        matMul(Bt, PB, BtPB, NU, NA, NU);
+        matMul(At, PA, AtPA, NA, NA, NA);
+        matMul(At, PB, AtPB, NA, NA, NU);
+
+        const double s00 = R[0] + BtPB[0], s01 = BtPB[1];
+        const double s10 = BtPB[2],        s11 = R[1] + BtPB[3];
+        const double det = s00 * s11 - s01 * s10;
+        const double Si[NU * NU] = { s11 / det, -s01 / det, -s10 / det, s00 / det };
+        matMul(Si, BtPA, K, NU, NU, NA);
+
+        double corr[NA * NA], diff = 0.0, mag = 0.0;
+        matMul(AtPB, K, corr, NA, NU, NA);
+        for (int i = 0; i < NA * NA; i++) {
+            const double q = (i % (NA + 1) == 0) ? Q[i / NA] : 0.0;
+            const double p = q + AtPA[i] - corr[i];
+            diff = fmax(diff, fabs(p - P[i]));
+            mag  = fmax(mag, fabs(p));
+            P[i] = p;
+        }
+        if (diff <= 1e-12 * fmax(1.0, mag)) return true;
+    }
+    return false;
+}
+
+// Radio espectral aproximado de A - BK (norma de potencias grandes)
+static double closedLoopRadius(const double A[NA * NA], const double B[NA * NU], const double K[NU * NA])
+{
+    double Acl[NA * NA], BK[NA * NA], P[NA * NA], tmp[NA * NA];
+    matMul(B, K, BK, NA, NU, NA);
+    for (int i = 0; i < NA * NA; i++) Acl[i] = A[i] - BK[i];
+    memcpy(P, Acl, sizeof(P));
+
+    // ||Acl^(2^k)||^(1/2^k), renormalizando para no desbordar
+    double logScale = 0.0, exponent = 1.0;
+    for (int k = 0; k < 12; k++) {
+        matMul(P, P, tmp, NA, NA, NA);
+        logScale *= 2.0;
+        exponent *= 2.0;
+        double n = 0.0;
+        for (int i = 0; i < NA * NA; i++) n = fmax(n, fabs(tmp[i]));
+        if (n == 0.0) return 0.0;
+        for (int i = 0; i < NA * NA; i++) P[i] = tmp[i] / n;
+        logScale += log(n);
+    }
+    return exp(logScale / exponent);
+}
+
+static bool parseArgs(int argc, char **argv, DesignArgs &a)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *k = argv[i];
+        const char *v = argv[i + 1];
+        if      (!strcmp(k, "--out"))   a.outPath  = v;
+        else if (!strcmp(k, "--theta")) a.thetaDeg = atof(v);
+        else if (!strcmp(k, "--rate"))  a.rateHz   = atof(v);
+        else if (!strcmp(k, "--rpm"))   a.rpm      = atof(v);
+        else if (!strcmp(k, "--angv"))  a.angV     = atof(v);
+        else if (!strcmp(k, "--angh"))  a.angH     = atof(v);
+        else if (!strcmp(k, "--ratev")) a.rateV    = atof(v);
+        else if (!strcmp(k, "--rateh")) a.rateH    = atof(v);
+        else if (!strcmp(k, "--intv"))  a.intV     = atof(v);
+        else if (!strcmp(k, "--inth"))  a.intH     = atof(v);
+        else if (!strcmp(k, "--umain")) a.uMain    = atof(v);
+        else if (!strcmp(k, "--utail")) a.uTail    = atof(v);
+        else return false;
+    }
+    return (argc % 2 == 1) && a.rateHz > 0.0 && a.rpm > 0.0 && a.angV > 0.0 && a.angH > 0.0 &&
+           a.rateV > 0.0 && a.rateH > 0.0 && a.intV > 0.0 && a.intH > 0.0 &&
+           a.uMain > 0.0 && a.uTail > 0.0;
+}
+
+// Literal float de C++ ("0.5f", "6000.0f", "1e-05f")
+static const char *lit(double v)
+{
+    static char buf[4][40];
+    static int  next = 0;
+    char *b = buf[next++ & 3];
+    snprintf(b, 32, "%.9g", v);
+    if (!strpbrk(b, ".en")) strcat(b, ".0");
+    strcat(b, "f");
+    return b;
+}
+
+static void writeHeader(FILE *f, const DesignArgs &a, const TrmsPlantState &x0,
+                        const double K[NU * NA], double radius)
+{
+    fprintf(f,
+        "/* Ganancias del modo STATE_FEEDBACK (LQI, ver \"StateFeedback.h\"). Generado por trms_lqi_design\n"
+        "(host/LqiDesign.cpp) a partir del modelo del simulador; no editar a mano, volver a generar:\n"
+        "\n"
+        "   trms_lqi_design --out lib/Custom_Libraries/StateFeedbackGains.h --theta %g --rate %g --rpm %g\n"
+        "                   --angv %g --angh %g --ratev %g --rateh %g --intv %g --inth %g --umain %g --utail %g\n"
+        "\n"
+        "Equilibrio de diseño: cabeceo %g deg, guiñada 0 deg, rotores w = %.4f / %.4f.\n"
+        "Radio espectral del lazo cerrado lineal: %.4f */\n\n",
+        a.thetaDeg, a.rateHz, a.rpm, a.angV, a.angH, a.rateV, a.rateH, a.intV, a.intH, a.uMain, a.uTail,
+        a.thetaDeg, x0.wMain, x0.wTail, radius);
+
+    fprintf(f, "// StateFeedbackGains.h\n#pragma once\n\n");
+    fprintf(f, "static constexpr float SF_DESIGN_DT    = %s;   // periodo de diseño [s]\n", lit(1.0 / a.rateHz));
+    fprintf(f, "static constexpr float SF_DESIGN_THETA = %s;   // cabeceo de diseño [deg]\n", lit(a.thetaDeg));
+    fprintf(f, "static constexpr float SF_RPM_AT_UNIT  = %s;   // rpm con velocidad normalizada 1\n", lit(a.rpm));
+    fprintf(f, "static constexpr float SF_U_EQ_MAIN    = %s;   // entradas de equilibrio [U]\n", lit(x0.wMain));
+    fprintf(f, "static constexpr float SF_U_EQ_TAIL    = %s;\n\n", lit(x0.wTail));
+
+    fprintf(f, "// u = u_eq - SF_KX * (x - x_ref) - SF_KZ * z\n");
+    fprintf(f, "// x = [cabeceo deg, deg/s, guiñada deg, deg/s, w principal, w cola], z = integrales [deg*s]\n");
+    fprintf(f, "// Filas: Uv (rotor principal), Uh (rotor de cola)\n");
+    fprintf(f, "static constexpr float SF_KX[2][6] = {\n");
+    for (int i = 0; i < NU; i++) {
+        fprintf(f, "    {");
+        for (int j = 0; j < NX; j++) fprintf(f, " %s%s", lit(K[i * NA + j]), (j + 1 < NX) ? "," : " ");
+        fprintf(f, "}%s\n", (i + 1 < NU) ? "," : "");
+    }
+    fprintf(f, "};\n\n");
+    fprintf(f, "static constexpr float SF_KZ[2][2] = {\n");
+    for (int i = 0; i < NU; i++) {
+        fprintf(f, "    {");
+        for (int j = 0; j < NZ; j++) fprintf(f, " %s%s", lit(K[i * NA + NX + j]), (j + 1 < NZ) ? "," : " ");
+        fprintf(f, "}%s\n", (i + 1 < NU) ? "," : "");
+    }
+    fprintf(f, "};\n");
+}
+
+int main(int argc, char **argv)
+{
+    DesignArgs a;
+    if (!parseArgs(argc, argv, a)) {
+        fprintf(stderr,
+                "uso: trms_lqi_design [--out FICHERO.h] [--theta DEG] [--rate HZ] [--rpm RPM]\n"
+                "                     [--angv DEG] [--angh DEG] [--ratev DEG/S] [--rateh DEG/S]\n"
+                "                     [--intv DEG*S] [--inth DEG*S] [--umain U] [--utail U]\n");
+        return 2;
+    }
+
+    TrmsPlant plant;
+    TrmsPlant_init(plant, TrmsPlant_defaultParams());
+
+    TrmsPlantState x0;
+    if (!equilibrium(plant, a.thetaDeg / DEG_PER_RAD, x0)) {
+        fprintf(stderr, "trms_lqi_design: no hay equilibrio en %g deg\n", a.thetaDeg);
+        return 1;
+    }
+
+    double A[NX * NX], B[NX * NU], Ad[NA * NA], Bd[NA * NU], K[NU * NA];
+    linearize(plant, x0, A, B);
+    discretize(A, B, 1.0 / a.rateHz, Ad, Bd);
+
+    // Bryson: 1 / desviación admisible^2; las velocidades de los rotores no pesan
+    const double Q[NA] = { 1.0 / (a.angV * a.angV), 1.0 / (a.rateV * a.rateV),
+                           1.0 / (a.angH * a.angH), 1.0 / (a.rateH * a.rateH),
+                           0.0, 0.0,
+                           1.0 / (a.intV * a.intV), 1.0 / (a.intH * a.intH) };
+    const double R[NU] = { 1.0 / (a.uMain * a.uMain), 1.0 / (a.uTail * a.uTail) };
+
+    if (!dlqr(Ad, Bd, Q, R, K)) {
+        fprintf(stderr, "trms_lqi_design: la ecuación de Riccati no converge\n");
+        return 1;
+    }
+    const double radius = closedLoopRadius(Ad, Bd, K);
+
+    FILE *f = a.outPath ? fopen(a.outPath, "w") : stdout;
+    if (!f) {
+        fprintf(stderr, "trms_lqi_design: no se puede escribir %s\n", a.outPath);
+        return 1;
+    }
+    writeHeader(f, a, x0, K, radius);
+    if (f != stdout) fclose(f);
+
+    fprintf(stderr, "equilibrio: w = %.4f / %.4f, radio espectral %.4f\n", x0.wMain, x0.wTail, radius);
+    return radius < 1.0 ? 0 : 1;
+}
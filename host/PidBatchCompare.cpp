@@ -0,0 +1,261 @@
+/* Comprobación del lote de PID-4 en estructura de arrays (PID_Batch.h) frente al PID escalar. Cada
+carril lleva ganancias aleatorias que recorren todas las ramas (Isat, Tf, derivada de la medida,
+seguimiento Kt, Uh_max/Uv_max con y sin límite) y recibe sus propias entradas aleatorias, con errores
+grandes para saturar integradores y salidas; tras cada paso se hace el seguimiento con un recorte
+externo como el de los registros. Salidas, parciales e integradores deben coincidir bit a bit con
+PID4_Update / PID4_Track (y los PID sueltos con PID_Update). Al final mide el coste por carril y paso
+de los dos caminos:
+
+   trms_batch_compare [--lanes N] [--steps N] [--seed S]
+
+Devuelve 1 si algún carril difiere */
+
+// PidBatchCompare.cpp
+#include "PID_Batch.h"
+#include "PID_Control.h"
+#include "HAL.h"
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static bool sameBits(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Ganancias de un PID que recorren las ramas del núcleo
+static PIDParams randomGains(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    PIDParams g;
+    g.Kp          = 5.0f * uni(rng);
+    g.Ki          = (uni(rng) < 0.2f) ? 0.0f : 5.0f * uni(rng);
+    g.Kd          = (uni(rng) < 0.2f) ? 0.0f : 2.0f * uni(rng);
+    g.I_sat       = (uni(rng) < 0.3f) ? 0.0f : 2.0f * uni(rng);
+    g.Tf          = (uni(rng) < 0.4f) ? 0.0f : 0.05f * uni(rng);
+    g.derivOnMeas = uni(rng) < 0.5f;
+    g.Kt          = (uni(rng) < 0.4f) ? 0.0f : 2.0f * uni(rng);
+    return g;
+}
+
+// Recorte externo (como el de los registros): lo aplicado cabe en ±lim
+static float clip(float u, float lim)
+{
+    if (u >  lim) return  lim;
+    if (u < -lim) return -lim;
+    return u;
+}
+
+struct Mismatch {
+    size_t count = 0;
+    size_t firstLane = 0;
+    int    firstStep = -1;
+    const char *what = "";
+};
+
+static void note(Mismatch &m, bool same, size_t lane, int step, const char *what)
+{
+    if (same) return;
+    if (m.count == 0) {
+        m.firstLane = lane;
+        m.firstStep = step;
+        m.what      = what;
+    }
+    m.count++;
+}
+
+/**
+ * @brief
+ * PID-4: lote frente a PID4_Update + PID4_Track carril a carril.
+ */
+static Mismatch comparePid4(size_t lanes, int steps, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+
+    PID4Batch b;
+    PID4Batch_init(b, lanes);
+    std::vector<PID4Params> params(lanes);
+    std::vector<PID4State>  states(lanes);
+    std::vector<float>      lim1(lanes), lim2(lanes);
+
+    for (size_t i = 0; i < lanes; i++) {
+        PID4Params &p = params[i];
+        p.hh = randomGains(rng);
+        p.hv = randomGains(rng);
+        p.vh = randomGains(rng);
+        p.vv = randomGains(rng);
+        p.Uh_max = (uni(rng) < -0.6f) ? 0.0f : 1.0f + uni(rng);
+        p.Uv_max = (uni(rng) < -0.6f) ? 0.0f : 1.0f + uni(rng);
+        lim1[i] = 0.6f + 0.5f * uni(rng);
+        lim2[i] = 0.6f + 0.5f * uni(rng);
+        PID4Batch_setLane(b, i, p);
+        PID4_Reset(states[i]);
+    }
+    PID4Batch_reset(b);
+
+    std::vector<float> in1(lanes), in2(lanes), m1(lanes), m2(lanes);
+    std::vector<float> o1(lanes), o2(lanes), x1(lanes), x2(lanes);
+    std::vector<float> phh(lanes), phv(lanes), pvh(lanes), pvv(lanes);
+    const PID4BatchPartials parts = { phh.data(), phv.data(), pvh.data(), pvv.data() };
+
+    Mismatch mm;
+    for (int k = 0; k < steps; k++) {
+        // dt fijo salvo algún paso con dt = 0 (los dos caminos usan 1 ms)
+        const float dt = (k % 97 == 50) ? 0.0f : 0.005f;
+        const float big = (k / 200) % 2 ? 2.0f : 0.05f;   // tramos con errores grandes
+        for (size_t i = 0; i < lanes; i++) {
+            in1[i] = big * uni(rng);
+            in2[i] = big * uni(rng);
+            m1[i]  = uni(rng);
+            m2[i]  = uni(rng);
+        }
+
+        PID4Batch_update(b, in1.data(), in2.data(), dt, o1.data(), o2.data(), &parts, m1.data(), m2.data());
+        for (size_t i = 0; i < lanes; i++) {
+            x1[i] = clip(o1[i], lim1[i]) - o1[i];
+            x2[i] = clip(o2[i], lim2[i]) - o2[i];
+        }
+        PID4Batch_track(b, x1.data(), x2.data(), dt);
+
+        for (size_t i = 0; i < lanes; i++) {
+            float s1, s2;
+            PID4Partials sp;
+            PID4_Update(params[i], states[i], in1[i], in2[i], dt, s1, s2, &sp, m1[i], m2[i]);
+            note(mm, sameBits(s1, o1[i]) && sameBits(s2, o2[i]), i, k, "las salidas");
+            note(mm, sameBits(sp.u_hh, phh[i]) && sameBits(sp.u_hv, phv[i]) &&
+                     sameBits(sp.u_vh, pvh[i]) && sameBits(sp.u_vv, pvv[i]), i, k, "las salidas parciales");
+
+            PID4_Track(params[i], states[i], clip(s1, lim1[i]) - s1, clip(s2, lim2[i]) - s2, dt);
+            note(mm, sameBits(states[i].hh.integrator(), b.hh.integrator[i]) &&
+                     sameBits(states[i].hv.integrator(), b.hv.integrator[i]) &&
+                     sameBits(states[i].vh.integrator(), b.vh.integrator[i]) &&
+                     sameBits(states[i].vv.integrator(), b.vv.integrator[i]), i, k, "los integradores");
+        }
+    }
+
+    PID4Batch_free(b);
+    return mm;
+}
+
+/**
+ * @brief
+ * PID sueltos: PIDBatch_update (sin medida) frente a PID_Update.
+ */
+static Mismatch comparePid(size_t lanes, int steps, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+
+    PID4Batch b;   // se usan solo los arrays de hh
+    PID4Batch_init(b, lanes);
+    std::vector<PID4Params> params(lanes);
+    std::vector<PIDState>   states(lanes);
+    for (size_t i = 0; i < lanes; i++) {
+        params[i].hh = randomGains(rng);
+        PID4Batch_setLane(b, i, params[i]);
+        PID_Reset(states[i]);
+    }
+    PID4Batch_reset(b);
+
+    std::vector<float> in(lanes), out(lanes);
+    Mismatch mm;
+    for (int k = 0; k < steps; k++) {
+        for (size_t i = 0; i < lanes; i++) in[i] = uni(rng);
+        PIDBatch_update(b.hh, lanes, in.data(), 0.005f, nullptr, out.data());
+        for (size_t i = 0; i < lanes; i++) {
+            note(mm, sameBits(PID_Update(params[i].hh, states[i], in[i], 0.005f), out[i]), i, k, "las salidas");
+        }
+    }
+
+    PID4Batch_free(b);
+    return mm;
+}
+
+/**
+ * @brief
+ * ns por carril y paso: PID4_Update en bucle frente a PID4Batch_update.
+ */
+static void measure(size_t lanes, int steps)
+{
+    std::vector<PID4Params> params(lanes);
+    std::vector<PID4State>  states(lanes);
+    PID4Batch b;
+    PID4Batch_init(b, lanes);
+
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < lanes; i++) {
+        params[i] = { randomGains(rng), randomGains(rng), randomGains(rng), randomGains(rng), 1.0f, 1.0f };
+        PID4Batch_setLane(b, i, params[i]);
+    }
+
+    std::vector<float> in1(lanes, 0.01f), in2(lanes, -0.02f), o1(lanes), o2(lanes);
+    volatile float sink = 0.0f;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < steps; k++) {
+        for (size_t i = 0; i < lanes; i++) {
+            PID4_Update(params[i], states[i], in1[i], in2[i], 0.005f, o1[i], o2[i]);
+        }
+        sink = sink + o1[k % lanes];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < steps; k++) {
+        PID4Batch_update(b, in1.data(), in2.data(), 0.005f, o1.data(), o2.data());
+        sink = sink + o1[k % lanes];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    const double n = (double)lanes * steps;
+    const double nsScalar = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    const double nsBatch  = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+    printf("coste por carril y paso: escalar %.2f ns, lote %.2f ns (x%.1f)\n",
+           nsScalar, nsBatch, nsScalar / nsBatch);
+
+    PID4Batch_free(b);
+}
+
+int main(int argc, char **argv)
+{
+    size_t   lanes = 1024;
+    int      steps = 2000;
+    uint32_t seed  = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "--lanes") && i + 1 < argc) lanes = (size_t)atol(argv[++i]);
+        else if (!strcmp(argv[i], "--steps") && i + 1 < argc) steps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed")  && i + 1 < argc) seed  = (uint32_t)atol(argv[++i]);
+        else {
+            printf("uso: trms_batch_compare [--lanes N] [--steps N] [--seed S]\n");
+            return 2;
+        }
+    }
+    if (lanes == 0) lanes = 1;
+    HAL_hostSetLogEnabled(false);
+
+    if (!PID_BATCH_MATCHES_SCALAR) {
+        printf("La variante del PID (build_flags) no es la del lote: no se compara\n");
+        return 0;
+    }
+
+    printf("Lote de PID-4 frente a PID escalar: %zu carriles, %d pasos\n", lanes, steps);
+    const Mismatch m4 = comparePid4(lanes, steps, seed);
+    printf("%-10s %12zu carriles x paso distintos\n", "PID-4", m4.count);
+    const Mismatch m1 = comparePid(lanes, steps, seed + 1);
+    printf("%-10s %12zu carriles x paso distintos\n", "PID", m1.count);
+
+    measure(lanes, steps / 4 + 1);
+
+    for (const Mismatch *m : { &m4, &m1 }) {
+        if (m->count) {
+            printf("FALLO: difieren %s (primero: carril %zu, paso %d)\n", m->what, m->firstLane, m->firstStep);
+            return 1;
+        }
+    }
+    printf("OK\n");
+    return 0;
+}
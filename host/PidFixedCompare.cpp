@@ -0,0 +1,179 @@
+/* Comparación del PID-4 en coma fija (PID_Fixed.h) con el PID-4 en float. El lazo cerrado corre en
+el simulador (TrmsSim) con el firmware tal como esté compilado; en cada ciclo se pasan las mismas
+cuentas, consignas y dt a los dos núcleos (cada uno con su propio estado) y se comparan las salidas
+en unidades de registro y los registros enteros antes de las lógicas de salida:
+
+   trms_fixed_compare [--rate HZ] [--verbose]
+
+Devuelve 1 si algún registro difiere en más de PID_FIXED_REG_TOLERANCE */
+
+// PidFixedCompare.cpp
+#include "TrmsSim.h"
+#include "PID_Control.h"
+#include "PID_Fixed.h"
+#include "PID_Kernels.h"
+#include "PID_Parameters.h"
+#include "HAL.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const float DEG2RAD = 0.01745329251994329577f;
+
+// Escalón de consignas en tStepS (MIMO_FULL)
+struct CompareScenario {
+    const char *name;
+    float       refV0, refH0;
+    float       refV1, refH1;
+    float       tStepS;
+    float       durationS;
+};
+
+static const CompareScenario SCENARIOS[] = {
+    { "v_up_across_rest",   -45.0f,  0.0f, -20.0f,   0.0f, 5.0f, 30.0f },
+    { "v_down_across_rest", -20.0f,  0.0f, -45.0f,   0.0f, 5.0f, 30.0f },
+    { "h_step_pos35",         0.0f,  0.0f,   0.0f,  35.0f, 5.0f, 30.0f },
+    { "h_step_neg35",         0.0f,  0.0f,   0.0f, -35.0f, 5.0f, 30.0f },
+    { "vh_combined",          0.0f,  0.0f,  10.0f,  30.0f, 5.0f, 30.0f },
+};
+
+// Diferencias acumuladas de un ensayo
+struct CompareStats {
+    uint32_t samples;
+    uint32_t regMismatch;   // muestras con algún registro distinto
+    int      maxRegDiff;    // |registro fijo - registro float|, máximo
+    float    maxRDiff;      // |R fijo - R float| [unidades de registro], máximo
+};
+
+static void loadParams(const PID_CURR &c, PID4Params &p)
+{
+    p.vv = { c.KpvvCurr, c.KivvCurr, c.KdvvCurr, c.IsatvvCurr,
+              c.TfvCurr, c.DerivOnMeasCurr };
+    p.hv = { c.KphvCurr, c.KihvCurr, c.KdhvCurr, c.IsathvCurr,
+              c.TfhCurr, c.DerivOnMeasCurr };
+    p.vh = { c.KpvhCurr, c.KivhCurr, c.KdvhCurr, c.IsatvhCurr,
+              c.TfvCurr, c.DerivOnMeasCurr };
+    p.hh = { c.KphhCurr, c.KihhCurr, c.KdhhCurr, c.IsathhCurr,
+              c.TfhCurr, c.DerivOnMeasCurr };
+    p.Uv_max = c.UvmaxCurr;
+    p.Uh_max = c.UhmaxCurr;
+}
+
+static float toRegUnits(float U, float Umax)
+{
+    return (Umax > 0.0f) ? U / Umax * 100.0f : 0.0f;
+}
+
+static bool runScenario(const CompareScenario &sc, uint32_t rateHz, CompareStats &st)
+{
+    TrmsSimConfig cfg = TrmsSim_defaultConfig();
+    cfg.rateHz = rateHz;
+    if (!TrmsSim_begin(cfg)) return false;
+
+    const float degPerCountV = 360.0f / cfg.encoders.countsPerRevVertical;
+    const float degPerCountH = 360.0f / cfg.encoders.countsPerRevHorizontal;
+
+    PID_LoadDefaults();
+    PID4_ResetShapingState();
+    PID4_ResetVerticalFeedforward();
+    PID4_LoadFromCurr(g_pidCurr);
+    PID4_SetMode(PIDMode::MIMO_FULL);
+    PID4_SetReferences(sc.refV0, sc.refH0);
+    PID4_SetEnabled(true);
+
+    // Los dos núcleos que se comparan, con estado propio
+    PID4Params      fp;
+    PID4State       fs;
+    PID4FixedParams qp;
+    PID4FixedState  qs;
+    loadParams(g_pidCurr, fp);
+    PID4Fixed_FromFloat(fp, degPerCountV, degPerCountH, qp);
+    PID4_Reset(fs);
+    qs.reset();
+
+    memset(&st, 0, sizeof(st));
+    bool stepped = false;
+
+    TelemetryRecord rec;
+    while (TrmsSim_timeS() < sc.durationS) {
+        if (!stepped && TrmsSim_timeS() >= sc.tStepS) {
+            PID4_SetReferences(sc.refV1, sc.refH1);
+            stepped = true;
+        }
+        if (!TrmsSim_step(rec) || !rec.pidEnabled) continue;
+
+        // Float: errores en rad, como PID4_StepWithCounts
+        const float measV = (float)rec.countV * degPerCountV;
+        const float measH = (float)rec.countH * degPerCountH;
+        const float ev = rec.refVDeg * DEG2RAD - measV * DEG2RAD;
+        const float eh = rec.refHDeg * DEG2RAD - measH * DEG2RAD;
+        float Uh, Uv;
+        PID4_Update(fp, fs, eh, ev, rec.dtS, Uh, Uv, nullptr, measH * DEG2RAD, measV * DEG2RAD);
+
+        // Coma fija: errores en cuentas
+        const Q16 cV = Q16::fromInt(rec.countV);
+        const Q16 cH = Q16::fromInt(rec.countH);
+        const Q16 refV = Q16::fromFloat(rec.refVDeg / degPerCountV);
+        const Q16 refH = Q16::fromFloat(rec.refHDeg / degPerCountH);
+        Q16 Rh, Rv;
+        PID4Fixed_Update(qp, qs, refH - cH, refV - cV, Q16::fromFloat(rec.dtS), Rh, Rv, nullptr, cH, cV);
+
+        const int dRegH = abs(PID4Fixed_ToRegister(Rh) - U_to_Register(Uh, fp.Uh_max));
+        const int dRegV = abs(PID4Fixed_ToRegister(Rv) - U_to_Register(Uv, fp.Uv_max));
+        const float dRh = fabsf(Rh.toFloat() - toRegUnits(Uh, fp.Uh_max));
+        const float dRv = fabsf(Rv.toFloat() - toRegUnits(Uv, fp.Uv_max));
+
+        st.samples++;
+        if (dRegH || dRegV) st.regMismatch++;
+        if (dRegH > st.maxRegDiff) st.maxRegDiff = dRegH;
+        if (dRegV > st.maxRegDiff) st.maxRegDiff = dRegV;
+        if (dRh > st.maxRDiff) st.maxRDiff = dRh;
+        if (dRv > st.maxRDiff) st.maxRDiff = dRv;
+    }
+
+    PID4_SetEnabled(false);
+    TrmsSim_end();
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t rateHz = 200;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--verbose")) verbose = true;
+        else if (!strcmp(argv[i], "--rate") && i + 1 < argc) rateHz = (uint32_t)atoi(argv[++i]);
+        else {
+            printf("uso: trms_fixed_compare [--rate HZ] [--verbose]\n");
+            return 2;
+        }
+    }
+    if (rateHz == 0) rateHz = 200;
+
+    HAL_hostSetLogEnabled(verbose);
+
+    printf("PID-4 coma fija (Q16.16) frente a float, %s, %u Hz, tolerancia %d registro\n",
+           PID_FIXED_POINT ? "lazo en coma fija" : "lazo en float", rateHz, PID_FIXED_REG_TOLERANCE);
+    printf("%-20s %8s %10s %12s %10s\n", "ensayo", "muestras", "reg != ", "max |dReg|", "max |dR|");
+
+    int worst = 0;
+    for (const CompareScenario &sc : SCENARIOS) {
+        CompareStats st;
+        if (!runScenario(sc, rateHz, st)) {
+            fprintf(stderr, "trms_fixed_compare: fallo al inicializar el simulador\n");
+            return 1;
+        }
+        printf("%-20s %8u %9.3f%% %12d %10.5f\n", sc.name, st.samples,
+               st.samples ? 100.0 * st.regMismatch / st.samples : 0.0, st.maxRegDiff, st.maxRDiff);
+        if (st.maxRegDiff > worst) worst = st.maxRegDiff;
+    }
+
+    if (worst > PID_FIXED_REG_TOLERANCE) {
+        printf("FALLO: diferencia de %d registros (tolerancia %d)\n", worst, PID_FIXED_REG_TOLERANCE);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,38 @@
+/* Micro-benchmark de host de los núcleos del PID (ver "PID_Bench.h"), sobre Google Benchmark.
+Registra un benchmark por caso de la tabla compartida con el comando "bench" del ESP32:
+
+   trms_pid_microbench [--benchmark_filter=vert_] [--benchmark_format=json] ... */
+
+// PidMicroBench.cpp
+#include "PID_Bench.h"
+#include "HAL.h"
+
+#include <benchmark/benchmark.h>
+
+// Iteraciones por llamada a run(): amortiza el coste de la llamada indirecta
+static const uint32_t BATCH = 256;
+
+static void benchCase(benchmark::State &state, size_t idx)
+{
+    const PIDBenchCase &c = PIDBench_case(idx);
+    PIDBench_prepare(idx);
+
+    while (state.KeepRunningBatch(BATCH)) {
+        c.run(BATCH);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    HAL_hostSetLogEnabled(false);
+
+    for (size_t i = 0; i < PIDBench_caseCount(); i++) {
+        benchmark::RegisterBenchmark(PIDBench_case(i).name, benchCase, i);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
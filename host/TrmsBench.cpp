@@ -0,0 +1,254 @@
+/* Batería de ensayos en lazo cerrado del PID-4 contra el modelo del TRMS (TrmsSim). Para cada modo
+(MIMO_FULL, VERTICAL_ONLY, HORIZONTAL_ONLY y STATE_FEEDBACK, el LQI que sustituye al PID-4) ejecuta un catálogo fijo de escalones y perturbaciones y
+mide calidad de control (subida, sobreoscilación, establecimiento, IAE/ITAE, recorrido de los
+actuadores, tiempo con la salida recortada por los límites) y coste del paso de PID (ns por paso, perfilador). Los resultados van a un CSV para
+comparar cada cambio de PID_Control.cpp con una referencia:
+
+   trms_bench [--out FICHERO.csv] [--baseline REF.csv] [--rate HZ] [--dmeas 0|1] [--tf S]
+              [--ktv K] [--kth K] [--sched TABLAS.txt] [--ffwarm 0|1] [--traj 0|1] [--observer 0|1]
+
+--dmeas, --tf, --ktv y --kth cambian sobre los valores por defecto DerivOnMeasCurr, TfvCurr/TfhCurr
+y las ganancias de seguimiento del anti-windup de los PID que forman Uv (KtvvCurr, KthvCurr) y Uh
+(KthhCurr, KtvhCurr). --sched carga tablas de ganancias con el formato de Sched_N.txt de la SD
+(ver GainSchedule.h; ejemplo en host/Sched_ejemplo.txt). Cada ensayo arranca con el mapa de
+equilibrio vertical en la recta por defecto; con --ffwarm 1 se ejecuta antes una vez el mismo ensayo
+y se mide con el mapa que ha aprendido (como tras reiniciar el equipo con el mapa guardado en NVS).
+Con --traj 1 las consignas siguen la trayectoria con los límites por defecto del firmware
+(PID4_TRAJ_DEFAULT_VERT/HOR) en lugar de saltar. Con --observer 1 el ciclo lleva el observador de
+estado por defecto y la derivada de la medida usa sus ángulos filtrados (junto con --dmeas 1); el
+modo STATE_FEEDBACK lo lleva siempre.
+
+Con --baseline se imprime, por ensayo, la diferencia de cada métrica respecto a REF.csv */
+
+// TrmsBench.cpp
+#include "BenchScenarios.h"
+#include "HAL.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cambios sobre PID_LoadDefaults (ver BenchOptions)
+static BenchOptions s_opt;
+static bool         s_ffWarm = false;
+
+/**
+ * @brief
+ * Carga un fichero de tablas de ganancias (como Sched_N.txt en la SD).
+ */
+static bool loadSchedules(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "trms_bench: no se puede abrir %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *text = (char *)malloc((size_t)len + 1);
+    size_t got = fread(text, 1, (size_t)len, f);
+    text[got] = '\0';
+    fclose(f);
+
+    static GsTableSpec specs[GS_TABLE_COUNT];
+    int badLine = GainSchedule_parse(text, specs);
+    free(text);
+    if (badLine) {
+        fprintf(stderr, "trms_bench: %s: error en la línea %d\n", path, badLine);
+        return false;
+    }
+    if (!PID4_LoadSchedules(specs)) {
+        fprintf(stderr, "trms_bench: %s: alguna tabla no es válida\n", path);
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// CSV
+// ------------------------------------------------------------
+
+static const char *CSV_HEADER =
+    "mode,scenario,axis,step_deg,rise_s,overshoot_pct,settle_s,peak_err_deg,final_err_deg,"
+    "iae,itae,travel_mp,travel_rdc,ns_per_step,ns_p99,sat_mp_pct,sat_rdc_pct";
+
+// Métricas numéricas en el orden de CSV_HEADER (a partir de step_deg). Las columnas
+// nuevas van al final para poder seguir comparando con CSV anteriores.
+static const int METRIC_COUNT = 14;
+static const char *const METRIC_NAMES[METRIC_COUNT] = {
+    "step_deg", "rise_s", "overshoot_pct", "settle_s", "peak_err_deg", "final_err_deg",
+    "iae", "itae", "travel_mp", "travel_rdc", "ns_per_step", "ns_p99", "sat_mp_pct", "sat_rdc_pct"
+};
+
+static void resultValues(const BenchResult &r, double v[METRIC_COUNT])
+{
+    v[0]  = r.m.stepDeg;
+    v[1]  = r.m.riseS;
+    v[2]  = r.m.overshootPct;
+    v[3]  = r.m.settleS;
+    v[4]  = r.m.peakErrDeg;
+    v[5]  = r.m.finalErrDeg;
+    v[6]  = r.m.iae;
+    v[7]  = r.m.itae;
+    v[8]  = r.travelMP;
+    v[9]  = r.travelRDC;
+    v[10] = r.nsPerStep;
+    v[11] = r.nsP99;
+    v[12] = r.satMPPct;
+    v[13] = r.satRDCPct;
+}
+
+static void writeCsv(FILE *f, const BenchResult *res, size_t n)
+{
+    fprintf(f, "%s\n", CSV_HEADER);
+    for (size_t i = 0; i < n; i++) {
+        double v[METRIC_COUNT];
+        resultValues(res[i], v);
+        fprintf(f, "%s,%s,%c", res[i].mode, res[i].scenario, res[i].axis);
+        for (int k = 0; k < METRIC_COUNT; k++) fprintf(f, ",%.9g", v[k]);
+        fprintf(f, "\n");
+    }
+}
+
+/**
+ * @brief
+ * Compara con un CSV de referencia (mismo formato) e imprime las diferencias.
+ * @note
+ * Las filas se emparejan por modo + ensayo + eje; las que no están en la
+ * referencia se marcan como nuevas.
+ */
+static bool compareBaseline(const char *path, const BenchResult *res, size_t n)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "trms_bench: no se puede abrir %s\n", path);
+        return false;
+    }
+
+    struct Row { char key[96]; double v[METRIC_COUNT]; };
+    Row *rows = (Row *)malloc(sizeof(Row) * 256);
+    size_t nRows = 0;
+
+    char line[512];
+    if (!fgets(line, sizeof(line), f)) line[0] = '\0';   // cabecera
+    while (nRows < 256 && fgets(line, sizeof(line), f)) {
+        char mode[32], scen[48], axis;
+        Row &r = rows[nRows];
+        char *p = line;
+        if (sscanf(p, "%31[^,],%47[^,],%c", mode, scen, &axis) != 3) continue;
+        snprintf(r.key, sizeof(r.key), "%s/%s/%c", mode, scen, axis);
+
+        for (int c = 0; c < 3; c++) p = strchr(p, ',') + 1;
+        for (int k = 0; k < METRIC_COUNT; k++) {
+            r.v[k] = strtod(p, &p);
+            if (*p == ',') p++;
+        }
+        nRows++;
+    }
+    fclose(f);
+
+    printf("\nComparación con %s (actual - referencia):\n", path);
+    for (size_t i = 0; i < n; i++) {
+        char key[96];
+        snprintf(key, sizeof(key), "%s/%s/%c", res[i].mode, res[i].scenario, res[i].axis);
+
+        const Row *base = nullptr;
+        for (size_t j = 0; j < nRows; j++) {
+            if (!strcmp(rows[j].key, key)) { base = &rows[j]; break; }
+        }
+        if (!base) {
+            printf("  %-40s (nuevo)\n", key);
+            continue;
+        }
+
+        double v[METRIC_COUNT];
+        resultValues(res[i], v);
+        printf("  %-40s", key);
+        for (int k = 1; k < METRIC_COUNT; k++) {
+            double d = v[k] - base->v[k];
+            double tol = 1e-6 * fmax(1.0, fabs(base->v[k]));   // redondeo del CSV
+            if (isnan(v[k]) != isnan(base->v[k])) printf(" %s=%s", METRIC_NAMES[k], isnan(v[k]) ? "nan" : "ok");
+            else if (!isnan(d) && fabs(d) > tol) printf(" %s%+.3g", METRIC_NAMES[k], d);
+        }
+        printf("\n");
+    }
+
+    free(rows);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *outPath  = "trms_bench.csv";
+    const char *basePath = nullptr;
+    const char *schedPath = nullptr;
+    uint32_t    rateHz   = 200;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if      (!strcmp(argv[i], "--out"))      outPath  = argv[i + 1];
+        else if (!strcmp(argv[i], "--baseline")) basePath = argv[i + 1];
+        else if (!strcmp(argv[i], "--rate"))     rateHz   = (uint32_t)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--dmeas"))    s_opt.derivOnMeas = atoi(argv[i + 1]) ? 1 : 0;
+        else if (!strcmp(argv[i], "--tf"))       s_opt.tfS    = (float)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--ktv"))      s_opt.ktV    = (float)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--kth"))      s_opt.ktH    = (float)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--sched"))    schedPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--ffwarm"))   s_ffWarm = atoi(argv[i + 1]) != 0;
+        else if (!strcmp(argv[i], "--traj"))     s_opt.traj   = atoi(argv[i + 1]) != 0;
+        else if (!strcmp(argv[i], "--observer")) s_opt.observer = atoi(argv[i + 1]) != 0;
+        else {
+            printf("uso: trms_bench [--out FICHERO.csv] [--baseline REF.csv] [--rate HZ]\n"
+                   "                  [--dmeas 0|1] [--tf S] [--ktv K] [--kth K] [--sched TABLAS.txt]\n"
+                   "                  [--ffwarm 0|1] [--traj 0|1] [--observer 0|1]\n");
+            return 2;
+        }
+    }
+    if (rateHz == 0) rateHz = 200;
+
+    HAL_hostSetLogEnabled(false);
+
+    if (schedPath && !loadSchedules(schedPath)) return 1;
+
+    BenchResult *results = (BenchResult *)calloc(BENCH_SCENARIO_COUNT * BENCH_MODE_COUNT * 2, sizeof(BenchResult));
+    size_t nRes = 0;
+
+    for (size_t m = 0; m < BENCH_MODE_COUNT; m++) {
+        const BenchMode &md = BENCH_MODES[m];
+        for (size_t s = 0; s < BENCH_SCENARIO_COUNT; s++) {
+            const BenchScenario &sc = BENCH_SCENARIOS[s];
+            if (!Bench_appliesTo(sc, md)) continue;
+            PID4_ResetVerticalFeedforward();
+            if (s_ffWarm) {
+                BenchResult warm[2];
+                Bench_runScenario(sc, md, rateHz, s_opt, warm);
+            }
+            nRes += Bench_runScenario(sc, md, rateHz, s_opt, &results[nRes]);
+        }
+    }
+
+    printf("%-16s %-20s %s %8s %8s %8s %8s %8s %9s %7s %6s %7s\n",
+           "modo", "ensayo", "eje", "paso", "subida", "sobreo%", "estab.", "e_final", "IAE", "recorr",
+           "sat%", "ns/paso");
+    for (size_t i = 0; i < nRes; i++) {
+        const BenchResult &r = results[i];
+        printf("%-16s %-20s  %c  %8.2f %8.3f %8.2f %8.3f %8.3f %9.3f %7u %6.1f %7.0f\n",
+               r.mode, r.scenario, r.axis, r.m.stepDeg, r.m.riseS, r.m.overshootPct,
+               r.m.settleS, r.m.finalErrDeg, r.m.iae, r.travelMP + r.travelRDC,
+               (r.axis == 'v') ? r.satMPPct : r.satRDCPct, r.nsPerStep);
+    }
+
+    FILE *f = fopen(outPath, "w");
+    if (!f) {
+        fprintf(stderr, "trms_bench: no se puede escribir %s\n", outPath);
+        return 1;
+    }
+    writeCsv(f, results, nRes);
+    fclose(f);
+    printf("\nResultados en %s\n", outPath);
+
+    const bool ok = !basePath || compareBaseline(basePath, results, nRes);
+    free(results);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+/* Modelo no lineal del TRMS (ver "TrmsPlant.h"): integración RK4 a paso fijo de la dinámica de
+cabeceo/guiñada y de los rotores, con topes mecánicos */
+
+// TrmsPlant.cpp
+#include "TrmsPlant.h"
+
+#include <math.h>
+
+static const double DEG_PER_RAD = 57.29577951308232;
+
+/**
+ * @brief
+ * Parámetros por defecto del modelo.
+ * @note
+ * Valores del orden de un TRMS de laboratorio (viga de ~0.5 m con contrapeso).
+ * La calibración clave es el equilibrio: con G = 0.3 N m y reposo en -36°,
+ * sostener la viga horizontal pide G*sin(36°) = 0.176 N m, que el rotor
+ * principal da con w = 0.53 -> registro 53 (feedforward en 0°, PID_Control.cpp).
+ * El rozamiento de cabeceo (bv, que incluye el arrastre aerodinámico de la
+ * viga) es el que deja estable el lazo vertical con las ganancias de
+ * PID_LoadDefaults (Kdvv = 0), como ocurre en el equipo.
+ */
+TrmsPlantParams TrmsPlant_defaultParams()
+{
+    TrmsPlantParams p;
+
+    p.tauMain        = 0.30f;
+    p.torqueMainMax  = 0.628f;
+    p.revFactorMain  = 0.5f;
+
+    p.tauTail        = 0.20f;
+    p.torqueTailMax  = 0.12f;
+    p.revFactorTail  = 0.6f;
+
+    p.Jv             = 0.055f;
+    p.G              = 0.30f;
+    p.thetaRestRad   = (float)(-36.0 / DEG_PER_RAD);
+    p.bv             = 0.20f;
+    p.thetaMinRad    = (float)(-60.0 / DEG_PER_RAD);
+    p.thetaMaxRad    = (float)( 60.0 / DEG_PER_RAD);
+
+    p.Jh0            = 0.015f;
+    p.Jh1            = 0.035f;
+    p.bh             = 0.03f;
+    p.kCable         = 0.02f;
+    p.phiMinRad      = (float)(-170.0 / DEG_PER_RAD);
+    p.phiMaxRad      = (float)( 170.0 / DEG_PER_RAD);
+
+    p.kGyro          = 0.01f;
+    p.kMainYaw       = 0.03f;
+    p.kTailPitch     = 0.005f;
+
+    p.stepS          = 0.001f;
+    return p;
+}
+
+void TrmsPlant_init(TrmsPlant &plant, const TrmsPlantParams &params)
+{
+    plant.p          = params;
+    plant.x          = {};
+    plant.x.thetaRad = params.thetaRestRad;
+    plant.uMain      = 0.0f;
+    plant.uTail      = 0.0f;
+    plant.distPitch  = 0.0f;
+    plant.distYaw    = 0.0f;
+    plant.tS         = 0.0;
+}
+
+void TrmsPlant_setPose(TrmsPlant &plant, float thetaDeg, float phiDeg)
+{
+    plant.x = {};
+    plant.x.thetaRad = thetaDeg / DEG_PER_RAD;
+    plant.x.phiRad   = phiDeg   / DEG_PER_RAD;
+}
+
+static float clampUnit(float u)
+{
+    if (u >  1.0f) return  1.0f;
+    if (u < -1.0f) return -1.0f;
+    return u;
+}
+
+void TrmsPlant_setInputs(TrmsPlant &plant, float uMain, float uTail)
+{
+    plant.uMain = clampUnit(uMain);
+    plant.uTail = clampUnit(uTail);
+}
+
+// Par de un rotor a partir de su velocidad normalizada (cuadrático, asimétrico)
+static double rotorTorque(double w, float torqueMax, float revFactor)
+{
+    double t = (double)torqueMax * w * w;
+    return (w >= 0.0) ? t : -(double)revFactor * t;
+}
+
+/**
+ * @brief
+ * Derivadas del estado para unas entradas dadas.
+ * @note
+ * Sin topes mecánicos: son cosa del integrador (applyStop).
+ */
+void TrmsPlant_derivatives(const TrmsPlant &plant, const TrmsPlantState &x, TrmsPlantState &dx)
+{
+    const TrmsPlantParams &p = plant.p;
+
+    double Tm = rotorTorque(x.wMain, p.torqueMainMax, p.revFactorMain);
+    double Tt = rotorTorque(x.wTail, p.torqueTailMax, p.revFactorTail);
+
+    double c = cos(x.thetaRad);
+
+    double pitchTorque = Tm
+                       - p.G * sin(x.thetaRad - p.thetaRestRad)
+                       - p.bv * x.thetaDot
+                       + p.kGyro * x.wMain * x.phiDot * c
+                       + p.kTailPitch * x.wTail * fabs(x.wTail)
+                       + plant.distPitch;
+
+    double yawTorque = Tt * c
+                     - p.bh * x.phiDot
+                     - p.kCable * x.phiRad
+                     + p.kMainYaw * x.wMain * fabs(x.wMain)
+                     + plant.distYaw;
+
+    double Jh = p.Jh0 + p.Jh1 * c * c;
+
+    dx.thetaRad = x.thetaDot;
+    dx.thetaDot = pitchTorque / p.Jv;
+    dx.phiRad   = x.phiDot;
+    dx.phiDot   = yawTorque / Jh;
+    dx.wMain    = (plant.uMain - x.wMain) / p.tauMain;
+    dx.wTail    = (plant.uTail - x.wTail) / p.tauTail;
+}
+
+static void axpy(TrmsPlantState &out, const TrmsPlantState &x, const TrmsPlantState &dx, double h)
+{
+    out.thetaRad = x.thetaRad + h * dx.thetaRad;
+    out.thetaDot = x.thetaDot + h * dx.thetaDot;
+    out.phiRad   = x.phiRad   + h * dx.phiRad;
+    out.phiDot   = x.phiDot   + h * dx.phiDot;
+    out.wMain    = x.wMain    + h * dx.wMain;
+    out.wTail    = x.wTail    + h * dx.wTail;
+}
+
+// Tope inelástico: la viga se queda en el límite y pierde la velocidad hacia fuera
+static void applyStop(double &pos, double &vel, float lo, float hi)
+{
+    if (pos < lo) { pos = lo; if (vel < 0.0) vel = 0.0; }
+    if (pos > hi) { pos = hi; if (vel > 0.0) vel = 0.0; }
+}
+
+static void rk4Step(TrmsPlant &plant, double h)
+{
+    const TrmsPlantState &x = plant.x;
+    TrmsPlantState k1, k2, k3, k4, tmp;
+
+    TrmsPlant_derivatives(plant, x, k1);
+    axpy(tmp, x, k1, 0.5 * h);
+    TrmsPlant_derivatives(plant, tmp, k2);
+    axpy(tmp, x, k2, 0.5 * h);
+    TrmsPlant_derivatives(plant, tmp, k3);
+    axpy(tmp, x, k3, h);
+    TrmsPlant_derivatives(plant, tmp, k4);
+
+    const double s = h / 6.0;
+    plant.x.thetaRad += s * (k1.thetaRad + 2.0 * k2.thetaRad + 2.0 * k3.thetaRad + k4.thetaRad);
+    plant.x.thetaDot += s * (k1.thetaDot + 2.0 * k2.thetaDot + 2.0 * k3.thetaDot + k4.thetaDot);
+    plant.x.phiRad   += s * (k1.phiRad   + 2.0 * k2.phiRad   + 2.0 * k3.phiRad   + k4.phiRad);
+    plant.x.phiDot   += s * (k1.phiDot   + 2.0 * k2.phiDot   + 2.0 * k3.phiDot   + k4.phiDot);
+    plant.x.wMain    += s * (k1.wMain    + 2.0 * k2.wMain    + 2.0 * k3.wMain    + k4.wMain);
+    plant.x.wTail    += s * (k1.wTail    + 2.0 * k2.wTail    + 2.0 * k3.wTail    + k4.wTail);
+
+    applyStop(plant.x.thetaRad, plant.x.thetaDot, plant.p.thetaMinRad, plant.p.thetaMaxRad);
+    applyStop(plant.x.phiRad,   plant.x.phiDot,   plant.p.phiMinRad,   plant.p.phiMaxRad);
+
+    plant.tS += h;
+}
+
+void TrmsPlant_advance(TrmsPlant &plant, double dtS)
+{
+    const double h = (plant.p.stepS > 0.0f) ? plant.p.stepS : 0.0005;
+
+    if (dtS <= 0.0) return;
+
+    // Número entero de pasos completos (el margen evita perder uno por redondeo)
+    long n = (long)(dtS / h + 1e-9);
+    for (long i = 0; i < n; i++) {
+        rk4Step(plant, h);
+    }
+
+    double rem = dtS - (double)n * h;
+    if (rem > 1e-9) {
+        rk4Step(plant, rem);
+    }
+}
+
+float TrmsPlant_pitchDeg(const TrmsPlant &plant)
+{
+    return (float)(plant.x.thetaRad * DEG_PER_RAD);
+}
+
+float TrmsPlant_yawDeg(const TrmsPlant &plant)
+{
+    return (float)(plant.x.phiRad * DEG_PER_RAD);
+}
@@ -0,0 +1,121 @@
+/* Modelo no lineal del TRMS (Twin Rotor MIMO System) para simular el lazo cerrado en el PC.
+Junto con "TrmsPlant.cpp" integra la dinámica de cabeceo (vertical) y guiñada (horizontal) con los dos
+rotores como entradas: empuje en función de la tensión, par gravitatorio con reposo en ~-36°,
+acoplamientos cruzados entre ejes y topes mecánicos. No depende de la HAL ni del reloj */
+
+// TrmsPlant.h
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Parámetros físicos del modelo (unidades SI, ángulos en rad).
+ *
+ * Rotores (velocidad normalizada w en [-1, 1], primer orden):
+ *   tau * dw/dt = u - w,  u = tensión normalizada del amplificador (-1..1)
+ *   empuje: T = Tmax * w^2 hacia delante, revFactor * Tmax * w^2 hacia atrás
+ *
+ * Cabeceo (theta, 0 = viga horizontal, positivo hacia arriba):
+ *   Jv * theta'' = Tm - G*sin(theta - thetaRest) - bv*theta'
+ *                  + kGyro*wm*phi'*cos(theta) + kTailPitch*wt*|wt|
+ *
+ * Guiñada (phi):
+ *   (Jh0 + Jh1*cos^2(theta)) * phi'' = Tt*cos(theta) - bh*phi' - kCable*phi
+ *                                      + kMainYaw*wm*|wm|
+ *
+ * Los valores por defecto están elegidos para que el registro de equilibrio
+ * del firmware (53) sostenga la viga cerca de la horizontal.
+ */
+struct TrmsPlantParams {
+    // Rotor principal (vertical)
+    float tauMain;          // constante de tiempo [s]
+    float torqueMainMax;    // par de cabeceo a w = 1 [N m]
+    float revFactorMain;    // eficiencia del empuje en sentido inverso (0..1)
+
+    // Rotor de cola (horizontal)
+    float tauTail;
+    float torqueTailMax;    // par de guiñada a w = 1 [N m]
+    float revFactorTail;
+
+    // Cabeceo
+    float Jv;               // inercia [kg m^2]
+    float G;                // par gravitatorio máximo [N m]
+    float thetaRestRad;     // ángulo de reposo sin empuje
+    float bv;               // rozamiento viscoso [N m s/rad]
+    float thetaMinRad;      // topes mecánicos
+    float thetaMaxRad;
+
+    // Guiñada
+    float Jh0;              // inercia independiente del cabeceo [kg m^2]
+    float Jh1;              // inercia que escala con cos^2(theta)
+    float bh;
+    float kCable;           // rigidez del cable [N m/rad]
+    float phiMinRad;
+    float phiMaxRad;
+
+    // Acoplamientos cruzados
+    float kGyro;            // giroscópico del rotor principal sobre el cabeceo
+    float kMainYaw;         // reacción del rotor principal sobre la guiñada
+    float kTailPitch;       // reacción del rotor de cola sobre el cabeceo
+
+    // Paso interno de integración (RK4) [s]
+    float stepS;
+};
+
+/**
+ * @brief Estado del modelo.
+ */
+struct TrmsPlantState {
+    double thetaRad;        // cabeceo
+    double thetaDot;
+    double phiRad;          // guiñada
+    double phiDot;
+    double wMain;           // velocidades normalizadas de los rotores
+    double wTail;
+};
+
+/**
+ * @brief Modelo completo: parámetros, estado, entradas y perturbaciones.
+ *
+ * uMain/uTail se mantienen constantes entre llamadas (retenedor de orden cero,
+ * como el DAC). distPitch/distYaw son pares externos [N m] para ensayos de
+ * rechazo de perturbaciones.
+ */
+struct TrmsPlant {
+    TrmsPlantParams p;
+    TrmsPlantState  x;
+    float           uMain;
+    float           uTail;
+    float           distPitch;
+    float           distYaw;
+    double          tS;     // tiempo simulado [s]
+};
+
+// Parámetros por defecto (TRMS de laboratorio, ver TrmsPlant.cpp)
+TrmsPlantParams TrmsPlant_defaultParams();
+
+// Inicializa el modelo en reposo (viga en thetaRest, rotores parados, t = 0)
+void TrmsPlant_init(TrmsPlant &plant, const TrmsPlantParams &params);
+
+// Fija la posición de la viga (velocidades y rotores a cero)
+void TrmsPlant_setPose(TrmsPlant &plant, float thetaDeg, float phiDeg);
+
+// Fija las tensiones normalizadas de los amplificadores (-1..1)
+void TrmsPlant_setInputs(TrmsPlant &plant, float uMain, float uTail);
+
+/**
+ * @brief Avanza el modelo dtS segundos.
+ *
+ * Integra con RK4 a paso fijo p.stepS; el último subpaso se acorta para caer
+ * exactamente en t + dtS. El resultado solo depende de la secuencia de
+ * llamadas, así que dos ejecuciones iguales dan el mismo resultado bit a bit.
+ */
+void TrmsPlant_advance(TrmsPlant &plant, double dtS);
+
+// Derivadas del estado x con las entradas y perturbaciones actuales de plant
+// (para linealizar el modelo, ver LqiDesign.cpp)
+void TrmsPlant_derivatives(const TrmsPlant &plant, const TrmsPlantState &x, TrmsPlantState &dx);
+
+// Ángulos actuales en grados
+float TrmsPlant_pitchDeg(const TrmsPlant &plant);
+float TrmsPlant_yawDeg(const TrmsPlant &plant);
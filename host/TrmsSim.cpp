@@ -0,0 +1,305 @@
+/* Simulador del TRMS en lazo cerrado (ver "TrmsSim.h"): backend de la HAL de host que emula los
+DACs, el HCTL-2016 + TCA9539 y los tacómetros sobre el modelo de "TrmsPlant.h" */
+
+// TrmsSim.cpp
+#include "TrmsSim.h"
+#include "HAL.h"
+#include "Clock.h"
+#include "ControlCycle.h"
+#include "MotorControl.h"
+#include "Tacho.h"
+
+#include <math.h>
+
+// Dirección y registros del TCA9539 (ver Encoders.cpp)
+static const uint8_t TCA_ADDR = 0x74;
+static const uint8_t TCA_REG_COUNT = 8;
+
+static const double TWO_PI = 6.283185307179586;
+
+static TrmsSimConfig s_cfg;
+static TrmsPlant     s_plant;
+static ControlCycle  s_cycle;
+static uint32_t      s_periodUs = 5000;
+static int64_t       s_plantUs  = 0;    // instante hasta el que está integrado el modelo
+static int64_t       s_tickUs   = 0;    // último disparo del lazo
+static int64_t       s_startUs  = 0;    // t = 0 de la simulación (tras Encoders_begin)
+static bool          s_hold     = false; // viga sujeta (arranque): el reloj corre pero el modelo no
+
+// Estado de los pines del HCTL-2016
+static bool s_sel = false;
+static bool s_oe  = false;
+static bool s_inhibit = false;   // cuentas retenidas durante una lectura
+
+// Contadores del HCTL: ángulo en el último reset y valor retenido en la lectura
+static double  s_zeroV = 0.0;
+static double  s_zeroH = 0.0;
+static int16_t s_latchV = 0;
+static int16_t s_latchH = 0;
+
+// Registros del TCA9539 (0..3 entrada/salida, 4..5 polaridad, 6..7 configuración)
+static uint8_t s_tcaRegs[TCA_REG_COUNT];
+
+// Registro de rotor (-100..100 en el firmware) a tensión normalizada del amplificador
+static float s_uMain = 0.0f;
+static float s_uTail = 0.0f;
+
+/**
+ * @brief
+ * Integra el modelo hasta el instante actual del reloj simulado.
+ * @note
+ * Se llama antes de cada acceso a la HAL que lee o cambia la planta, de modo
+ * que las entradas se mantienen entre escrituras del DAC (retenedor de orden
+ * cero) y cada lectura ve el estado en su instante exacto.
+ */
+static void syncPlant()
+{
+    int64_t now = Clock_nowUs();
+    if (now <= s_plantUs) return;
+
+    if (!s_hold) TrmsPlant_advance(s_plant, (double)(now - s_plantUs) * 1e-6);
+    s_plantUs = now;
+}
+
+static int16_t angleToCounts(double rad, double zeroRad, float countsPerRev)
+{
+    // El contador del HCTL es de 16 bits y da la vuelta (complemento a 2)
+    long c = lround((rad - zeroRad) * (double)countsPerRev / TWO_PI);
+    return (int16_t)(uint16_t)(c & 0xFFFF);
+}
+
+// ------------------------------------------------------------
+// Backend de la HAL
+// ------------------------------------------------------------
+
+/**
+ * @brief
+ * Pines de control del HCTL-2016.
+ * @note
+ * - RST (activo HIGH): pone a cero los contadores en la posición actual.
+ * - OE activo: retiene las cuentas de ambos ejes (lógica de inhibición del
+ *   HCTL). La retención dura hasta que OE se desactiva con SEL = 1, es decir,
+ *   hasta terminar la lectura del byte alto; el pulso de OE entre bytes que
+ *   hace Encoders.cpp no la libera, así que los dos bytes son coherentes.
+ */
+static void simGpioWrite(uint8_t pin, bool level)
+{
+    if (pin == s_cfg.pinRST) {
+        if (level) {
+            syncPlant();
+            s_zeroV = s_plant.x.thetaRad;
+            s_zeroH = s_plant.x.phiRad;
+        }
+    } else if (pin == s_cfg.pinOE) {
+        if (level && !s_inhibit) {
+            syncPlant();
+            s_latchV  = angleToCounts(s_plant.x.thetaRad, s_zeroV, s_cfg.encoders.countsPerRevVertical);
+            s_latchH  = angleToCounts(s_plant.x.phiRad,   s_zeroH, s_cfg.encoders.countsPerRevHorizontal);
+            s_inhibit = true;
+        } else if (!level && s_sel) {
+            s_inhibit = false;
+        }
+        s_oe = level;
+    } else if (pin == s_cfg.pinSEL) {
+        s_sel = level;
+    }
+}
+
+/**
+ * @brief
+ * DACs: inversa de computeDacFromRegister (MotorControl.cpp).
+ * @note
+ * 0..255 -> -1..1 (128 ~ 0 V en el amplificador).
+ */
+static void simDacWrite(uint8_t pin, uint8_t value)
+{
+    float u = (float)value / 255.0f * 2.0f - 1.0f;
+
+    if (pin == s_cfg.dacPinMain)      s_uMain = u;
+    else if (pin == s_cfg.dacPinTail) s_uTail = u;
+    else return;
+
+    syncPlant();
+    TrmsPlant_setInputs(s_plant, s_uMain, s_uTail);
+}
+
+/**
+ * @brief
+ * Tacómetros: inversa de adcToVolts + voltsAdapter (Tacho.cpp).
+ */
+static uint16_t simAdcRead(uint8_t pin)
+{
+    if (pin != s_cfg.adcPinMain && pin != s_cfg.adcPinTail) return 0;
+
+    syncPlant();
+    double w = (pin == s_cfg.adcPinMain) ? s_plant.x.wMain : s_plant.x.wTail;
+    double rpm   = w * s_cfg.rotorMaxRpm;
+    double vTach = rpm / 1000.0 * s_cfg.tachoVoltsPer1000RPM;
+    double vAdc  = 1.65 - vTach / 2.0;
+
+    long raw = lround(vAdc / 3.3 * 4095.0);
+    if (raw < 0)    raw = 0;
+    if (raw > 4095) raw = 4095;
+    return (uint16_t)raw;
+}
+
+static uint8_t simI2cWriteReg(uint8_t addr, uint8_t reg, uint8_t value)
+{
+    if (addr != TCA_ADDR) return 2;        // NACK on address
+    if (reg >= TCA_REG_COUNT) return 3;    // NACK on data
+    s_tcaRegs[reg] = value;
+    return 0;
+}
+
+/**
+ * @brief
+ * Lectura de registros del TCA9539.
+ * @note
+ * Los puertos de entrada devuelven el byte del HCTL seleccionado por SEL
+ * (0 = bajo, 1 = alto) con OE activo; IN0 = horizontal, IN1 = vertical
+ * (el cableado real, s_swapPorts en Encoders.cpp). Con OE inactivo el bus
+ * está en alta impedancia y se lee 0xFF (pull-ups).
+ */
+static bool simI2cReadReg(uint8_t addr, uint8_t reg, uint8_t &value)
+{
+    if (addr != TCA_ADDR || reg >= TCA_REG_COUNT) return false;
+
+    Clock_mockAdvanceUs(s_cfg.i2cReadUs);
+
+    if (reg <= 0x01) {
+        if (!s_oe) {
+            value = 0xFF;
+            return true;
+        }
+        uint16_t c = (uint16_t)((reg == 0x00) ? s_latchH : s_latchV);
+        value = s_sel ? (uint8_t)(c >> 8) : (uint8_t)(c & 0xFF);
+        return true;
+    }
+
+    value = s_tcaRegs[reg];
+    return true;
+}
+
+static const HalHostBackend s_backend = {
+    simGpioWrite,
+    simDacWrite,
+    simAdcRead,
+    simI2cWriteReg,
+    simI2cReadReg
+};
+
+// ------------------------------------------------------------
+// API
+// ------------------------------------------------------------
+
+TrmsSimConfig TrmsSim_defaultConfig()
+{
+    TrmsSimConfig c;
+    c.plant                = TrmsPlant_defaultParams();
+    c.rateHz               = 200;
+    c.encoders             = { 2000.0f, 2000.0f };
+    c.pinSEL               = 12;
+    c.pinRST               = 13;
+    c.pinOE                = 14;
+    c.dacPinMain           = 25;
+    c.dacPinTail           = 26;
+    c.adcPinMain           = 36;
+    c.adcPinTail           = 39;
+    c.i2cReadUs            = 100;
+    c.tachoVoltsPer1000RPM = 0.52f;
+    c.rotorMaxRpm          = 6000.0f;
+    c.startPitchDeg        = c.plant.thetaRestRad * 57.29577951308232f;
+    c.startYawDeg          = 0.0f;
+    c.observer             = nullptr;
+    return c;
+}
+
+bool TrmsSim_begin(const TrmsSimConfig &cfg)
+{
+    s_cfg      = cfg;
+    s_periodUs = (cfg.rateHz > 0) ? 1000000UL / cfg.rateHz : 5000;
+
+    Clock_mockSetUs(0);
+    s_plantUs = 0;
+    s_tickUs  = 0;
+
+    s_sel = false;
+    s_oe  = false;
+    s_inhibit = false;
+    s_latchV = 0;
+    s_latchH = 0;
+    s_zeroV  = 0.0;
+    s_zeroH  = 0.0;
+    for (uint8_t i = 0; i < TCA_REG_COUNT; i++) s_tcaRegs[i] = 0xFF;
+    s_tcaRegs[0x04] = 0x00;
+    s_tcaRegs[0x05] = 0x00;
+    s_uMain = 0.0f;
+    s_uTail = 0.0f;
+
+    TrmsPlant_init(s_plant, cfg.plant);
+
+    // Reset del HCTL con la viga sujeta en horizontal: 0° del firmware = horizontal
+    TrmsPlant_setPose(s_plant, 0.0f, 0.0f);
+    s_hold = true;
+    HAL_hostSetBackend(&s_backend);
+
+    if (!Encoders_begin(cfg.pinSEL, cfg.pinRST, cfg.pinOE, cfg.encoders)) {
+        HAL_hostSetBackend(nullptr);
+        return false;
+    }
+
+    MotorControl_begin(cfg.dacPinMain, cfg.dacPinTail);
+    MotorControl_writeOutputs(0, 0);
+
+    TachoConfig tacho = { cfg.adcPinTail, cfg.adcPinMain, cfg.tachoVoltsPer1000RPM };
+    Tacho_begin(tacho);
+
+    // La simulación empieza con la viga soltada en la posición inicial
+    TrmsPlant_setPose(s_plant, cfg.startPitchDeg, cfg.startYawDeg);
+    TrmsPlant_setInputs(s_plant, s_uMain, s_uTail);
+    s_hold     = false;
+    s_plant.tS = 0.0;
+    s_plantUs  = Clock_nowUs();
+    s_tickUs   = s_plantUs;
+    s_startUs  = s_plantUs;
+
+    ControlCycle_init(s_cycle, s_periodUs, cfg.encoders);
+    ControlCycle_setObserver(s_cycle, cfg.observer);
+    return true;
+}
+
+bool TrmsSim_step(TelemetryRecord &rec)
+{
+    // Siguiente disparo; si el ciclo anterior se pasó del periodo, se arranca tarde
+    s_tickUs += s_periodUs;
+    int64_t wakeUs = s_tickUs;
+    if (Clock_nowUs() < wakeUs) Clock_mockSetUs(wakeUs);
+    else                        wakeUs = Clock_nowUs();
+
+    EncoderSample smp;
+    return ControlCycle_run(s_cycle, wakeUs, rec, smp);
+}
+
+void TrmsSim_run(double seconds)
+{
+    TelemetryRecord rec;
+    const int64_t endUs = s_tickUs + (int64_t)(seconds * 1e6);
+    while (s_tickUs + (int64_t)s_periodUs <= endUs) {
+        TrmsSim_step(rec);
+    }
+}
+
+TrmsPlant &TrmsSim_plant()
+{
+    return s_plant;
+}
+
+double TrmsSim_timeS()
+{
+    return (double)(Clock_nowUs() - s_startUs) * 1e-6;
+}
+
+void TrmsSim_end()
+{
+    HAL_hostSetBackend(nullptr);
+}
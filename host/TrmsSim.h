@@ -0,0 +1,92 @@
+/* Simulador del TRMS en lazo cerrado para el PC. Junto con "TrmsSim.cpp" conecta el modelo de
+"TrmsPlant.h" a la HAL de host en lugar del hardware: los DACs (GPIO 25/26) mueven los rotores,
+el HCTL-2016 + TCA9539 (GPIO SEL/RST/OE + I2C 0x74) devuelven las cuentas de los encoders y los
+ADC de los tacómetros la velocidad de los rotores. El firmware (Encoders, MotorControl,
+ControlCycle y PID4_StepWithCounts) corre sin modificar sobre el reloj simulado */
+
+// TrmsSim.h
+#pragma once
+
+#include <stdint.h>
+#include "TrmsPlant.h"
+#include "Encoders.h"
+#include "Telemetry.h"
+#include "StateObserver.h"
+
+/**
+ * @brief Configuración del simulador.
+ *
+ * Los pines y las cuentas por vuelta son los de src/main.cpp. Los ángulos del
+ * firmware toman como 0° la posición en el reset del HCTL; el simulador hace
+ * ese reset con la viga horizontal (como al poner en marcha el equipo real) y
+ * después coloca la viga en startPitchDeg / startYawDeg.
+ *
+ * @param plant          Parámetros físicos del modelo
+ * @param rateHz         Frecuencia del lazo de control
+ * @param encoders       Cuentas por vuelta de cada eje
+ * @param i2cReadUs      Duración simulada de cada lectura de registro del TCA9539 [us]
+ * @param tachoVoltsPer1000RPM, rotorMaxRpm  Tacómetros (rpm a w = 1)
+ * @param observer       Observador de estado del ciclo de control (nullptr = sin él)
+ */
+struct TrmsSimConfig {
+    TrmsPlantParams plant;
+    uint32_t        rateHz;
+    EncoderConfig   encoders;
+
+    uint8_t pinSEL;
+    uint8_t pinRST;
+    uint8_t pinOE;
+    uint8_t dacPinMain;     // G1 -> motor principal
+    uint8_t dacPinTail;     // G2 -> rotor de cola
+    uint8_t adcPinMain;     // tacómetro del motor principal
+    uint8_t adcPinTail;     // tacómetro del rotor de cola
+
+    uint32_t i2cReadUs;
+    float    tachoVoltsPer1000RPM;
+    float    rotorMaxRpm;
+
+    float startPitchDeg;
+    float startYawDeg;
+
+    const ObserverConfig *observer;
+};
+
+// Configuración por defecto (la del equipo real, viga en reposo)
+TrmsSimConfig TrmsSim_defaultConfig();
+
+/**
+ * @brief Arranca el simulador.
+ *
+ * Pone el reloj simulado a 0, instala el backend de la HAL, inicializa el
+ * modelo, Encoders_begin / MotorControl_begin / Tacho_begin y el ciclo de
+ * control. No toca el PID-4 (ganancias, consignas y habilitación son cosa del
+ * que llama).
+ *
+ * @return false si Encoders_begin falla
+ */
+bool TrmsSim_begin(const TrmsSimConfig &cfg);
+
+/**
+ * @brief Ejecuta un ciclo de control.
+ *
+ * Avanza el reloj al siguiente disparo y ejecuta ControlCycle_run. El modelo
+ * se integra hasta el instante de cada acceso a la HAL (lectura de encoders,
+ * escritura de DACs), así que ve exactamente la misma secuencia temporal que
+ * el equipo real.
+ *
+ * @param rec Registro de telemetría del ciclo
+ * @return true si la lectura de encoders ha sido correcta
+ */
+bool TrmsSim_step(TelemetryRecord &rec);
+
+// Ejecuta ciclos hasta alcanzar seconds de tiempo simulado (sin telemetría)
+void TrmsSim_run(double seconds);
+
+// Modelo en uso (para leer el estado real o meter perturbaciones)
+TrmsPlant &TrmsSim_plant();
+
+// Tiempo simulado [s]
+double TrmsSim_timeS();
+
+// Desinstala el backend de la HAL
+void TrmsSim_end();
@@ -0,0 +1,444 @@
+/* Programa de simulación del TRMS en lazo cerrado: ejecuta el PID-4 del firmware contra el modelo
+no lineal (TrmsSim) más rápido que el tiempo real y muestra un resumen o un CSV de la telemetría.
+
+   trms_sim [--time S] [--rate HZ] [--refv DEG] [--refh DEG] [--step-at S]
+            [--mode mimo|v|h|cascade|sf] [--csv FICHERO] [--csv-every N] [--verbose]
+            [--manual-mp REG] [--manual-rdc REG] [--pid-at S] [--switch-mode mimo|v|h|cascade|sf] [--switch-at S]
+            [--retune-at S --retune-scale K] [--traj 0|1] [--observer 0|1|2] [--ident 0|1]
+            [--tune v|h|vh] [--tune-rule zn|tl] [--bode mp|rdc]
+
+Con --step-at las consignas valen 0 hasta ese instante y después refv/refh. Con --pid-at el PID
+arranca deshabilitado con los registros manuales (como los sliders) y se habilita en ese instante;
+--switch-mode cambia de modo en marcha en --switch-at. En los dos casos se muestra el salto de
+registro en el primer paso tras el cambio (transferencia sin salto, PID4_SetEnabled y PID4_SetMode)
+y el peor error vertical en los 2 s siguientes. --retune-at multiplica Kp/Ki/Kd de los cuatro PID por
+--retune-scale en marcha (PID4_PublishGains, sin reset) y lista los eventos de ganancias. Con
+--traj 1 las consignas siguen la trayectoria por defecto del firmware (PID4_TRAJ_DEFAULT_*). En el
+modo cascade el CSV lleva además las consignas de velocidad y los tacómetros filtrados. --observer 1
+activa el observador de estado y compara sus velocidades de la viga con las del modelo (y con la
+diferencia de cuentas); con 2 además la derivada del PID usa sus ángulos filtrados. El modo sf
+(realimentación del estado, LQI) activa siempre el observador. --ident 1 activa la identificación en
+marcha (RigIdent) y al final compara el modelo identificado con los parámetros del modelo simulado.
+--tune hace primero el auto-ajuste por relé (RelayTune) del eje o ejes pedidos, como el botón de la
+pantalla de parámetros, muestra Ku, Tu y las ganancias (Tyreus–Luyben salvo --tune-rule zn) y arranca
+el PID con ellas en cuanto acaba. --bode hace el barrido de respuesta en frecuencia (FreqResp) sobre ese
+motor alrededor de --manual-mp / --manual-rdc y muestra la tabla de ganancia y fase. Dos ejecuciones con los mismos argumentos dan exactamente la misma telemetría */
+
+// TrmsSimMain.cpp
+#include "TrmsSim.h"
+#include "PID_Control.h"
+#include "PID_Parameters.h"
+#include "HAL.h"
+#include "RigIdent.h"
+#include "RelayTune.h"
+#include "FreqResp.h"
+#include "EquilibriumMap.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SimArgs {
+    double      timeS     = 20.0;
+    uint32_t    rateHz    = 200;
+    float       refV      = 0.0f;
+    float       refH      = 0.0f;
+    double      stepAtS   = 0.0;
+    PIDMode     mode      = PIDMode::MIMO_FULL;
+    const char *csvPath   = nullptr;
+    uint32_t    csvEvery  = 1;
+    bool        verbose   = false;
+    int         manualMP  = 0;
+    int         manualRDC = 0;
+    double      pidAtS    = 0.0;
+    bool        switchMode = false;
+    PIDMode     mode2     = PIDMode::MIMO_FULL;
+    double      switchAtS = 0.0;
+    double      retuneAtS = -1.0;
+    float       retuneScale = 1.0f;
+    bool        traj      = false;
+    int         observer  = 0;
+    bool        ident     = false;
+    bool        tuneV     = false;
+    bool        tuneH     = false;
+    TuneRule    tuneRule  = TuneRule::TYREUS_LUYBEN;
+    bool        bode      = false;
+    FreqRespInput bodeInput = FreqRespInput::MAIN_ROTOR;
+};
+
+static bool parseMode(const char *v, PIDMode &mode)
+{
+    if      (!strcmp(v, "mimo")) mode = PIDMode::MIMO_FULL;
+    else if (!strcmp(v, "v"))    mode = PIDMode::VERTICAL_ONLY;
+    else if (!strcmp(v, "h"))    mode = PIDMode::HORIZONTAL_ONLY;
+    else if (!strcmp(v, "cascade")) mode = PIDMode::CASCADE;
+    else if (!strcmp(v, "sf"))   mode = PIDMode::STATE_FEEDBACK;
+    else return false;
+    return true;
+}
+
+// Salto de registro en el primer paso tras una transferencia y peor error vertical después
+struct TransferJump {
+    double atS     = -1.0;
+    bool   pending = false;
+    int    lastMP  = 0, lastRDC = 0;
+    int    jumpMP  = 0, jumpRDC = 0;
+    float  maxErrV = 0.0f;
+};
+
+static void transferTrack(TransferJump &j, double t, int regMP, int regRDC, float errV)
+{
+    if (j.pending) {
+        j.jumpMP  = regMP  - j.lastMP;
+        j.jumpRDC = regRDC - j.lastRDC;
+        j.pending = false;
+    }
+    if (j.atS >= 0.0 && t <= j.atS + 2.0 && fabsf(errV) > j.maxErrV) j.maxErrV = fabsf(errV);
+    j.lastMP  = regMP;
+    j.lastRDC = regRDC;
+}
+
+// Modelo identificado frente a los parámetros del modelo simulado
+static void printIdent(const TrmsPlantParams &p, const TrmsSimConfig &cfg)
+{
+    RigIdentModel m;
+    RigIdent_getModel(m);
+    printf("Identificado:   %lu muestras de %.1f ms\n", (unsigned long)m.samples, m.Ts * 1e3f);
+    printf("  vertical      reposo %.1f deg, %.3f deg/krpm2 MP, %.3f deg/krpm2 RDC, ajuste %.3f deg\n",
+           m.vert.restDeg, m.vert.dcGain, m.vert.crossGain, m.vert.fitRms);
+    printf("  horizontal    reposo %.1f deg, %.3f deg/krpm2 RDC, %.3f deg/krpm2 MP, ajuste %.3f deg\n",
+           m.hor.restDeg, m.hor.dcGain, m.hor.crossGain, m.hor.fitRms);
+    printf("  rotor MP      tau %.3f s, %.1f rpm/reg, zona muerta %.1f reg, ajuste %.0f rpm\n",
+           m.main.tauS, m.main.rpmPerReg, m.main.deadbandReg, m.main.fitRms);
+    printf("  rotor RDC     tau %.3f s, %.1f rpm/reg, zona muerta %.1f reg, ajuste %.0f rpm\n",
+           m.tail.tauS, m.tail.rpmPerReg, m.tail.deadbandReg, m.tail.fitRms);
+    printf("Modelo:         reposo %.1f deg, tau MP %.3f s, RDC %.3f s, %.1f rpm/reg\n",
+           p.thetaRestRad * 57.29578f, p.tauMain, p.tauTail, cfg.rotorMaxRpm / 100.0f);
+}
+
+// Arranca el ensayo de relé de un eje como AutoTune_Start (ui_events.cpp)
+static bool startTune(bool vertical)
+{
+    int holdMP, holdRDC;
+    MotorControl_getLastRegisters(holdMP, holdRDC);
+    if (!vertical) return RelayTune_start(TuneAxis::HORIZONTAL, NAN, 0.0f, holdMP, holdRDC);
+
+    EqMap map;
+    PID4_GetVerticalFeedforwardMap(map);
+    return RelayTune_start(TuneAxis::VERTICAL, 0.0f, EqMap_lookup(map, 0.0f), holdMP, holdRDC);
+}
+
+// Resultado del ensayo y ganancias escritas en g_pidCurr
+static bool finishTune(TuneRule rule)
+{
+    RelayTuneResult r;
+    RelayTune_getResult(r);
+    const bool vert = (r.axis == TuneAxis::VERTICAL);
+    const char *axis = vert ? "vertical" : "horizontal";
+    if (!RelayTune_applyToCurr(r, rule, g_pidCurr, g_pidMin, g_pidMax)) {
+        printf("Auto-ajuste:    %s fallido (%s) en %.1f s, %u ciclos\n",
+               axis, RelayTune_failName(r.fail), r.elapsedS, (unsigned)r.cycles);
+        return false;
+    }
+    printf("Auto-ajuste:    %s en %.1f s, %u ciclos: Ku %.3f reg/deg, Tu %.3f s, a %.2f deg, bias %.1f reg\n",
+           axis, r.elapsedS, (unsigned)r.cycles, r.Ku, r.periodS, r.amplitudeDeg, r.biasReg);
+    printf("                Kp %.3f Ki %.3f Kd %.3f (%s)\n",
+           vert ? g_pidCurr.KpvvCurr : g_pidCurr.KphhCurr,
+           vert ? g_pidCurr.KivvCurr : g_pidCurr.KihhCurr,
+           vert ? g_pidCurr.KdvvCurr : g_pidCurr.KdhhCurr,
+           rule == TuneRule::ZIEGLER_NICHOLS ? "Ziegler-Nichols" : "Tyreus-Luyben");
+    return true;
+}
+
+// Tabla del barrido de Bode
+static void printBode()
+{
+    static char text[1536];
+    FreqRespResult r;
+    FreqResp_getResult(r);
+    if (r.state == FreqRespState::FAILED) {
+        printf("Bode:           fallido (%s) tras %u de %u puntos\n",
+               FreqResp_failName(r.fail), (unsigned)r.done, (unsigned)r.points);
+    } else if (r.state == FreqRespState::RUNNING) {
+        printf("Bode:           sin terminar (%u de %u puntos, alarga --time)\n",
+               (unsigned)r.done, (unsigned)r.points);
+    }
+    FreqResp_format(r, text, sizeof(text));
+    printf("%s", text);
+}
+
+static void usage()
+{
+    printf("uso: trms_sim [--time S] [--rate HZ] [--refv DEG] [--refh DEG] [--step-at S]\n"
+           "                [--mode mimo|v|h|cascade|sf] [--csv FICHERO] [--csv-every N] [--verbose]\n"
+           "                [--manual-mp REG] [--manual-rdc REG] [--pid-at S]\n"
+           "                [--switch-mode mimo|v|h|cascade|sf] [--switch-at S]\n"
+           "                [--retune-at S --retune-scale K] [--traj 0|1] [--observer 0|1|2]\n"
+           "                [--ident 0|1] [--tune v|h|vh] [--tune-rule zn|tl] [--bode mp|rdc]\n");
+}
+
+static bool parseArgs(int argc, char **argv, SimArgs &a)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *k = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!strcmp(k, "--verbose")) { a.verbose = true; continue; }
+        if (!v) return false;
+
+        if      (!strcmp(k, "--time"))      a.timeS    = atof(v);
+        else if (!strcmp(k, "--rate"))      a.rateHz   = (uint32_t)atoi(v);
+        else if (!strcmp(k, "--refv"))      a.refV     = (float)atof(v);
+        else if (!strcmp(k, "--refh"))      a.refH     = (float)atof(v);
+        else if (!strcmp(k, "--step-at"))   a.stepAtS  = atof(v);
+        else if (!strcmp(k, "--csv"))       a.csvPath  = v;
+        else if (!strcmp(k, "--csv-every")) a.csvEvery = (uint32_t)atoi(v);
+        else if (!strcmp(k, "--manual-mp"))  a.manualMP  = atoi(v);
+        else if (!strcmp(k, "--manual-rdc")) a.manualRDC = atoi(v);
+        else if (!strcmp(k, "--pid-at"))     a.pidAtS    = atof(v);
+        else if (!strcmp(k, "--switch-at"))  a.switchAtS = atof(v);
+        else if (!strcmp(k, "--retune-at"))    a.retuneAtS   = atof(v);
+        else if (!strcmp(k, "--retune-scale")) a.retuneScale = (float)atof(v);
+        else if (!strcmp(k, "--traj"))         a.traj        = atoi(v) != 0;
+        else if (!strcmp(k, "--observer"))     a.observer    = atoi(v);
+        else if (!strcmp(k, "--ident"))        a.ident       = atoi(v) != 0;
+        else if (!strcmp(k, "--tune")) {
+            a.tuneV = (strchr(v, 'v') != nullptr);
+            a.tuneH = (strchr(v, 'h') != nullptr);
+            if (!a.tuneV && !a.tuneH) return false;
+        }
+        else if (!strcmp(k, "--tune-rule")) {
+            if      (!strcmp(v, "zn")) a.tuneRule = TuneRule::ZIEGLER_NICHOLS;
+            else if (!strcmp(v, "tl")) a.tuneRule = TuneRule::TYREUS_LUYBEN;
+            else return false;
+        }
+        else if (!strcmp(k, "--bode")) {
+            if      (!strcmp(v, "mp"))  a.bodeInput = FreqRespInput::MAIN_ROTOR;
+            else if (!strcmp(v, "rdc")) a.bodeInput = FreqRespInput::TAIL_ROTOR;
+            else return false;
+            a.bode = true;
+        }
+        else if (!strcmp(k, "--mode")) {
+            if (!parseMode(v, a.mode)) return false;
+        }
+        else if (!strcmp(k, "--switch-mode")) {
+            if (!parseMode(v, a.mode2)) return false;
+            a.switchMode = true;
+        }
+        else return false;
+        i++;
+    }
+    if (a.csvEvery == 0) a.csvEvery = 1;
+    return a.timeS > 0.0 && a.rateHz > 0;
+}
+
+int main(int argc, char **argv)
+{
+    SimArgs args;
+    if (!parseArgs(argc, argv, args)) {
+        usage();
+        return 2;
+    }
+
+    HAL_hostSetLogEnabled(args.verbose);
+
+    TrmsSimConfig cfg = TrmsSim_defaultConfig();
+    cfg.rateHz = args.rateHz;
+    // STATE_FEEDBACK trabaja sobre la estimación del observador
+    const bool sf = (args.mode == PIDMode::STATE_FEEDBACK) ||
+                    (args.switchMode && args.mode2 == PIDMode::STATE_FEEDBACK);
+    if (args.observer > 0 || sf) cfg.observer = &OBSERVER_DEFAULT_CONFIG;
+    if (!TrmsSim_begin(cfg)) {
+        fprintf(stderr, "trms_sim: fallo al inicializar los encoders simulados\n");
+        return 1;
+    }
+
+    PID_LoadDefaults();
+    PID4_LoadFromCurr(g_pidCurr);
+    RigIdent_setEnabled(args.ident);
+    PID4_SetCascadeParams(g_pidCascade);
+    PID4_SetMode(args.mode);
+    PID4_SetObserverDerivative(args.observer > 1);
+    if (args.traj) PID4_SetTrajectoryLimits(PID4_TRAJ_DEFAULT_VERT, PID4_TRAJ_DEFAULT_HOR);
+    bool stepped = (args.stepAtS <= 0.0);
+    PID4_SetReferences(stepped ? args.refV : 0.0f, stepped ? args.refH : 0.0f);
+
+    // Manual (sliders) hasta --pid-at; con --tune, relé y después el PID con lo ajustado
+    bool tuning = args.tuneV || args.tuneH;
+    bool pidOn = (args.pidAtS <= 0.0) && !tuning && !args.bode;
+    if (args.bode) {
+        // Con el PID parado, sobre los registros manuales
+        MotorControl_writeOutputs(args.manualMP, args.manualRDC);
+        if (tuning || !FreqResp_start(args.bodeInput, args.manualMP, args.manualRDC, (float)args.rateHz)) {
+            fprintf(stderr, "trms_sim: no se pudo arrancar el barrido de Bode\n");
+            return 1;
+        }
+    } else if (tuning) {
+        MotorControl_writeOutputs(args.manualMP, args.manualRDC);
+        if (!startTune(args.tuneV)) {
+            fprintf(stderr, "trms_sim: no se pudo arrancar el auto-ajuste\n");
+            return 1;
+        }
+    } else if (pidOn) {
+        PID4_SetEnabled(true);
+    } else {
+        MotorControl_writeOutputs(args.manualMP, args.manualRDC);
+    }
+    bool switched = !args.switchMode;
+    bool retuned  = (args.retuneAtS < 0.0);
+    TransferJump jump;
+
+    FILE *csv = nullptr;
+    if (args.csvPath) {
+        csv = fopen(args.csvPath, "w");
+        if (!csv) {
+            fprintf(stderr, "trms_sim: no se puede abrir %s\n", args.csvPath);
+            return 1;
+        }
+        fprintf(csv, "t_s,ref_v,ref_h,meas_v,meas_h,pitch_deg,yaw_deg,Uv,Uh,reg_mp,reg_rdc,dac_g1,dac_g2,sp_mp,sp_rdc,rpm_mp,rpm_rdc,rate_v,rate_h\n");
+    }
+
+    // Errores de seguimiento en la segunda mitad (régimen permanente)
+    const double settleFromS = args.stepAtS + 0.5 * (args.timeS - args.stepAtS);
+    double sumSqV = 0.0, sumSqH = 0.0;
+    float  maxAbsV = 0.0f, maxAbsH = 0.0f;
+    uint32_t nSettled = 0;
+    uint32_t steps = 0, readErrors = 0;
+
+    // Velocidad de la viga: observador y diferencia de cuentas frente al modelo
+    double sumSqObsV = 0.0, sumSqObsH = 0.0, sumSqDiffV = 0.0, sumSqDiffH = 0.0;
+    uint32_t nRate = 0;
+    float lastMeasV = 0.0f, lastMeasH = 0.0f;
+
+    auto wall0 = std::chrono::steady_clock::now();
+
+    TelemetryRecord rec;
+    while (TrmsSim_timeS() < args.timeS) {
+        if (!stepped && TrmsSim_timeS() >= args.stepAtS) {
+            PID4_SetReferences(args.refV, args.refH);
+            stepped = true;
+        }
+        if (tuning && !RelayTune_isActive()) {
+            // Tras el vertical, el horizontal si está pedido; después el PID con lo ajustado
+            RelayTuneResult r;
+            RelayTune_getResult(r);
+            const bool ok = finishTune(args.tuneRule);
+            const bool next = ok && r.axis == TuneAxis::VERTICAL && args.tuneH && startTune(false);
+            if (!next) {
+                tuning = false;
+                PID4_LoadFromCurr(g_pidCurr);
+                pidOn = (TrmsSim_timeS() >= args.pidAtS);
+                if (pidOn) {
+                    PID4_SetEnabled(true);
+                    jump.atS = TrmsSim_timeS();
+                    jump.pending = true;
+                }
+            }
+        }
+        if (!pidOn && !tuning && !args.bode && TrmsSim_timeS() >= args.pidAtS) {
+            PID4_SetEnabled(true);
+            pidOn = true;
+            jump.atS = TrmsSim_timeS();
+            jump.pending = true;
+        }
+        if (!switched && pidOn && TrmsSim_timeS() >= args.switchAtS) {
+            PID4_SetMode(args.mode2);
+            switched = true;
+            jump.atS = TrmsSim_timeS();
+            jump.pending = true;
+        }
+        if (!retuned && pidOn && TrmsSim_timeS() >= args.retuneAtS) {
+            // Como un slider con el PID en marcha: se publica y el paso la recoge
+            PID_CURR c = g_pidCurr;
+            c.KpvvCurr *= args.retuneScale; c.KivvCurr *= args.retuneScale; c.KdvvCurr *= args.retuneScale;
+            c.KpvhCurr *= args.retuneScale; c.KivhCurr *= args.retuneScale; c.KdvhCurr *= args.retuneScale;
+            c.KphvCurr *= args.retuneScale; c.KihvCurr *= args.retuneScale; c.KdhvCurr *= args.retuneScale;
+            c.KphhCurr *= args.retuneScale; c.KihhCurr *= args.retuneScale; c.KdhhCurr *= args.retuneScale;
+            retuned = PID4_PublishGains(c);
+            if (retuned) {
+                jump.atS = TrmsSim_timeS();
+                jump.pending = true;
+            }
+        }
+
+        if (!TrmsSim_step(rec)) readErrors++;
+        steps++;
+
+        const TrmsPlant &plant = TrmsSim_plant();
+        double t = TrmsSim_timeS();
+
+        if (args.observer > 0 && rec.encOk) {
+            const double rateV = plant.x.thetaDot * 57.29577951308232;
+            const double rateH = plant.x.phiDot   * 57.29577951308232;
+            if (steps > 1) {
+                const double dV = (rec.measVDeg - lastMeasV) / rec.dtS - rateV;
+                const double dH = (rec.measHDeg - lastMeasH) / rec.dtS - rateH;
+                sumSqObsV  += (rec.rateVDegS - rateV) * (rec.rateVDegS - rateV);
+                sumSqObsH  += (rec.rateHDegS - rateH) * (rec.rateHDegS - rateH);
+                sumSqDiffV += dV * dV;
+                sumSqDiffH += dH * dH;
+                nRate++;
+            }
+            lastMeasV = rec.measVDeg;
+            lastMeasH = rec.measHDeg;
+        }
+
+        int regMP, regRDC;
+        MotorControl_getLastRegisters(regMP, regRDC);
+        transferTrack(jump, t, regMP, regRDC, rec.refVDeg - rec.measVDeg);
+
+        if (stepped && t >= settleFromS) {
+            float eV = rec.refVDeg - rec.measVDeg;
+            float eH = rec.refHDeg - rec.measHDeg;
+            sumSqV += (double)eV * eV;
+            sumSqH += (double)eH * eH;
+            if (fabsf(eV) > maxAbsV) maxAbsV = fabsf(eV);
+            if (fabsf(eH) > maxAbsH) maxAbsH = fabsf(eH);
+            nSettled++;
+        }
+
+        PID4GainEvent gev;
+        while (PID4_PopGainEvent(gev)) {
+            printf("Ganancias:      gen %u desde la muestra %u (t %.3f s, %s), Kphh %.3f Kpvv %.3f\n",
+                   (unsigned)gev.gen, (unsigned)gev.sample, (double)gev.tUs * 1e-6,
+                   gev.reload ? "carga" : "en marcha", gev.gains.KphhCurr, gev.gains.KpvvCurr);
+        }
+
+        if (csv && (steps % args.csvEvery) == 0) {
+            fprintf(csv, "%.6f,%.2f,%.2f,%.3f,%.3f,%.4f,%.4f,%.5f,%.5f,%d,%d,%u,%u,%d,%d,%.0f,%.0f,%.3f,%.3f\n",
+                    t, rec.refVDeg, rec.refHDeg, rec.measVDeg, rec.measHDeg,
+                    TrmsPlant_pitchDeg(plant), TrmsPlant_yawDeg(plant),
+                    rec.Uv, rec.Uh, rec.regMP, rec.regRDC, rec.dacG1, rec.dacG2,
+                    rec.spMP, rec.spRDC, rec.rpmMP, rec.rpmRDC, rec.rateVDegS, rec.rateHDegS);
+        }
+    }
+
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    if (csv) fclose(csv);
+    TrmsSim_end();
+
+    const TrmsPlant &plant = TrmsSim_plant();
+    printf("Simulado:       %.2f s (%u pasos a %u Hz, %u lecturas fallidas)\n",
+           TrmsSim_timeS(), steps, args.rateHz, readErrors);
+    printf("Tiempo real:    %.3f s  ->  x%.0f\n", wallS, (wallS > 0.0) ? TrmsSim_timeS() / wallS : 0.0);
+    printf("Final:          cabeceo %.2f deg (ref %.2f), guinada %.2f deg (ref %.2f)\n",
+           TrmsPlant_pitchDeg(plant), args.refV, TrmsPlant_yawDeg(plant), args.refH);
+    if (nSettled > 0) {
+        printf("Reg. perm.:     RMS eV %.3f deg (max %.3f), RMS eH %.3f deg (max %.3f)\n",
+               sqrt(sumSqV / nSettled), maxAbsV, sqrt(sumSqH / nSettled), maxAbsH);
+    }
+    if (nRate > 0) {
+        printf("Velocidades:    RMS error observador V %.2f / H %.2f deg/s, diferencia de cuentas V %.2f / H %.2f deg/s\n",
+               sqrt(sumSqObsV / nRate), sqrt(sumSqObsH / nRate),
+               sqrt(sumSqDiffV / nRate), sqrt(sumSqDiffH / nRate));
+    }
+    if (args.ident) printIdent(plant.p, cfg);
+    if (args.bode) printBode();
+    if (jump.atS >= 0.0) {
+        printf("Transferencia:  en %.2f s, salto MP %+d, RDC %+d; peor eV en 2 s %.2f deg\n",
+               jump.atS, jump.jumpMP, jump.jumpRDC, jump.maxErrV);
+    }
+    return 0;
+}
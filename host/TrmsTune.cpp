@@ -0,0 +1,643 @@
+/* Optimizador de ganancias del PID-4 contra el modelo del TRMS: busca los valores de PID_CURR que
+minimizan un coste sobre el catálogo de ensayos de trms_bench (BenchScenarios) y escribe los mejores
+como /Config_PID/Config_N.txt, con el mismo formato que guarda el firmware, para cargarlos desde la
+SD con ControlSD_LoadConfig:
+
+   trms_tune [--method grid|random|cmaes] [--evals N] [--threads N] [--seed S]
+             [--params Kpvv,Kphh,...] [--levels L] [--sigma S] [--lambda N]
+             [--mode mimo_full|vertical_only|horizontal_only] [--rate HZ]
+             [--from Config_N.txt] [--out DIR] [--best K] [--first N]
+
+Cada candidato es una simulación independiente de todos los ensayos del modo. El estado del firmware
+(PID_Control, HAL simulada, reloj) es global del proceso, así que las simulaciones corren en procesos
+hijo, uno por hilo del pool: cada hilo manda el PID_CURR a su proceso por una tubería y recibe el
+coste. Los hilos se reparten los candidatos de cada lote con robo de trabajo (WorkStealingPool), y
+el resultado no depende del número de hilos: los candidatos se generan en el hilo principal con la
+semilla dada y cada simulación arranca de cero.
+
+--params elige los valores que se buscan (por defecto los 18: Kp/Ki/Kd de los cuatro PID, Isat y
+Umax); el resto se queda en el punto de partida, que son los valores por defecto o los de --from.
+La búsqueda va entre los [PID_MIN] y [PID_MAX] del punto de partida. --evals limita las evaluaciones
+de random y cmaes; grid evalúa las L^n combinaciones de --levels valores por parámetro. Los ficheros
+van a DIR/Config_PID/Config_<first>.txt, Config_<first+1>.txt... (índices 1..5 como en la SD) */
+
+// TrmsTune.cpp
+#include "BenchScenarios.h"
+#include "Cmaes.h"
+#include "WorkStealingPool.h"
+#include "HAL.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// ------------------------------------------------------------
+// Parámetros que se pueden buscar
+// ------------------------------------------------------------
+
+struct TuneParam {
+    const char      *name;      // nombre base en Config_N.txt (Kpvv -> KpvvCurr/KpvvMin/KpvvMax)
+    float PID_CURR::*curr;
+    float PID_MIN::*min;
+    float PID_MAX::*max;
+};
+
+#define TUNE_PARAM(n) { #n, &PID_CURR::n##Curr, &PID_MIN::n##Min, &PID_MAX::n##Max }
+
+static const TuneParam TUNE_PARAMS[] = {
+    TUNE_PARAM(Kpvv), TUNE_PARAM(Kpvh), TUNE_PARAM(Kivv), TUNE_PARAM(Kivh), TUNE_PARAM(Kdvv), TUNE_PARAM(Kdvh),
+    TUNE_PARAM(Kphv), TUNE_PARAM(Kphh), TUNE_PARAM(Kihv), TUNE_PARAM(Kihh), TUNE_PARAM(Kdhv), TUNE_PARAM(Kdhh),
+    TUNE_PARAM(Isatvv), TUNE_PARAM(Isatvh), TUNE_PARAM(Isathv), TUNE_PARAM(Isathh),
+    TUNE_PARAM(Uvmax), TUNE_PARAM(Uhmax),
+};
+
+static const int TUNE_PARAM_COUNT = (int)(sizeof(TUNE_PARAMS) / sizeof(TUNE_PARAMS[0]));
+
+// Resto de PID_CURR (no se buscan, pero van al fichero)
+struct ExtraParam {
+    const char      *key;
+    float PID_CURR::*curr;
+};
+
+static const ExtraParam EXTRA_PARAMS[] = {
+    { "TfvCurr",  &PID_CURR::TfvCurr },
+    { "TfhCurr",  &PID_CURR::TfhCurr },
+    { "KtvvCurr", &PID_CURR::KtvvCurr },
+    { "KtvhCurr", &PID_CURR::KtvhCurr },
+    { "KthvCurr", &PID_CURR::KthvCurr },
+    { "KthhCurr", &PID_CURR::KthhCurr },
+};
+
+struct TuneSpace {
+    int      n;
+    int      idx[TUNE_PARAM_COUNT];   // índice en TUNE_PARAMS de cada coordenada
+    PID_CURR start;
+    PID_MIN  lo;
+    PID_MAX  hi;
+};
+
+// Coordenadas normalizadas [0, 1] -> PID_CURR (fuera del intervalo se recorta)
+static PID_CURR toGains(const TuneSpace &sp, const double *u)
+{
+    PID_CURR g = sp.start;
+    for (int k = 0; k < sp.n; k++) {
+        const TuneParam &p = TUNE_PARAMS[sp.idx[k]];
+        const double lo = sp.lo.*p.min, hi = sp.hi.*p.max;
+        const double c = fmin(1.0, fmax(0.0, u[k]));
+        g.*p.curr = (float)(lo + c * (hi - lo));
+    }
+    return g;
+}
+
+static void toUnit(const TuneSpace &sp, const PID_CURR &g, double *u)
+{
+    for (int k = 0; k < sp.n; k++) {
+        const TuneParam &p = TUNE_PARAMS[sp.idx[k]];
+        const double lo = sp.lo.*p.min, hi = sp.hi.*p.max;
+        u[k] = (hi > lo) ? (g.*p.curr - lo) / (hi - lo) : 0.0;
+    }
+}
+
+static bool parseParams(const char *list, TuneSpace &sp)
+{
+    sp.n = 0;
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *tok = strtok(buf, ","); tok; tok = strtok(nullptr, ",")) {
+        int found = -1;
+        for (int i = 0; i < TUNE_PARAM_COUNT; i++) {
+            if (!strcmp(tok, TUNE_PARAMS[i].name)) found = i;
+        }
+        if (found < 0) {
+            fprintf(stderr, "trms_tune: parámetro desconocido: %s\n", tok);
+            return false;
+        }
+        for (int k = 0; k < sp.n; k++) {
+            if (sp.idx[k] == found) found = -1;
+        }
+        if (found >= 0) sp.idx[sp.n++] = found;
+    }
+    return sp.n > 0;
+}
+
+// ------------------------------------------------------------
+// Config_N.txt (mismo formato que PID_SaveConfigToFile / PID_LoadConfigFromFile)
+// ------------------------------------------------------------
+
+/**
+ * @brief
+ * Lee un Config_N.txt sobre start/lo/hi (las claves que falten no cambian).
+ */
+static bool loadConfig(const char *path, PID_CURR &start, PID_MIN &lo, PID_MAX &hi)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "trms_tune: no se puede abrir %s\n", path);
+        return false;
+    }
+
+    enum { SEC_NONE, SEC_MIN, SEC_CURR, SEC_MAX } section = SEC_NONE;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        p[strcspn(p, "\r\n")] = '\0';
+        if (*p == '\0' || *p == '#') continue;
+
+        if (*p == '[') {
+            if      (!strcmp(p, "[PID_MIN]"))  section = SEC_MIN;
+            else if (!strcmp(p, "[PID_CURR]")) section = SEC_CURR;
+            else if (!strcmp(p, "[PID_MAX]"))  section = SEC_MAX;
+            else                               section = SEC_NONE;
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        char *end = eq;
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+        const float v = (float)atof(eq + 1);
+
+        char key[48];
+        for (int i = 0; i < TUNE_PARAM_COUNT; i++) {
+            const TuneParam &tp = TUNE_PARAMS[i];
+            if (section == SEC_MIN) {
+                snprintf(key, sizeof(key), "%sMin", tp.name);
+                if (!strcmp(p, key)) lo.*tp.min = v;
+            } else if (section == SEC_MAX) {
+                snprintf(key, sizeof(key), "%sMax", tp.name);
+                if (!strcmp(p, key)) hi.*tp.max = v;
+            } else if (section == SEC_CURR) {
+                snprintf(key, sizeof(key), "%sCurr", tp.name);
+                if (!strcmp(p, key)) start.*tp.curr = v;
+            }
+        }
+        if (section == SEC_CURR) {
+            for (const ExtraParam &e : EXTRA_PARAMS) {
+                if (!strcmp(p, e.key)) start.*e.curr = v;
+            }
+            if (!strcmp(p, "DerivOnMeasCurr")) start.DerivOnMeasCurr = (v != 0.0f);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeConfig(const char *path, const PID_CURR &g, const PID_MIN &lo, const PID_MAX &hi,
+                        double cost)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "trms_tune: no se puede escribir %s\n", path);
+        return false;
+    }
+
+    fprintf(f, "# CONFIGURACION PID -----------------------\n");
+    fprintf(f, "# trms_tune: coste %.6f\n", cost);
+
+    fprintf(f, "[PID_MIN]\n");
+    for (const TuneParam &p : TUNE_PARAMS) fprintf(f, "%sMin=%.6f\n", p.name, lo.*p.min);
+    fprintf(f, "\n");
+
+    fprintf(f, "[PID_CURR]\n");
+    for (const TuneParam &p : TUNE_PARAMS) fprintf(f, "%sCurr=%.6f\n", p.name, g.*p.curr);
+    fprintf(f, "DerivOnMeasCurr=%d\n", g.DerivOnMeasCurr ? 1 : 0);
+    for (const ExtraParam &e : EXTRA_PARAMS) fprintf(f, "%s=%.6f\n", e.key, g.*e.curr);
+    fprintf(f, "\n");
+
+    fprintf(f, "[PID_MAX]\n");
+    for (const TuneParam &p : TUNE_PARAMS) fprintf(f, "%sMax=%.6f\n", p.name, hi.*p.max);
+    fprintf(f, "-------------------------------------------\n");
+
+    fclose(f);
+    return true;
+}
+
+// ------------------------------------------------------------
+// Coste de un candidato
+// ------------------------------------------------------------
+
+/**
+ * @brief
+ * Coste de una fila de resultados (menor es mejor).
+ * @note
+ * IAE relativo al salto (como mínimo 10° para las perturbaciones), más
+ * sobreoscilación, error final y recorrido de los actuadores; no
+ * asentarse penaliza como 5 s de IAE a plena escala.
+ */
+static double rowCost(const BenchResult &r)
+{
+    const double scale = fmax(fabs((double)r.m.stepDeg), 10.0);
+    double c = r.m.iae / scale
+             + 2.0 * r.m.overshootPct / 100.0
+             + 0.2 * fabs((double)r.m.finalErrDeg)
+             + (double)(r.travelMP + r.travelRDC) / 1e5;
+    if (isnan(r.m.settleS)) c += 5.0;
+    return isfinite(c) ? c : 1e6;
+}
+
+static double evaluate(const BenchMode &md, uint32_t rateHz, const PID_CURR &gains)
+{
+    BenchOptions opt;
+    opt.gains = &gains;
+
+    double cost = 0.0;
+    for (size_t s = 0; s < BENCH_SCENARIO_COUNT; s++) {
+        const BenchScenario &sc = BENCH_SCENARIOS[s];
+        if (!Bench_appliesTo(sc, md)) continue;
+        PID4_ResetVerticalFeedforward();
+        BenchResult res[2];
+        const size_t nRows = Bench_runScenario(sc, md, rateHz, opt, res);
+        if (nRows == 0) return 1e6;
+        for (size_t i = 0; i < nRows; i++) cost += rowCost(res[i]);
+    }
+    return cost;
+}
+
+// ------------------------------------------------------------
+// Procesos de evaluación
+// ------------------------------------------------------------
+
+struct Evaluator {
+    pid_t pid;
+    int   toChild;
+    int   fromChild;
+};
+
+static bool writeAll(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0) {
+        ssize_t w = write(fd, p, len);
+        if (w <= 0) return false;
+        p += w;
+        len -= (size_t)w;
+    }
+    return true;
+}
+
+static bool readAll(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0) {
+        ssize_t r = read(fd, p, len);
+        if (r <= 0) return false;
+        p += r;
+        len -= (size_t)r;
+    }
+    return true;
+}
+
+// Bucle del proceso hijo: PID_CURR -> coste, hasta que se cierra la tubería
+static void evaluatorLoop(int in, int out, const BenchMode &md, uint32_t rateHz)
+{
+    PID_CURR g;
+    while (readAll(in, &g, sizeof(g))) {
+        const double c = evaluate(md, rateHz, g);
+        if (!writeAll(out, &c, sizeof(c))) break;
+    }
+}
+
+static bool startEvaluators(std::vector<Evaluator> &ev, size_t n, const BenchMode &md, uint32_t rateHz)
+{
+    fflush(stdout);
+    for (size_t i = 0; i < n; i++) {
+        int down[2], up[2];
+        if (pipe(down) != 0 || pipe(up) != 0) return false;
+
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            // Hijo: cierra los extremos del padre (también los de hermanos anteriores)
+            for (const Evaluator &e : ev) {
+                close(e.toChild);
+                close(e.fromChild);
+            }
+            close(down[1]);
+            close(up[0]);
+            evaluatorLoop(down[0], up[1], md, rateHz);
+            _exit(0);
+        }
+        close(down[0]);
+        close(up[1]);
+        ev.push_back({ pid, down[1], up[0] });
+    }
+    return true;
+}
+
+static void stopEvaluators(std::vector<Evaluator> &ev)
+{
+    for (Evaluator &e : ev) {
+        close(e.toChild);
+        close(e.fromChild);
+    }
+    for (Evaluator &e : ev) waitpid(e.pid, nullptr, 0);
+    ev.clear();
+}
+
+// Todos los candidatos evaluados (para elegir los mejores al final)
+struct Candidate {
+    PID_CURR g;
+    double   cost;
+};
+
+struct Tuner {
+    WorkStealingPool       *pool;
+    std::vector<Evaluator> *ev;
+    std::vector<Candidate>  all;
+    size_t                  evals = 0;
+};
+
+/**
+ * @brief
+ * Evalúa un lote en paralelo: cada hilo del pool usa su propio proceso.
+ */
+static void evaluateBatch(Tuner &t, const PID_CURR *g, size_t n, double *cost)
+{
+    t.pool->run(n, [&](size_t thread, size_t item) {
+        const Evaluator &e = (*t.ev)[thread];
+        double c = 1e6;
+        if (!writeAll(e.toChild, &g[item], sizeof(PID_CURR)) || !readAll(e.fromChild, &c, sizeof(c))) {
+            c = 1e6;
+        }
+        cost[item] = c;
+    });
+    for (size_t i = 0; i < n; i++) t.all.push_back({ g[i], cost[i] });
+    t.evals += n;
+}
+
+// ------------------------------------------------------------
+// Métodos de búsqueda
+// ------------------------------------------------------------
+
+static const size_t BATCH = 256;   // candidatos por lote en grid y random
+
+static void searchGrid(Tuner &t, const TuneSpace &sp, int levels)
+{
+    size_t total = 1;
+    for (int k = 0; k < sp.n; k++) total *= (size_t)levels;
+
+    std::vector<PID_CURR> g(BATCH);
+    std::vector<double>   c(BATCH);
+    double u[TUNE_PARAM_COUNT];
+
+    for (size_t base = 0; base < total; base += BATCH) {
+        const size_t n = (total - base < BATCH) ? total - base : BATCH;
+        for (size_t i = 0; i < n; i++) {
+            size_t code = base + i;
+            for (int k = 0; k < sp.n; k++) {
+                u[k] = (levels > 1) ? (double)(code % (size_t)levels) / (levels - 1) : 0.5;
+                code /= (size_t)levels;
+            }
+            g[i] = toGains(sp, u);
+        }
+        evaluateBatch(t, g.data(), n, c.data());
+    }
+}
+
+static void searchRandom(Tuner &t, const TuneSpace &sp, size_t evals, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    std::vector<PID_CURR> g(BATCH);
+    std::vector<double>   c(BATCH);
+    double u[TUNE_PARAM_COUNT];
+
+    for (size_t done = 0; done < evals;) {
+        const size_t n = (evals - done < BATCH) ? evals - done : BATCH;
+        for (size_t i = 0; i < n; i++) {
+            for (int k = 0; k < sp.n; k++) u[k] = uni(rng);
+            g[i] = toGains(sp, u);
+        }
+        evaluateBatch(t, g.data(), n, c.data());
+        done += n;
+    }
+}
+
+/**
+ * @brief
+ * CMA-ES en coordenadas normalizadas desde el punto de partida.
+ * @note
+ * Los candidatos fuera de [0, 1] se simulan recortados y se penalizan con
+ * el cuadrado de lo que se salen, para que la media vuelva al intervalo.
+ */
+static bool searchCmaes(Tuner &t, const TuneSpace &sp, size_t evals, double sigma, int lambda, uint32_t seed)
+{
+    static Cmaes es;
+    double mean[TUNE_PARAM_COUNT];
+    toUnit(sp, sp.start, mean);
+    if (!Cmaes_init(es, sp.n, mean, sigma, lambda, seed)) {
+        fprintf(stderr, "trms_tune: lambda fuera de rango (2..%d)\n", CMAES_MAX_LAMBDA);
+        return false;
+    }
+
+    std::vector<double>   X((size_t)es.lambda * sp.n);
+    std::vector<PID_CURR> g(es.lambda);
+    std::vector<double>   c(es.lambda);
+
+    while (t.evals + (size_t)es.lambda <= evals) {
+        Cmaes_ask(es, X.data());
+        for (int k = 0; k < es.lambda; k++) g[k] = toGains(sp, &X[(size_t)k * sp.n]);
+        evaluateBatch(t, g.data(), es.lambda, c.data());
+
+        double best = c[0];
+        for (int k = 0; k < es.lambda; k++) {
+            double out = 0.0;
+            for (int i = 0; i < sp.n; i++) {
+                const double x = X[(size_t)k * sp.n + i];
+                const double d = x - fmin(1.0, fmax(0.0, x));
+                out += d * d;
+            }
+            best = fmin(best, c[k]);
+            c[k] += 100.0 * out;
+        }
+        Cmaes_tell(es, c.data());
+        printf("  gen %3d  evals %6zu  mejor %10.4f  sigma %.4f\n", es.gen, t.evals, best, es.sigma);
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// Programa
+// ------------------------------------------------------------
+
+static void usage()
+{
+    printf("uso: trms_tune [--method grid|random|cmaes] [--evals N] [--threads N] [--seed S]\n"
+           "                 [--params Kpvv,Kphh,...] [--levels L] [--sigma S] [--lambda N]\n"
+           "                 [--mode mimo_full|vertical_only|horizontal_only] [--rate HZ]\n"
+           "                 [--from Config_N.txt] [--out DIR] [--best K] [--first N]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *method   = "cmaes";
+    const char *params   = nullptr;
+    const char *modeName = "mimo_full";
+    const char *fromPath = nullptr;
+    const char *outDir   = ".";
+    size_t      evals    = 2000;
+    size_t      threads  = std::thread::hardware_concurrency();
+    uint32_t    seed     = 1;
+    uint32_t    rateHz   = 200;
+    int         levels   = 3;
+    double      sigma    = 0.2;
+    int         lambda   = 0;
+    int         best     = 1;
+    int         first    = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if      (!strcmp(argv[i], "--method"))  method   = argv[i + 1];
+        else if (!strcmp(argv[i], "--evals"))   evals    = (size_t)atol(argv[i + 1]);
+        else if (!strcmp(argv[i], "--threads")) threads  = (size_t)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--seed"))    seed     = (uint32_t)atol(argv[i + 1]);
+        else if (!strcmp(argv[i], "--params"))  params   = argv[i + 1];
+        else if (!strcmp(argv[i], "--levels"))  levels   = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--sigma"))   sigma    = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--lambda"))  lambda   = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--mode"))    modeName = argv[i + 1];
+        else if (!strcmp(argv[i], "--rate"))    rateHz   = (uint32_t)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--from"))    fromPath = argv[i + 1];
+        else if (!strcmp(argv[i], "--out"))     outDir   = argv[i + 1];
+        else if (!strcmp(argv[i], "--best"))    best     = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--first"))   first    = atoi(argv[i + 1]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (argc % 2 == 0) {
+        usage();
+        return 2;
+    }
+    if (rateHz == 0) rateHz = 200;
+    if (threads == 0) threads = 1;
+    if (levels < 1) levels = 1;
+
+    // Índices de la SD: Config_1..Config_5
+    if (first < 1 || first > 5) {
+        fprintf(stderr, "trms_tune: --first debe estar entre 1 y 5\n");
+        return 2;
+    }
+    if (best < 1) best = 1;
+    if (best > 6 - first) best = 6 - first;
+
+    const BenchMode *md = nullptr;
+    for (size_t m = 0; m < BENCH_MODE_COUNT; m++) {
+        if (!strcmp(BENCH_MODES[m].name, modeName)) md = &BENCH_MODES[m];
+    }
+    if (!md || md->mode == PIDMode::STATE_FEEDBACK) {
+        fprintf(stderr, "trms_tune: modo no válido para el PID-4: %s\n", modeName);
+        return 2;
+    }
+
+    TuneSpace sp;
+    if (params) {
+        if (!parseParams(params, sp)) return 2;
+    } else {
+        sp.n = TUNE_PARAM_COUNT;
+        for (int i = 0; i < TUNE_PARAM_COUNT; i++) sp.idx[i] = i;
+    }
+
+    HAL_hostSetLogEnabled(false);
+    PID_LoadDefaults();
+    sp.start = g_pidCurr;
+    sp.lo    = g_pidMin;
+    sp.hi    = g_pidMax;
+    if (fromPath && !loadConfig(fromPath, sp.start, sp.lo, sp.hi)) return 1;
+
+    if (!strcmp(method, "grid")) {
+        double total = pow((double)levels, (double)sp.n);
+        if (total > 1e6) {
+            fprintf(stderr, "trms_tune: %.3g combinaciones; reduce --params o --levels\n", total);
+            return 2;
+        }
+    } else if (strcmp(method, "random") && strcmp(method, "cmaes")) {
+        usage();
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    // Los procesos antes que los hilos: fork() solo copia el hilo que lo llama
+    std::vector<Evaluator> ev;
+    if (!startEvaluators(ev, threads, *md, rateHz)) {
+        fprintf(stderr, "trms_tune: no se pueden crear los procesos de evaluación\n");
+        stopEvaluators(ev);
+        return 1;
+    }
+
+    printf("trms_tune: %s, modo %s, %d parámetros, %zu hilos\n", method, md->name, sp.n, threads);
+
+    bool ok = true;
+    const auto t0 = std::chrono::steady_clock::now();
+    Tuner t;
+    {
+        WorkStealingPool pool(threads);
+        t.pool = &pool;
+        t.ev   = &ev;
+
+        double refCost;
+        evaluateBatch(t, &sp.start, 1, &refCost);
+        printf("  punto de partida: coste %.4f\n", refCost);
+
+        if      (!strcmp(method, "grid"))   searchGrid(t, sp, levels);
+        else if (!strcmp(method, "random")) searchRandom(t, sp, evals, seed);
+        else                                ok = searchCmaes(t, sp, evals, sigma, lambda, seed);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    stopEvaluators(ev);
+    if (!ok) return 2;
+
+    printf("  %zu evaluaciones en %.1f s (%.1f evaluaciones/s)\n", t.evals, elapsed, t.evals / elapsed);
+
+    // Mejores candidatos distintos (a la resolución del fichero), de menor a mayor coste
+    std::vector<size_t> order(t.all.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return t.all[a].cost < t.all[b].cost; });
+
+    std::vector<size_t> chosen;
+    for (size_t i = 0; i < order.size() && (int)chosen.size() < best; i++) {
+        const PID_CURR &g = t.all[order[i]].g;
+        bool dup = false;
+        for (size_t j : chosen) {
+            bool same = true;
+            for (const TuneParam &p : TUNE_PARAMS) {
+                if (fabsf(g.*p.curr - t.all[j].g.*p.curr) > 5e-7f) same = false;
+            }
+            if (same) dup = true;
+        }
+        if (!dup) chosen.push_back(order[i]);
+    }
+
+    char dir[512], path[600];
+    snprintf(dir, sizeof(dir), "%s/Config_PID", outDir);
+    mkdir(outDir, 0755);
+    mkdir(dir, 0755);
+
+    for (size_t i = 0; i < chosen.size(); i++) {
+        const Candidate &c = t.all[chosen[i]];
+        snprintf(path, sizeof(path), "%s/Config_%d.txt", dir, first + (int)i);
+        if (!writeConfig(path, c.g, sp.lo, sp.hi, c.cost)) return 1;
+
+        printf("\n%s  coste %.4f\n ", path, c.cost);
+        for (int k = 0; k < sp.n; k++) {
+            const TuneParam &p = TUNE_PARAMS[sp.idx[k]];
+            printf(" %s=%.4f", p.name, c.g.*p.curr);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/* Pool de hilos con robo de trabajo para las herramientas de host. Cada hilo tiene su propia cola:
+saca trabajo del final de la suya y, cuando se queda sin nada, roba del principio de la de otro hilo.
+Así un lote de tareas de duración muy distinta (ensayos que se asientan antes o después) se reparte
+solo entre los núcleos, sin una cola central por la que pasen todos */
+
+// WorkStealingPool.h
+#pragma once
+
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    // Tarea: fn(hilo, elemento); hilo en [0, size()) identifica al hilo que la ejecuta
+    typedef std::function<void(size_t, size_t)> Task;
+
+    explicit WorkStealingPool(size_t nThreads)
+        : m_queues(nThreads ? nThreads : 1)
+    {
+        for (size_t i = 0; i < m_queues.size(); i++) {
+            m_threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread &t : m_threads) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    size_t size() const { return m_queues.size(); }
+
+    /**
+     * @brief Ejecuta fn(hilo, i) para i en [0, n) y espera a que terminen todas.
+     *
+     * Los elementos se reparten en bloques contiguos, uno por hilo; a partir
+     * de ahí cada hilo roba cuando vacía su cola. No es reentrante: una sola
+     * llamada a la vez.
+     */
+    void run(size_t n, const Task &fn)
+    {
+        if (n == 0) return;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_task      = &fn;
+            m_remaining = n;
+        }
+        const size_t nq = m_queues.size();
+        for (size_t q = 0; q < nq; q++) {
+            std::lock_guard<std::mutex> lk(m_queues[q].m);
+            for (size_t i = q * n / nq; i < (q + 1) * n / nq; i++) m_queues[q].items.push_back(i);
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_batch++;
+        }
+        m_wake.notify_all();
+
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_done.wait(lk, [this] { return m_remaining == 0; });
+        m_task = nullptr;
+    }
+
+private:
+    struct Queue {
+        std::mutex         m;
+        std::deque<size_t> items;
+    };
+
+    // Propia: por el final (lo último repartido, aún en caché); ajena: por el principio
+    bool take(size_t self, size_t &item)
+    {
+        {
+            Queue &q = m_queues[self];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (!q.items.empty()) {
+                item = q.items.back();
+                q.items.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < m_queues.size(); k++) {
+            Queue &q = m_queues[(self + k) % m_queues.size()];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (!q.items.empty()) {
+                item = q.items.front();
+                q.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // La tarea se lee con cada elemento: un hilo que aún no ha visto el lote
+    // nuevo puede robar ya de él (las colas se llenan antes de avisar)
+    void workerLoop(size_t self)
+    {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lk(m_mutex);
+                m_wake.wait(lk, [&] { return m_stop || m_batch != seen; });
+                if (m_stop) return;
+                seen = m_batch;
+            }
+
+            size_t item;
+            while (take(self, item)) {
+                const Task *task;
+                {
+                    std::lock_guard<std::mutex> lk(m_mutex);
+                    task = m_task;
+                }
+                (*task)(self, item);
+                std::lock_guard<std::mutex> lk(m_mutex);
+                if (--m_remaining == 0) m_done.notify_all();
+            }
+        }
+    }
+
+    std::vector<Queue>       m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex              m_mutex;       // protege lo de abajo
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const Task             *m_task      = nullptr;
+    size_t                  m_remaining = 0;
+    size_t                  m_batch     = 0;
+    bool                    m_stop      = false;
+};
@@ -0,0 +1,68 @@
+/* Esta librería, junto con su correspondiente "Clock.h", define el reloj en microsegundos que usan
+el lazo de control y la lectura de encoders. En el ESP32 es esp_timer_get_time(); fuera del ESP32
+es un reloj simulado que se avanza a mano, para poder probar el cálculo de dt y jitter sin hardware */
+
+// Clock.cpp
+#include "Clock.h"
+
+#include <limits.h>
+
+#ifdef ARDUINO
+#include <esp_timer.h>
+
+int64_t Clock_nowUs()
+{
+    return esp_timer_get_time();
+}
+
+#else
+
+static int64_t s_mockUs = 0;
+
+int64_t Clock_nowUs()
+{
+    return s_mockUs;
+}
+
+void Clock_mockSetUs(int64_t us)
+{
+    s_mockUs = us;
+}
+
+void Clock_mockAdvanceUs(int64_t us)
+{
+    s_mockUs += us;
+}
+
+#endif
+
+void SamplePeriod_init(SamplePeriod &sp, uint32_t nominalUs)
+{
+    sp.nominalUs    = nominalUs;
+    sp.lastUs       = -1;
+    sp.lastJitterUs = 0;
+    sp.minJitterUs  = INT32_MAX;
+    sp.maxJitterUs  = INT32_MIN;
+    sp.samples      = 0;
+}
+
+float SamplePeriod_update(SamplePeriod &sp, int64_t tUs)
+{
+    const float nominalS = (float)sp.nominalUs * 1e-6f;
+
+    if (sp.lastUs < 0 || tUs <= sp.lastUs) {
+        sp.lastUs = tUs;
+        return nominalS;
+    }
+
+    int64_t deltaUs = tUs - sp.lastUs;
+    sp.lastUs = tUs;
+
+    int32_t jitter = (int32_t)(deltaUs - (int64_t)sp.nominalUs);
+    sp.lastJitterUs = jitter;
+    if (jitter < sp.minJitterUs) sp.minJitterUs = jitter;
+    if (jitter > sp.maxJitterUs) sp.maxJitterUs = jitter;
+    sp.samples++;
+
+    return (float)deltaUs * 1e-6f;
+}
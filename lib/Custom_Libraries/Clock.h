@@ -0,0 +1,53 @@
+/* Esta librería, junto con su correspondiente "Clock.cpp", define el reloj en microsegundos que usan
+el lazo de control y la lectura de encoders. En el ESP32 es esp_timer_get_time(); fuera del ESP32
+es un reloj simulado que se avanza a mano, para poder probar el cálculo de dt y jitter sin hardware */
+
+// Clock.h
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Tiempo monotónico en microsegundos desde el arranque.
+ *
+ * ESP32: esp_timer_get_time() (64 bits, no desborda).
+ * Host:  valor del reloj simulado (Clock_mockSetUs / Clock_mockAdvanceUs).
+ */
+int64_t Clock_nowUs();
+
+#ifndef ARDUINO
+// Reloj simulado (solo en compilación host)
+void Clock_mockSetUs(int64_t us);
+void Clock_mockAdvanceUs(int64_t us);
+#endif
+
+/**
+ * @brief Periodo de muestreo medido a partir de instantes de muestra.
+ *
+ * Calcula el dt exacto entre muestras consecutivas (en lugar de suponer el
+ * nominal o de usar millis(), que cuantiza a 1 ms) y acumula el jitter
+ * (periodo real - nominal).
+ *
+ * @param nominalUs   Periodo nominal [us]
+ * @param lastUs      Instante de la última muestra (-1 = ninguna todavía)
+ * @param lastJitterUs, minJitterUs, maxJitterUs  Jitter observado
+ * @param samples     Intervalos medidos (muestras - 1)
+ */
+struct SamplePeriod {
+    uint32_t nominalUs;
+    int64_t  lastUs;
+    int32_t  lastJitterUs;
+    int32_t  minJitterUs;
+    int32_t  maxJitterUs;
+    uint32_t samples;
+};
+
+// Inicializa con el periodo nominal y borra historia y estadísticas
+void SamplePeriod_init(SamplePeriod &sp, uint32_t nominalUs);
+
+/**
+ * @brief Registra una muestra tomada en tUs y devuelve el dt exacto [s].
+ *
+ * En la primera muestra (o si el reloj no avanza) devuelve el nominal.
+ */
+float SamplePeriod_update(SamplePeriod &sp, int64_t tUs);
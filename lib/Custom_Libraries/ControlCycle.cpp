@@ -0,0 +1,163 @@
+/* Esta librería, junto con su correspondiente "ControlCycle.h", define un ciclo del lazo de control
+del TRMS: la misma secuencia corre en la tarea de control del ESP32 y en el simulador del PC */
+
+// ControlCycle.cpp
+#include "ControlCycle.h"
+#include "PID_Control.h"
+#include "MotorControl.h"
+#include "Tacho.h"
+#include "Profiler.h"
+#include "RigIdent.h"
+#include "RelayTune.h"
+#include "FreqResp.h"
+
+static float degPerCount(float countsPerRev)
+{
+    return (countsPerRev > 0.0f) ? 360.0f / countsPerRev : 0.0f;
+}
+
+void ControlCycle_init(ControlCycle &cc, uint32_t periodUs, const EncoderConfig &enc)
+{
+    cc.periodUs = periodUs;
+    cc.kV       = degPerCount(enc.countsPerRevVertical);
+    cc.kH       = degPerCount(enc.countsPerRevHorizontal);
+    cc.countV   = 0;
+    cc.countH   = 0;
+    cc.observe  = false;
+    SamplePeriod_init(cc.period, periodUs);
+    PID4_SetEncoderScale(cc.kV, cc.kH);
+}
+
+void ControlCycle_resetPeriod(ControlCycle &cc, uint32_t periodUs)
+{
+    const bool changed = (periodUs != cc.periodUs);
+    cc.periodUs = periodUs;
+    SamplePeriod_init(cc.period, periodUs);
+
+    // Ganancias para el periodo nuevo (un reset de estadísticas no toca la estimación)
+    if (cc.observe && changed) Observer_init(cc.obs, cc.obs.cfg, (float)periodUs * 1e-6f, cc.kV, cc.kH);
+    if (changed) RigIdent_reset();
+}
+
+void ControlCycle_setObserver(ControlCycle &cc, const ObserverConfig *cfg)
+{
+    cc.observe = (cfg != nullptr);
+    if (cfg) Observer_init(cc.obs, *cfg, (float)cc.periodUs * 1e-6f, cc.kV, cc.kH);
+
+    ObserverEstimate none = {};
+    PID4_SetObserverEstimate(none);
+}
+
+/**
+ * @brief
+ * Ejecuta un ciclo del lazo de control.
+ * @note
+ * Las lecturas fallidas no cuentan para el dt: la siguiente muestra buena
+ * integra todo el intervalo transcurrido desde la última buena. Si la lectura
+ * falla no se ejecuta el PID (los DACs conservan el último valor). Con un
+ * auto-ajuste (RelayTune) o un barrido de Bode (FreqResp) en marcha, son ellos
+ * los que escriben los registros.
+ */
+bool ControlCycle_run(ControlCycle &cc, int64_t wakeUs,
+                      TelemetryRecord &rec, EncoderSample &smp)
+{
+    // ---- 1) Lectura de encoders (con instante de muestra) ----
+    bool ok;
+    {
+        PROF_SCOPE(PROF_ENCODERS);
+        ok = Encoders_readSample(smp);
+    }
+    if (ok) {
+        cc.countV = smp.countV;
+        cc.countH = smp.countH;
+    }
+
+    // ---- 2) Paso de control con el dt exacto entre muestras ----
+    float dt = ok ? SamplePeriod_update(cc.period, smp.tUs)
+                  : (float)cc.periodUs * 1e-6f;
+    if (dt > CONTROL_CYCLE_MAX_DT_S) dt = CONTROL_CYCLE_MAX_DT_S;
+
+    float measV = (float)cc.countV * cc.kV;
+    float measH = (float)cc.countH * cc.kH;
+
+    PID4StepResult res;
+    res.enabled = false;
+    const ObserverEstimate *est = nullptr;
+    int tuneMP = 0, tuneRDC = 0;
+    bool tuning = false;
+
+    if (ok) {
+        PROF_SCOPE(PROF_PID);
+        // Tacómetros: para el observador, los lazos internos del modo en
+        // cascada y la identificación (si no hace falta ninguno, no se lee el ADC)
+        const bool cascade = (PID4_GetMode() == PIDMode::CASCADE);
+        const bool ident   = RigIdent_isEnabled();
+        if (cc.observe || cascade || ident) {
+            float rpmMP, rpmRDC;
+            Tacho_readRpm(rpmMP, rpmRDC);
+            // Registros aplicados desde la muestra anterior (entrada de los modelos)
+            int regMP, regRDC;
+            MotorControl_getLastRegisters(regMP, regRDC);
+            // Con los tacómetros sin filtrar: el observador ya supone un modelo de los rotores
+            if (ident) RigIdent_update(dt, measV, measH, rpmMP, rpmRDC, regMP, regRDC);
+            if (cc.observe) {
+                est = &Observer_update(cc.obs, dt, measV, measH, rpmMP, rpmRDC, regMP, regRDC);
+                PID4_SetObserverEstimate(*est);
+                rpmMP  = est->rpmMain;
+                rpmRDC = est->rpmTail;
+            }
+            if (cascade) PID4_SetRotorSpeeds(rpmMP, rpmRDC);
+        }
+        // Auto-ajuste por relé o barrido de Bode en marcha: sustituyen al PID (que está deshabilitado)
+        tuning = RelayTune_step(dt, measV, measH, tuneMP, tuneRDC) ||
+                 FreqResp_step(dt, measV, measH, tuneMP, tuneRDC);
+        if (tuning) {
+            MotorControl_writeOutputs(tuneMP, tuneRDC);
+        } else {
+            PID4_StepWithCounts(dt, cc.countV, cc.countH, &res);
+        }
+    } else {
+        // si falla encoder, opcional: parar motores por seguridad
+        // MotorControl_writeOutputs(0, 0);
+    }
+
+    // ---- 3) Registro de telemetría ----
+    rec = {};
+    rec.tUs        = ok ? smp.tUs : wakeUs;
+    rec.dtS        = dt;
+    rec.countV     = cc.countV;
+    rec.countH     = cc.countH;
+    rec.measVDeg   = measV;
+    rec.measHDeg   = measH;
+    rec.encOk      = ok;
+    rec.pidEnabled = res.enabled;
+    if (res.enabled) {
+        rec.refVDeg = res.refVertDeg;
+        rec.refHDeg = res.refHorDeg;
+        rec.u_hh    = res.parts.u_hh;
+        rec.u_hv    = res.parts.u_hv;
+        rec.u_vh    = res.parts.u_vh;
+        rec.u_vv    = res.parts.u_vv;
+        rec.Uh      = res.Uh;
+        rec.Uv      = res.Uv;
+        rec.regMP   = (int16_t)res.regMP;
+        rec.regRDC  = (int16_t)res.regRDC;
+        rec.satMP   = (res.trackUv != 0.0f);
+        rec.satRDC  = (res.trackUh != 0.0f);
+        rec.gainGen = res.gainGen;
+        rec.spMP    = (int16_t)res.spMP;
+        rec.spRDC   = (int16_t)res.spRDC;
+        rec.rpmMP   = res.rpmMP;
+        rec.rpmRDC  = res.rpmRDC;
+    } else if (tuning) {
+        rec.regMP  = (int16_t)tuneMP;
+        rec.regRDC = (int16_t)tuneRDC;
+    }
+    if (est) {
+        rec.rateVDegS = est->rateVDegS;
+        rec.rateHDegS = est->rateHDegS;
+    }
+    MotorControl_getLastDacValues(rec.dacG1, rec.dacG2);
+
+    return ok;
+}
@@ -0,0 +1,72 @@
+/* Esta librería, junto con su correspondiente "ControlCycle.cpp", define un ciclo del lazo de control
+del TRMS (lectura de encoders con marca de tiempo, dt exacto, paso del PID-4 y registro de telemetría)
+sin depender de FreeRTOS: la usa la tarea de control en el ESP32 y el simulador en el PC */
+
+// ControlCycle.h
+#pragma once
+
+#include <stdint.h>
+#include "Encoders.h"
+#include "Clock.h"
+#include "Telemetry.h"
+#include "StateObserver.h"
+
+// Límite del dt que se pasa al PID (evita saltos grandes tras muchos fallos de lectura)
+static const float CONTROL_CYCLE_MAX_DT_S = 0.100f;
+
+/**
+ * @brief Estado de un lazo de control entre ciclos.
+ *
+ * @param periodUs  Periodo nominal del lazo [us]
+ * @param kV, kH    Grados por cuenta de cada eje
+ * @param period    dt real entre muestras de encoder y jitter de muestreo
+ * @param countV, countH  Última lectura correcta (se repite si falla la siguiente)
+ * @param observe   Observador de estado activo (ControlCycle_setObserver)
+ * @param obs       Observador (ángulos, velocidades de la viga y de los rotores)
+ */
+struct ControlCycle {
+    uint32_t      periodUs;
+    float         kV;
+    float         kH;
+    SamplePeriod  period;
+    int16_t       countV;
+    int16_t       countH;
+    bool          observe;
+    StateObserver obs;
+};
+
+// Inicializa el ciclo con el periodo nominal y las cuentas por vuelta de cada eje
+// (también fija la escala de los encoders del PID-4, PID4_SetEncoderScale)
+void ControlCycle_init(ControlCycle &cc, uint32_t periodUs, const EncoderConfig &enc);
+
+// Reinicia la medida del dt (cambio de frecuencia o reset de estadísticas).
+// Si el periodo cambia y el observador está activo, recalcula sus ganancias; la
+// identificación vuelve a empezar (sus modelos dependen del periodo).
+void ControlCycle_resetPeriod(ControlCycle &cc, uint32_t periodUs);
+
+/**
+ * @brief Activa el observador de estado con cfg (nullptr lo desactiva).
+ *
+ * Activo, cada ciclo lee también los tacómetros y pasa la estimación al PID-4
+ * (PID4_SetObserverEstimate). Desactivado (por defecto) no se lee el ADC salvo
+ * en el modo CASCADE o con la identificación activa. Llamar antes de arrancar el lazo.
+ */
+void ControlCycle_setObserver(ControlCycle &cc, const ObserverConfig *cfg);
+
+/**
+ * @brief Ejecuta un ciclo completo del lazo.
+ *
+ *  1) Lee los encoders con marca de tiempo (punto medio de la lectura I2C)
+ *  2) Calcula el dt exacto desde la última muestra buena y avanza el observador
+ *     y la identificación en marcha (RigIdent, si está activa)
+ *  3) Ejecuta PID4_StepWithCounts (que escribe los DACs si está habilitado)
+ *  4) Rellena rec con la muestra, el resultado del PID y los DACs (no lo publica)
+ *
+ * @param cc      Estado del lazo
+ * @param wakeUs  Instante de disparo del ciclo (marca del registro si falla la lectura)
+ * @param rec     Registro de telemetría del ciclo
+ * @param smp     Muestra de encoders leída (readUs para estadísticas)
+ * @return true si la lectura de encoders ha sido correcta
+ */
+bool ControlCycle_run(ControlCycle &cc, int64_t wakeUs,
+                      TelemetryRecord &rec, EncoderSample &smp);
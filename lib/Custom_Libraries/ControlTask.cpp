@@ -0,0 +1,288 @@
+/* Esta librería, junto con su correspondiente "ControlTask.h", define la tarea de control en tiempo real
+del TRMS: un temporizador periódico despierta una tarea FreeRTOS anclada a un núcleo que lee los encoders,
+ejecuta el PID-4 y escribe los DACs a frecuencia fija, independientemente de LVGL, SD o Serial */
+
+// ControlTask.cpp
+#include "ControlTask.h"
+#include "ControlCycle.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+// Límites de frecuencia admitidos para el lazo
+static const uint32_t RATE_MIN_HZ = 50;
+static const uint32_t RATE_MAX_HZ = 1000;
+
+// Configuración y objetos del módulo
+static ControlTaskConfig  s_cfg;
+static TaskHandle_t       s_task  = nullptr;
+static esp_timer_handle_t s_timer = nullptr;
+
+static volatile uint32_t  s_periodUs = 5000;
+
+// Última lectura de encoders (compartida con la UI)
+static int16_t s_lastCountV = 0;
+static int16_t s_lastCountH = 0;
+static bool    s_lastOk     = false;
+
+// Estadísticas
+static ControlTaskStats s_stats;
+
+// Estado del lazo (última lectura, dt del PID y jitter de muestreo)
+static ControlCycle s_cycle;
+static volatile bool s_samplePeriodReset = true;
+
+// Protege la última lectura y las estadísticas (se leen desde la UI)
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief
+ * Limita la frecuencia pedida al rango admitido y la convierte a periodo.
+ */
+static uint32_t rateToPeriodUs(uint32_t rateHz)
+{
+    if (rateHz < RATE_MIN_HZ) rateHz = RATE_MIN_HZ;
+    if (rateHz > RATE_MAX_HZ) rateHz = RATE_MAX_HZ;
+    return 1000000UL / rateHz;
+}
+
+/**
+ * @brief
+ * Pone a cero las estadísticas conservando el periodo nominal.
+ * @note
+ * Debe llamarse con s_mux tomado.
+ */
+static void resetStatsUnlocked()
+{
+    s_stats = {};
+    s_stats.periodUs    = s_periodUs;
+    s_stats.minJitterUs = INT32_MAX;
+    s_stats.maxJitterUs = INT32_MIN;
+    s_stats.minSampleJitterUs = INT32_MAX;
+    s_stats.maxSampleJitterUs = INT32_MIN;
+    s_samplePeriodReset = true;   // la tarea reinicia SamplePeriod con el nuevo nominal
+}
+
+/**
+ * @brief
+ * Callback del temporizador periódico.
+ * @note
+ * Se ejecuta en la tarea de esp_timer: solo despierta a la tarea de control.
+ * Si la tarea no ha consumido la notificación anterior, el contador se acumula
+ * y la tarea lo detecta como disparo perdido.
+ */
+static void controlTimerCb(void *arg)
+{
+    (void)arg;
+    if (s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+/**
+ * @brief
+ * Cuerpo de la tarea de control.
+ * @note
+ * Por cada disparo del temporizador:
+ *  1) Ejecuta ControlCycle_run: lee los encoders (I2C) con marca de tiempo, calcula
+ *     el dt exacto entre muestras y ejecuta PID4_StepWithCounts (que escribe
+ *     los DACs si el PID está habilitado)
+ *  2) Publica el TelemetryRecord en la cola SPSC (sin bloquear ni formatear)
+ *  3) Actualiza jitter, overruns y tiempo de ejecución
+ */
+static void controlTaskFn(void *arg)
+{
+    (void)arg;
+
+    int64_t lastWakeUs = 0;
+
+    for (;;) {
+        // Espera al temporizador. n > 1 => se han perdido disparos
+        uint32_t n = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t wakeUs = esp_timer_get_time();
+        uint32_t cycleT0 = Profiler_now();
+
+        if (s_samplePeriodReset) {
+            s_samplePeriodReset = false;
+            ControlCycle_resetPeriod(s_cycle, s_periodUs);
+        }
+
+        // ---- 1) Encoders + PID + DAC ----
+        TelemetryRecord rec;
+        EncoderSample smp;
+        bool ok = ControlCycle_run(s_cycle, wakeUs, rec, smp);
+
+        // ---- 2) Telemetría ----
+        Telemetry_push(rec);
+
+        portENTER_CRITICAL(&s_mux);
+        s_lastCountV = s_cycle.countV;
+        s_lastCountH = s_cycle.countH;
+        s_lastOk     = ok;
+        portEXIT_CRITICAL(&s_mux);
+
+#if PROFILER_ENABLED
+        Profiler_record(PROF_CTRL_CYCLE, Profiler_now() - cycleT0);
+#else
+        (void)cycleT0;
+#endif
+
+        // ---- 3) Estadísticas ----
+        uint32_t execUs = (uint32_t)(esp_timer_get_time() - wakeUs);
+        uint32_t period = s_periodUs;
+
+        portENTER_CRITICAL(&s_mux);
+        s_stats.cycles++;
+        if (!ok) {
+            s_stats.readErrors++;
+        } else {
+            s_stats.lastReadUs = smp.readUs;
+            if (smp.readUs > s_stats.maxReadUs) s_stats.maxReadUs = smp.readUs;
+
+            if (s_cycle.period.samples > 0) {
+                s_stats.lastSampleJitterUs = s_cycle.period.lastJitterUs;
+                s_stats.minSampleJitterUs  = s_cycle.period.minJitterUs;
+                s_stats.maxSampleJitterUs  = s_cycle.period.maxJitterUs;
+            }
+        }
+
+        if (lastWakeUs != 0) {
+            int32_t jitter = (int32_t)(wakeUs - lastWakeUs) - (int32_t)period;
+            s_stats.lastJitterUs = jitter;
+            if (jitter < s_stats.minJitterUs) s_stats.minJitterUs = jitter;
+            if (jitter > s_stats.maxJitterUs) s_stats.maxJitterUs = jitter;
+        }
+
+        if (n > 1) {
+            s_stats.missedTicks += (n - 1);
+        }
+        if (n > 1 || execUs > period) {
+            s_stats.overruns++;
+        }
+
+        s_stats.lastExecUs = execUs;
+        if (execUs > s_stats.maxExecUs) s_stats.maxExecUs = execUs;
+        portEXIT_CRITICAL(&s_mux);
+
+        lastWakeUs = wakeUs;
+    }
+}
+
+/**
+ * @brief
+ * Inicializa la tarea de control y su temporizador periódico.
+ * @note
+ * La tarea se ancla a cfg.core con prioridad cfg.priority; el temporizador
+ * (esp_timer) la despierta cada 1/rateHz segundos.
+ * @param cfg
+ * @return true
+ * @return false
+ */
+bool ControlTask_begin(const ControlTaskConfig &cfg)
+{
+    if (s_task) return true;   // ya iniciada
+
+    s_cfg      = cfg;
+    s_periodUs = rateToPeriodUs(cfg.rateHz);
+    ControlCycle_init(s_cycle, s_periodUs, cfg.encoders);
+    ControlCycle_setObserver(s_cycle, cfg.observer);
+
+    portENTER_CRITICAL(&s_mux);
+    resetStatsUnlocked();
+    portEXIT_CRITICAL(&s_mux);
+
+    BaseType_t okTask = xTaskCreatePinnedToCore(
+        controlTaskFn,
+        "trms_ctrl",
+        cfg.stackBytes,
+        nullptr,
+        cfg.priority,
+        &s_task,
+        cfg.core
+    );
+
+    if (okTask != pdPASS) {
+        Serial.println("[CTRL] ERROR: no se pudo crear la tarea de control");
+        s_task = nullptr;
+        return false;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback        = controlTimerCb;
+    args.arg             = nullptr;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name            = "trms_ctrl_tmr";
+
+    if (esp_timer_create(&args, &s_timer) != ESP_OK ||
+        esp_timer_start_periodic(s_timer, s_periodUs) != ESP_OK) {
+        Serial.println("[CTRL] ERROR: no se pudo arrancar el temporizador de control");
+        // Sin temporizador la tarea se quedaría bloqueada para siempre y un
+        // ControlTask_begin posterior daría por buena la inicialización
+        if (s_timer) {
+            esp_timer_delete(s_timer);
+            s_timer = nullptr;
+        }
+        vTaskDelete(s_task);
+        s_task = nullptr;
+        return false;
+    }
+
+    Serial.printf("[CTRL] Tarea de control: %lu Hz (Ts = %lu us) en nucleo %u, prioridad %u\n",
+                  (unsigned long)(1000000UL / s_periodUs), (unsigned long)s_periodUs,
+                  (unsigned)cfg.core, (unsigned)cfg.priority);
+    return true;
+}
+
+/**
+ * @brief
+ * Cambia la frecuencia del lazo de control.
+ * @note
+ * Reinicia el temporizador con el nuevo periodo y pone a cero las estadísticas,
+ * ya que el jitter se mide respecto al periodo nominal.
+ * @param rateHz
+ */
+void ControlTask_setRateHz(uint32_t rateHz)
+{
+    s_periodUs = rateToPeriodUs(rateHz);
+
+    if (s_timer) {
+        esp_timer_stop(s_timer);
+        esp_timer_start_periodic(s_timer, s_periodUs);
+    }
+
+    portENTER_CRITICAL(&s_mux);
+    resetStatsUnlocked();
+    portEXIT_CRITICAL(&s_mux);
+}
+
+uint32_t ControlTask_getRateHz()
+{
+    return 1000000UL / s_periodUs;
+}
+
+bool ControlTask_getLastCounts(int16_t &countV, int16_t &countH)
+{
+    portENTER_CRITICAL(&s_mux);
+    countV  = s_lastCountV;
+    countH  = s_lastCountH;
+    bool ok = s_lastOk;
+    portEXIT_CRITICAL(&s_mux);
+    return ok;
+}
+
+void ControlTask_getStats(ControlTaskStats &out)
+{
+    portENTER_CRITICAL(&s_mux);
+    out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void ControlTask_resetStats()
+{
+    portENTER_CRITICAL(&s_mux);
+    resetStatsUnlocked();
+    portEXIT_CRITICAL(&s_mux);
+}
@@ -0,0 +1,88 @@
+/* Esta librería, junto con su correspondiente "ControlTask.cpp", define la tarea de control en tiempo real
+del TRMS: un temporizador periódico despierta una tarea FreeRTOS anclada a un núcleo que lee los encoders,
+ejecuta el PID-4 y escribe los DACs a frecuencia fija, independientemente de LVGL, SD o Serial */
+
+// ControlTask.h
+#pragma once
+
+#include <Arduino.h>
+#include "Encoders.h"
+#include "StateObserver.h"
+
+/**
+ * @brief Configuración de la tarea de control
+ *
+ * @param rateHz      Frecuencia de muestreo del lazo (ej: 200..1000 Hz)
+ * @param core        Núcleo en el que se ancla la tarea (la UI va en el otro)
+ * @param priority    Prioridad FreeRTOS de la tarea (por encima de la UI)
+ * @param stackBytes  Tamaño de pila de la tarea
+ * @param encoders    Cuentas por vuelta de cada eje (conversión a grados)
+ * @param observer    Observador de estado (nullptr = sin observador, ver ControlCycle_setObserver)
+ */
+struct ControlTaskConfig {
+    uint32_t      rateHz;
+    uint8_t       core;
+    uint8_t       priority;
+    uint32_t      stackBytes;
+    EncoderConfig encoders;
+    const ObserverConfig *observer;
+};
+
+/**
+ * @brief Estadísticas de temporización de la tarea de control.
+ *
+ * - Jitter: diferencia entre el periodo real (inicio a inicio) y el nominal.
+ * - Jitter de muestreo: igual, pero entre instantes de muestra de encoder
+ *   (punto medio de la lectura I2C), que es lo que ve el PID como dt.
+ * - Overrun: periodo en el que el trabajo no terminó antes del siguiente disparo
+ *   (el temporizador ha notificado más de una vez o execUs > periodo).
+ */
+struct ControlTaskStats {
+    uint32_t periodUs;       // periodo nominal
+    uint32_t cycles;         // periodos ejecutados
+    uint32_t overruns;       // periodos que no llegaron a tiempo
+    uint32_t missedTicks;    // disparos del temporizador perdidos
+    uint32_t readErrors;     // lecturas de encoder fallidas (I2C)
+
+    int32_t  lastJitterUs;   // jitter del último periodo
+    int32_t  minJitterUs;    // jitter mínimo observado
+    int32_t  maxJitterUs;    // jitter máximo observado
+
+    int32_t  lastSampleJitterUs;  // jitter entre muestras de encoder (dt del PID - nominal)
+    int32_t  minSampleJitterUs;
+    int32_t  maxSampleJitterUs;
+
+    uint32_t lastReadUs;     // duración de la última lectura I2C de encoders
+    uint32_t maxReadUs;
+
+    uint32_t lastExecUs;     // duración del último paso (lectura + PID + DAC)
+    uint32_t maxExecUs;      // duración máxima observada
+};
+
+/**
+ * @brief Crea el temporizador periódico y la tarea de control.
+ *
+ * Debe llamarse al final de setup(), con encoders, motores y PID ya inicializados.
+ *
+ * @return true si la tarea y el temporizador se han creado correctamente
+ */
+bool ControlTask_begin(const ControlTaskConfig &cfg);
+
+/**
+ * @brief Cambia la frecuencia del lazo en caliente (reinicia el temporizador).
+ */
+void ControlTask_setRateHz(uint32_t rateHz);
+uint32_t ControlTask_getRateHz();
+
+/**
+ * @brief Devuelve la última lectura de encoders hecha por la tarea de control.
+ *
+ * La UI la usa para las gráficas en lugar de volver a leer por I2C.
+ *
+ * @return true si la última lectura fue correcta
+ */
+bool ControlTask_getLastCounts(int16_t &countV, int16_t &countH);
+
+// Estadísticas de temporización (copia coherente) y reset
+void ControlTask_getStats(ControlTaskStats &out);
+void ControlTask_resetStats();
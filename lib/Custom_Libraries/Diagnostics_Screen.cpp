@@ -0,0 +1,360 @@
+/* Este archivo, y su correspondiente ".h", crean por código (sin SquareLine) una pantalla de
+diagnóstico con los tiempos por etapa del Profiler y las estadísticas de la tarea de control, o
+con el modelo identificado en marcha (RigIdent), o con el diagrama de Bode medido (FreqResp). Se abre
+con los comandos serie "diag", "ident" y "bode" y se cierra tocando la pantalla (vuelve a la anterior) */
+
+#include "Diagnostics_Screen.h"
+#include "Profiler.h"
+#include "ControlTask.h"
+#include "RigIdent.h"
+#include "EquilibriumMap.h"
+#include "FreqResp.h"
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+
+// ------------------------------------------------------------
+// AJUSTES
+// ------------------------------------------------------------
+static const uint32_t REFRESH_MS = 500;
+
+static const lv_color_t COL_BG     = lv_color_make(255, 255, 255);
+static const lv_color_t COL_HEADER = lv_color_make(138, 43, 226);   // morado UI
+
+// Columnas de la tabla: etapa | n | min | media | max | p99
+static const uint8_t  TABLE_COLS = 6;
+static const lv_coord_t COL_W[TABLE_COLS] = { 110, 70, 70, 70, 70, 70 };
+
+// Tabla del modelo: modelo | a1 | a2 | b1 | b2 | c | d | ajuste (los rotores solo a, b, c)
+static const uint8_t  IDENT_COLS = 8;
+static const uint8_t  IDENT_ROWS = 5;
+static const lv_coord_t IDENT_COL_W[IDENT_COLS] = { 50, 60, 60, 60, 60, 60, 60, 60 };
+
+// Gráfica de Bode: ganancia (eje izquierdo, dB) y fase (eje derecho, grados) por punto del barrido
+static const lv_color_t COL_GAIN  = lv_color_make(200, 30, 30);
+static const lv_color_t COL_PHASE = lv_color_make(30, 80, 200);
+
+// ------------------------------------------------------------
+// ESTADO INTERNO
+// ------------------------------------------------------------
+static lv_obj_t *s_scr      = nullptr;
+static lv_obj_t *s_title    = nullptr;
+static lv_obj_t *s_table    = nullptr;
+static lv_obj_t *s_tblIdent = nullptr;
+static lv_obj_t *s_lblIdent = nullptr;
+static lv_obj_t *s_lblCtrl  = nullptr;
+static lv_obj_t *s_chart    = nullptr;
+static lv_chart_series_t *s_serGain  = nullptr;
+static lv_chart_series_t *s_serPhase = nullptr;
+static lv_obj_t *s_lblBode  = nullptr;
+static DiagPage  s_page     = DIAG_PAGE_TIMES;
+static lv_obj_t *s_prevScr  = nullptr;
+static uint32_t  s_lastRefreshMs = 0;
+
+static void onScreenClicked(lv_event_t *e)
+{
+    (void)e;
+    DiagScreen_Hide();
+}
+
+static void buildScreen()
+{
+    s_scr = lv_obj_create(NULL);
+    lv_obj_clear_flag(s_scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_bg_color(s_scr, COL_BG, 0);
+    lv_obj_add_event_cb(s_scr, onScreenClicked, LV_EVENT_CLICKED, NULL);
+
+    s_title = lv_label_create(s_scr);
+    lv_label_set_text(s_title, "");
+    lv_obj_set_style_text_color(s_title, COL_HEADER, 0);
+    lv_obj_align(s_title, LV_ALIGN_TOP_MID, 0, 6);
+
+    s_table = lv_table_create(s_scr);
+    lv_table_set_col_cnt(s_table, TABLE_COLS);
+    lv_table_set_row_cnt(s_table, PROF_STAGE_COUNT + 1);
+    for (uint8_t c = 0; c < TABLE_COLS; c++) {
+        lv_table_set_col_width(s_table, c, COL_W[c]);
+    }
+    lv_obj_set_style_pad_top(s_table, 2, LV_PART_ITEMS);
+    lv_obj_set_style_pad_bottom(s_table, 2, LV_PART_ITEMS);
+    lv_obj_set_size(s_table, 470, 230);
+    lv_obj_align(s_table, LV_ALIGN_TOP_MID, 0, 28);
+    // La tabla no debe tragarse el toque: así cualquier pulsación cierra la pantalla
+    lv_obj_clear_flag(s_table, LV_OBJ_FLAG_CLICKABLE);
+
+    static const char *hdr[TABLE_COLS] = { "etapa", "n", "min", "media", "max", "p99" };
+    for (uint8_t c = 0; c < TABLE_COLS; c++) {
+        lv_table_set_cell_value(s_table, 0, c, hdr[c]);
+    }
+
+    // Página del modelo identificado
+    s_tblIdent = lv_table_create(s_scr);
+    lv_table_set_col_cnt(s_tblIdent, IDENT_COLS);
+    lv_table_set_row_cnt(s_tblIdent, IDENT_ROWS);
+    for (uint8_t c = 0; c < IDENT_COLS; c++) {
+        lv_table_set_col_width(s_tblIdent, c, IDENT_COL_W[c]);
+    }
+    lv_obj_set_style_pad_top(s_tblIdent, 2, LV_PART_ITEMS);
+    lv_obj_set_style_pad_bottom(s_tblIdent, 2, LV_PART_ITEMS);
+    lv_obj_set_style_pad_left(s_tblIdent, 3, LV_PART_ITEMS);
+    lv_obj_set_style_pad_right(s_tblIdent, 3, LV_PART_ITEMS);
+    lv_obj_set_size(s_tblIdent, 470, 150);
+    lv_obj_align(s_tblIdent, LV_ALIGN_TOP_MID, 0, 28);
+    lv_obj_clear_flag(s_tblIdent, LV_OBJ_FLAG_CLICKABLE);
+
+    static const char *identHdr[IDENT_COLS] = { "", "a1", "a2", "b1", "b2", "c", "d", "ajuste" };
+    static const char *identRows[IDENT_ROWS - 1] = { "V", "H", "MP", "RDC" };
+    for (uint8_t c = 0; c < IDENT_COLS; c++) {
+        lv_table_set_cell_value(s_tblIdent, 0, c, identHdr[c]);
+    }
+    for (uint8_t r = 1; r < IDENT_ROWS; r++) {
+        lv_table_set_cell_value(s_tblIdent, r, 0, identRows[r - 1]);
+    }
+
+    s_lblIdent = lv_label_create(s_scr);
+    lv_label_set_text(s_lblIdent, "");
+    lv_obj_align(s_lblIdent, LV_ALIGN_TOP_LEFT, 6, 186);
+
+    // Página de Bode (el eje X es el índice del punto: el barrido ya es logarítmico)
+    s_chart = lv_chart_create(s_scr);
+    lv_chart_set_type(s_chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(s_chart, FREQ_RESP_MAX_POINTS);
+    lv_chart_set_div_line_count(s_chart, 5, FREQ_RESP_MAX_POINTS / 2);
+    lv_chart_set_axis_tick(s_chart, LV_CHART_AXIS_PRIMARY_Y, 6, 3, 5, 2, true, 40);
+    lv_chart_set_axis_tick(s_chart, LV_CHART_AXIS_SECONDARY_Y, 6, 3, 5, 2, true, 40);
+    lv_obj_set_size(s_chart, 370, 180);
+    lv_obj_align(s_chart, LV_ALIGN_TOP_MID, 0, 30);
+    lv_obj_clear_flag(s_chart, LV_OBJ_FLAG_CLICKABLE);
+    s_serGain  = lv_chart_add_series(s_chart, COL_GAIN, LV_CHART_AXIS_PRIMARY_Y);
+    s_serPhase = lv_chart_add_series(s_chart, COL_PHASE, LV_CHART_AXIS_SECONDARY_Y);
+
+    s_lblBode = lv_label_create(s_scr);
+    lv_label_set_text(s_lblBode, "");
+    lv_obj_align(s_lblBode, LV_ALIGN_TOP_LEFT, 6, 222);
+
+    s_lblCtrl = lv_label_create(s_scr);
+    lv_label_set_text(s_lblCtrl, "");
+    lv_obj_align(s_lblCtrl, LV_ALIGN_BOTTOM_LEFT, 6, -6);
+}
+
+static void setCell(uint16_t row, uint8_t col, const char *fmt, float v)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), fmt, v);
+    lv_table_set_cell_value(s_tblIdent, row, col, buf);
+}
+
+static void refreshIdent()
+{
+    RigIdentModel m;
+    RigIdent_getModel(m);
+
+    const RigAxisModel *axes[2] = { &m.vert, &m.hor };
+    for (uint8_t i = 0; i < 2; i++) {
+        const RigAxisModel &a = *axes[i];
+        const uint16_t row = i + 1;
+        setCell(row, 1, "%.4f", a.a1);
+        setCell(row, 2, "%.4f", a.a2);
+        setCell(row, 3, "%.4f", a.b1);
+        setCell(row, 4, "%.4f", a.b2);
+        setCell(row, 5, "%.4f", a.c);
+        setCell(row, 6, "%.3f", a.d);
+        setCell(row, 7, "%.3f", a.fitRms);
+    }
+    const RigRotorModel *rotors[2] = { &m.main, &m.tail };
+    for (uint8_t i = 0; i < 2; i++) {
+        const RigRotorModel &r = *rotors[i];
+        const uint16_t row = i + 3;
+        setCell(row, 1, "%.4f", r.a);
+        lv_table_set_cell_value(s_tblIdent, row, 2, "-");
+        setCell(row, 3, "%.3f", r.b);
+        lv_table_set_cell_value(s_tblIdent, row, 4, "-");
+        lv_table_set_cell_value(s_tblIdent, row, 5, "-");
+        setCell(row, 6, "%.1f", r.c);
+        setCell(row, 7, "%.0f", r.fitRms);
+    }
+
+    char eq[24] = "-";
+    float mpEq;
+    if (RigIdent_equilibriumRegister(m, EQMAP_THRESHOLD_DEG, 0.0f, mpEq)) {
+        snprintf(eq, sizeof(eq), "%.1f", mpEq);
+    }
+
+    // En el ARX de la viga c es el rotor cruzado; en los rotores, la constante
+    char text[320];
+    snprintf(text, sizeof(text),
+             "V: reposo %.1f deg, %.2f deg/krpm2 (cruce %.2f)\n"
+             "H: reposo %.1f deg, %.2f deg/krpm2 (cruce %.2f)\n"
+             "MP: tau %.3f s, %.1f rpm/reg, zona muerta %.1f reg\n"
+             "RDC: tau %.3f s, %.1f rpm/reg, zona muerta %.1f reg\n"
+             "Reg. MP a %.0f deg: %s | %s, %lu muestras de %.0f ms",
+             m.vert.restDeg, m.vert.dcGain, m.vert.crossGain,
+             m.hor.restDeg, m.hor.dcGain, m.hor.crossGain,
+             m.main.tauS, m.main.rpmPerReg, m.main.deadbandReg,
+             m.tail.tauS, m.tail.rpmPerReg, m.tail.deadbandReg,
+             EQMAP_THRESHOLD_DEG, eq, m.enabled ? "activa" : "pausada",
+             (unsigned long)m.samples, m.Ts * 1e3f);
+    lv_label_set_text(s_lblIdent, text);
+}
+
+// Rango de un eje redondeado a múltiplos de step que contiene [lo, hi]
+static void axisRange(float lo, float hi, float step, lv_coord_t &outLo, lv_coord_t &outHi)
+{
+    outLo = (lv_coord_t)(floorf(lo / step) * step);
+    outHi = (lv_coord_t)(ceilf(hi / step) * step);
+    if (outHi <= outLo) outHi = outLo + (lv_coord_t)step;
+}
+
+static void refreshBode()
+{
+    FreqRespResult r;
+    FreqResp_getResult(r);
+
+    const uint8_t n = (r.points >= 2) ? r.points : FREQ_RESP_MAX_POINTS;
+    lv_chart_set_point_count(s_chart, n);
+    lv_chart_set_all_value(s_chart, s_serGain, LV_CHART_POINT_NONE);
+    lv_chart_set_all_value(s_chart, s_serPhase, LV_CHART_POINT_NONE);
+
+    float gLo = 0.0f, gHi = 0.0f, pLo = 0.0f, pHi = 0.0f;
+    for (uint8_t i = 0; i < r.done; i++) {
+        const FreqRespPoint &p = r.pt[i];
+        if (i == 0 || p.gainDb < gLo)   gLo = p.gainDb;
+        if (i == 0 || p.gainDb > gHi)   gHi = p.gainDb;
+        if (i == 0 || p.phaseDeg < pLo) pLo = p.phaseDeg;
+        if (i == 0 || p.phaseDeg > pHi) pHi = p.phaseDeg;
+        lv_chart_set_value_by_id(s_chart, s_serGain, i, (lv_coord_t)lroundf(p.gainDb));
+        lv_chart_set_value_by_id(s_chart, s_serPhase, i, (lv_coord_t)lroundf(p.phaseDeg));
+    }
+    lv_coord_t lo, hi;
+    axisRange(gLo, gHi, 10.0f, lo, hi);
+    lv_chart_set_range(s_chart, LV_CHART_AXIS_PRIMARY_Y, lo, hi);
+    axisRange(pLo, pHi, 45.0f, lo, hi);
+    lv_chart_set_range(s_chart, LV_CHART_AXIS_SECONDARY_Y, lo, hi);
+    lv_chart_refresh(s_chart);
+
+    const char *state = "sin barrido";
+    if (r.state == FreqRespState::RUNNING)     state = "en marcha";
+    else if (r.state == FreqRespState::DONE)   state = "terminado";
+    else if (r.state == FreqRespState::FAILED) state = FreqResp_failName(r.fail);
+
+    char text[200];
+    if (r.done > 0) {
+        snprintf(text, sizeof(text),
+                 "%s -> %s | %.2f..%.2f Hz | %u/%u puntos, %.0f s (%s)\n"
+                 "Rojo: ganancia [dB deg/reg]   Azul: fase [deg]",
+                 (r.input == FreqRespInput::MAIN_ROTOR) ? "MP" : "RDC",
+                 (r.input == FreqRespInput::MAIN_ROTOR) ? "cabeceo" : "guinada",
+                 r.pt[0].freqHz, r.pt[r.done - 1].freqHz, (unsigned)r.done, (unsigned)r.points,
+                 r.elapsedS, state);
+    } else {
+        snprintf(text, sizeof(text), "Bode: %s (%u/%u puntos, %.0f s)",
+                 state, (unsigned)r.done, (unsigned)r.points, r.elapsedS);
+    }
+    lv_label_set_text(s_lblBode, text);
+}
+
+static void refreshTimes()
+{
+    char buf[48];
+
+    for (uint8_t i = 0; i < PROF_STAGE_COUNT; i++) {
+        ProfStageStats st;
+        Profiler_getStageStats((ProfStage)i, st);
+
+        uint16_t row = i + 1;
+        lv_table_set_cell_value(s_table, row, 0, st.name);
+
+        if (st.count == 0) {
+            for (uint8_t c = 1; c < TABLE_COLS; c++) lv_table_set_cell_value(s_table, row, c, "-");
+            continue;
+        }
+
+        snprintf(buf, sizeof(buf), "%lu", (unsigned long)st.count);
+        lv_table_set_cell_value(s_table, row, 1, buf);
+        snprintf(buf, sizeof(buf), "%.1f", st.minUs);
+        lv_table_set_cell_value(s_table, row, 2, buf);
+        snprintf(buf, sizeof(buf), "%.1f", st.avgUs);
+        lv_table_set_cell_value(s_table, row, 3, buf);
+        snprintf(buf, sizeof(buf), "%.1f", st.maxUs);
+        lv_table_set_cell_value(s_table, row, 4, buf);
+        snprintf(buf, sizeof(buf), "%.1f", st.p99Us);
+        lv_table_set_cell_value(s_table, row, 5, buf);
+    }
+}
+
+static void refreshTable()
+{
+    if (s_page == DIAG_PAGE_IDENT)     refreshIdent();
+    else if (s_page == DIAG_PAGE_BODE) refreshBode();
+    else                               refreshTimes();
+
+    ControlTaskStats cs;
+    ControlTask_getStats(cs);
+
+    char line[128];
+    snprintf(line, sizeof(line),
+             "Ctrl %lu Hz | overruns %lu | perdidos %lu | jitter %ld..%ld us | err I2C %lu",
+             (unsigned long)ControlTask_getRateHz(),
+             (unsigned long)cs.overruns, (unsigned long)cs.missedTicks,
+             (long)(cs.cycles > 1 ? cs.minSampleJitterUs : 0),
+             (long)(cs.cycles > 1 ? cs.maxSampleJitterUs : 0),
+             (unsigned long)cs.readErrors);
+    lv_label_set_text(s_lblCtrl, line);
+}
+
+static void setHidden(lv_obj_t *obj, bool hidden)
+{
+    if (hidden) lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    else        lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Muestra los objetos de una página y oculta los de las otras
+static void applyPage(DiagPage page)
+{
+    s_page = page;
+    const bool ident = (page == DIAG_PAGE_IDENT);
+    const bool bode  = (page == DIAG_PAGE_BODE);
+    lv_label_set_text(s_title, ident ? "Diagnostico: modelo identificado (RLS)"
+                             : bode  ? "Diagnostico: respuesta en frecuencia (Goertzel)"
+                                     : "Diagnostico: tiempos por etapa (us)");
+    setHidden(s_table, ident || bode);
+    setHidden(s_tblIdent, !ident);
+    setHidden(s_lblIdent, !ident);
+    setHidden(s_chart, !bode);
+    setHidden(s_lblBode, !bode);
+}
+
+void DiagScreen_Show(DiagPage page)
+{
+    if (!s_scr) buildScreen();
+    applyPage(page);
+    refreshTable();
+    s_lastRefreshMs = millis();
+    if (lv_scr_act() == s_scr) return;
+
+    s_prevScr = lv_scr_act();
+    lv_scr_load(s_scr);
+}
+
+void DiagScreen_Hide()
+{
+    if (!s_scr || lv_scr_act() != s_scr) return;
+    if (s_prevScr) lv_scr_load(s_prevScr);
+}
+
+bool DiagScreen_IsActive()
+{
+    return s_scr && lv_scr_act() == s_scr;
+}
+
+void DiagScreen_Update()
+{
+    if (!DiagScreen_IsActive()) return;
+
+    uint32_t now = millis();
+    if (now - s_lastRefreshMs < REFRESH_MS) return;
+    s_lastRefreshMs = now;
+
+    refreshTable();
+}
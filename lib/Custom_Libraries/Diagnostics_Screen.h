@@ -0,0 +1,26 @@
+/* Este archivo, y su correspondiente ".cpp", crean por código (sin SquareLine) una pantalla de
+diagnóstico con los tiempos por etapa del Profiler y las estadísticas de la tarea de control, o
+con el modelo identificado en marcha (RigIdent), o con el diagrama de Bode medido (FreqResp). Se abre
+con los comandos serie "diag", "ident" y "bode" y se cierra tocando la pantalla (vuelve a la anterior) */
+
+#pragma once
+
+#include <lvgl.h>
+
+// Páginas de la pantalla
+enum DiagPage : uint8_t {
+    DIAG_PAGE_TIMES = 0,   // tiempos por etapa (Profiler)
+    DIAG_PAGE_IDENT,       // modelo identificado (RigIdent)
+    DIAG_PAGE_BODE         // respuesta en frecuencia (FreqResp)
+};
+
+// Crea la pantalla (la primera vez) y la carga con la página dada, recordando la pantalla actual
+void DiagScreen_Show(DiagPage page = DIAG_PAGE_TIMES);
+
+// Vuelve a la pantalla que estaba activa antes de DiagScreen_Show()
+void DiagScreen_Hide();
+
+bool DiagScreen_IsActive();
+
+// Refresca la tabla si la pantalla está activa (llamar periódicamente desde la tarea de interfaz)
+void DiagScreen_Update();
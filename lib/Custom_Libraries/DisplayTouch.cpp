@@ -5,6 +5,7 @@ de esta */
 
 // DisplayTouch.cpp
 #include "DisplayTouch.h"
+#include "Profiler.h"
 
 // -----------------------------------------------------------------------------
 // Variables y buffers internos
@@ -126,7 +127,11 @@ static void my_touchpad_read(lv_indev_drv_t *indev_drv,
 
     if (level == LOW) {
         // Solo intentamos leer el táctil cuando T_IRQ está en LOW
-        bool touched = s_tft->getTouch(&x, &y);
+        bool touched;
+        {
+            PROF_SCOPE(PROF_TOUCH);
+            touched = s_tft->getTouch(&x, &y);
+        }
 
         if (touched) {
             data->state   = LV_INDEV_STATE_PR;
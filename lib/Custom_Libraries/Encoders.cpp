@@ -14,8 +14,7 @@ de los ángulos obtenidos por los encoders */
 */
 
 #include "Encoders.h"
-#include <Wire.h>
-#include <lvgl.h>
+#include "HAL.h"
 
 // Dirección I2C del TCA9539
 #define TCA_ADDR 0x74
@@ -26,12 +25,12 @@ de los ángulos obtenidos por los encoders */
 // Debug
 #define TCA_DEBUG 1
 #if TCA_DEBUG
-  #define TCA_LOGF(...) Serial.printf(__VA_ARGS__)
+  #define TCA_LOGF(...) HAL_logf(__VA_ARGS__)
 #else
   #define TCA_LOGF(...) do{}while(0)
 #endif
 
-// Convierte códigos de Wire.endTransmission() a texto (Arduino Wire)
+// Convierte códigos de Wire.endTransmission() / HAL_i2cWriteReg() a texto
 static const char* i2cErrToStr(uint8_t err) {
   switch (err) {
     case 0: return "OK";
@@ -51,9 +50,11 @@ static uint8_t s_pinOE  = 0;
 // Configuración cuentas por vuelta
 static EncoderConfig s_config;
 
+#ifndef TRMS_NATIVE
 // Series del chart
 static lv_chart_series_t * s_serHorizontal = nullptr;
 static lv_chart_series_t * s_serVertical   = nullptr;
+#endif
 
 // -------------------------
 // Ajustes de lectura (us)
@@ -79,17 +80,17 @@ static int16_t s_offV = 0;
 
 static void hctl_setSEL(bool level) {
   // En tu estado actual: sin inversión aquí
-  digitalWrite(s_pinSEL, level);
+  HAL_gpioWrite(s_pinSEL, level);
 }
 
 static void hctl_setRST(bool level) {
   // En tu lógica actual: RST activo HIGH
-  digitalWrite(s_pinRST, level);
+  HAL_gpioWrite(s_pinRST, level);
 }
 
 static void hctl_setOE(bool level) {
   // En tu lógica actual: OE_ENABLE = HIGH, OE_DISABLE = LOW
-  digitalWrite(s_pinOE, level);
+  HAL_gpioWrite(s_pinOE, level);
 }
 
 // ============================================================
@@ -97,10 +98,7 @@ static void hctl_setOE(bool level) {
 // ============================================================
 
 static bool tca_writeReg(uint8_t reg, uint8_t value) {
-  Wire.beginTransmission(TCA_ADDR);
-  Wire.write(reg);
-  Wire.write(value);
-  uint8_t err = Wire.endTransmission(true); // STOP
+  uint8_t err = HAL_i2cWriteReg(TCA_ADDR, reg, value); // STOP
 
 #if TCA_DEBUG
   TCA_LOGF("[TCA9539][W] reg 0x%02X <= 0x%02X -> endTx=%u (%s)\n",
@@ -112,16 +110,7 @@ static bool tca_writeReg(uint8_t reg, uint8_t value) {
 
 // Lectura robusta (STOP tras setear registro + requestFrom con stop)
 static bool tca_readReg(uint8_t reg, uint8_t &out) {
-  Wire.beginTransmission(TCA_ADDR);
-  Wire.write(reg);
-  uint8_t err = Wire.endTransmission(true); // STOP
-  if (err != 0) return false;
-
-  uint8_t n = Wire.requestFrom((uint16_t)TCA_ADDR, (uint8_t)1, (uint8_t)true);
-  if (n != 1) return false;
-
-  out = Wire.read();
-  return true;
+  return HAL_i2cReadReg(TCA_ADDR, reg, out);
 }
 
 static bool tca_readPort(uint8_t port, uint8_t &out) {
@@ -197,7 +186,7 @@ static bool tca_init() {
 static void hctl_resetCounters_internal() {
   // En tu lógica: reset activo HIGH
   hctl_setRST(1);
-  delayMicroseconds(5);
+  HAL_delayUs(5);
   hctl_setRST(0);
 }
 
@@ -211,14 +200,14 @@ static bool hctl_read16_ports(uint8_t &lo0, uint8_t &lo1,
 {
   // (A) Tri-state breve para “abrir ventana”
   hctl_setOE(0);
-  delayMicroseconds(s_triUs);
+  HAL_delayUs(s_triUs);
 
   // (B) LOW byte
   hctl_setSEL(0); // LOW byte
-  delayMicroseconds(s_afterSelUs);
+  HAL_delayUs(s_afterSelUs);
 
   hctl_setOE(1);
-  delayMicroseconds(s_afterOeUs);
+  HAL_delayUs(s_afterOeUs);
 
   if (!tca_readPort(0, lo0)) return false;
   if (!tca_readPort(1, lo1)) return false;
@@ -226,21 +215,21 @@ static bool hctl_read16_ports(uint8_t &lo0, uint8_t &lo1,
   // (B2) Opcional: “pulsar” OE entre bytes si tu hardware lo necesita
   if (s_toggleOE) {
     hctl_setOE(0);
-    delayMicroseconds(s_triUs);
+    HAL_delayUs(s_triUs);
     hctl_setOE(1);
-    delayMicroseconds(s_afterOeUs);
+    HAL_delayUs(s_afterOeUs);
   }
 
   // (C) HIGH byte
   hctl_setSEL(1); // HIGH byte
-  delayMicroseconds(s_afterSelUs);
+  HAL_delayUs(s_afterSelUs);
 
   if (!tca_readPort(0, hi0)) return false;
   if (!tca_readPort(1, hi1)) return false;
 
   // (D) Tri-state final (opcional)
   hctl_setOE(0);
-  delayMicroseconds(s_triUs);
+  HAL_delayUs(s_triUs);
 
   return true;
 }
@@ -268,18 +257,18 @@ bool Encoders_begin(uint8_t pinSEL,
   s_pinOE  = pinOE;
   s_config = config;
 
-  pinMode(s_pinSEL, OUTPUT);
-  pinMode(s_pinRST, OUTPUT);
-  pinMode(s_pinOE,  OUTPUT);
+  HAL_pinMode(s_pinSEL, HAL_PIN_OUTPUT);
+  HAL_pinMode(s_pinRST, HAL_PIN_OUTPUT);
+  HAL_pinMode(s_pinOE,  HAL_PIN_OUTPUT);
 
   // Reset pin del TCA
-  pinMode(TCA_RESET, OUTPUT);
+  HAL_pinMode(TCA_RESET, HAL_PIN_OUTPUT);
 
   // Reset del TCA9539 (activo LOW)
-  digitalWrite(TCA_RESET, LOW);
-  delay(5);
-  digitalWrite(TCA_RESET, HIGH);
-  delay(5);
+  HAL_gpioWrite(TCA_RESET, false);
+  HAL_delayMs(5);
+  HAL_gpioWrite(TCA_RESET, true);
+  HAL_delayMs(5);
 
   // Estado inicial recomendado
   hctl_setOE(0);   // tri-state
@@ -289,10 +278,10 @@ bool Encoders_begin(uint8_t pinSEL,
   // Init TCA
   bool ok = tca_init();
   if (!ok) {
-    Serial.println("Encoders: ERROR inicializando TCA9539 (I2C).");
+    HAL_logf("Encoders: ERROR inicializando TCA9539 (I2C).\n");
     return false;
   } else {
-    Serial.println("Encoders: TCA9539 inicializado correctamente.");
+    HAL_logf("Encoders: TCA9539 inicializado correctamente.\n");
   }
 
   // Defaults coherentes con tu caso
@@ -345,6 +334,26 @@ bool Encoders_readCounts(int16_t &countV, int16_t &countH)
   return true;
 }
 
+/**
+ * @brief
+ * Lee las cuentas y sella la muestra con el instante de lectura.
+ * @note
+ * Los dos HCTL-2016 se leen a través del TCA9539 en varias transacciones I2C
+ * (~cientos de us). Se toma el reloj justo antes y justo después de la
+ * secuencia y se usa el punto medio como instante de la muestra; readUs
+ * queda como medida de la incertidumbre de ese instante.
+ */
+bool Encoders_readSample(EncoderSample &sample)
+{
+  int64_t t0 = Clock_nowUs();
+  bool ok = Encoders_readCounts(sample.countV, sample.countH);
+  int64_t t1 = Clock_nowUs();
+
+  sample.tUs    = t0 + (t1 - t0) / 2;
+  sample.readUs = (uint32_t)(t1 - t0);
+  return ok;
+}
+
 EncoderAngles Encoders_readAngles() {
   EncoderAngles ang{0.0f, 0.0f};
 
@@ -386,13 +395,14 @@ void Encoders_setSEL(bool level) { hctl_setSEL(level); }
 void Encoders_pulseReset(uint16_t high_us) {
   // reset activo HIGH (según tu lógica)
   Encoders_setRST(1);
-  delayMicroseconds(high_us);
+  HAL_delayUs(high_us);
   Encoders_setRST(0);
 }
 
 // ============================================================
 // LVGL chart (sin cambios funcionales)
 // ============================================================
+#ifndef TRMS_NATIVE
 
 void Encoders_chartBindSeries(lv_chart_series_t *serH, lv_chart_series_t *serV) {
     s_serHorizontal = serH;
@@ -417,29 +427,27 @@ void Encoders_chartAddSample(lv_obj_t *chart, const EncoderAngles &angles) {
     lv_chart_set_next_value(chart, s_serHorizontal, (lv_coord_t)angles.horizontalDeg);
     lv_chart_set_next_value(chart, s_serVertical,   (lv_coord_t)angles.verticalDeg);
 }
+#endif // TRMS_NATIVE
 
 // ============================================================
 // Utilidad opcional: scan I2C (igual que lo tenías)
 // ============================================================
 
 void i2cScan() {
-  Serial.println("Escaneando I2C...");
+  HAL_logf("Escaneando I2C...\n");
   int found = 0;
 
   for (uint8_t addr = 1; addr < 127; addr++) {
-    Wire.beginTransmission(addr);
-    uint8_t err = Wire.endTransmission();
+    uint8_t err = HAL_i2cProbe(addr);
 
     if (err == 0) {
-      Serial.print("  Dispositivo en 0x");
-      if (addr < 16) Serial.print("0");
-      Serial.println(addr, HEX);
+      HAL_logf("  Dispositivo en 0x%02X\n", addr);
       found++;
     }
   }
 
   if (found == 0) {
-    Serial.println("  (No se ha encontrado ningun dispositivo I2C)");
+    HAL_logf("  (No se ha encontrado ningun dispositivo I2C)\n");
   }
-  Serial.println("Fin escaneo I2C.");
+  HAL_logf("Fin escaneo I2C.\n");
 }
@@ -1,6 +1,8 @@
 #pragma once
-#include <Arduino.h>
+#include <stdint.h>
+#ifndef TRMS_NATIVE
 #include <lvgl.h>
+#endif
 
 // Cuentas por vuelta de cada eje
 struct EncoderConfig {
@@ -14,6 +16,16 @@ struct EncoderAngles {
     float horizontalDeg;
 };
 
+// Muestra de encoders con marca de tiempo
+//  - tUs:    instante de la muestra [us, Clock_nowUs], punto medio de la ventana de lectura I2C
+//  - readUs: duración de la ventana de lectura (incertidumbre del instante: ±readUs/2)
+struct EncoderSample {
+    int16_t  countV;
+    int16_t  countH;
+    int64_t  tUs;
+    uint32_t readUs;
+};
+
 // Inicialización general (TCA, HCTL, pines)
 bool Encoders_begin(uint8_t pinSEL,
                     uint8_t pinRST,
@@ -30,6 +42,10 @@ EncoderAngles Encoders_readAngles();
 // Aquí devuelve el contador “tal cual” (firmado), sin convertir a grados.
 bool Encoders_readCounts(int16_t &countV, int16_t &countH);
 
+// Igual que Encoders_readCounts, pero sellando la muestra con el punto medio
+// de la ventana de lectura (para que el PID derive/integre con el dt real)
+bool Encoders_readSample(EncoderSample &sample);
+
 // Ajustes runtime de lectura (por tu caso hardware)
 void Encoders_setSwapPorts(bool swap);              // true: IN0=H, IN1=V
 void Encoders_setToggleOE(bool enable);             // true: toggle OE entre bytes
@@ -37,11 +53,14 @@ void Encoders_setTimingsUs(uint16_t afterSelUs,
                            uint16_t afterOeUs,
                            uint16_t triUs);
 
+#ifndef TRMS_NATIVE
 // LVGL
 void Encoders_chartInit(lv_obj_t * chart);
 void Encoders_chartAddSample(lv_obj_t * chart,
                              const EncoderAngles &angles);
 
+#endif
+
 // Debug I2C / TCA
 bool Encoders_readTcaPorts(uint8_t &port0, uint8_t &port1);
 void i2cScan();
@@ -52,4 +71,6 @@ void Encoders_setRST(bool level);
 void Encoders_setSEL(bool level);
 void Encoders_pulseReset(uint16_t high_us = 5);
 
+#ifndef TRMS_NATIVE
 void Encoders_chartBindSeries(lv_chart_series_t *serH, lv_chart_series_t *serV);
+#endif
@@ -0,0 +1,85 @@
+/* Esta librería, junto con su correspondiente "EquilibriumMap.h", interpola y aprende el mapa de
+equilibrio vertical */
+
+// EquilibriumMap.cpp
+#include "EquilibriumMap.h"
+
+#include <math.h>
+
+static float priorAt(const EqMapPrior &p, float deg)
+{
+    const float d = deg - EQMAP_THRESHOLD_DEG;
+    return p.mpAtThreshold + ((d >= 0.0f) ? p.slopeUp : p.slopeDown) * d;
+}
+
+static float clampReg(float r)
+{
+    if (r > 100.0f)  return 100.0f;
+    if (r < -100.0f) return -100.0f;
+    return r;
+}
+
+void EqMap_reset(EqMap &m, const EqMapPrior &prior, bool keepLearned)
+{
+    m.version = EQMAP_VERSION;
+    if (!keepLearned) m.updates = 0;
+
+    for (int i = 0; i < EQMAP_POINTS; i++) {
+        if (keepLearned && m.hits[i]) continue;
+        m.hits[i] = 0;
+        m.reg[i]  = clampReg(priorAt(prior, EQMAP_DEG_MIN + (float)i * EQMAP_DEG_STEP));
+    }
+}
+
+// Punto inferior y fracción hacia el siguiente (i en [0, EQMAP_POINTS - 2])
+static void locate(float deg, int &i, float &u)
+{
+    float f = (deg - EQMAP_DEG_MIN) / EQMAP_DEG_STEP;
+    if (!(f > 0.0f)) f = 0.0f;                                // por debajo (o NaN)
+    if (f > (float)(EQMAP_POINTS - 1)) f = (float)(EQMAP_POINTS - 1);
+
+    i = (int)f;
+    if (i > EQMAP_POINTS - 2) i = EQMAP_POINTS - 2;
+    u = f - (float)i;
+}
+
+float EqMap_lookup(const EqMap &m, float deg)
+{
+    int   i;
+    float u;
+    locate(deg, i, u);
+    return m.reg[i] + u * (m.reg[i + 1] - m.reg[i]);
+}
+
+/**
+ * @brief
+ * Acerca los dos puntos que rodean a deg hacia reg.
+ * @note
+ * Cada punto se mueve con su peso de interpolación, así que una muestra justo
+ * en un punto solo mueve ese punto. Se llama en el paso de control: sin bucles
+ * sobre todo el mapa.
+ */
+void EqMap_learn(EqMap &m, float deg, float reg, float alpha)
+{
+    int   i;
+    float u;
+    locate(deg, i, u);
+    reg = clampReg(reg);
+
+    const float w[2] = { 1.0f - u, u };
+    for (int k = 0; k < 2; k++) {
+        if (w[k] <= 0.0f) continue;
+        m.reg[i + k] += alpha * w[k] * (reg - m.reg[i + k]);
+        if (m.hits[i + k] < 0xFFFF) m.hits[i + k]++;
+    }
+    m.updates++;
+}
+
+bool EqMap_isValid(const EqMap &m)
+{
+    if (m.version != EQMAP_VERSION) return false;
+    for (int i = 0; i < EQMAP_POINTS; i++) {
+        if (!(m.reg[i] >= -100.0f && m.reg[i] <= 100.0f)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/* Esta librería, junto con su correspondiente "EquilibriumMap.cpp", define el mapa de equilibrio
+vertical: el registro del motor principal que sostiene la viga en cada ángulo. Se usa como
+feedforward en la lógica de subida (PID_Control.cpp) para que el PID solo corrija el residuo.
+
+El mapa arranca de una recta a tramos (umbral en -30° y pendientes, ver
+PID4_SetVerticalFeedforwardAtThreshold) y se va corrigiendo en marcha con el registro que
+sostiene la viga cuando está asentada. PID_Parameters.cpp lo guarda en NVS */
+
+// EquilibriumMap.h
+#pragma once
+
+#include <stdint.h>
+
+static const float EQMAP_DEG_MIN       = -40.0f;  // primer punto [grados]
+static const float EQMAP_DEG_STEP      = 5.0f;    // separación entre puntos [grados]
+static const int   EQMAP_POINTS        = 21;      // de -40° a 60°
+static const float EQMAP_THRESHOLD_DEG = -30.0f;  // ángulo de mpAtThreshold
+
+// Versión del formato guardado en NVS (cambiarla si cambia EqMap)
+static const uint16_t EQMAP_VERSION = 1;
+
+/**
+ * @brief Recta a tramos de partida (antes de aprender nada).
+ *
+ * reg(x) = mpAtThreshold + slopeUp   * (x - EQMAP_THRESHOLD_DEG)   si x >= umbral
+ *        = mpAtThreshold + slopeDown * (x - EQMAP_THRESHOLD_DEG)   si x <  umbral
+ */
+struct EqMapPrior {
+    float mpAtThreshold;   // [reg]
+    float slopeUp;         // [reg/deg]
+    float slopeDown;       // [reg/deg]
+};
+
+/**
+ * @brief Mapa de equilibrio (se guarda tal cual en NVS).
+ */
+struct EqMap {
+    uint16_t version;
+    uint16_t hits[EQMAP_POINTS];   // muestras aprendidas por punto (satura en 65535)
+    float    reg[EQMAP_POINTS];    // registro de equilibrio por punto
+    uint32_t updates;              // muestras aprendidas en total (para saber si hay que guardar)
+};
+
+/**
+ * @brief Vuelve a la recta de partida.
+ *
+ * @param keepLearned true: solo se rehacen los puntos sin muestras aprendidas
+ */
+void EqMap_reset(EqMap &m, const EqMapPrior &prior, bool keepLearned = false);
+
+// Registro de equilibrio en un ángulo (interpolación lineal, extremos fuera del rango)
+float EqMap_lookup(const EqMap &m, float deg);
+
+/**
+ * @brief Acerca el mapa al registro medido en un ángulo.
+ *
+ * Los dos puntos que rodean a deg se mueven alpha * peso hacia reg, con el peso
+ * de la interpolación (el más cercano aprende más).
+ */
+void EqMap_learn(EqMap &m, float deg, float reg, float alpha);
+
+// true si el mapa es de esta versión y sus valores son razonables (tras leerlo de NVS)
+bool EqMap_isValid(const EqMap &m);
@@ -0,0 +1,84 @@
+/* Aritmética en coma fija Q16.16 con saturación. El tipo Q16 se puede usar como Scalar en las
+plantillas de "PID_Template.h": solo enteros de 32/64 bits (sin FPU), resultado determinista y
+apto para una ISR o una tarea de alta prioridad */
+
+// FixedPoint.h
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Número Q16.16 (int32: 16 bits enteros con signo + 16 fraccionarios).
+ *
+ * - Rango: [-32768, 32767.99998], resolución 1/65536 (1.5e-5).
+ * - +, -, * y / saturan al rango en lugar de desbordar.
+ * - El producto redondea al más cercano; la división trunca hacia cero.
+ * - Dividir por cero da el extremo del signo del dividendo.
+ * - El constructor desde double es constexpr: con constantes se resuelve al
+ *   compilar (no hay conversión de coma flotante en el código generado).
+ */
+class Q16 {
+public:
+    static const int     FRAC_BITS = 16;
+    static const int32_t RAW_ONE   = (int32_t)1 << FRAC_BITS;
+    static const int32_t RAW_MAX   = INT32_MAX;
+    static const int32_t RAW_MIN   = INT32_MIN;
+
+    constexpr Q16() : _raw(0) {}
+    explicit constexpr Q16(double v) : _raw(fromDouble(v)) {}
+
+    static constexpr Q16 fromRaw(int32_t raw) { return Q16(raw, RawTag()); }
+    static constexpr Q16 fromInt(int32_t v)   { return fromRaw(saturate((int64_t)v * RAW_ONE)); }
+    static Q16 fromFloat(float v)             { return Q16((double)v); }
+
+    constexpr int32_t raw() const { return _raw; }
+    float   toFloat() const { return (float)_raw * (1.0f / (float)RAW_ONE); }
+
+    // Parte entera truncando hacia cero (como un cast de float a int)
+    int32_t toIntTrunc() const { return (_raw >= 0) ? (_raw >> FRAC_BITS) : -((-(int64_t)_raw) >> FRAC_BITS); }
+
+    friend Q16 operator+(Q16 a, Q16 b) { return fromRaw(saturate((int64_t)a._raw + b._raw)); }
+    friend Q16 operator-(Q16 a, Q16 b) { return fromRaw(saturate((int64_t)a._raw - b._raw)); }
+    friend Q16 operator-(Q16 a)        { return fromRaw(saturate(-(int64_t)a._raw)); }
+
+    friend Q16 operator*(Q16 a, Q16 b)
+    {
+        int64_t p = (int64_t)a._raw * b._raw;
+        return fromRaw(saturate((p + ((int64_t)1 << (FRAC_BITS - 1))) >> FRAC_BITS));
+    }
+
+    friend Q16 operator/(Q16 a, Q16 b)
+    {
+        if (b._raw == 0) return fromRaw((a._raw >= 0) ? RAW_MAX : RAW_MIN);
+        return fromRaw(saturate(((int64_t)a._raw * RAW_ONE) / b._raw));
+    }
+
+    Q16 &operator+=(Q16 b) { return *this = *this + b; }
+    Q16 &operator-=(Q16 b) { return *this = *this - b; }
+    Q16 &operator*=(Q16 b) { return *this = *this * b; }
+
+    friend bool operator==(Q16 a, Q16 b) { return a._raw == b._raw; }
+    friend bool operator!=(Q16 a, Q16 b) { return a._raw != b._raw; }
+    friend bool operator< (Q16 a, Q16 b) { return a._raw <  b._raw; }
+    friend bool operator> (Q16 a, Q16 b) { return a._raw >  b._raw; }
+    friend bool operator<=(Q16 a, Q16 b) { return a._raw <= b._raw; }
+    friend bool operator>=(Q16 a, Q16 b) { return a._raw >= b._raw; }
+
+private:
+    struct RawTag {};
+    constexpr Q16(int32_t raw, RawTag) : _raw(raw) {}
+
+    static constexpr int32_t saturate(int64_t v)
+    {
+        return (v > RAW_MAX) ? RAW_MAX : (v < RAW_MIN) ? RAW_MIN : (int32_t)v;
+    }
+
+    static constexpr int32_t fromDouble(double v)
+    {
+        return (v * RAW_ONE >= (double)RAW_MAX) ? RAW_MAX
+             : (v * RAW_ONE <= (double)RAW_MIN) ? RAW_MIN
+             : (int32_t)(v * RAW_ONE + ((v >= 0.0) ? 0.5 : -0.5));
+    }
+
+    int32_t _raw;
+};
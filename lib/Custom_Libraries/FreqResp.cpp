@@ -0,0 +1,337 @@
+/* Esta librería, junto con su correspondiente "FreqResp.h", mide la respuesta en frecuencia de un
+rotor a los ángulos de la viga con filtros de Goertzel (ver FreqResp.h) */
+
+// FreqResp.cpp
+#include "FreqResp.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// La tarea de control escribe el resultado; la interfaz lo lee.
+// En la compilación nativa todo corre en un solo hilo y el lock no hace nada.
+#ifdef ARDUINO
+static portMUX_TYPE s_frMux = portMUX_INITIALIZER_UNLOCKED;
+#define FR_LOCK()   portENTER_CRITICAL(&s_frMux)
+#define FR_UNLOCK() portEXIT_CRITICAL(&s_frMux)
+#else
+#define FR_LOCK()   do {} while (0)
+#define FR_UNLOCK() do {} while (0)
+#endif
+
+static const double TWO_PI_D = 6.283185307179586;
+static const float  RAD_TO_DEG_F = 57.29577951f;
+
+// Muestras mínimas por periodo (fMax se limita a fs / 4)
+static const float MIN_SAMPLES_PER_PERIOD = 4.0f;
+
+/**
+ * @brief Filtro de Goertzel en un bin.
+ * @note
+ * En double: a baja frecuencia el coeficiente 2 cos(w) está muy cerca de 2 y
+ * en float el error del polo se acumula a lo largo de miles de muestras.
+ */
+struct Goertzel {
+    double coeff, cosw, sinw;
+    double s1, s2;
+};
+
+static void goertzelInit(Goertzel &g, double w)
+{
+    g.cosw  = cos(w);
+    g.sinw  = sin(w);
+    g.coeff = 2.0 * g.cosw;
+    g.s1 = g.s2 = 0.0;
+}
+
+static inline void goertzelUpdate(Goertzel &g, double x)
+{
+    const double s0 = x + g.coeff * g.s1 - g.s2;
+    g.s2 = g.s1;
+    g.s1 = s0;
+}
+
+// Valor del bin (salvo un factor de fase común a todos los filtros con el mismo w)
+static void goertzelResult(const Goertzel &g, double &re, double &im)
+{
+    re = g.s1 - g.s2 * g.cosw;
+    im = g.s2 * g.sinw;
+}
+
+// ------------------------------------------------------------
+// ESTADO
+// ------------------------------------------------------------
+static FreqRespResult s_res;          // protegido por el lock
+static volatile bool  s_active = false;
+static volatile bool  s_abortReq = false;
+
+// Solo la tarea de control (se inicializan en FreqResp_start, antes de s_active)
+static FreqRespConfig s_cfg;
+static float    s_rateHz;
+static float    s_fMax;
+static uint8_t  s_index;           // frecuencia en curso
+static uint32_t s_n;               // muestra dentro de la frecuencia
+static uint32_t s_settleN, s_measN;
+static double   s_w;
+static Goertzel s_gIn, s_gOut, s_gCross;
+static double   s_dtSum;
+static double   s_sumY, s_sumY2;   // salida directa respecto a s_y0 (potencia alterna)
+static bool     s_haveY0;
+static float    s_y0;
+static float    s_time;
+
+static const char *inputName(FreqRespInput input)
+{
+    return (input == FreqRespInput::MAIN_ROTOR) ? "MP" : "RDC";
+}
+
+// Prepara la frecuencia s_index: muestras de asentamiento y de medida y filtros
+static void beginPoint()
+{
+    const float span = (s_cfg.points > 1) ? (float)s_index / (float)(s_cfg.points - 1) : 0.0f;
+    const float f = s_cfg.fMinHz * powf(s_fMax / s_cfg.fMinHz, span);
+
+    s_measN = (uint32_t)lroundf((float)s_cfg.measureCycles * s_rateHz / f);
+    if (s_measN < s_cfg.measureCycles * 4u) s_measN = s_cfg.measureCycles * 4u;
+    s_settleN = (uint32_t)lroundf((float)s_cfg.settleCycles * (float)s_measN / (float)s_cfg.measureCycles);
+    s_w = TWO_PI_D * (double)s_cfg.measureCycles / (double)s_measN;
+
+    goertzelInit(s_gIn, s_w);
+    goertzelInit(s_gOut, s_w);
+    goertzelInit(s_gCross, s_w);
+    s_n = 0;
+    s_dtSum = 0.0;
+    s_sumY = s_sumY2 = 0.0;
+}
+
+bool FreqResp_start(FreqRespInput input, int regMP, int regRDC, float rateHz,
+                    const FreqRespConfig &cfg)
+{
+    if (s_active) return false;
+    if (!(rateHz > 0.0f) || !(cfg.amplitudeReg > 0.0f)) return false;
+    if (!(cfg.fMinHz > 0.0f) || !(cfg.fMaxHz >= cfg.fMinHz)) return false;
+    if (cfg.points < 2 || cfg.points > FREQ_RESP_MAX_POINTS || cfg.measureCycles == 0) return false;
+
+    s_cfg    = cfg;
+    s_rateHz = rateHz;
+    s_fMax   = cfg.fMaxHz;
+    if (s_fMax > rateHz / MIN_SAMPLES_PER_PERIOD) s_fMax = rateHz / MIN_SAMPLES_PER_PERIOD;
+    if (s_fMax < cfg.fMinHz) return false;
+
+    s_index    = 0;
+    s_haveY0   = false;
+    s_time     = 0.0f;
+    s_abortReq = false;
+    beginPoint();
+
+    FR_LOCK();
+    s_res = {};
+    s_res.state        = FreqRespState::RUNNING;
+    s_res.fail         = FreqRespFail::NONE;
+    s_res.input        = input;
+    s_res.biasMP       = regMP;
+    s_res.biasRDC      = regRDC;
+    s_res.amplitudeReg = cfg.amplitudeReg;
+    s_res.points       = cfg.points;
+    FR_UNLOCK();
+    s_active = true;
+    return true;
+}
+
+void FreqResp_abort()
+{
+    if (s_active) s_abortReq = true;
+}
+
+bool FreqResp_isActive()
+{
+    return s_active;
+}
+
+// Lleva la fase a (-180, 180] alrededor de la del punto anterior
+static float unwrapDeg(float deg, float prev)
+{
+    while (deg - prev > 180.0f)   deg -= 360.0f;
+    while (deg - prev <= -180.0f) deg += 360.0f;
+    return deg;
+}
+
+// 10 log10 de un cociente de potencias (= 20 log10 de amplitudes), con suelo en FREQ_RESP_FLOOR_DB
+static float ratioDb(double num, double den)
+{
+    if (!(den > 0.0) || !(num > 0.0)) return FREQ_RESP_FLOOR_DB;
+    const float db = (float)(10.0 * log10(num / den));
+    return (db < FREQ_RESP_FLOOR_DB) ? FREQ_RESP_FLOOR_DB : db;
+}
+
+/**
+ * @brief
+ * Cierra la frecuencia en curso: ganancias y fases respecto a la entrada.
+ */
+static void finishPoint(FreqRespPoint &p, const FreqRespPoint *prev)
+{
+    double inRe, inIm, outRe, outIm, crRe, crIm;
+    goertzelResult(s_gIn, inRe, inIm);
+    goertzelResult(s_gOut, outRe, outIm);
+    goertzelResult(s_gCross, crRe, crIm);
+
+    const double in2  = inRe * inRe + inIm * inIm;
+    const double out2 = outRe * outRe + outIm * outIm;
+    const double cr2  = crRe * crRe + crIm * crIm;
+    const double inPh = atan2(inIm, inRe);
+
+    p.freqHz = (s_dtSum > 0.0) ? (float)((double)s_cfg.measureCycles / s_dtSum) : 0.0f;
+    p.gainDb      = ratioDb(out2, in2);
+    p.crossGainDb = ratioDb(cr2, in2);
+
+    float ph  = (float)(atan2(outIm, outRe) - inPh) * RAD_TO_DEG_F;
+    float cph = (float)(atan2(crIm, crRe) - inPh) * RAD_TO_DEG_F;
+    p.phaseDeg      = unwrapDeg(ph,  prev ? prev->phaseDeg : 0.0f);
+    p.crossPhaseDeg = unwrapDeg(cph, prev ? prev->crossPhaseDeg : 0.0f);
+
+    // Potencia del bin (A N / 2)^2 frente a la alterna total N A^2 / 2
+    const double n  = (double)s_measN;
+    const double ac = s_sumY2 - s_sumY * s_sumY / n;
+    p.quality = (ac > 0.0) ? (float)(2.0 * out2 / (n * ac)) : 0.0f;
+    if (p.quality > 1.0f) p.quality = 1.0f;
+}
+
+bool FreqResp_step(float dt, float measVDeg, float measHDeg, int &regMP, int &regRDC)
+{
+    if (!s_active) return false;
+
+    FR_LOCK();
+    const FreqRespInput input = s_res.input;
+    const int biasMP  = s_res.biasMP;
+    const int biasRDC = s_res.biasRDC;
+    FR_UNLOCK();
+
+    const bool mp = (input == FreqRespInput::MAIN_ROTOR);
+    const float y  = mp ? measVDeg : measHDeg;
+    const float yc = mp ? measHDeg : measVDeg;
+    if (!s_haveY0) {
+        s_y0 = y;
+        s_haveY0 = true;
+    }
+    s_time += dt;
+
+    FreqRespState state = FreqRespState::RUNNING;
+    FreqRespFail  fail  = FreqRespFail::NONE;
+    if (s_abortReq) {
+        state = FreqRespState::FAILED;
+        fail  = FreqRespFail::ABORTED;
+    } else if (fabsf(y - s_y0) > s_cfg.maxDevDeg) {
+        state = FreqRespState::FAILED;
+        fail  = FreqRespFail::RUNAWAY;
+    }
+
+    // Seno por índice de muestra: el filtro ve exactamente measureCycles periodos
+    int u = 0;
+    if (state == FreqRespState::RUNNING) {
+        u = (int)lroundf(s_cfg.amplitudeReg * (float)sin(s_w * (double)s_n));
+        if (s_n >= s_settleN) {
+            const double dy = (double)(y - s_y0);
+            goertzelUpdate(s_gIn, (double)u);
+            goertzelUpdate(s_gOut, (double)y);
+            goertzelUpdate(s_gCross, (double)yc);
+            s_sumY  += dy;
+            s_sumY2 += dy * dy;
+            s_dtSum += dt;
+        }
+        s_n++;
+    }
+
+    bool pointDone = false;
+    FreqRespPoint p;
+    if (state == FreqRespState::RUNNING && s_n >= s_settleN + s_measN) {
+        FreqRespPoint prev;
+        if (s_index > 0) {
+            FR_LOCK();
+            prev = s_res.pt[s_index - 1];
+            FR_UNLOCK();
+        }
+        finishPoint(p, (s_index > 0) ? &prev : nullptr);
+        pointDone = true;
+    }
+
+    FR_LOCK();
+    s_res.elapsedS = s_time;
+    if (pointDone) {
+        s_res.pt[s_index] = p;
+        s_res.done = s_index + 1;
+    }
+    FR_UNLOCK();
+
+    if (pointDone) {
+        s_index++;
+        if (s_index >= s_cfg.points) state = FreqRespState::DONE;
+        else beginPoint();
+    }
+
+    const bool running = (state == FreqRespState::RUNNING);
+    regMP  = biasMP  + ((running && mp)  ? u : 0);
+    regRDC = biasRDC + ((running && !mp) ? u : 0);
+
+    if (!running) {
+        FR_LOCK();
+        s_res.state = state;
+        s_res.fail  = fail;
+        FR_UNLOCK();
+        s_active = false;
+    }
+    return true;
+}
+
+void FreqResp_getResult(FreqRespResult &out)
+{
+    FR_LOCK();
+    out = s_res;
+    FR_UNLOCK();
+}
+
+const char *FreqResp_failName(FreqRespFail fail)
+{
+    switch (fail) {
+    case FreqRespFail::NONE:    return "ninguno";
+    case FreqRespFail::ABORTED: return "cancelado";
+    case FreqRespFail::RUNAWAY: return "desvio excesivo";
+    }
+    return "?";
+}
+
+static void appendf(char *buf, size_t len, size_t &pos, const char *fmt, ...)
+{
+    if (pos >= len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(buf + pos, len - pos, fmt, ap);
+    va_end(ap);
+    if (w > 0) pos += ((size_t)w < len - pos) ? (size_t)w : len - pos - 1;
+}
+
+size_t FreqResp_format(const FreqRespResult &r, char *buf, size_t len)
+{
+    if (len == 0) return 0;
+    buf[0] = '\0';
+    size_t pos = 0;
+
+    appendf(buf, len, pos, "# entrada=%s\n", inputName(r.input));
+    appendf(buf, len, pos, "# biasMP=%d\n# biasRDC=%d\n# amplitudeReg=%.1f\n",
+            r.biasMP, r.biasRDC, r.amplitudeReg);
+    appendf(buf, len, pos, "# puntos=%u/%u\n# duracionS=%.1f\n",
+            (unsigned)r.done, (unsigned)r.points, r.elapsedS);
+    if (r.state == FreqRespState::FAILED) {
+        appendf(buf, len, pos, "# fallo=%s\n", FreqResp_failName(r.fail));
+    }
+    appendf(buf, len, pos, "f_hz,gain_db,phase_deg,cross_db,cross_phase_deg,quality\n");
+    for (uint8_t i = 0; i < r.done && i < FREQ_RESP_MAX_POINTS; i++) {
+        const FreqRespPoint &p = r.pt[i];
+        appendf(buf, len, pos, "%.4f,%.2f,%.1f,%.2f,%.1f,%.3f\n",
+                p.freqHz, p.gainDb, p.phaseDeg, p.crossGainDb, p.crossPhaseDeg, p.quality);
+    }
+    return pos;
+}
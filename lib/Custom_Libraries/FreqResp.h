@@ -0,0 +1,154 @@
+/* Esta librería, junto con su correspondiente "FreqResp.cpp", mide en el propio equipo la respuesta en
+frecuencia (diagrama de Bode) de un rotor a los ángulos de la viga. Con el PID parado, la tarea de
+control suma al registro de un motor un seno por escalones de frecuencia alrededor del punto de
+trabajo (los registros manuales Registro_MP / Registro_RDC al empezar):
+
+   reg[n] = bias + A sin(w n),   w = 2 pi * measureCycles / N
+
+y en cada frecuencia, tras settleCycles periodos de asentamiento, pasa la entrada aplicada y los dos
+ángulos por un filtro de Goertzel en la frecuencia excitada durante N muestras (measureCycles periodos
+exactos, así la continua y las demás frecuencias de la DFT no se cuelan). Cada muestra cuesta O(1)
+y no hace falta guardar la señal. La ganancia y la fase salen del cociente salida / entrada en el
+mismo bin, de modo que el redondeo del registro y la amplitud real aplicada se cancelan; la fase
+incluye el periodo de control entre escribir el registro y leer los encoders, que es el retardo que
+ve el PID.
+
+Salida directa: motor principal -> cabeceo, rotor de cola -> guiñada; la otra es el acoplamiento
+cruzado. La frecuencia de cada punto se da con el dt medido en su ventana */
+
+// FreqResp.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Máximo de frecuencias de un barrido
+static const uint8_t FREQ_RESP_MAX_POINTS = 16;
+
+// Ganancia que se da cuando la salida no se mueve (por debajo de la resolución del encoder)
+static const float FREQ_RESP_FLOOR_DB = -120.0f;
+
+enum class FreqRespInput : uint8_t {
+    MAIN_ROTOR,    // Registro_MP (salida directa: cabeceo)
+    TAIL_ROTOR     // Registro_RDC (salida directa: guiñada)
+};
+
+/**
+ * @brief Configuración del barrido.
+ *
+ * @param amplitudeReg   Amplitud A del seno [reg]
+ * @param fMinHz, fMaxHz Extremos del barrido (espaciado logarítmico; fMax se limita a fs / 4)
+ * @param points         Frecuencias del barrido (2..FREQ_RESP_MAX_POINTS)
+ * @param settleCycles   Periodos que se descartan al cambiar de frecuencia
+ * @param measureCycles  Periodos que entran en el filtro de Goertzel
+ * @param maxDevDeg      Desvío máximo de la salida directa respecto al ángulo inicial antes de abortar
+ */
+struct FreqRespConfig {
+    float   amplitudeReg;
+    float   fMinHz;
+    float   fMaxHz;
+    uint8_t points;
+    uint8_t settleCycles;
+    uint8_t measureCycles;
+    float   maxDevDeg;
+};
+
+// Péndulo vertical ~0.6 Hz y rotores con tau ~0.3 s: unos 2.5 min de barrido
+static const FreqRespConfig FREQ_RESP_DEFAULT_CONFIG = {
+    8.0f,     // reg
+    0.1f,     // Hz
+    3.0f,     // Hz
+    10,
+    2,
+    3,
+    60.0f     // deg
+};
+
+enum class FreqRespState : uint8_t {
+    IDLE,
+    RUNNING,
+    DONE,
+    FAILED
+};
+
+enum class FreqRespFail : uint8_t {
+    NONE,
+    ABORTED,     // FreqResp_abort
+    RUNAWAY      // la salida directa pasó de maxDevDeg
+};
+
+/**
+ * @brief Un punto del diagrama.
+ *
+ * @param gainDb, phaseDeg            Salida directa / entrada [dB de deg/reg, grados]
+ * @param crossGainDb, crossPhaseDeg  Igual con la salida cruzada
+ * @param quality   Fracción de la potencia alterna de la salida directa que cae en la
+ *                  frecuencia excitada (1: respuesta lineal y sin ruido)
+ */
+struct FreqRespPoint {
+    float freqHz;
+    float gainDb;
+    float phaseDeg;
+    float crossGainDb;
+    float crossPhaseDeg;
+    float quality;
+};
+
+/**
+ * @brief Estado y resultado del barrido (FreqResp_getResult).
+ *
+ * Las fases están desenrolladas a lo largo del barrido (continuas entre puntos).
+ */
+struct FreqRespResult {
+    FreqRespState state;
+    FreqRespFail  fail;
+    FreqRespInput input;
+    int           biasMP, biasRDC;   // punto de trabajo
+    float         amplitudeReg;
+    float         elapsedS;
+    uint8_t       points;            // frecuencias pedidas
+    uint8_t       done;              // puntos medidos
+    FreqRespPoint pt[FREQ_RESP_MAX_POINTS];
+};
+
+/**
+ * @brief Arranca el barrido (desde la interfaz, con el PID deshabilitado).
+ *
+ * @param input    Motor excitado
+ * @param regMP, regRDC  Punto de trabajo (registros manuales)
+ * @param rateHz   Frecuencia del lazo de control (fija las muestras por periodo)
+ * @param cfg      Configuración
+ * @return false si ya hay un barrido en marcha o la configuración no vale
+ */
+bool FreqResp_start(FreqRespInput input, int regMP, int regRDC, float rateHz,
+                    const FreqRespConfig &cfg = FREQ_RESP_DEFAULT_CONFIG);
+
+// Detiene el barrido (los motores vuelven al punto de trabajo)
+void FreqResp_abort();
+
+// true mientras el barrido está en marcha (la tarea de control no ejecuta el PID)
+bool FreqResp_isActive();
+
+/**
+ * @brief Un paso del barrido (desde la tarea de control, en lugar del PID).
+ *
+ * @param dt                  Tiempo desde la muestra anterior [s]
+ * @param measVDeg, measHDeg  Ángulos medidos
+ * @param regMP, regRDC       Registros que hay que escribir
+ * @return false si no hay barrido en marcha (no toca los registros)
+ */
+bool FreqResp_step(float dt, float measVDeg, float measHDeg, int &regMP, int &regRDC);
+
+// Copia el estado del barrido (desde cualquier tarea)
+void FreqResp_getResult(FreqRespResult &out);
+
+// Nombre corto del motivo de fallo (para mensajes)
+const char *FreqResp_failName(FreqRespFail fail);
+
+/**
+ * @brief Escribe los puntos medidos como CSV con una cabecera de comentarios ("# ...").
+ *
+ * Columnas: f_hz, gain_db, phase_deg, cross_db, cross_phase_deg, quality. Es el
+ * formato del fichero que guarda ControlSD_SaveBode. Devuelve los caracteres escritos.
+ */
+size_t FreqResp_format(const FreqRespResult &r, char *buf, size_t len);
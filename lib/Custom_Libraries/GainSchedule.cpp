@@ -0,0 +1,215 @@
+/* Esta librería, junto con su correspondiente "GainSchedule.h", precalcula y consulta las tablas de
+ganancias por punto de funcionamiento y lee su fichero de texto */
+
+// GainSchedule.cpp
+#include "GainSchedule.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const s_tableNames[GS_TABLE_COUNT] = {
+    "PID_HH",
+    "PID_HV",
+    "PID_VH",
+    "PID_VV",
+    "SHAPE_H",
+    "SHAPE_V",
+};
+
+// Índice por defecto: el eje de entrada de cada tabla
+static const GsIndex s_defaultIndex[GS_TABLE_COUNT] = {
+    GsIndex::REF_H,
+    GsIndex::REF_H,
+    GsIndex::REF_V,
+    GsIndex::REF_V,
+    GsIndex::REF_H,
+    GsIndex::REF_V,
+};
+
+const char *GainSchedule_tableName(GsTableId id)
+{
+    return (id < GS_TABLE_COUNT) ? s_tableNames[id] : "?";
+}
+
+/**
+ * @brief
+ * Precalcula la rejilla uniforme de una tabla.
+ * @note
+ * Cada punto de la rejilla se interpola en el tramo [pts[j], pts[j+1]) que lo
+ * contiene, así los puntos de la tabla que caen en la rejilla se copian sin
+ * redondeo. Se llama al cargar tablas, nunca en el paso de control.
+ */
+bool GainSchedule_compile(const GsTableSpec &spec, GsTable &out)
+{
+    out.index = spec.index;
+    out.n     = 0;
+    if (spec.n == 0) return true;
+    if (spec.n > GS_MAX_POINTS) return false;
+    for (int j = 1; j < spec.n; j++) {
+        if (!(spec.pts[j].x > spec.pts[j - 1].x)) return false;
+    }
+
+    const float xMin  = spec.pts[0].x;
+    const float range = spec.pts[spec.n - 1].x - xMin;
+
+    int   n;
+    float step;
+    if (range <= (float)(GS_GRID_MAX - 1)) {
+        n    = (int)range + 1;
+        step = 1.0f;
+        if ((float)(n - 1) < range) n++;   // rango no entero: un punto más
+    } else {
+        n    = GS_GRID_MAX;
+        step = range / (float)(GS_GRID_MAX - 1);
+    }
+
+    int j = 0;
+    for (int k = 0; k < n; k++) {
+        const float x = xMin + (float)k * step;
+        while (j + 1 < spec.n && x >= spec.pts[j + 1].x) j++;
+
+        for (int c = 0; c < GS_COLS; c++) {
+            if (j + 1 >= spec.n) {
+                out.grid[k][c] = spec.pts[spec.n - 1].v[c];
+            } else {
+                const GsPoint &a = spec.pts[j];
+                const GsPoint &b = spec.pts[j + 1];
+                out.grid[k][c] = a.v[c] + (x - a.x) / (b.x - a.x) * (b.v[c] - a.v[c]);
+            }
+        }
+    }
+
+    out.x0      = xMin;
+    out.invStep = 1.0f / step;
+    out.n       = (uint16_t)n;
+    return true;
+}
+
+void GainSchedule_lookup(const GsTable &t, float x, float out[GS_COLS])
+{
+    float f = (x - t.x0) * t.invStep;
+    const int last = (int)t.n - 1;
+
+    if (!(f > 0.0f) || last == 0) {          // por debajo (o NaN) o un solo punto
+        for (int c = 0; c < GS_COLS; c++) out[c] = t.grid[0][c];
+        return;
+    }
+    if (f >= (float)last) {
+        for (int c = 0; c < GS_COLS; c++) out[c] = t.grid[last][c];
+        return;
+    }
+
+    const int   i = (int)f;
+    const float u = f - (float)i;
+    for (int c = 0; c < GS_COLS; c++) {
+        out[c] = t.grid[i][c] + u * (t.grid[i + 1][c] - t.grid[i][c]);
+    }
+}
+
+// ------------------------------------------------------------
+// Fichero de tablas
+// ------------------------------------------------------------
+
+static bool parseIndex(const char *s, GsIndex &out)
+{
+    if      (!strcmp(s, "REF_V"))  out = GsIndex::REF_V;
+    else if (!strcmp(s, "REF_H"))  out = GsIndex::REF_H;
+    else if (!strcmp(s, "MEAS_V")) out = GsIndex::MEAS_V;
+    else if (!strcmp(s, "MEAS_H")) out = GsIndex::MEAS_H;
+    else return false;
+    return true;
+}
+
+// Recorta espacios al principio y al final (modifica el buffer)
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s)) s++;
+    char *e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) e--;
+    *e = '\0';
+    return s;
+}
+
+/**
+ * @brief
+ * Lee el texto de un fichero de tablas (ver GainSchedule.h).
+ * @note
+ * Sin memoria dinámica: cada línea se copia a un buffer de la pila.
+ */
+int GainSchedule_parse(const char *text, GsTableSpec specs[GS_TABLE_COUNT])
+{
+    for (int i = 0; i < GS_TABLE_COUNT; i++) {
+        specs[i].index = s_defaultIndex[i];
+        specs[i].n     = 0;
+    }
+
+    GsTableSpec *cur = nullptr;
+    int lineNo = 0;
+    const char *p = text;
+
+    while (*p) {
+        lineNo++;
+        const char *eol = strchr(p, '\n');
+        size_t len = eol ? (size_t)(eol - p) : strlen(p);
+
+        char buf[128];
+        if (len >= sizeof(buf)) return lineNo;
+        memcpy(buf, p, len);
+        buf[len] = '\0';
+        p = eol ? eol + 1 : p + len;
+
+        char *hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        char *line = trim(buf);
+        if (*line == '\0') continue;
+
+        // [TABLA]
+        if (*line == '[') {
+            char *close = strchr(line, ']');
+            if (!close) return lineNo;
+            *close = '\0';
+            cur = nullptr;
+            for (int i = 0; i < GS_TABLE_COUNT; i++) {
+                if (!strcmp(line + 1, s_tableNames[i])) cur = &specs[i];
+            }
+            if (!cur) return lineNo;
+            cur->n = 0;
+            continue;
+        }
+        if (!cur) return lineNo;
+
+        // index=...
+        char *eq = strchr(line, '=');
+        if (eq) {
+            *eq = '\0';
+            if (strcmp(trim(line), "index") || !parseIndex(trim(eq + 1), cur->index)) return lineNo;
+            continue;
+        }
+
+        // x, v0, v1, ...
+        if (cur->n >= GS_MAX_POINTS) return lineNo;
+        GsPoint &pt = cur->pts[cur->n];
+        memset(&pt, 0, sizeof(pt));
+
+        char *q = line;
+        char *end;
+        pt.x = strtof(q, &end);
+        if (end == q) return lineNo;
+        q = end;
+        for (int c = 0; c < GS_COLS; c++) {
+            while (isspace((unsigned char)*q)) q++;
+            if (*q == '\0') break;
+            if (*q != ',') return lineNo;
+            q++;
+            pt.v[c] = strtof(q, &end);
+            if (end == q) return lineNo;
+            q = end;
+        }
+        while (isspace((unsigned char)*q)) q++;
+        if (*q != '\0') return lineNo;
+        if (cur->n > 0 && !(pt.x > cur->pts[cur->n - 1].x)) return lineNo;
+        cur->n++;
+    }
+    return 0;
+}
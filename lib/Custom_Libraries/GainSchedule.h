@@ -0,0 +1,112 @@
+/* Esta librería, junto con su correspondiente "GainSchedule.cpp", define las tablas de ganancias
+por punto de funcionamiento (gain scheduling) del PID-4. Cada tabla se escribe como unos pocos
+puntos (ángulo -> valores) y se precalcula en una rejilla uniforme: en el paso de control la
+consulta es un índice y una interpolación lineal, sin búsquedas.
+
+Las tablas las instala y consulta PID_Control.cpp (PID4_LoadSchedules); el formato de fichero
+(Sched_N.txt en la SD, junto a Config_N.txt) se describe en GainSchedule_parse */
+
+// GainSchedule.h
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Tablas disponibles.
+ *
+ * - GS_PID_HH..GS_PID_VV: multiplicadores sobre las ganancias de PID_CURR de
+ *   cada PID. Columnas: Kp, Ki, Kd, Isat (1 = sin cambio). Sin tabla no se
+ *   escala nada.
+ * - GS_SHAPE_H: lógica horizontal. Columna 0: escala de deltaRDC (antes
+ *   H_NEAR0_DEG, K_RDC_NEAR0 y K_RDC_NEG).
+ * - GS_SHAPE_V: lógicas verticales. Columnas: registro mínimo de subida
+ *   (MIN_OUT), freno al pasarse [reg/deg] (V_BIAS_REL_K) y adaptación de la
+ *   base de bajada hacia abajo / hacia 0 (Kbase_down / Kbase_up).
+ */
+enum GsTableId : uint8_t {
+    GS_PID_HH = 0,
+    GS_PID_HV,
+    GS_PID_VH,
+    GS_PID_VV,
+    GS_SHAPE_H,
+    GS_SHAPE_V,
+    GS_TABLE_COUNT
+};
+
+// Variable con la que se indexa cada tabla [grados]
+enum class GsIndex : uint8_t {
+    REF_V,      // consigna vertical
+    REF_H,      // consigna horizontal
+    MEAS_V,     // ángulo vertical medido
+    MEAS_H      // ángulo horizontal medido
+};
+
+static const int GS_COLS       = 4;     // columnas por punto (las que sobran valen 0)
+static const int GS_MAX_POINTS = 16;    // puntos por tabla en el fichero
+static const int GS_GRID_MAX   = 121;   // puntos de la rejilla precalculada
+
+/**
+ * @brief Punto de una tabla tal como se escribe (ángulo y valores).
+ */
+struct GsPoint {
+    float x;
+    float v[GS_COLS];
+};
+
+/**
+ * @brief Tabla sin precalcular: puntos ordenados por x (n = 0 -> sin tabla).
+ */
+struct GsTableSpec {
+    GsIndex index;
+    uint8_t n;
+    GsPoint pts[GS_MAX_POINTS];
+};
+
+/**
+ * @brief Tabla precalculada en una rejilla uniforme de x0 a x0 + (n-1)/invStep.
+ *
+ * Paso de 1° si el rango cabe en GS_GRID_MAX puntos (los puntos en grados
+ * enteros salen exactos); si no, el rango se reparte en GS_GRID_MAX puntos.
+ * Fuera del rango se usa el extremo más cercano.
+ */
+struct GsTable {
+    GsIndex  index;
+    uint16_t n;         // 0 = tabla vacía
+    float    x0;
+    float    invStep;
+    float    grid[GS_GRID_MAX][GS_COLS];
+};
+
+// Nombre de una tabla en el fichero ("PID_HH", ..., "SHAPE_V")
+const char *GainSchedule_tableName(GsTableId id);
+
+/**
+ * @brief Precalcula la rejilla de una tabla.
+ *
+ * @return false si los puntos no están ordenados por x (estrictamente) o n > GS_MAX_POINTS
+ *         (la tabla de salida queda vacía)
+ */
+bool GainSchedule_compile(const GsTableSpec &spec, GsTable &out);
+
+/**
+ * @brief Consulta O(1): interpolación lineal entre los dos puntos de la rejilla.
+ *
+ * @note En los puntos de la rejilla devuelve el valor exacto. No se llama con
+ *       tablas vacías (out queda sin tocar).
+ */
+void GainSchedule_lookup(const GsTable &t, float x, float out[GS_COLS]);
+
+/**
+ * @brief Lee un fichero de tablas ya cargado en memoria.
+ *
+ *   # comentario
+ *   [PID_VV]            <- tabla (PID_HH, PID_HV, PID_VH, PID_VV, SHAPE_H, SHAPE_V)
+ *   index=REF_V         <- REF_V, REF_H, MEAS_V o MEAS_H (por defecto, el eje de entrada de la tabla)
+ *   -45, 1.2, 1, 1, 1   <- x, valores (las columnas que falten valen 0)
+ *   0,   1.0, 1, 1, 1
+ *
+ * Las tablas que no aparecen quedan con n = 0.
+ *
+ * @return 0 si todo es correcto; si no, el número de la primera línea errónea
+ */
+int GainSchedule_parse(const char *text, GsTableSpec specs[GS_TABLE_COUNT]);
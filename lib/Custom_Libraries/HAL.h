@@ -0,0 +1,90 @@
+/* Esta librería, junto con "HAL_ESP32.cpp" y "HAL_Host.cpp", define una capa mínima de abstracción
+del hardware (GPIO, DAC, ADC, I2C, reloj y trazas) para los módulos de control (PID, encoders,
+tacómetros y motores). En el ESP32 se implementa con Arduino/Wire; en un PC (compilación nativa,
+carpeta host/) con un backend de funciones que puede conectarse a un simulador de la planta */
+
+// HAL.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Clock.h"
+
+/*
+    Compilación nativa (host/):
+      - No existe ARDUINO: se compila HAL_Host.cpp en lugar de HAL_ESP32.cpp.
+      - Se define TRMS_NATIVE: los módulos dejan fuera la parte de interfaz (LVGL / SquareLine),
+        que en el ESP32 sigue igual.
+*/
+
+// Modos de pin
+enum HalPinMode : uint8_t {
+    HAL_PIN_INPUT  = 0,
+    HAL_PIN_OUTPUT = 1
+};
+
+// -------------------------
+// GPIO
+// -------------------------
+void HAL_pinMode(uint8_t pin, HalPinMode mode);
+void HAL_gpioWrite(uint8_t pin, bool level);
+
+// -------------------------
+// DAC (8 bits, GPIO 25/26 en el ESP32)
+// -------------------------
+void HAL_dacWrite(uint8_t pin, uint8_t value);
+
+// -------------------------
+// ADC (12 bits, 0..4095)
+// -------------------------
+uint16_t HAL_adcRead(uint8_t pin);
+
+// -------------------------
+// I2C (registro de 8 bits)
+// -------------------------
+// Escribe reg <- value. Devuelve el código de Wire.endTransmission() (0 = OK)
+uint8_t HAL_i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t value);
+
+// Lee un registro (STOP tras fijar el registro + lectura de 1 byte con STOP)
+bool HAL_i2cReadReg(uint8_t addr, uint8_t reg, uint8_t &value);
+
+// Comprueba si hay un dispositivo en addr. Devuelve el código de endTransmission()
+uint8_t HAL_i2cProbe(uint8_t addr);
+
+// -------------------------
+// Reloj (en us: Clock_nowUs, ver Clock.h)
+// -------------------------
+uint32_t HAL_millis();
+void     HAL_delayMs(uint32_t ms);
+void     HAL_delayUs(uint32_t us);
+
+// -------------------------
+// Trazas (Serial en el ESP32, stdout en host)
+// -------------------------
+void HAL_logf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#ifndef ARDUINO
+/**
+ * @brief Backend de la HAL en compilación host.
+ *
+ * Cada puntero puede ser nullptr: en ese caso la operación no hace nada
+ * (o devuelve 0 / "no hay dispositivo"). Un simulador de la planta rellena
+ * los que necesite (DAC -> actuadores, I2C -> encoders, ADC -> tacómetros).
+ */
+struct HalHostBackend {
+    void     (*gpioWrite)(uint8_t pin, bool level);
+    void     (*dacWrite)(uint8_t pin, uint8_t value);
+    uint16_t (*adcRead)(uint8_t pin);
+    uint8_t  (*i2cWriteReg)(uint8_t addr, uint8_t reg, uint8_t value);
+    bool     (*i2cReadReg)(uint8_t addr, uint8_t reg, uint8_t &value);
+};
+
+// Instala el backend (nullptr = sin backend). El puntero debe seguir siendo válido.
+void HAL_hostSetBackend(const HalHostBackend *backend);
+
+// Activa/desactiva las trazas HAL_logf (por defecto activadas)
+void HAL_hostSetLogEnabled(bool enable);
+
+// Último valor escrito en un DAC (útil sin backend)
+uint8_t HAL_hostGetDac(uint8_t pin);
+#endif
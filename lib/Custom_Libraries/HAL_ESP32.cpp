@@ -0,0 +1,86 @@
+/* Implementación de la HAL (ver "HAL.h") para el ESP32 con el framework Arduino:
+GPIO/DAC/ADC con las funciones de Arduino, I2C con Wire y trazas por Serial */
+
+// HAL_ESP32.cpp
+#ifdef ARDUINO
+
+#include "HAL.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <stdarg.h>
+
+void HAL_pinMode(uint8_t pin, HalPinMode mode)
+{
+    pinMode(pin, mode == HAL_PIN_OUTPUT ? OUTPUT : INPUT);
+}
+
+void HAL_gpioWrite(uint8_t pin, bool level)
+{
+    digitalWrite(pin, level ? HIGH : LOW);
+}
+
+void HAL_dacWrite(uint8_t pin, uint8_t value)
+{
+    dacWrite(pin, value);
+}
+
+uint16_t HAL_adcRead(uint8_t pin)
+{
+    return analogRead(pin);
+}
+
+uint8_t HAL_i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t value)
+{
+    Wire.beginTransmission(addr);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission(true); // STOP
+}
+
+bool HAL_i2cReadReg(uint8_t addr, uint8_t reg, uint8_t &value)
+{
+    Wire.beginTransmission(addr);
+    Wire.write(reg);
+    uint8_t err = Wire.endTransmission(true); // STOP
+    if (err != 0) return false;
+
+    uint8_t n = Wire.requestFrom((uint16_t)addr, (uint8_t)1, (uint8_t)true);
+    if (n != 1) return false;
+
+    value = Wire.read();
+    return true;
+}
+
+uint8_t HAL_i2cProbe(uint8_t addr)
+{
+    Wire.beginTransmission(addr);
+    return Wire.endTransmission();
+}
+
+uint32_t HAL_millis()
+{
+    return millis();
+}
+
+void HAL_delayMs(uint32_t ms)
+{
+    delay(ms);
+}
+
+void HAL_delayUs(uint32_t us)
+{
+    delayMicroseconds(us);
+}
+
+void HAL_logf(const char *fmt, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    Serial.print(buf);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,98 @@
+/* Implementación de la HAL (ver "HAL.h") para compilación nativa en PC.
+Cada operación se delega en el backend instalado con HAL_hostSetBackend (por ejemplo un simulador
+de la planta). Los retardos no esperan: avanzan el reloj simulado de Clock.cpp */
+
+// HAL_Host.cpp
+#ifndef ARDUINO
+
+#include "HAL.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static const HalHostBackend *s_backend = nullptr;
+static bool    s_logEnabled = true;
+static uint8_t s_lastDac[40] = {0};   // por número de GPIO
+
+void HAL_hostSetBackend(const HalHostBackend *backend)
+{
+    s_backend = backend;
+}
+
+void HAL_hostSetLogEnabled(bool enable)
+{
+    s_logEnabled = enable;
+}
+
+uint8_t HAL_hostGetDac(uint8_t pin)
+{
+    return (pin < sizeof(s_lastDac)) ? s_lastDac[pin] : 0;
+}
+
+void HAL_pinMode(uint8_t pin, HalPinMode mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void HAL_gpioWrite(uint8_t pin, bool level)
+{
+    if (s_backend && s_backend->gpioWrite) s_backend->gpioWrite(pin, level);
+}
+
+void HAL_dacWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < sizeof(s_lastDac)) s_lastDac[pin] = value;
+    if (s_backend && s_backend->dacWrite) s_backend->dacWrite(pin, value);
+}
+
+uint16_t HAL_adcRead(uint8_t pin)
+{
+    if (s_backend && s_backend->adcRead) return s_backend->adcRead(pin);
+    return 0;
+}
+
+uint8_t HAL_i2cWriteReg(uint8_t addr, uint8_t reg, uint8_t value)
+{
+    if (s_backend && s_backend->i2cWriteReg) return s_backend->i2cWriteReg(addr, reg, value);
+    return 2;   // "NACK on address": no hay dispositivo
+}
+
+bool HAL_i2cReadReg(uint8_t addr, uint8_t reg, uint8_t &value)
+{
+    if (s_backend && s_backend->i2cReadReg) return s_backend->i2cReadReg(addr, reg, value);
+    return false;
+}
+
+uint8_t HAL_i2cProbe(uint8_t addr)
+{
+    uint8_t dummy = 0;
+    return HAL_i2cReadReg(addr, 0x00, dummy) ? 0 : 2;
+}
+
+uint32_t HAL_millis()
+{
+    return (uint32_t)(Clock_nowUs() / 1000);
+}
+
+void HAL_delayMs(uint32_t ms)
+{
+    Clock_mockAdvanceUs((int64_t)ms * 1000);
+}
+
+void HAL_delayUs(uint32_t us)
+{
+    Clock_mockAdvanceUs(us);
+}
+
+void HAL_logf(const char *fmt, ...)
+{
+    if (!s_logEnabled) return;
+
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+#endif // !ARDUINO
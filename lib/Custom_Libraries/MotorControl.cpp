@@ -4,6 +4,9 @@ y su control mediante sliders que se muestran en la interfaz gráfica*/
 
 // MotorControl.cpp
 #include "MotorControl.h"
+#include "HAL.h"
+
+#include <stdio.h>
 
 // Constantes para el DAC
 static const float MAX_VOLTAGE   = 3.3f;
@@ -20,7 +23,12 @@ static uint8_t s_lastDacG2 = 0;
 // Contador de cambios (sube cuando cambia G1 o G2)
 static uint32_t s_dacUpdateSeq = 0;
 
+// Últimos registros escritos (ya limitados a ±100)
+static int s_lastRegMP  = 0;
+static int s_lastRegRDC = 0;
+
 // Funciones auxiliares
+#ifndef TRMS_NATIVE
 
 /**
  * @brief   
@@ -93,6 +101,8 @@ void ocultar_flecha(lv_obj_t * flecha) {
     lv_obj_add_flag(flecha, LV_OBJ_FLAG_HIDDEN);
 }
 
+#endif // TRMS_NATIVE
+
 /**
  * @brief 
  * Inicializa el control de los motores.
@@ -135,28 +145,7 @@ static float computeDacFromRegister(int regValue) {
     return dacVal;
 }
 
-/**
- * @brief 
- * Convierte un valor de registro en un valor DAC.
- * @note
-  Toma un valor de registro en el rango [-100, 100]
-  y lo convierte en un valor DAC correspondiente
-  en el rango [0, 255], considerando el voltaje máximo. 
- * @param regValue 
- * @return float 
- */
-
-static float computeVoltFromRegister(int regValue) {
-    // Magnitud 0..100
-    int mag = regValue;
-    if (mag > 100) mag = 100;
-    if (mag < -100) mag = -100;
-
-    float volt = (mag + 100)*(MAX_VOLTAGE/200); 
-
-    return volt;
-}
-
+#ifndef TRMS_NATIVE
 /**
  * @brief 
  * Convierte un valor de registro en un voltaje de entrada TRMS.
@@ -178,6 +167,7 @@ static float VinTRMSFromRegister(int regValue) {
 
     return volt;
 }
+#endif // TRMS_NATIVE
 
 /**
  * @brief 
@@ -207,6 +197,19 @@ uint32_t MotorControl_getDacUpdateSeq()
     return s_dacUpdateSeq;
 }
 
+/**
+ * @brief
+ * Devuelve los últimos registros escritos a los DAC (-100..100).
+ * @note
+ * Los usa el PID-4 para arrancar sin salto desde lo que se estaba aplicando
+ * (sliders o el propio PID antes de cambiar de modo o de ganancias).
+ */
+void MotorControl_getLastRegisters(int &regMP, int &regRDC)
+{
+    regMP  = s_lastRegMP;
+    regRDC = s_lastRegRDC;
+}
+
 /**
  * @brief 
  * Actualiza el control de los motores basado en los registros.
@@ -237,54 +240,70 @@ void MotorControl_update(int &Registro_MP, int &Registro_RDC) {
     //lv_slider_set_value(ui_MotorPrincipal, Registro_MP, LV_ANIM_OFF);
     //lv_slider_set_value(ui_RotorDeCola, Registro_RDC, LV_ANIM_OFF);
 
-    // 3) Actualizar animaciones
-    if (Registro_RDC > 0) {
+    // 3) Actualizar animaciones y labels de Vin
+#ifndef TRMS_NATIVE
+    MotorControl_refreshUI(Registro_MP, Registro_RDC);
+#endif
+
+    // 4) Escribir a los DACs
+    MotorControl_writeOutputs(Registro_MP, Registro_RDC);
+}
+
+/**
+ * @brief
+ * Actualiza la parte gráfica asociada a los registros de los motores.
+ * @note
+ * Gira la imagen del motor, muestra/oculta las flechas de sentido
+ * y actualiza las labels de Vin. Usa LVGL, por lo que solo debe llamarse
+ * desde la tarea de interfaz (nunca desde la tarea de control).
+ * @param regMP
+ * @param regRDC
+ */
+
+#ifndef TRMS_NATIVE
+void MotorControl_refreshUI(int regMP, int regRDC) {
+
+    // 1) Actualizar animaciones
+    if (regRDC > 0) {
         motor_girar_a(-120); // Giro hacia "arriba"
         mostrar_flecha(ui_FlechaVerdeCurva);
         ocultar_flecha(ui_FlechaVerdeCurvaGirada);
     }
-    else if (Registro_RDC < 0) {
+    else if (regRDC < 0) {
         motor_girar_a(120); // Giro hacia abajo
         ocultar_flecha(ui_FlechaVerdeCurva);
         mostrar_flecha(ui_FlechaVerdeCurvaGirada);
     }
-    else if (Registro_RDC == 0) { // Centro
+    else if (regRDC == 0) { // Centro
         motor_girar_a(0);
         ocultar_flecha(ui_FlechaVerdeCurva);
         ocultar_flecha(ui_FlechaVerdeCurvaGirada);
     }
 
-    if (Registro_MP > 0) {
+    if (regMP > 0) {
         motor_girar_a(-120); // Giro hacia "arriba"
         mostrar_flecha(ui_FlechaVerdeRecta);
         ocultar_flecha(ui_FlechaVerdeRectaGirada);
     }
-    else if (Registro_MP < 0) {
+    else if (regMP < 0) {
         motor_girar_a(120); // Giro hacia abajo
         ocultar_flecha(ui_FlechaVerdeRecta);
         mostrar_flecha(ui_FlechaVerdeRectaGirada);
     }
-    else if (Registro_MP == 0) { // Centro
+    else if (regMP == 0) { // Centro
         motor_girar_a(0);
         ocultar_flecha(ui_FlechaVerdeRecta);
         ocultar_flecha(ui_FlechaVerdeRectaGirada);
     }
 
-    // 4) Calcular valores DAC a partir de los registros
-    int dac_mp = computeDacFromRegister(Registro_MP);
-    float volt_mp = computeVoltFromRegister(Registro_MP);
-
-    int dac_rdc  = computeDacFromRegister(Registro_RDC);
-    float volt_rdc  = computeVoltFromRegister(Registro_RDC);
-
-    /* 5) Actualizar labels de Vin. Estas labels no indican directamente el voltaje que sale de los 
+    /* 2) Actualizar labels de Vin. Estas labels no indican directamente el voltaje que sale de los 
     terminales del ESP32, sino lo que va a ver el TRMS en sus entradas para los motores. Es decir,
     las señales de control, una vez pasadas por el circuito de adaptación correspondiente, 
     y por el primer circuito de adaptación interno del propio TRMS, que elevan el rango de estas, 
     de (0-3.3)V, a (0-5)V */
     
-    float VinMP = VinTRMSFromRegister(Registro_MP);
-    float VinRDC = VinTRMSFromRegister(Registro_RDC);
+    float VinMP = VinTRMSFromRegister(regMP);
+    float VinRDC = VinTRMSFromRegister(regRDC);
 
     char buf[32];
     snprintf(buf, sizeof(buf), "Vin = %.2f V", VinMP);
@@ -292,12 +311,33 @@ void MotorControl_update(int &Registro_MP, int &Registro_RDC) {
 
     snprintf(buf, sizeof(buf), "Vin = %.2f V", VinRDC);
     lv_label_set_text(ui_VinRDC, buf);
+}
+#endif // TRMS_NATIVE
+
+/**
+ * @brief
+ * Escribe los DACs a partir de los registros, sin tocar la interfaz.
+ * @note
+ * Es la única parte de MotorControl_update que necesita la tarea de control:
+ * convierte los registros a 0..255, detecta cambios (s_dacUpdateSeq)
+ * y llama a HAL_dacWrite. No usa LVGL ni formatea texto.
+ * @param regMP
+ * @param regRDC
+ */
+
+void MotorControl_writeOutputs(int regMP, int regRDC) {
 
-    // 6) Escribir a los DACs
-    // Convertimos a uint8_t porque dacWrite usa 0..255
+    // 1) Calcular valores DAC a partir de los registros (computeDacFromRegister ya limita a ±100)
+    int dac_mp  = computeDacFromRegister(regMP);
+    int dac_rdc = computeDacFromRegister(regRDC);
+
+    // 2) Convertimos a uint8_t porque dacWrite usa 0..255
     uint8_t outG1 = (uint8_t)dac_mp;
     uint8_t outG2 = (uint8_t)dac_rdc;
 
+    s_lastRegMP  = (regMP  > 100) ? 100 : (regMP  < -100) ? -100 : regMP;
+    s_lastRegRDC = (regRDC > 100) ? 100 : (regRDC < -100) ? -100 : regRDC;
+
     // Si cambió cualquier salida, incrementamos el contador de cambios
     if (outG1 != s_lastDacG1 || outG2 != s_lastDacG2) {
         s_dacUpdateSeq++;
@@ -305,21 +345,6 @@ void MotorControl_update(int &Registro_MP, int &Registro_RDC) {
         s_lastDacG2 = outG2;
     }
 
-    dacWrite(s_dacPinG1, outG1);  // Motor / G1
-
-    //Serial.print("DAC_motor_Principal = ");
-    //Serial.println(Registro_MP);
-    //Serial.println(outG1);
-    //Serial.print("Volt_motor_Principal = ");
-    //Serial.println(volt_mp);
-
-    dacWrite(s_dacPinG2, outG2);   // Rotor / G2
-/*
-    Serial.print("DAC_rotor_de_cola = ");
-    Serial.println(outG2);
-    Serial.print("Volt_rotor_de_cola = ");
-    Serial.println(volt_rdc);
-*/
-
-
+    HAL_dacWrite(s_dacPinG1, outG1);  // Motor / G1
+    HAL_dacWrite(s_dacPinG2, outG2);   // Rotor / G2
 }
@@ -5,9 +5,11 @@ y su control mediante sliders que se muestran en la interfaz gráfica*/
 // MotorControl.h
 #pragma once
 
-#include <Arduino.h>
+#include <stdint.h>
+#ifndef TRMS_NATIVE
 #include <lvgl.h>
 #include "ui.h"    // Para usar ui_MotorAscendente, ui_RotorDerecha, etc.
+#endif
 
 /*
 // Estructura para devolver las banderas de estado del motor
@@ -39,12 +41,32 @@ void MotorControl_begin(uint8_t dacPinG1, uint8_t dacPinG2);
  */
 void MotorControl_update(int &Registro_MP, int &Registro_RDC);
 
+/**
+ * @brief Escribe únicamente los DACs a partir de los registros (sin tocar LVGL).
+ *
+ * Pensada para la tarea de control en tiempo real: no dibuja nada, solo limita
+ * los registros a [-100, 100], escribe G1/G2 y actualiza el contador de cambios.
+ *
+ * @param regMP   Registro del motor principal (-100..100)
+ * @param regRDC  Registro del rotor de cola (-100..100)
+ */
+void MotorControl_writeOutputs(int regMP, int regRDC);
+
+#ifndef TRMS_NATIVE
+/**
+ * @brief Actualiza flechas, giro del motor y labels Vin a partir de los registros.
+ *
+ * Solo debe llamarse desde la tarea de interfaz (contexto LVGL).
+ */
+void MotorControl_refreshUI(int regMP, int regRDC);
+
 //Funciones auxiliares
 void motor_girar_a(int16_t angle);
 void bloquear_slider(lv_obj_t * slider);
 void desbloquear_slider(lv_obj_t * slider);
 void mostrar_flecha(lv_obj_t * flecha);
 void ocultar_flecha(lv_obj_t * flecha);
+#endif
 
 /**
  * @brief 
@@ -63,4 +85,14 @@ void MotorControl_getLastDacValues(uint8_t &dacG1, uint8_t &dacG2);
  * Útil para detectar cambios de control desde la última comprobación.
  * @return uint32_t Contador de actualizaciones de DAC
  */
-uint32_t MotorControl_getDacUpdateSeq();
\ No newline at end of file
+uint32_t MotorControl_getDacUpdateSeq();
+
+/**
+ * @brief
+ * Devuelve los últimos registros escritos (-100..100).
+ * @note
+ * Para la transferencia sin salto del PID-4 (manual -> PID, cambios de modo).
+ * @param regMP  Referencia donde se devuelve el registro del motor principal
+ * @param regRDC Referencia donde se devuelve el registro del rotor de cola
+ */
+void MotorControl_getLastRegisters(int &regMP, int &regRDC);
\ No newline at end of file
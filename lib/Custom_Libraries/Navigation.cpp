@@ -1,6 +1,7 @@
 #include "Navigation.h"
 #include "ui.h"
 #include "Ang_Select.h"
+#include "PID_Control.h"
 
 extern lv_group_t * g_navGroup;
 extern lv_style_t   style_focus;
@@ -27,6 +28,9 @@ static lv_obj_t* s_fineSlider     = nullptr;
 static int       s_origMin        = 0;
 static int       s_origMax        = 0;
 
+// Ganancias editadas que el PID en marcha aún no ha recibido (ver HandlePendingGains)
+static bool      s_gainsPending   = false;
+
 // Estilo rojo para indicar precisión
 static lv_style_t s_styleFineInd;
 static lv_style_t s_styleFineKnob;
@@ -259,7 +263,43 @@ void HandleDeltaSlider(int delta)
         g_pidCurr.UhmaxCurr = value / 10.0f;
         PID_UpdateParamLabel(ui_Uhmax, g_pidMin.UhmaxMin, g_pidCurr.UhmaxCurr, g_pidMax.UhmaxMax);
     }
+    else {
+        return;
+    }
+
+    // 4) Con el PID en marcha, las ganancias entran en el siguiente paso (sin parar)
+    PID_MarkGainsPending();
+}
+
+/**
+ * @brief
+ * Marca g_pidCurr como pendiente de publicar y lo intenta publicar ya.
+ * @note
+ * La llaman tanto el mando (HandleDeltaSlider) como los eventos táctiles de
+ * los sliders de ganancias, Isat y Umax, para que el PID en marcha reciba el
+ * cambio por cualquiera de los dos caminos.
+ */
+void PID_MarkGainsPending()
+{
+    s_gainsPending = true;
+    HandlePendingGains();
+}
 
+/**
+ * @brief
+ * Publica g_pidCurr en el PID-4 en marcha si hay cambios pendientes.
+ * @note
+ * Se llama tras cada cambio de slider y en cada vuelta del loop: si el paso de
+ * control aún no había aplicado la publicación anterior, se reintenta aquí con
+ * los valores más recientes. Con el PID parado no hace falta publicar:
+ * function_Start_Control_PID carga g_pidCurr al arrancar.
+ */
+void HandlePendingGains()
+{
+    if (!s_gainsPending) return;
+    if (!PID4_IsEnabled() || PID4_PublishGains(g_pidCurr)) {
+        s_gainsPending = false;
+    }
 }
 /*
 static void ApplyNumericBufferToAngle(lv_obj_t *focused)
@@ -613,6 +653,7 @@ void SetupScreen4Nav()
 {
     lv_group_remove_all_objs(g_navGroup);
     lv_group_add_obj(g_navGroup, ui_Button14);
+    lv_group_add_obj(g_navGroup, ui_Button28);
     lv_group_add_obj(g_navGroup, ui_Button25);
     lv_group_add_obj(g_navGroup, ui_Button21);
     lv_group_add_obj(g_navGroup, ui_Button13);
@@ -637,6 +678,7 @@ void SetupScreen4Nav()
 
     // Aplicar estilo de foco a todos ellos
     lv_obj_add_style(ui_Button14, &style_focus, LV_STATE_FOCUSED);
+    lv_obj_add_style(ui_Button28, &style_focus, LV_STATE_FOCUSED);
     lv_obj_add_style(ui_Button25, &style_focus, LV_STATE_FOCUSED);
     lv_obj_add_style(ui_Button21, &style_focus, LV_STATE_FOCUSED);
     lv_obj_add_style(ui_Button13, &style_focus, LV_STATE_FOCUSED);
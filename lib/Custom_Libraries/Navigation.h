@@ -8,6 +8,8 @@ void HandleIRNavigation(IRNavKey nav);
 void HandleDeltaSlider(int delta);
 void HandleNumericDigit(int digit);
 void HandleNumericMinus();
+void HandlePendingGains();
+void PID_MarkGainsPending();   // g_pidCurr cambiado desde la interfaz (IR o táctil)
 
 static void FineStyle_InitOnce();
 static void FineMode_Exit();
@@ -0,0 +1,254 @@
+/* Esta librería, junto con su correspondiente "PID_Batch.h", evalúa lotes de PID-4 como estructura
+de arrays (ver PID_Batch.h) */
+
+// PID_Batch.cpp
+#include "PID_Batch.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Versión AVX2 de los núcleos, elegida al arrancar (GCC en x86 con ifunc). Sin FMA: con
+// multiplicación y suma fusionadas el redondeo ya no sería el del PID escalar.
+// no-trapping-math deja a GCC convertir las selecciones con divisiones en máscaras (solo
+// cambia las excepciones de coma flotante, que nadie mira; los resultados son los mismos)
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define PID_BATCH_KERNEL __attribute__((target_clones("avx2", "default"), optimize("no-trapping-math")))
+#elif defined(__GNUC__) && !defined(__clang__)
+#define PID_BATCH_KERNEL __attribute__((optimize("no-trapping-math")))
+#else
+#define PID_BATCH_KERNEL
+#endif
+
+static const size_t BATCH_ALIGN_FLOATS = 16;   // 64 bytes
+
+// Arrays por PID: 7 de ganancias + 5 de estado
+static const size_t LANE_ARRAYS = 12;
+
+static void assignLanes(PIDBatchLanes &l, float *&p, size_t stride)
+{
+    float **fields[LANE_ARRAYS] = {
+        &l.Kp, &l.Ki, &l.Kd, &l.Isat, &l.Tf, &l.Kt, &l.derivOnMeas,
+        &l.integrator, &l.prevInput, &l.prevMeas, &l.filterY, &l.hasPrev
+    };
+    for (size_t k = 0; k < LANE_ARRAYS; k++) {
+        *fields[k] = p;
+        p += stride;
+    }
+}
+
+bool PID4Batch_init(PID4Batch &b, size_t n)
+{
+    memset(&b, 0, sizeof(b));
+    const size_t stride = (n + BATCH_ALIGN_FLOATS - 1) / BATCH_ALIGN_FLOATS * BATCH_ALIGN_FLOATS;
+    const size_t arrays = 4 * LANE_ARRAYS + 2 + 4;
+
+    // Sobrante para alinear el primer array (malloc solo garantiza 8/16 bytes)
+    void *block = calloc(arrays * stride + BATCH_ALIGN_FLOATS, sizeof(float));
+    if (!block) return false;
+
+    uintptr_t addr = (uintptr_t)block;
+    addr = (addr + BATCH_ALIGN_FLOATS * sizeof(float) - 1) & ~(uintptr_t)(BATCH_ALIGN_FLOATS * sizeof(float) - 1);
+    float *p = (float *)addr;
+
+    b.n     = n;
+    b.block = block;
+    assignLanes(b.hh, p, stride);
+    assignLanes(b.hv, p, stride);
+    assignLanes(b.vh, p, stride);
+    assignLanes(b.vv, p, stride);
+    b.Uh_max = p; p += stride;
+    b.Uv_max = p; p += stride;
+    for (int k = 0; k < 4; k++) {
+        b.work[k] = p;
+        p += stride;
+    }
+    return true;
+}
+
+void PID4Batch_free(PID4Batch &b)
+{
+    free(b.block);
+    memset(&b, 0, sizeof(b));
+}
+
+static void setGains(PIDBatchLanes &l, size_t i, const PIDParams &g)
+{
+    l.Kp[i]          = g.Kp;
+    l.Ki[i]          = g.Ki;
+    l.Kd[i]          = g.Kd;
+    l.Isat[i]        = g.I_sat;
+    l.Tf[i]          = g.Tf;
+    l.Kt[i]          = g.Kt;
+    l.derivOnMeas[i] = g.derivOnMeas ? 1.0f : 0.0f;
+}
+
+void PID4Batch_setLane(PID4Batch &b, size_t lane, const PID4Params &p)
+{
+    if (lane >= b.n) return;
+    setGains(b.hh, lane, p.hh);
+    setGains(b.hv, lane, p.hv);
+    setGains(b.vh, lane, p.vh);
+    setGains(b.vv, lane, p.vv);
+    b.Uh_max[lane] = p.Uh_max;
+    b.Uv_max[lane] = p.Uv_max;
+}
+
+static void resetLanes(PIDBatchLanes &l, size_t n)
+{
+    memset(l.integrator, 0, n * sizeof(float));
+    memset(l.prevInput,  0, n * sizeof(float));
+    memset(l.prevMeas,   0, n * sizeof(float));
+    memset(l.filterY,    0, n * sizeof(float));
+    memset(l.hasPrev,    0, n * sizeof(float));
+}
+
+void PID4Batch_reset(PID4Batch &b)
+{
+    resetLanes(b.hh, b.n);
+    resetLanes(b.hv, b.n);
+    resetLanes(b.vh, b.n);
+    resetLanes(b.vv, b.n);
+}
+
+// ------------------------------------------------------------
+// Núcleos
+// ------------------------------------------------------------
+//  Mismo orden de operaciones que Pid<>::update con DerivativeSelectable,
+//  LowPassRuntime y BackCalculation; cada "if" es una selección para que el
+//  bucle no tenga ramas (un límite <= 0, "sin límite", se vuelve ±infinito).
+
+/**
+ * @brief
+ * Un paso de n PID (out = Kp*u + I + Kd*F(D(u, y))).
+ * @note
+ * meas no puede ser nullptr (ver lanesStep).
+ */
+PID_BATCH_KERNEL
+static void pidStep(size_t n, float dt,
+                    const float *__restrict in, const float *__restrict meas,
+                    const float *__restrict Kp, const float *__restrict Ki,
+                    const float *__restrict Kd, const float *__restrict Isat,
+                    const float *__restrict Tf, const float *__restrict dMeas,
+                    float *__restrict I, float *__restrict prevIn, float *__restrict prevMeas,
+                    float *__restrict fy, float *__restrict hasPrev,
+                    float *__restrict out)
+{
+    for (size_t i = 0; i < n; i++) {
+        const float u = in[i];
+        const float y = meas[i];
+
+        // Derivada del error o de la medida (0 en la primera muestra)
+        const float dm = -(y - prevMeas[i]) / dt;
+        const float de = (u - prevIn[i]) / dt;
+        const float ds = (dMeas[i] != 0.0f) ? dm : de;
+        const float d  = (hasPrev[i] != 0.0f) ? ds : 0.0f;
+        hasPrev[i]  = 1.0f;
+        prevIn[i]   = u;
+        prevMeas[i] = y;
+
+        // Filtro paso bajo (Tf <= 0: sin filtro)
+        const float tf  = Tf[i];
+        const float fyF = fy[i] + dt / (tf + dt) * (d - fy[i]);
+        const float du  = (tf <= 0.0f) ? d : fyF;
+        fy[i] = du;
+
+        // Integrador saturado ±Isat (0 = sin límite)
+        float integ = I[i] + Ki[i] * u * dt;
+        const float hi = (Isat[i] > 0.0f) ? Isat[i] : INFINITY;
+        integ = (integ >  hi) ?  hi : integ;
+        integ = (integ < -hi) ? -hi : integ;
+        I[i] = integ;
+
+        out[i] = Kp[i] * u + integ + Kd[i] * du;
+    }
+}
+
+// out = sat(a + b, ±umax) (umax <= 0: sin límite)
+PID_BATCH_KERNEL
+static void sumSaturate(size_t n, const float *__restrict a, const float *__restrict b2,
+                        const float *__restrict umax, float *__restrict out)
+{
+    for (size_t i = 0; i < n; i++) {
+        float u = a[i] + b2[i];
+        const float hi = (umax[i] > 0.0f) ? umax[i] : INFINITY;
+        u = (u >  hi) ?  hi : u;
+        u = (u < -hi) ? -hi : u;
+        out[i] = u;
+    }
+}
+
+// I += Kt * excess * dt, saturado ±Isat
+PID_BATCH_KERNEL
+static void trackStep(size_t n, float dt, const float *__restrict excess,
+                      const float *__restrict Kt, const float *__restrict Isat, float *__restrict I)
+{
+    for (size_t i = 0; i < n; i++) {
+        float integ = I[i] + Kt[i] * excess[i] * dt;
+        const float hi = (Isat[i] > 0.0f) ? Isat[i] : INFINITY;
+        integ = (integ >  hi) ?  hi : integ;
+        integ = (integ < -hi) ? -hi : integ;
+        I[i] = integ;
+    }
+}
+
+// Medidas a 0 para quien no las pasa (derivada del error), por tramos
+static const size_t ZERO_CHUNK = 256;
+static const float  ZEROS[ZERO_CHUNK] = {};
+
+static void lanesStep(PIDBatchLanes &l, size_t n, float dt, const float *in, const float *meas, float *out)
+{
+    if (meas) {
+        pidStep(n, dt, in, meas, l.Kp, l.Ki, l.Kd, l.Isat, l.Tf, l.derivOnMeas,
+                l.integrator, l.prevInput, l.prevMeas, l.filterY, l.hasPrev, out);
+        return;
+    }
+    for (size_t i = 0; i < n; i += ZERO_CHUNK) {
+        const size_t m = (n - i < ZERO_CHUNK) ? n - i : ZERO_CHUNK;
+        pidStep(m, dt, in + i, ZEROS, l.Kp + i, l.Ki + i, l.Kd + i, l.Isat + i, l.Tf + i, l.derivOnMeas + i,
+                l.integrator + i, l.prevInput + i, l.prevMeas + i, l.filterY + i, l.hasPrev + i, out + i);
+    }
+}
+
+void PIDBatch_update(PIDBatchLanes &l, size_t n, const float *in, float dt,
+                     const float *meas, float *out)
+{
+    if (dt <= 0.0f) dt = 0.001f;
+    lanesStep(l, n, dt, in, meas, out);
+}
+
+/**
+ * @brief
+ * Un paso de todos los PID-4 del lote.
+ * @note
+ * Los cuatro PID van en pasadas separadas (cada una recorre solo sus
+ * arrays); las salidas parciales quedan en parts o en los arrays de trabajo.
+ */
+void PID4Batch_update(PID4Batch &b, const float *in1, const float *in2, float dt,
+                      float *out1, float *out2, const PID4BatchPartials *parts,
+                      const float *meas1, const float *meas2)
+{
+    if (dt <= 0.0f) dt = 0.001f;
+
+    float *u_hh = (parts && parts->u_hh) ? parts->u_hh : b.work[0];
+    float *u_hv = (parts && parts->u_hv) ? parts->u_hv : b.work[1];
+    float *u_vh = (parts && parts->u_vh) ? parts->u_vh : b.work[2];
+    float *u_vv = (parts && parts->u_vv) ? parts->u_vv : b.work[3];
+
+    lanesStep(b.hh, b.n, dt, in1, meas1, u_hh);
+    lanesStep(b.hv, b.n, dt, in1, meas1, u_hv);
+    lanesStep(b.vh, b.n, dt, in2, meas2, u_vh);
+    lanesStep(b.vv, b.n, dt, in2, meas2, u_vv);
+
+    sumSaturate(b.n, u_hh, u_vh, b.Uh_max, out1);
+    sumSaturate(b.n, u_hv, u_vv, b.Uv_max, out2);
+}
+
+void PID4Batch_track(PID4Batch &b, const float *excess1, const float *excess2, float dt)
+{
+    if (dt <= 0.0f) dt = 0.001f;
+    trackStep(b.n, dt, excess1, b.hh.Kt, b.hh.Isat, b.hh.integrator);
+    trackStep(b.n, dt, excess1, b.vh.Kt, b.vh.Isat, b.vh.integrator);
+    trackStep(b.n, dt, excess2, b.hv.Kt, b.hv.Isat, b.hv.integrator);
+    trackStep(b.n, dt, excess2, b.vv.Kt, b.vv.Isat, b.vv.integrator);
+}
@@ -0,0 +1,109 @@
+/* Esta librería, junto con su correspondiente "PID_Batch.cpp", evalúa muchos PID-4 (o PID sueltos) a
+la vez, en paso fijo común, para barridos de ganancias y ensayos de Monte-Carlo en el host. Guarda
+parámetros y estados como estructura de arrays (un array por campo, un elemento por controlador o
+"carril"), así que cada paso es un bucle sin ramas por campo que el compilador vectoriza (SSE/AVX en
+el host; en x86 con GCC se genera además una versión AVX2 que se elige al arrancar).
+
+Calcula exactamente lo mismo que la variante por defecto del PID (DerivativeSelectable +
+BackCalculation + LowPassRuntime, ver "PID_Template.h"), operación por operación: cada carril da,
+bit a bit, las mismas salidas que PID_Update / PID4_Update con los mismos parámetros. trms_batch_compare
+(host/) lo comprueba carril a carril */
+
+// PID_Batch.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "PID_Control.h"
+
+// El lote reproduce la variante por defecto; con otras políticas (build_flags) ya no coincide
+static constexpr bool PID_BATCH_MATCHES_SCALAR =
+    std::is_same<PIDState, Pid<float, DerivativeSelectable, BackCalculation, LowPassRuntime>>::value;
+
+/**
+ * @brief Un PID por carril (estructura de arrays de n elementos).
+ *
+ * Ganancias como en PidGains; derivOnMeas es 0/1 en float para que el
+ * bucle no mezcle tipos. hasPrev = 0 tras el reset (la primera muestra no
+ * tiene derivada).
+ */
+struct PIDBatchLanes {
+    float *Kp;
+    float *Ki;
+    float *Kd;
+    float *Isat;
+    float *Tf;
+    float *Kt;
+    float *derivOnMeas;
+
+    float *integrator;
+    float *prevInput;
+    float *prevMeas;
+    float *filterY;
+    float *hasPrev;
+};
+
+/**
+ * @brief Lote de PID-4 (mismo reparto que Pid4: hh, hv con in1; vh, vv con in2).
+ */
+struct PID4Batch {
+    size_t        n;
+    PIDBatchLanes hh;
+    PIDBatchLanes hv;
+    PIDBatchLanes vh;
+    PIDBatchLanes vv;
+    float        *Uh_max;
+    float        *Uv_max;
+
+    float        *work[4]; // parciales cuando quien llama no las pide
+    void         *block;   // memoria de todos los arrays (PID4Batch_free)
+};
+
+// Salidas parciales por carril (arrays de n elementos; cualquiera puede ser nullptr)
+struct PID4BatchPartials {
+    float *u_hh;
+    float *u_hv;
+    float *u_vh;
+    float *u_vv;
+};
+
+/**
+ * @brief Reserva un lote de n carriles con ganancias a cero y estados reseteados.
+ *
+ * Cada array empieza alineado a 64 bytes.
+ *
+ * @return false si no hay memoria
+ */
+bool PID4Batch_init(PID4Batch &b, size_t n);
+void PID4Batch_free(PID4Batch &b);
+
+// Copia los parámetros de un PID-4 a un carril (no toca su estado)
+void PID4Batch_setLane(PID4Batch &b, size_t lane, const PID4Params &p);
+
+// Resetea los estados de todos los carriles (como PID4_Reset en cada uno)
+void PID4Batch_reset(PID4Batch &b);
+
+/**
+ * @brief Un paso de todos los carriles (PID4_Update en cada uno).
+ *
+ * @param in1, in2      Errores horizontal y vertical por carril
+ * @param dt            Tiempo de muestreo común [s] (<= 0 -> 1 ms, como Pid)
+ * @param out1, out2    Uh, Uv saturadas por carril
+ * @param parts         (opcional) salidas parciales
+ * @param meas1, meas2  Medidas (derivada de la medida; nullptr = 0, como en PID4_Update)
+ */
+void PID4Batch_update(PID4Batch &b, const float *in1, const float *in2, float dt,
+                      float *out1, float *out2, const PID4BatchPartials *parts = nullptr,
+                      const float *meas1 = nullptr, const float *meas2 = nullptr);
+
+// Anti-windup por seguimiento de todos los carriles (PID4_Track en cada uno)
+void PID4Batch_track(PID4Batch &b, const float *excess1, const float *excess2, float dt);
+
+/**
+ * @brief Un paso de n PID sueltos (PID_Update en cada carril).
+ *
+ * @param meas  nullptr = 0
+ */
+void PIDBatch_update(PIDBatchLanes &l, size_t n, const float *in, float dt,
+                     const float *meas, float *out);
@@ -0,0 +1,378 @@
+/* Esta librería, junto con su correspondiente "PID_Bench.h", mide el coste de los núcleos del PID
+con entradas fijas (ver PID_Bench.h) */
+
+// PID_Bench.cpp
+#include "PID_Bench.h"
+#include "PID_Control.h"
+#include "PID_Kernels.h"
+#include "PID_Fixed.h"
+#include "PID_Batch.h"
+#include "Profiler.h"
+#include "HAL.h"
+
+// Sumideros: impiden que el compilador descarte los resultados
+static volatile float s_sinkF = 0.0f;
+static volatile int   s_sinkI = 0;
+
+// Entradas fijas (16 por caso, el índice avanza con la iteración)
+static const uint32_t INPUT_MASK = 15;
+
+// Errores pequeños [rad]: sin saturación
+static const float ERR_SMALL_RAD[16] = {
+     0.010f, -0.020f,  0.035f, -0.005f,  0.050f, -0.040f,  0.015f, -0.030f,
+     0.025f, -0.010f,  0.045f, -0.050f,  0.005f, -0.015f,  0.030f, -0.025f
+};
+
+// Errores grandes y del mismo signo [rad]: integrador y salidas saturados
+static const float ERR_BIG_RAD[16] = {
+     0.60f, 0.80f, 1.00f, 0.70f, 0.90f, 0.65f, 0.85f, 0.75f,
+     0.95f, 0.55f, 0.60f, 0.80f, 1.00f, 0.70f, 0.90f, 0.65f
+};
+
+// Los mismos errores pequeños en cuentas (2000 cuentas/vuelta)
+static const int16_t ERR_SMALL_COUNTS[16] = {
+     3, -6, 11, -2, 16, -13, 5, -10, 8, -3, 14, -16, 2, -5, 10, -8
+};
+
+// Salidas U en distintas zonas de U_to_Register
+static const float U_IN_RANGE[16] = {
+     0.10f, -0.25f,  0.50f, -0.75f,  0.90f, -0.05f,  0.33f, -0.66f,
+     0.20f, -0.40f,  0.60f, -0.80f,  0.15f, -0.35f,  0.55f, -0.95f
+};
+static const float U_SAT[16] = {
+     1.50f, -2.00f,  3.00f, -1.20f,  2.50f, -3.30f,  1.10f, -1.75f,
+     2.20f, -2.80f,  1.40f, -1.90f,  3.10f, -2.60f,  1.30f, -1.05f
+};
+
+// Errores en grados para las lógicas de salida
+static const float ERR_DB_V_DEG[16] = {     // |err| < 0.1
+     0.02f, -0.05f,  0.08f, -0.01f,  0.04f, -0.09f,  0.06f, -0.03f,
+     0.01f, -0.07f,  0.09f, -0.02f,  0.05f, -0.04f,  0.03f, -0.08f
+};
+static const float ERR_DB_DOWN_DEG[16] = {  // |err| < 1.0
+     0.20f, -0.50f,  0.80f, -0.10f,  0.40f, -0.90f,  0.60f, -0.30f,
+     0.10f, -0.70f,  0.90f, -0.20f,  0.50f, -0.40f,  0.30f, -0.80f
+};
+static const float ERR_POS_DEG[16] = {
+     1.0f, 3.0f, 5.0f, 8.0f, 12.0f, 2.0f, 4.0f, 6.0f,
+     9.0f, 15.0f, 1.5f, 3.5f, 5.5f, 7.5f, 10.0f, 20.0f
+};
+static const float ERR_NEG_DEG[16] = {
+    -1.0f, -3.0f, -5.0f, -8.0f, -12.0f, -2.0f, -4.0f, -6.0f,
+    -9.0f, -15.0f, -1.5f, -3.5f, -5.5f, -7.5f, -10.0f, -20.0f
+};
+static const float ERR_DB_H_DEG[16] = {     // |err| < 0.15 (y < 0.6 para aprender)
+     0.03f, -0.06f,  0.10f, -0.02f,  0.05f, -0.12f,  0.08f, -0.04f,
+     0.01f, -0.09f,  0.13f, -0.03f,  0.07f, -0.05f,  0.04f, -0.11f
+};
+static const float ERR_MIX_DEG[16] = {
+     2.0f, -4.0f,  6.0f, -1.0f,  8.0f, -10.0f,  3.0f, -5.0f,
+     1.0f, -2.0f,  12.0f, -6.0f,  4.0f, -8.0f,  0.5f, -0.7f
+};
+static const float MEAS_V_DEG[16] = {       // alrededor de la banda -37..-36
+   -30.0f, -40.0f, -36.5f, -35.0f, -38.0f, -36.2f, -33.0f, -42.0f,
+   -36.8f, -31.0f, -39.0f, -36.4f, -34.0f, -45.0f, -36.9f, -28.0f
+};
+static const float REF_H_JUMP_DEG[16] = {   // saltos > 2° entre muestras
+     0.0f, 35.0f, -35.0f, 10.0f, -10.0f, 20.0f, -20.0f, 5.0f,
+    -5.0f, 30.0f, -30.0f, 15.0f, -15.0f, 25.0f, -25.0f, 0.0f
+};
+static const int DELTA_REG[16] = {
+     5, -10, 20, -3, 40, -60, 12, -25, 8, -15, 30, -45, 2, -8, 55, -90
+};
+
+// Ganancias de PID_LoadDefaults
+static const PIDParams P_HH = { 2.196f, 1.394f, 1.98f, 1.87f };
+static const PIDParams P_HV = { 0.2321f, 0.1f, 0.1f, 1.0f };
+static const PIDParams P_VH = { 0.0451f, 0.021f, 0.0f, 1.0f };
+static const PIDParams P_VV = { 1.1f, 0.0f, 0.0f, 1.3f };
+static const PIDParams P_ZERO = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+static PIDState  s_pidState;
+static PID4State s_pid4State;
+
+// PID-4 en coma fija (ganancias de P_HH..P_VV reescaladas en PIDBench_prepare)
+static const float BENCH_DEG_PER_COUNT = 360.0f / 2000.0f;
+static PID4FixedParams s_pid4FixedParams;
+static PID4FixedState  s_pid4FixedState;
+
+// ------------------------------------------------------------
+// PID_Update
+// ------------------------------------------------------------
+
+static void runPidNominal(uint32_t n)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        acc += PID_Update(P_HH, s_pidState, ERR_SMALL_RAD[i & INPUT_MASK], 0.005f);
+    }
+    s_sinkF = acc;
+}
+
+static void runPidIsat(uint32_t n)
+{
+    static const PIDParams p = { 2.0f, 5.0f, 0.5f, 0.2f };
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        acc += PID_Update(p, s_pidState, ERR_BIG_RAD[i & INPUT_MASK], 0.005f);
+    }
+    s_sinkF = acc;
+}
+
+static void runPidNoIsat(uint32_t n)
+{
+    static const PIDParams p = { 2.0f, 1.0f, 0.5f, 0.0f };
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        acc += PID_Update(p, s_pidState, ERR_SMALL_RAD[i & INPUT_MASK], 0.005f);
+    }
+    s_sinkF = acc;
+}
+
+// ------------------------------------------------------------
+// PID4_Update
+// ------------------------------------------------------------
+
+static void runPid4(const PID4Params &p, const float *in, uint32_t n)
+{
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        float e = in[i & INPUT_MASK];
+        float out1, out2;
+        PID4_Update(p, s_pid4State, e, -0.5f * e, 0.005f, out1, out2);
+        acc += out1 + out2;
+    }
+    s_sinkF = acc;
+}
+
+static void runPid4Mimo(uint32_t n)
+{
+    static const PID4Params p = { P_HH, P_HV, P_VH, P_VV, 1.0f, 1.0f };
+    runPid4(p, ERR_SMALL_RAD, n);
+}
+
+static void runPid4VerticalOnly(uint32_t n)
+{
+    static const PID4Params p = { P_ZERO, P_ZERO, P_ZERO, P_VV, 1.0f, 1.0f };
+    runPid4(p, ERR_SMALL_RAD, n);
+}
+
+static void runPid4HorizontalOnly(uint32_t n)
+{
+    static const PID4Params p = { P_HH, P_ZERO, P_ZERO, P_ZERO, 1.0f, 1.0f };
+    runPid4(p, ERR_SMALL_RAD, n);
+}
+
+static void runPid4OutSat(uint32_t n)
+{
+    static const PID4Params p = { P_HH, P_HV, P_VH, P_VV, 0.3f, 0.3f };
+    runPid4(p, ERR_BIG_RAD, n);
+}
+
+// ------------------------------------------------------------
+// PID-4 en coma fija (cuentas -> unidades de registro)
+// ------------------------------------------------------------
+
+static void runPid4Fixed(uint32_t n)
+{
+    static const Q16 dt = Q16(0.005);
+    int32_t acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        Q16 e = Q16::fromInt(ERR_SMALL_COUNTS[i & INPUT_MASK]);
+        Q16 out1, out2;
+        PID4Fixed_Update(s_pid4FixedParams, s_pid4FixedState, e, -(e * Q16(0.5)), dt, out1, out2);
+        acc += PID4Fixed_ToRegister(out1) + PID4Fixed_ToRegister(out2);
+    }
+    s_sinkI = acc;
+}
+
+// ------------------------------------------------------------
+// Lote de PID-4 (PID_Batch): una iteración = un carril
+// ------------------------------------------------------------
+
+static const uint32_t BATCH_LANES = 16;
+static PID4Batch s_batch;   // se reserva en el primer PIDBench_prepare
+static float     s_batchIn1[BATCH_LANES], s_batchIn2[BATCH_LANES];
+static float     s_batchOut1[BATCH_LANES], s_batchOut2[BATCH_LANES];
+
+static void runPid4Batch(uint32_t n)
+{
+    if (!s_batch.block) return;
+    float acc = 0.0f;
+    for (uint32_t i = 0; i < n; i += BATCH_LANES) {
+        PID4Batch_update(s_batch, s_batchIn1, s_batchIn2, 0.005f, s_batchOut1, s_batchOut2);
+        acc += s_batchOut1[i & INPUT_MASK] + s_batchOut2[i & INPUT_MASK];
+    }
+    s_sinkF = acc;
+}
+
+// ------------------------------------------------------------
+// U_to_Register
+// ------------------------------------------------------------
+
+static void runURegister(const float *in, float Umax, uint32_t n)
+{
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        acc += U_to_Register(in[i & INPUT_MASK], Umax);
+    }
+    s_sinkI = acc;
+}
+
+static void runURegInRange(uint32_t n) { runURegister(U_IN_RANGE, 1.0f, n); }
+static void runURegSat(uint32_t n)     { runURegister(U_SAT, 1.0f, n); }
+static void runURegUmax0(uint32_t n)   { runURegister(U_IN_RANGE, 0.0f, n); }
+
+// ------------------------------------------------------------
+// Lógicas de salida
+// ------------------------------------------------------------
+
+static void runVertUp(const float *err, uint32_t n)
+{
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        acc += ApplyVerticalUnidirectionalControl_Up(DELTA_REG[i & INPUT_MASK], err[i & INPUT_MASK]);
+    }
+    s_sinkI = acc;
+}
+
+static void runVertDown(const float *err, uint32_t n)
+{
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        acc += ApplyVerticalUnidirectionalControl_Down(DELTA_REG[i & INPUT_MASK], err[i & INPUT_MASK]);
+    }
+    s_sinkI = acc;
+}
+
+static void runVertUpDeadband(uint32_t n)   { runVertUp(ERR_DB_V_DEG, n); }
+static void runVertUpOver(uint32_t n)       { runVertUp(ERR_NEG_DEG, n); }
+static void runVertUpUnder(uint32_t n)      { runVertUp(ERR_POS_DEG, n); }
+static void runVertDownDeadband(uint32_t n) { runVertDown(ERR_DB_DOWN_DEG, n); }
+static void runVertDownPush(uint32_t n)     { runVertDown(ERR_NEG_DEG, n); }
+static void runVertDownRelease(uint32_t n)  { runVertDown(ERR_POS_DEG, n); }
+
+static void runBandHold(uint32_t n)
+{
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i & INPUT_MASK;
+        acc += ApplyVerticalBandHold(DELTA_REG[k], -36.5f - MEAS_V_DEG[k], MEAS_V_DEG[k]);
+    }
+    s_sinkI = acc;
+}
+
+static void runHoriz(const float *err, const float *ref, float refConst, uint32_t n)
+{
+    int acc = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i & INPUT_MASK;
+        acc += ApplyHorizontalBidirectionalControl(DELTA_REG[k], err[k], ref ? ref[k] : refConst);
+    }
+    s_sinkI = acc;
+}
+
+static void runHorizDeadband(uint32_t n) { runHoriz(ERR_DB_H_DEG, nullptr, 30.0f, n); }
+static void runHorizTrack(uint32_t n)    { runHoriz(ERR_MIX_DEG, nullptr, 30.0f, n); }
+static void runHorizRefJump(uint32_t n)  { runHoriz(ERR_MIX_DEG, REF_H_JUMP_DEG, 0.0f, n); }
+
+// ------------------------------------------------------------
+// Tabla de casos
+// ------------------------------------------------------------
+
+static const PIDBenchCase CASES[] = {
+    { "pid_update/nominal",          runPidNominal },
+    { "pid_update/isat_clamp",       runPidIsat },
+    { "pid_update/no_isat",          runPidNoIsat },
+    { "pid4_update/mimo_full",       runPid4Mimo },
+    { "pid4_update/vertical_only",   runPid4VerticalOnly },
+    { "pid4_update/horizontal_only", runPid4HorizontalOnly },
+    { "pid4_update/out_sat",         runPid4OutSat },
+    { "pid4_fixed/mimo_full",        runPid4Fixed },
+    { "pid4_batch/mimo_full",        runPid4Batch },
+    { "u_to_register/in_range",      runURegInRange },
+    { "u_to_register/sat",           runURegSat },
+    { "u_to_register/umax0",         runURegUmax0 },
+    { "vert_up/deadband",            runVertUpDeadband },
+    { "vert_up/over",                runVertUpOver },
+    { "vert_up/under",               runVertUpUnder },
+    { "vert_down/deadband",          runVertDownDeadband },
+    { "vert_down/push",              runVertDownPush },
+    { "vert_down/release",           runVertDownRelease },
+    { "vert_band_hold/mixed",        runBandHold },
+    { "horiz/deadband_learn",        runHorizDeadband },
+    { "horiz/tracking",              runHorizTrack },
+    { "horiz/ref_jump",              runHorizRefJump },
+};
+
+static const size_t CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+size_t PIDBench_caseCount()
+{
+    return CASE_COUNT;
+}
+
+const PIDBenchCase &PIDBench_case(size_t i)
+{
+    return CASES[(i < CASE_COUNT) ? i : 0];
+}
+
+void PIDBench_prepare(size_t i)
+{
+    (void)i;
+    PID_Reset(s_pidState);
+    PID4_Reset(s_pid4State);
+    PID4_ResetShapingState();
+
+    static const PID4Params p = { P_HH, P_HV, P_VH, P_VV, 1.0f, 1.0f };
+    PID4Fixed_FromFloat(p, BENCH_DEG_PER_COUNT, BENCH_DEG_PER_COUNT, s_pid4FixedParams);
+    s_pid4FixedState.reset();
+
+    if (!s_batch.block && !PID4Batch_init(s_batch, BATCH_LANES)) return;
+    for (uint32_t k = 0; k < BATCH_LANES; k++) {
+        PID4Batch_setLane(s_batch, k, p);
+        s_batchIn1[k] = ERR_SMALL_RAD[k & INPUT_MASK];
+        s_batchIn2[k] = -0.5f * s_batchIn1[k];
+    }
+    PID4Batch_reset(s_batch);
+}
+
+/**
+ * @brief
+ * Mide todos los casos con el contador de Profiler_now().
+ * @note
+ * Cada caso se ejecuta una vez en frío (n/8 iteraciones, para llenar cachés y
+ * la tabla de entradas) y luego se mide con n iteraciones.
+ */
+bool PIDBench_run(uint32_t iterations)
+{
+    if (PID4_IsEnabled()) {
+        HAL_logf("[BENCH] Deshabilita el PID antes de medir (comparte estado con el lazo)\n");
+        return false;
+    }
+    if (iterations == 0) iterations = 1;
+
+    const float nsPerTick = 1000.0f / Profiler_ticksPerUs();
+
+    // La lógica de subida aprende el mapa de equilibrio: se guarda y se repone al final
+    static EqMap ffMap;
+    PID4_GetVerticalFeedforwardMap(ffMap);
+
+    HAL_logf("[BENCH] %lu iteraciones por caso\n", (unsigned long)iterations);
+    HAL_logf("%-28s %10s\n", "caso", "ns/iter");
+
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        PIDBench_prepare(i);
+        CASES[i].run(iterations / 8 + 1);
+
+        uint32_t t0 = Profiler_now();
+        CASES[i].run(iterations);
+        uint32_t ticks = Profiler_now() - t0;
+
+        HAL_logf("%-28s %10.1f\n", CASES[i].name, (float)ticks * nsPerTick / (float)iterations);
+    }
+
+    PID4_ResetShapingState();
+    PID4_SetVerticalFeedforwardMap(ffMap);
+    return true;
+}
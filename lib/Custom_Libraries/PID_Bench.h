@@ -0,0 +1,41 @@
+/* Esta librería, junto con su correspondiente "PID_Bench.cpp", mide el coste de los núcleos del PID
+(PID_Update, PID4_Update, su variante en coma fija y el lote en estructura de arrays, U_to_Register y
+las lógicas de salida) con entradas fijas que recorren cada modo y cada camino de saturación. La misma
+tabla de casos se usa en el ESP32 (comando serie "bench", contador de ciclos) y en el micro-benchmark
+de host/ (Google Benchmark) */
+
+// PID_Bench.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Caso de medida.
+ *
+ * run(n) ejecuta n iteraciones del núcleo recorriendo una tabla fija de
+ * entradas (16 valores) y deja el resultado en un sumidero volatile para que
+ * el compilador no elimine el cálculo.
+ */
+struct PIDBenchCase {
+    const char *name;
+    void      (*run)(uint32_t iterations);
+};
+
+// Número de casos y acceso a la tabla
+size_t PIDBench_caseCount();
+const PIDBenchCase &PIDBench_case(size_t i);
+
+// Prepara un caso (estado del PID y bases aprendidas a cero)
+void PIDBench_prepare(size_t i);
+
+/**
+ * @brief Mide todos los casos e imprime ns por iteración (HAL_logf).
+ *
+ * Las lógicas de salida guardan estado compartido con el lazo de control, así
+ * que no se ejecuta con el PID-4 habilitado. Al terminar deja las bases
+ * aprendidas a cero.
+ *
+ * @return false si el PID-4 está habilitado
+ */
+bool PIDBench_run(uint32_t iterations);
@@ -12,8 +12,11 @@
             vh: ev -> Uh
             vv: ev -> Uv
         y dos salidas:
-            Uh -> rotor de cola (horizontal)  -> Registro_RDC
-            Uv -> motor principal (vertical) -> Registro_MP
+            Uh -> rotor de cola (horizontal)  -> regRDC
+            Uv -> motor principal (vertical) -> regMP
+
+        Los registros se escriben en los DACs y se publican en la telemetría;
+        la interfaz refleja Registro_MP / Registro_RDC a partir de ella.
 
     ------------------------------------------------------------------------------------
     CAMBIO IMPORTANTE (NUEVO)
@@ -22,9 +25,14 @@
 
       - PIDMode::MIMO_FULL       -> usa hh, hv, vh, vv (el 2x2 completo)
       - PIDMode::VERTICAL_ONLY   -> SOLO usa vv (ev -> Uv). El resto de PIDs se anulan (K=0) y se resetean.
-                                  Además fuerza Registro_RDC = 0.
+                                  Además fuerza regRDC = 0.
       - PIDMode::HORIZONTAL_ONLY -> SOLO usa hh (eh -> Uh). El resto de PIDs se anulan (K=0) y se resetean.
-                                  Además fuerza Registro_MP = 0.
+                                  Además fuerza regMP = 0.
+      - PIDMode::CASCADE         -> el 2x2 completo, pero sus registros son consignas de velocidad de los
+                                  rotores (% de rpmMax); un PI por motor sobre el tacómetro da el registro
+                                  final (ver PID4_ApplyCascadeUnlocked).
+      - PIDMode::STATE_FEEDBACK  -> LQI sobre el estado estimado por el observador (StateFeedback.h) en lugar
+                                  del PID-4; sin lógicas de salida. Sin estimación válida hace de MIMO_FULL.
 
     ¿Por qué hay que anular PIDs y resetear estado?
       Porque aunque “no uses” una salida, si dejas integradores/derivadas vivos,
@@ -34,9 +42,9 @@
     NOTA
     ------------------------------------------------------------------------------------
     Este fichero asume que en PID_Control.h existen (o se han añadido):
-      - struct PIDParams, PIDState
-      - struct PID4Params { PIDParams vv, hv, vh, hh; float Uv_max, Uh_max; }
-      - struct PID4State  { PIDState  vv, hv, vh, hh; }
+      - PIDParams, PIDState (alias de PidGains<float> / Pid<float, ...>, ver PID_Template.h)
+      - PID4Params { PIDParams hh, hv, vh, vv; float Uh_max, Uv_max; }
+      - PID4State  { PIDState  hh, hv, vh, vv; }
       - struct PID_CURR con los parámetros actuales (Kp..Ki..Kd..Isat..Umax)
       - enum class PIDMode { MIMO_FULL, VERTICAL_ONLY, HORIZONTAL_ONLY };
       - void PID4_SetMode(PIDMode mode);
@@ -45,22 +53,26 @@
 */
 
 #include "PID_Control.h"
+#include "PID_Kernels.h"
+#include "PID_Fixed.h"
 #include "Encoders.h"
 #include "PID_Parameters.h"
 #include "MotorControl.h"
+#include "Profiler.h"
+#include "HAL.h"
+#include "SpscRing.h"
+#include "StateFeedback.h"
+#ifndef TRMS_NATIVE
 #include "ui.h"
+#endif
 
-#include <Arduino.h>
 #include <math.h>
+#include <atomic>
 
 #ifndef DEG_TO_RAD
 #define DEG_TO_RAD 0.01745329251994329577f   // pi/180
 #endif
 
-// Registros globales (salidas normalizadas -100..100)
-extern int Registro_MP;   // Motor principal (vertical)
-extern int Registro_RDC;  // Rotor de cola (horizontal)
-
 static constexpr float V_BIAS_REL_K     = 0.1f;  // [reg/deg] cuánto se reduce el bias cuando err<0
 
 enum class VertRefZone {
@@ -76,12 +88,18 @@ static constexpr float V_REST_LOW_DEG  = -37.0f;
 static constexpr float V_REST_HIGH_DEG = -36.0f;
 
 // -----------------------------------------------------
-// Bias vertical (registro que "sostiene" el ángulo)
+// Feedforward vertical: mapa de equilibrio (ver "EquilibriumMap.h")
 // -----------------------------------------------------
-// Voltaje de offset (o bias) para mantener el sistema estable en un posición diferente a la de reposo
-//PID4_SetVerticalEquilibriumRegister(0).
-static int s_MP_eq = 53;   // valor experimental de equilibrio (ajustable)
-//54 era el valor antiguo
+// Registro que "sostiene" la viga en cada ángulo (sustituye al antiguo bias fijo
+// s_MP_eq = 53). Recta de partida: con el reposo en -36° el registro necesario
+// crece con el ángulo; 22 en -30° y 53 en 0° (el valor experimental de antes).
+static constexpr float V_FF_MP_AT_THRESHOLD = 22.0f;          // [reg] en -30°
+static constexpr float V_FF_SLOPE_UP        = 31.0f / 30.0f;  // [reg/deg] por encima de -30°
+static constexpr float V_FF_SLOPE_DOWN      = 3.0f;           // [reg/deg] por debajo de -30° (hacia el reposo)
+static constexpr float V_FF_ALPHA           = 0.005f;         // aprendizaje por muestra asentada
+
+static EqMapPrior s_ffPrior = { V_FF_MP_AT_THRESHOLD, V_FF_SLOPE_UP, V_FF_SLOPE_DOWN };
+static EqMap      s_ffMap;   // version = 0 hasta el primer uso (se rellena con la recta)
 // -----------------------------------------------------
 // Parámetros para la lógica "Opción B" (unidireccional + modulación)
 // -----------------------------------------------------
@@ -95,6 +113,48 @@ static constexpr float V_HYST_DEG     = 1.0f;   // histéresis para no estar cam
 static constexpr float V_BIG_ERR_DEG  = 20.0f;  // si |error| > esto, se permite invertir
 static constexpr float V_ERR_DB_DEG   = 0.1f;  // deadband alrededor de consigna (evita caza)
 static constexpr float V_ERR_DB_DEG_DOWN   = 1.0f;  // deadband alrededor de consigna (evita caza)
+
+// -----------------------------------------------------
+// Tablas de ganancias por punto de funcionamiento (ver "GainSchedule.h")
+// -----------------------------------------------------
+// Las de por defecto reproducen las constantes fijas de antes:
+//  - SHAPE_H: deltaRDC x0.80 con |refH| <= 35°, x0.65 por debajo de -35° y sin
+//    reducir por encima de 35° (entre 35° y 36° en valor absoluto se interpola)
+//  - SHAPE_V: MIN_OUT, V_BIAS_REL_K, Kbase_down y Kbase_up constantes
+//  - PID_*: sin tabla (ganancias de PID_CURR tal cual)
+static constexpr float K_RDC_NEAR0       = 0.80f; // prueba 0.75..0.90
+static constexpr float K_RDC_NEG         = 0.65f;
+static constexpr int   V_UP_MIN_OUT      = 15;    // nunca bajar de este registro (subida)
+static constexpr int   V_UP_MAX_CUT      = 30;    // recorte máximo por “pasarte” (subida)
+static constexpr int   V_DOWN_BASE_MIN   = -60;   // límite más negativo de la base de bajada
+static constexpr float V_DOWN_KBASE_DOWN = 0.15f; // base de bajada cuando err<0: más negativa (0.05..0.3)
+static constexpr float V_DOWN_KBASE_UP   = 0.05f; // base de bajada cuando err>0: hacia 0 (0.1..0.8)
+
+static const GsTableSpec GS_DEFAULT_SHAPE_H = { GsIndex::REF_H, 4, {
+    { -36.0f, { K_RDC_NEG,   0.0f, 0.0f, 0.0f } },
+    { -35.0f, { K_RDC_NEAR0, 0.0f, 0.0f, 0.0f } },
+    {  35.0f, { K_RDC_NEAR0, 0.0f, 0.0f, 0.0f } },
+    {  36.0f, { 1.0f,        0.0f, 0.0f, 0.0f } },
+} };
+
+static const GsTableSpec GS_DEFAULT_SHAPE_V = { GsIndex::REF_V, 1, {
+    { 0.0f, { (float)V_UP_MIN_OUT, V_BIAS_REL_K, V_DOWN_KBASE_DOWN, V_DOWN_KBASE_UP } },
+} };
+
+// Parámetros de las lógicas verticales en el punto de funcionamiento actual
+struct VertShapeParams {
+    int   minOut;      // MIN_OUT de la subida
+    float biasRelK;    // [reg/deg] freno al pasarte (subida)
+    float kBaseDown;   // adaptación de la base de bajada
+    float kBaseUp;
+};
+
+static VertShapeParams s_vShape = { V_UP_MIN_OUT, V_BIAS_REL_K, V_DOWN_KBASE_DOWN, V_DOWN_KBASE_UP };
+
+static GsTable s_sched[GS_TABLE_COUNT];
+static GsTable s_schedScratch;              // rejilla en preparación (fuera de la sección crítica)
+static bool    s_schedLoaded    = false;
+static bool    s_schedPidActive = false;    // alguna tabla PID_* instalada
 // -----------------------------------------------------
 // Estado global del PID-4
 // -----------------------------------------------------
@@ -106,11 +166,135 @@ static bool  s_pid4_enabled = false;
 static float s_refVertDeg   = 0.0f; // ref display (grados)
 static float s_refHorDeg    = 0.0f; // ref display (grados)
 
-static uint32_t last = 0;
+// Consignas pedidas (PID4_SetReferences). Con trayectoria, s_refVertDeg y
+// s_refHorDeg las recorren paso a paso; sin ella son las mismas
+static float      s_goalVertDeg = 0.0f;
+static float      s_goalHorDeg  = 0.0f;
+static TrajLimits s_trajLimV    = { 0.0f, 0.0f, 0.0f };   // desactivada por defecto
+static TrajLimits s_trajLimH    = { 0.0f, 0.0f, 0.0f };
+static TrajAxis   s_trajV;
+static TrajAxis   s_trajH;
+
+// Grados por cuenta de los encoders (PID4_SetEncoderScale; 2000 cuentas/vuelta por defecto)
+static float s_degPerCountV = 0.18f;
+static float s_degPerCountH = 0.18f;
+
+#if PID_FIXED_POINT
+// PID-4 en coma fija: parámetros reescalados y consignas en cuentas
+static PID4FixedParams s_pid4_fixed_params;
+static PID4FixedState  s_pid4_fixed_state;
+static Q16             s_refVertCounts;
+static Q16             s_refHorCounts;
+#endif
+
+// Última medida recibida (también con el PID deshabilitado), para la transferencia sin salto
+static float   s_lastMeasVertDeg = 0.0f;
+static float   s_lastMeasHorDeg  = 0.0f;
+static int16_t s_lastCountV      = 0;
+static int16_t s_lastCountH      = 0;
 
 // Modo de control (nuevo)
 static PIDMode s_pidMode = PIDMode::MIMO_FULL;
 
+// -----------------------------------------------------
+// Lazos internos de velocidad (modo CASCADE)
+// -----------------------------------------------------
+// Consigna y medida en % de rpmMax, salida en registro: reg = consigna + PI.
+// El término directo hace que, con el rotor en régimen (velocidad = registro),
+// el PI solo corrija la diferencia; con el PI recién reseteado no hay salto.
+struct SpeedLoop {
+    PIDParams g;
+    PIDState  pi;
+    float     rpmMax;   // [rpm] con registro 100
+    float     filt;     // velocidad filtrada [%]
+    bool      first;    // el filtro arranca en la primera medida
+};
+
+static SpeedLoop s_speedMP;
+static SpeedLoop s_speedRDC;
+static float     s_speedTf   = 0.0f;   // filtro de los tacómetros [s]
+static float     s_rpmMeasMP  = 0.0f;  // última medida (PID4_SetRotorSpeeds) [rpm]
+static float     s_rpmMeasRDC = 0.0f;
+
+// Observador de estado (ver "StateObserver.h"): estimación del paso en curso
+static ObserverEstimate s_obsEst      = {};
+static bool             s_obsDerivative = false;   // derivada de la medida sobre los ángulos filtrados
+
+// Integrales del LQI (modo STATE_FEEDBACK)
+static SfState s_sf = { 0.0f, 0.0f };
+
+// -----------------------------------------------------
+// Memoria de las lógicas de salida (bases adaptativas)
+// -----------------------------------------------------
+// Antes eran variables static dentro de cada función; se sacan aquí para
+// poder reiniciarlas (PID4_ResetShapingState) entre ensayos del simulador.
+struct VertUpShapeState {
+    int   targetBase;
+    int   stableCount;
+    float lastMeasDeg;
+};
+
+struct VertDownShapeState {
+    int targetBase;
+};
+
+struct HorizShapeState {
+    int   baseH;
+    float lastRefH;
+    bool  inited;
+    int   stableCount;
+};
+
+// Transferencia sin salto: lo que no absorben los integradores se suma a los
+// registros como un offset que se desvanece (ver PID4_BumplessUnlocked)
+struct TransferState {
+    bool  pending;     // calcular el offset en el próximo paso
+    int   fromMP;      // registros aplicados al hacer la transferencia
+    int   fromRDC;
+    float offMP;       // offset actual [reg]
+    float offRDC;
+};
+
+static constexpr float TRANSFER_TAU_S = 1.0f;   // constante de tiempo del offset
+
+static TransferState s_transfer = { false, 0, 0, 0.0f, 0.0f };
+
+static VertUpShapeState   s_shapeUp   = { 0, 0, 0.0f };
+static VertDownShapeState s_shapeDown = { 0 };
+static HorizShapeState    s_shapeH    = { 0, 0.0f, false, 0 };
+
+// -----------------------------------------------------
+// Ganancias en marcha (doble buffer)
+// -----------------------------------------------------
+// La interfaz escribe el hueco libre y publica una generación nueva; el paso
+// de control la aplica entre muestras, sin resetear estados, y anota en
+// s_gainLog en qué muestra entró. La interfaz no toma el lock: solo vuelve a
+// publicar cuando el paso ya ha aplicado la generación anterior.
+static PID_CURR              s_gainSlot[2];
+static std::atomic<uint32_t> s_gainPublished(0);   // solo la escribe la interfaz
+static std::atomic<uint32_t> s_gainApplied(0);     // solo la escribe el paso de control
+static bool                  s_gainReload = false; // generación de PID4_LoadFromCurr (ya aplicada)
+static uint32_t              s_stepSample = 0;     // pasos con el PID habilitado
+
+static SpscRing<PID4GainEvent, PID4_GAIN_LOG_CAPACITY> s_gainLog;
+
+// -----------------------------------------------------
+// Sección crítica
+// -----------------------------------------------------
+// El paso de control se ejecuta en la tarea de control (ControlTask, núcleo 1),
+// mientras que referencias, modo, ganancias y resets llegan desde la tarea de
+// interfaz (núcleo 0). El spinlock protege el estado del PID-4 entre ambas.
+// Dentro de la sección crítica solo hay aritmética: ni I2C, ni DAC, ni LVGL.
+// En la compilación nativa todo corre en un solo hilo y el lock no hace nada.
+#ifdef ARDUINO
+static portMUX_TYPE s_pidMux = portMUX_INITIALIZER_UNLOCKED;
+#define PID_LOCK()   portENTER_CRITICAL(&s_pidMux)
+#define PID_UNLOCK() portEXIT_CRITICAL(&s_pidMux)
+#else
+#define PID_LOCK()   do {} while (0)
+#define PID_UNLOCK() do {} while (0)
+#endif
+
 /**
  * @brief
  * Obtiene los ángulos actuales del TRMS en grados.
@@ -135,13 +319,11 @@ static inline int clampi(int v, int lo, int hi)
  * @brief
  * Pone a cero el integrador y la memoria de derivada de un controlador PID simple.
  * @note
- * Implementa el reseteo del estado interno de un PID individual.
+ * Capa fina sobre Pid<>::reset (ver "PID_Template.h").
  */
 void PID_Reset(PIDState &state)
 {
-    state.integrator = 0.0f;
-    state.prevInput  = 0.0f;
-    state.firstRun   = true;
+    state.reset();
 }
 
 // =====================================================
@@ -152,7 +334,7 @@ void PID_Reset(PIDState &state)
  * @brief
  * Actualiza un controlador PID simple.
  * @note
- * Implementa la ecuación del PID con integrador y derivada, incluyendo saturación del integrador.
+ * Capa fina sobre Pid<>::update. Con la variante por defecto:
  *
  * out = Kp*u + I + Kd*du/dt
  * I[k] = saturación( I[k-1] + Ki * u[k] * dt, ±I_sat )
@@ -160,36 +342,10 @@ void PID_Reset(PIDState &state)
 float PID_Update(const PIDParams &p,
                  PIDState        &s,
                  float            u,
-                 float            dt)
+                 float            dt,
+                 float            meas)
 {
-    // Protección básica
-    if (dt <= 0.0f) dt = 1e-3f;
-
-    // ---- Derivada du/dt ----
-    float du_dt = 0.0f;
-    if (!s.firstRun) {
-        du_dt = (u - s.prevInput) / dt;
-    } else {
-        du_dt = 0.0f;
-        s.firstRun = false;
-    }
-    s.prevInput = u;
-
-    // ---- Integrador con saturación ----
-    s.integrator += p.Ki * u * dt;
-
-    // Saturación simétrica ±I_sat
-    if (p.I_sat > 0.0f) {
-        if (s.integrator >  p.I_sat) s.integrator =  p.I_sat;
-        if (s.integrator < -p.I_sat) s.integrator = -p.I_sat;
-    }
-
-    // ---- Salida total ----
-    float outP = p.Kp * u;
-    float outI = s.integrator;
-    float outD = p.Kd * du_dt;
-
-    return (outP + outI + outD);
+    return s.update(p, u, dt, meas);
 }
 
 // =====================================================
@@ -204,72 +360,541 @@ float PID_Update(const PIDParams &p,
  */
 void PID4_Reset(PID4State &s)
 {
-    PID_Reset(s.hh);
-    PID_Reset(s.hv);
-    PID_Reset(s.vh);
-    PID_Reset(s.vv);
+    s.reset();
 }
 
-void PID4_ResetStates()
+/**
+ * @brief
+ * Resetea el estado del PID-4 en uso (float o coma fija).
+ * @note
+ * Uso interno: se llama ya dentro de la sección crítica.
+ */
+static void PID4_ResetStatesUnlocked()
 {
     PID4_Reset(s_pid4_state);
+    s_speedMP.pi.reset();
+    s_speedRDC.pi.reset();
+    s_speedMP.first  = true;
+    s_speedRDC.first = true;
+    StateFeedback_reset(s_sf);
+#if PID_FIXED_POINT
+    s_pid4_fixed_state.reset();
+#endif
 }
 
 /**
  * @brief
- * Carga los parámetros del PID-4 desde la estructura PID_CURR.
+ * Recalcula los parámetros y consignas del PID-4 en coma fija.
  * @note
- * Copia los parámetros actuales a la estructura interna usada por el controlador.
+ * Uso interno, dentro de la sección crítica: se llama al cambiar ganancias,
+ * modo, consignas o escala de los encoders (nunca en el paso de control).
  */
-void PID4_LoadFromCurr(const PID_CURR &c)
+static void PID4_RefreshFixedUnlocked()
+{
+#if PID_FIXED_POINT
+    PID4Fixed_FromFloat(s_pid4_params, s_degPerCountV, s_degPerCountH, s_pid4_fixed_params);
+    s_refVertCounts = Q16::fromFloat(s_refVertDeg / s_degPerCountV);
+    s_refHorCounts  = Q16::fromFloat(s_refHorDeg  / s_degPerCountH);
+#endif
+}
+
+void PID4_ResetStates()
+{
+    PID_LOCK();
+    PID4_ResetStatesUnlocked();
+    PID_UNLOCK();
+}
+
+/**
+ * @brief
+ * Cambio de consigna: resetea los estados solo con la derivada del error.
+ * @note
+ * STATE_FEEDBACK no deriva el error (las velocidades son del observador):
+ * conserva sus integrales.
+ */
+void PID4_HandleReferenceChange()
+{
+    PID_LOCK();
+    // Con trayectoria la consigna ya no salta: no hay pico de derivada que evitar
+    const bool smooth = Traj_enabled(s_trajLimV) || Traj_enabled(s_trajLimH);
+    const bool lqi    = (s_pidMode == PIDMode::STATE_FEEDBACK);
+    if (!s_pidCurrCopy.DerivOnMeasCurr && !smooth && !lqi) {
+        PID4_ResetStatesUnlocked();
+    }
+    PID_UNLOCK();
+}
+
+/**
+ * @brief
+ * Devuelve las lógicas de salida vertical/horizontal a su estado de arranque.
+ * @note
+ * Borra las bases aprendidas (targetBase de subida/bajada y baseH). No se
+ * llama al habilitar el PID ni al cambiar de modo, igual que hasta ahora:
+ * está pensada para que cada ensayo del simulador empiece desde cero.
+ */
+void PID4_ResetShapingState()
+{
+    PID_LOCK();
+    s_shapeUp   = { 0, 0, 0.0f };
+    s_shapeDown = { 0 };
+    s_shapeH    = { 0, 0.0f, false, 0 };
+    PID_UNLOCK();
+}
+
+// Tabla por defecto de cada id (nullptr = sin tabla)
+static const GsTableSpec *PID4_DefaultSchedule(int id)
+{
+    if (id == GS_SHAPE_H) return &GS_DEFAULT_SHAPE_H;
+    if (id == GS_SHAPE_V) return &GS_DEFAULT_SHAPE_V;
+    return nullptr;
+}
+
+/**
+ * @brief
+ * Instala las tablas de ganancias.
+ * @note
+ * Cada rejilla se precalcula fuera de la sección crítica y solo la copia se
+ * hace con el lock tomado. Se llama desde la tarea de interfaz (SD) o al
+ * arrancar, nunca desde el paso de control.
+ */
+bool PID4_LoadSchedules(const GsTableSpec specs[GS_TABLE_COUNT])
+{
+    static const GsTableSpec EMPTY = { GsIndex::REF_V, 0, {} };
+    bool ok = true;
+    bool pidActive = false;
+
+    for (int i = 0; i < GS_TABLE_COUNT; i++) {
+        const GsTableSpec *spec = (specs && specs[i].n) ? &specs[i] : PID4_DefaultSchedule(i);
+        if (!spec) spec = &EMPTY;
+
+        if (!GainSchedule_compile(*spec, s_schedScratch)) {
+            ok = false;
+            spec = PID4_DefaultSchedule(i);
+            GainSchedule_compile(spec ? *spec : EMPTY, s_schedScratch);
+        }
+        if (i <= GS_PID_VV && s_schedScratch.n) pidActive = true;
+
+        PID_LOCK();
+        s_sched[i] = s_schedScratch;
+        PID_UNLOCK();
+    }
+
+    PID_LOCK();
+    s_schedPidActive = pidActive;
+    s_schedLoaded    = true;
+    if (!s_sched[GS_SHAPE_V].n) {
+        s_vShape = { V_UP_MIN_OUT, V_BIAS_REL_K, V_DOWN_KBASE_DOWN, V_DOWN_KBASE_UP };
+    }
+    PID_UNLOCK();
+    return ok;
+}
+
+void PID4_ResetSchedules()
+{
+    PID4_LoadSchedules(nullptr);
+}
+
+// Variable con la que se indexa una tabla [grados]
+static float PID4_ScheduleX(GsIndex idx, float measVertDeg, float measHorDeg)
+{
+    switch (idx) {
+    case GsIndex::REF_V:  return s_refVertDeg;
+    case GsIndex::REF_H:  return s_refHorDeg;
+    case GsIndex::MEAS_V: return measVertDeg;
+    case GsIndex::MEAS_H:
+    default:              return measHorDeg;
+    }
+}
+
+template <typename S>
+static void PID4_ScaleGains(PidGains<S> &g, const float m[GS_COLS])
+{
+    g.Kp    = g.Kp    * S(m[0]);
+    g.Ki    = g.Ki    * S(m[1]);
+    g.Kd    = g.Kd    * S(m[2]);
+    g.I_sat = g.I_sat * S(m[3]);
+}
+
+/**
+ * @brief
+ * Copia los parámetros del PID-4 escalados con las tablas PID_*.
+ * @note
+ * Uso interno, dentro de la sección crítica. Vale para float y coma fija.
+ * Los PID sin tabla se quedan como están.
+ */
+template <typename Params>
+static void PID4_ScheduleGains(const Params &base, Params &out, float measVertDeg, float measHorDeg)
+{
+    out = base;
+    decltype(&out.hh) g[4] = { &out.hh, &out.hv, &out.vh, &out.vv };   // orden de GS_PID_*
+    for (int i = 0; i < 4; i++) {
+        const GsTable &t = s_sched[GS_PID_HH + i];
+        if (!t.n) continue;
+        float m[GS_COLS];
+        GainSchedule_lookup(t, PID4_ScheduleX(t.index, measVertDeg, measHorDeg), m);
+        PID4_ScaleGains(*g[i], m);
+    }
+}
+
+// Escala de deltaRDC de la tabla SHAPE_H (1 sin tabla)
+static float PID4_RdcScale(float measVertDeg, float measHorDeg)
+{
+    const GsTable &t = s_sched[GS_SHAPE_H];
+    if (!t.n) return 1.0f;
+    float gs[GS_COLS];
+    GainSchedule_lookup(t, PID4_ScheduleX(t.index, measVertDeg, measHorDeg), gs);
+    return gs[0];
+}
+
+// Mapa de equilibrio, relleno con la recta de partida en el primer uso
+static EqMap &PID4_FeedforwardMapUnlocked()
+{
+    if (s_ffMap.version != EQMAP_VERSION) EqMap_reset(s_ffMap, s_ffPrior);
+    return s_ffMap;
+}
+
+/**
+ * @brief
+ * Transferencia sin salto: carga los integradores con lo que se está aplicando.
+ * @note
+ * Uso interno, dentro de la sección crítica y con los estados ya reseteados.
+ * Deshace las lógicas de salida con la última medida para saber qué deltaMP y
+ * deltaRDC darían los registros aplicados (MotorControl_getLastRegisters) con
+ * las bases aprendidas, y carga los integradores para pedirlos (Pid4::preload).
+ * La base de bajada parte del propio registro, así el PID no tiene que aportar.
+ * Lo que no quepa en los integradores (Ki = 0, I_sat, salidas que el modo
+ * fuerza a 0) lo cubre el offset de s_transfer, que el primer paso calcula
+ * contra los registros aplicados y que se desvanece con TRANSFER_TAU_S.
+ * Con los dos motores parados no hay nada que conservar y se arranca en frío.
+ */
+static void PID4_BumplessUnlocked()
+{
+    int regMP, regRDC;
+    MotorControl_getLastRegisters(regMP, regRDC);
+    s_transfer = { false, regMP, regRDC, 0.0f, 0.0f };
+    if (regMP == 0 && regRDC == 0) return;
+    s_transfer.pending = true;
+
+    const float measV  = s_lastMeasVertDeg;
+    const float measH  = s_lastMeasHorDeg;
+    const float errDeg = s_refVertDeg - measV;
+
+    // Vertical: la misma lógica que elegiría PID4_StepImpl
+    int deltaMP;
+    const bool down = (s_vertZone == VertRefZone::BELOW_REST) ||
+                      (s_vertZone == VertRefZone::REST_BAND && measV < V_REST_LOW_DEG);
+    if (down) {
+        s_shapeDown.targetBase = clampi(regMP, V_DOWN_BASE_MIN, 0);
+        deltaMP = 2 * (regMP - s_shapeDown.targetBase);
+    } else {
+        const int base = clampi((int)lroundf(EqMap_lookup(PID4_FeedforwardMapUnlocked(), s_refVertDeg)),
+                                s_vShape.minOut, 100);
+        deltaMP = regMP - base;
+        if (errDeg < 0.0f) deltaMP += clampi((int)lroundf(-errDeg * s_vShape.biasRelK), 0, V_UP_MAX_CUT);
+    }
+
+    // Horizontal: out = baseH + deltaRDC * kRdc
+    const float kRdc = PID4_RdcScale(measV, measH);
+    const float deltaRDC = (kRdc != 0.0f) ? (float)(regRDC - s_shapeH.baseH) / kRdc : 0.0f;
+
+#if PID_FIXED_POINT
+    const PID4FixedParams *fp = &s_pid4_fixed_params;
+    PID4FixedParams schedParams;
+    if (s_schedPidActive) {
+        PID4_ScheduleGains(s_pid4_fixed_params, schedParams, measV, measH);
+        fp = &schedParams;
+    }
+    s_pid4_fixed_state.preload(*fp,
+                               s_refHorCounts  - Q16::fromInt(s_lastCountH),
+                               s_refVertCounts - Q16::fromInt(s_lastCountV),
+                               Q16::fromFloat(deltaRDC), Q16::fromInt(deltaMP));
+#else
+    const PID4Params *pp = &s_pid4_params;
+    PID4Params schedParams;
+    if (s_schedPidActive) {
+        PID4_ScheduleGains(s_pid4_params, schedParams, measV, measH);
+        pp = &schedParams;
+    }
+    s_pid4_state.preload(*pp,
+                         (s_refHorDeg  - measH) * DEG_TO_RAD,
+                         (s_refVertDeg - measV) * DEG_TO_RAD,
+                         deltaRDC * s_pid4_params.Uh_max * 0.01f,
+                         (float)deltaMP * s_pid4_params.Uv_max * 0.01f);
+#endif
+}
+
+/**
+ * @brief
+ * Copia PID_CURR a los parámetros internos y resetea estados (sin tomar el lock).
+ * @note
+ * Uso interno: lo llaman PID4_LoadFromCurr y PID4_SetMode, que ya están dentro
+ * de la sección crítica.
+ */
+static void PID4_ParamsFromCurrUnlocked(const PID_CURR &c)
 {
     // Guardamos una copia por si luego queremos volver a MIMO_FULL
     s_pidCurrCopy = c;
 
-    s_pid4_params.vv = { c.KpvvCurr, c.KivvCurr, c.KdvvCurr, c.IsatvvCurr };
-    s_pid4_params.hv = { c.KphvCurr, c.KihvCurr, c.KdhvCurr, c.IsathvCurr };
-    s_pid4_params.vh = { c.KpvhCurr, c.KivhCurr, c.KdvhCurr, c.IsatvhCurr };
-    s_pid4_params.hh = { c.KphhCurr, c.KihhCurr, c.KdhhCurr, c.IsathhCurr };
+    // Tf y derivada de la medida van por eje de entrada (in_1 = H, in_2 = V);
+    // Kt, como el resto de ganancias, por PID
+    s_pid4_params.vv = { c.KpvvCurr, c.KivvCurr, c.KdvvCurr, c.IsatvvCurr, c.TfvCurr, c.DerivOnMeasCurr,
+                         c.KtvvCurr };
+    s_pid4_params.hv = { c.KphvCurr, c.KihvCurr, c.KdhvCurr, c.IsathvCurr, c.TfhCurr, c.DerivOnMeasCurr,
+                         c.KthvCurr };
+    s_pid4_params.vh = { c.KpvhCurr, c.KivhCurr, c.KdvhCurr, c.IsatvhCurr, c.TfvCurr, c.DerivOnMeasCurr,
+                         c.KtvhCurr };
+    s_pid4_params.hh = { c.KphhCurr, c.KihhCurr, c.KdhhCurr, c.IsathhCurr, c.TfhCurr, c.DerivOnMeasCurr,
+                         c.KthhCurr };
 
     s_pid4_params.Uv_max = c.UvmaxCurr;
     s_pid4_params.Uh_max = c.UhmaxCurr;
+}
 
-    PID4_Reset(s_pid4_state);
+static void PID4_LoadFromCurrUnlocked(const PID_CURR &c)
+{
+    PID4_ParamsFromCurrUnlocked(c);
+    PID4_ResetStatesUnlocked();
+    PID4_RefreshFixedUnlocked();
+}
+
+// Anula los PIDs que no usa el modo SISO en curso (MIMO_FULL los deja todos)
+static void PID4_MaskForModeUnlocked()
+{
+    switch (s_pidMode) {
+    case PIDMode::VERTICAL_ONLY:
+        // Mantener solo PIDvv (ev -> Uv)
+        s_pid4_params.hh = {0,0,0,0};
+        s_pid4_params.hv = {0,0,0,0};
+        s_pid4_params.vh = {0,0,0,0};
+        break;
+
+    case PIDMode::HORIZONTAL_ONLY:
+        // Mantener solo PIDhh (eh -> Uh)
+        s_pid4_params.vv = {0,0,0,0};
+        s_pid4_params.hv = {0,0,0,0};
+        s_pid4_params.vh = {0,0,0,0};
+        break;
+
+    case PIDMode::MIMO_FULL:
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief
+ * Aplica la última generación de ganancias publicada (paso de control).
+ * @note
+ * Uso interno, dentro de la sección crítica y al principio del paso. Los
+ * estados no se tocan: el integrador está en unidades de salida, así que un
+ * cambio de Ki no da salto; un cambio de Kp o Kd sí mueve la salida en
+ * proporción al error. La de PID4_LoadFromCurr ya está aplicada y solo se anota.
+ */
+static void PID4_TakeGainsUnlocked()
+{
+    const uint32_t gen = s_gainPublished.load(std::memory_order_acquire);
+    if (gen == s_gainApplied.load(std::memory_order_relaxed)) return;
+
+    const PID_CURR &c = s_gainSlot[gen & 1];
+    if (!s_gainReload) {
+        PID4_ParamsFromCurrUnlocked(c);
+        PID4_MaskForModeUnlocked();
+        PID4_RefreshFixedUnlocked();
+    }
+
+    PID4GainEvent ev;
+    ev.sample = s_stepSample;
+    ev.tUs    = Clock_nowUs();
+    ev.gen    = gen;
+    ev.reload = s_gainReload;
+    ev.gains  = c;
+    s_gainLog.push(ev);
+
+    s_gainReload = false;
+    s_gainApplied.store(gen, std::memory_order_release);
+}
+
+/**
+ * @brief
+ * Publica ganancias nuevas para el PID-4 en marcha (desde la interfaz).
+ * @note
+ * No toma el lock: copia c en el hueco que el paso de control no está leyendo
+ * y sube la generación. El paso la aplica antes de la siguiente muestra sin
+ * resetear estados (ver PID4_TakeGainsUnlocked). Con el PID deshabilitado se
+ * quedan pendientes hasta el siguiente PID4_LoadFromCurr.
+ *
+ * @return false si el paso aún no ha aplicado la publicación anterior
+ *         (volver a llamar más tarde con las ganancias más recientes)
+ */
+bool PID4_PublishGains(const PID_CURR &c)
+{
+    const uint32_t gen = s_gainPublished.load(std::memory_order_relaxed);
+    if (s_gainApplied.load(std::memory_order_acquire) != gen) return false;
+
+    s_gainSlot[(gen + 1) & 1] = c;
+    s_gainPublished.store(gen + 1, std::memory_order_release);
+    return true;
+}
+
+uint32_t PID4_GetGainGeneration()
+{
+    return s_gainApplied.load(std::memory_order_acquire);
+}
+
+bool PID4_PopGainEvent(PID4GainEvent &ev)
+{
+    return s_gainLog.pop(ev);
+}
+
+/**
+ * @brief
+ * Carga los parámetros del PID-4 desde la estructura PID_CURR.
+ * @note
+ * Copia los parámetros actuales a la estructura interna usada por el controlador.
+ * Con el PID en marcha (edición de ganancias) los integradores se cargan con
+ * lo que se está aplicando, para que el cambio no dé un salto.
+ */
+void PID4_LoadFromCurr(const PID_CURR &c)
+{
+    // Primera carga: tablas por defecto (fuera del lock, ver PID4_LoadSchedules)
+    if (!s_schedLoaded) PID4_ResetSchedules();
+
+    PID_LOCK();
+    PID4_LoadFromCurrUnlocked(c);
+    if (s_pid4_enabled) PID4_BumplessUnlocked();
+
+    // Generación nueva (ya aplicada) para el registro de eventos; tapa
+    // cualquier publicación que siguiera pendiente
+    const uint32_t gen = s_gainPublished.load(std::memory_order_relaxed) + 1;
+    s_gainSlot[gen & 1] = c;
+    s_gainReload = true;
+    s_gainPublished.store(gen, std::memory_order_release);
+    PID_UNLOCK();
+}
+
+// Consigna de un eje: sin trayectoria (o con el PID parado) salta al objetivo
+static float PID4_SetAxisGoalUnlocked(TrajAxis &t, const TrajLimits &lim, float goal)
+{
+    if (!Traj_enabled(lim) || !s_pid4_enabled) {
+        Traj_reset(t, goal);
+    } else {
+        Traj_setGoal(t, goal);
+    }
+    return t.out;
+}
+
+/**
+ * @brief
+ * Avanza las trayectorias de consigna un paso (dentro de la sección crítica).
+ * @note
+ * O(1) por eje. Sin trayectoria en ningún eje no toca nada.
+ */
+static void PID4_AdvanceReferencesUnlocked(float dt)
+{
+    if (!Traj_enabled(s_trajLimV) && !Traj_enabled(s_trajLimH)) return;
+
+    s_refVertDeg = Traj_step(s_trajV, s_trajLimV, dt);
+    s_refHorDeg  = Traj_step(s_trajH, s_trajLimH, dt);
+#if PID_FIXED_POINT
+    s_refVertCounts = Q16::fromFloat(s_refVertDeg / s_degPerCountV);
+    s_refHorCounts  = Q16::fromFloat(s_refHorDeg  / s_degPerCountH);
+#endif
+}
+
+// Al habilitar: las trayectorias parten de la última medida hacia la consigna
+static void PID4_StartTrajectoriesUnlocked()
+{
+    if (Traj_enabled(s_trajLimV)) {
+        Traj_reset(s_trajV, s_lastMeasVertDeg);
+        Traj_setGoal(s_trajV, s_goalVertDeg);
+        s_refVertDeg = s_trajV.out;
+    }
+    if (Traj_enabled(s_trajLimH)) {
+        Traj_reset(s_trajH, s_lastMeasHorDeg);
+        Traj_setGoal(s_trajH, s_goalHorDeg);
+        s_refHorDeg = s_trajH.out;
+    }
+    PID4_RefreshFixedUnlocked();
 }
 
 /**
  * @brief
  * Establece las referencias de posición para el PID-4.
  * @note
- * Actualiza las referencias vertical y horizontal en grados.
+ * Actualiza las referencias vertical y horizontal en grados. Con trayectoria
+ * (PID4_SetTrajectoryLimits) son el objetivo: el paso de control las recorre
+ * en curva en S. La lógica vertical se elige con el objetivo.
  */
 void PID4_SetReferences(float refVertDeg, float refHorDeg)
 {
-    s_refVertDeg = refVertDeg;
-    s_refHorDeg  = refHorDeg;
+    PID_LOCK();
+    s_goalVertDeg = refVertDeg;
+    s_goalHorDeg  = refHorDeg;
+    s_refVertDeg  = PID4_SetAxisGoalUnlocked(s_trajV, s_trajLimV, refVertDeg);
+    s_refHorDeg   = PID4_SetAxisGoalUnlocked(s_trajH, s_trajLimH, refHorDeg);
 
     // LATCH del modo vertical según la consigna (solo depende de referencia)
-    if (s_refVertDeg > V_REST_LOW_DEG) {
+    if (s_goalVertDeg > V_REST_LOW_DEG) {
         s_vertZone = VertRefZone::ABOVE_REST;   // ref > -37
-    } else if (s_refVertDeg < V_REST_HIGH_DEG) {
+    } else if (s_goalVertDeg < V_REST_HIGH_DEG) {
         s_vertZone = VertRefZone::BELOW_REST;   // ref < -36
     } else {
         s_vertZone = VertRefZone::REST_BAND;    // -37..-36
     }
+    PID4_RefreshFixedUnlocked();
+    PID_UNLOCK();
+}
+
+/**
+ * @brief
+ * Fija los límites de la trayectoria de consigna de cada eje.
+ * @note
+ * vMax <= 0 la desactiva (la consigna salta al objetivo, como antes). Un eje
+ * que se activa parte de la consigna que tiene ahora; uno que se desactiva
+ * salta a su objetivo.
+ */
+void PID4_SetTrajectoryLimits(const TrajLimits &vert, const TrajLimits &hor)
+{
+    PID_LOCK();
+    if (Traj_enabled(vert) && !Traj_enabled(s_trajLimV)) Traj_reset(s_trajV, s_refVertDeg);
+    if (Traj_enabled(hor)  && !Traj_enabled(s_trajLimH)) Traj_reset(s_trajH, s_refHorDeg);
+    s_trajLimV = vert;
+    s_trajLimH = hor;
+    s_refVertDeg = PID4_SetAxisGoalUnlocked(s_trajV, s_trajLimV, s_goalVertDeg);
+    s_refHorDeg  = PID4_SetAxisGoalUnlocked(s_trajH, s_trajLimH, s_goalHorDeg);
+    PID4_RefreshFixedUnlocked();
+    PID_UNLOCK();
+}
+
+void PID4_GetTrajectoryLimits(TrajLimits &vert, TrajLimits &hor)
+{
+    PID_LOCK();
+    vert = s_trajLimV;
+    hor  = s_trajLimH;
+    PID_UNLOCK();
 }
 
 /**
  * @brief
  * Habilita o deshabilita el controlador PID-4.
  * @note
- * Cuando se habilita, se resetea el estado interno.
+ * Cuando se habilita, se resetea el estado interno, las trayectorias de
+ * consigna (si las hay) parten de la medida actual y los integradores se
+ * cargan con los registros que se estaban aplicando (por ejemplo, desde los
+ * sliders): el paso de manual a PID no da un salto. Con los motores parados
+ * es un arranque en frío, como antes.
  */
 void PID4_SetEnabled(bool enable)
 {
+    PID_LOCK();
+    const bool wasEnabled = s_pid4_enabled;
     s_pid4_enabled = enable;
-    if (enable) {
-        PID4_Reset(s_pid4_state);
+    if (enable && !wasEnabled) {
+        PID4_ResetStatesUnlocked();
+        PID4_StartTrajectoriesUnlocked();
+        PID4_BumplessUnlocked();
     }
+    PID_UNLOCK();
 }
 
 /**
@@ -288,40 +913,110 @@ bool PID4_IsEnabled()
  * - MIMO_FULL:   restaura parámetros completos desde s_pidCurrCopy
  * - VERTICAL_ONLY: anula hh/hv/vh (K=0) y deja solo vv
  * - HORIZONTAL_ONLY: anula vv/hv/vh (K=0) y deja solo hh
+ * - CASCADE:     como MIMO_FULL, con los lazos de velocidad detrás
+ * - STATE_FEEDBACK: LQI; carga los parámetros completos por si falta el observador
  *
  * IMPORTANTE:
  *  - Resetea el estado interno para evitar memoria cruzada.
+ *  - Con el PID en marcha, los PIDs que quedan activos se cargan con los
+ *    registros aplicados (sin salto al cambiar de modo).
  */
 void PID4_SetMode(PIDMode mode)
 {
+    PID_LOCK();
     s_pidMode = mode;
 
     // Reset completo siempre (evita integradores/derivadas “fantasma”)
-    PID4_Reset(s_pid4_state);
+    PID4_ResetStatesUnlocked();
 
-    switch (mode) {
-    case PIDMode::VERTICAL_ONLY:
-        // Mantener solo PIDvv (ev -> Uv)
-        s_pid4_params.hh = {0,0,0,0};
-        s_pid4_params.hv = {0,0,0,0};
-        s_pid4_params.vh = {0,0,0,0};
-        // vv se mantiene como esté cargado (desde PID4_LoadFromCurr)
-        break;
+    if (mode == PIDMode::MIMO_FULL || mode == PIDMode::CASCADE || mode == PIDMode::STATE_FEEDBACK) {
+        // Restaurar parámetros completos
+        PID4_LoadFromCurrUnlocked(s_pidCurrCopy);
+    } else {
+        // El PID que queda se mantiene como esté cargado (desde PID4_LoadFromCurr)
+        PID4_MaskForModeUnlocked();
+    }
+    PID4_RefreshFixedUnlocked();
+    if (s_pid4_enabled) PID4_BumplessUnlocked();
+    PID_UNLOCK();
+}
 
-    case PIDMode::HORIZONTAL_ONLY:
-        // Mantener solo PIDhh (eh -> Uh)
-        s_pid4_params.vv = {0,0,0,0};
-        s_pid4_params.hv = {0,0,0,0};
-        s_pid4_params.vh = {0,0,0,0};
-        // hh se mantiene como esté cargado
-        break;
+PIDMode PID4_GetMode()
+{
+    return s_pidMode;
+}
 
-    case PIDMode::MIMO_FULL:
-    default:
-        // Restaurar parámetros completos
-        PID4_LoadFromCurr(s_pidCurrCopy);
-        break;
+/**
+ * @brief
+ * Carga los parámetros de los lazos de velocidad del modo CASCADE.
+ * @note
+ * Un PI por motor (sin derivada); Kt sigue el recorte de ±100 del registro.
+ * Resetea los dos lazos: en marcha, el término directo evita el salto.
+ */
+void PID4_SetCascadeParams(const PID_CASCADE &c)
+{
+    PID_LOCK();
+    s_speedMP.g  = { c.KpMPCurr,  c.KiMPCurr,  0.0f, c.IsatMPCurr,  0.0f, false, c.KtCurr };
+    s_speedRDC.g = { c.KpRDCCurr, c.KiRDCCurr, 0.0f, c.IsatRDCCurr, 0.0f, false, c.KtCurr };
+    s_speedMP.rpmMax  = c.RpmMaxMPCurr;
+    s_speedRDC.rpmMax = c.RpmMaxRDCCurr;
+    s_speedTf = c.TfCurr;
+
+    s_speedMP.pi.reset();
+    s_speedRDC.pi.reset();
+    s_speedMP.first  = true;
+    s_speedRDC.first = true;
+    PID_UNLOCK();
+}
+
+// Solo desde la tarea de control (la misma que ejecuta el paso)
+void PID4_SetRotorSpeeds(float rpmMP, float rpmRDC)
+{
+    s_rpmMeasMP  = rpmMP;
+    s_rpmMeasRDC = rpmRDC;
+}
+
+// Solo desde la tarea de control (la misma que ejecuta el paso)
+void PID4_SetObserverEstimate(const ObserverEstimate &est)
+{
+    s_obsEst = est;
+}
+
+/**
+ * @brief
+ * Elige la medida que ve la derivada (cuentas o ángulos filtrados).
+ * @note
+ * Solo cambia algo con la derivada de la medida (DerivOnMeasCurr). Resetea
+ * los estados, como un cambio de modo: la derivada no debe ver el salto entre
+ * una medida y otra.
+ */
+void PID4_SetObserverDerivative(bool enable)
+{
+    PID_LOCK();
+    if (enable != s_obsDerivative) {
+        s_obsDerivative = enable;
+        PID4_ResetStatesUnlocked();
+        if (s_pid4_enabled) PID4_BumplessUnlocked();
     }
+    PID_UNLOCK();
+}
+
+/**
+ * @brief
+ * Fija los grados por cuenta de cada eje.
+ * @note
+ * Lo llama ControlCycle_init con la configuración de los encoders. Valores
+ * <= 0 se ignoran.
+ */
+void PID4_SetEncoderScale(float degPerCountV, float degPerCountH)
+{
+    if (degPerCountV <= 0.0f || degPerCountH <= 0.0f) return;
+
+    PID_LOCK();
+    s_degPerCountV = degPerCountV;
+    s_degPerCountH = degPerCountH;
+    PID4_RefreshFixedUnlocked();
+    PID_UNLOCK();
 }
 
 /**
@@ -330,7 +1025,7 @@ void PID4_SetMode(PIDMode mode)
  * @note
  * Normaliza U respecto a Umax, limita a [-1,1], y escala a [-100,100].
  */
-static int U_to_Register(float U, float Umax)
+int U_to_Register(float U, float Umax)
 {
     if (Umax <= 0.0f) return 0;
 
@@ -359,36 +1054,28 @@ void PID4_Update(const PID4Params &p,
                  float             in2,
                  float             dt,
                  float            &out1,
-                 float            &out2)
+                 float            &out2,
+                 PID4Partials     *parts,
+                 float             meas1,
+                 float             meas2)
 {
-    // PIDhh: in1 -> out1
-    float u_hh = PID_Update(p.hh, s.hh, in1, dt);
-
-    // PIDhv: in1 -> out2
-    float u_hv = PID_Update(p.hv, s.hv, in1, dt);
-
-    // PIDvh: in2 -> out1
-    float u_vh = PID_Update(p.vh, s.vh, in2, dt);
-
-    // PIDvv: in2 -> out2
-    float u_vv = PID_Update(p.vv, s.vv, in2, dt);
-
-    // Sumas MIMO
-    float Uh = u_hh + u_vh;   // out_1
-    float Uv = u_hv + u_vv;   // out_2
-
-    // Saturaciones simétricas ±
-    if (p.Uh_max > 0.0f) {
-        if (Uh >  p.Uh_max) Uh =  p.Uh_max;
-        if (Uh < -p.Uh_max) Uh = -p.Uh_max;
-    }
-    if (p.Uv_max > 0.0f) {
-        if (Uv >  p.Uv_max) Uv =  p.Uv_max;
-        if (Uv < -p.Uv_max) Uv = -p.Uv_max;
-    }
+    s.update(p, in1, in2, dt, out1, out2, parts, meas1, meas2);
+}
 
-    out1 = Uh;
-    out2 = Uv;
+/**
+ * @brief
+ * Anti-windup por seguimiento de la salida aplicada.
+ * @note
+ * Capa fina sobre Pid4<>::track: excess1 va a PIDhh/PIDvh y excess2 a
+ * PIDhv/PIDvv, cada uno con su Kt. Con ClampIntegrator no hace nada.
+ */
+void PID4_Track(const PID4Params &p,
+                PID4State        &s,
+                float             excess1,
+                float             excess2,
+                float             dt)
+{
+    s.track(p, excess1, excess2, dt);
 }
 
 // =====================================================
@@ -416,59 +1103,63 @@ void PID4_Update(const PID4Params &p,
 
 // Versión actualizada:
 // - Mantiene tu estructura (Opción 2)
-// - Reintroduce deadband, pero NO vuelve a s_MP_eq fijo: mantiene/actualiza un targetBase
-// - targetBase se actualiza SOLO si estamos “cerca del equilibrio” durante varias iteraciones
-//   (para no contaminarlo con la inercia al cruzar la consigna)
-// - Cuando errDeg<0, la reducción se hace respecto a targetBase (no respecto a s_MP_eq),
+// - targetBase es el feedforward: el registro de equilibrio del mapa en la consigna
+// - El mapa se aprende SOLO con la viga quieta durante varias iteraciones, aunque no
+//   esté en la consigna: quieta en un ángulo, el registro aplicado es el de equilibrio
+//   de ese ángulo (así se corrige también lo que el integrador no alcanza por Isat)
+// - Cuando errDeg<0, la reducción se hace respecto a targetBase,
 //   y se limita para evitar “bajadas” demasiado fuertes.
 
-static int ApplyVerticalUnidirectionalControl_Up(int deltaMP, float errDeg)
+// Aprende el registro aplicado en el ángulo medido si la viga está asentada
+// (no durante una transferencia: el registro aplicado aún lleva el offset)
+static int PID4_LearnEquilibrium(int out, float measDeg, bool settled)
+{
+    if (settled && s_transfer.offMP == 0.0f) EqMap_learn(PID4_FeedforwardMapUnlocked(), measDeg, (float)out, V_FF_ALPHA);
+    return out;
+}
+
+int ApplyVerticalUnidirectionalControl_Up(int deltaMP, float errDeg, int *appliedDelta)
 {
     // --- Tuning knobs ---
     const float ERR_DB        = V_ERR_DB_DEG;   // deadband “de control”
-    const int   MIN_OUT       = 15;             // nunca bajar de este registro
+    const int   MIN_OUT       = s_vShape.minOut;   // nunca bajar de este registro (tabla SHAPE_V)
     const int   MAX_NEG       = 10;             // máxima reducción extra vía deltaMP cuando err<0
-    const float Kb            = V_BIAS_REL_K;   // [reg/deg] freno al pasarte
-    const int   MAX_CUT       = 30;             // recorte máximo por “pasarte” (evita bajadas brutales)
+    const float Kb            = s_vShape.biasRelK; // [reg/deg] freno al pasarte (tabla SHAPE_V)
+    const int   MAX_CUT       = V_UP_MAX_CUT;   // recorte máximo por “pasarte” (evita bajadas brutales)
 
-    // --- Aprendizaje de targetBase (por inercia: solo en equilibrio) ---
-    const float ERR_LEARN     = 0.5f;           // grados (más grande que ERR_DB)
-    const int   HOLD_SAMPLES  = 6;              // nº iteraciones seguidas “estables” antes de actualizar
-    const float ALPHA         = 0.05f;          // adaptación lenta del targetBase (0.02..0.1 típico)
+    // --- Aprendizaje del mapa de equilibrio (por inercia: solo en equilibrio) ---
+    const float STILL_DEG     = 0.1f;           // grados: cambio máximo entre muestras (< 1 cuenta)
+    const int   HOLD_SAMPLES  = 40;             // nº iteraciones seguidas “quieta” antes de aprender
 
-    static int  targetBase    = 0;
-    static bool inited        = false;
-    static int  stableCount   = 0;
+    int   &targetBase  = s_shapeUp.targetBase;
+    int   &stableCount = s_shapeUp.stableCount;
+    float &lastMeas    = s_shapeUp.lastMeasDeg;
 
-    // Base nominal (tu antigua “equilibrio” fijo)
-    int base = clampi(s_MP_eq, 0, 100);
+    // Feedforward: registro de equilibrio en la consigna
+    targetBase = clampi((int)lroundf(EqMap_lookup(PID4_FeedforwardMapUnlocked(), s_refVertDeg)),
+                        MIN_OUT, 100);
 
-    if (!inited) {
-        targetBase = base;
-        inited = true;
-    }
-
-    // 0) Detecta si estamos realmente cerca del equilibrio (evita inercia / cruce rápido)
+    // 0) Detecta si la viga está realmente quieta (evita inercia / cruce rápido)
     //    (sin medida de velocidad aquí, usamos “varias muestras seguidas” como criterio simple)
-    if (fabsf(errDeg) < ERR_LEARN) {
+    const float measDeg = s_refVertDeg - errDeg;
+    if (fabsf(measDeg - lastMeas) < STILL_DEG) {
         if (stableCount < HOLD_SAMPLES) stableCount++;
     } else {
         stableCount = 0;
     }
+    lastMeas = measDeg;
+
+    // El mapa aprende el registro aplicado solo tras varias iteraciones quieta,
+    // para que no aprenda en los puntos de retorno de una oscilación.
+    const bool settled = (stableCount >= HOLD_SAMPLES);
 
-    // 1) Deadband: cerca de consigna, mantener targetBase (y solo actualizarlo si llevamos
-    //    varias iteraciones estables para que no aprenda durante el cruce por inercia).
+    // 1) Deadband: cerca de consigna, mantener targetBase
     if (fabsf(errDeg) < ERR_DB) {
-        if (stableCount >= HOLD_SAMPLES) {
-            // Aprendemos lentamente hacia la base nominal (puedes cambiar “base” por “out aplicado”
-            // si lo pasas como argumento externo).
-            float tb = (1.0f - ALPHA) * (float)targetBase + ALPHA * (float)base;
-            targetBase = clampi((int)lroundf(tb), MIN_OUT, 100);
-        }
-        return clampi(targetBase, MIN_OUT, 100);
+        if (appliedDelta) *appliedDelta = deltaMP;   // zona muerta: no es saturación
+        return PID4_LearnEquilibrium(targetBase, measDeg, settled);
     }
 
-    // 2) Si nos pasamos (err < 0): reduce respecto a targetBase (no respecto a s_MP_eq),
+    // 2) Si nos pasamos (err < 0): reduce respecto a targetBase,
     //    y limita recorte total para no “bajar con tanta fuerza”.
     if (errDeg < 0.0f) {
         int cut = (int)lroundf((-errDeg) * Kb);
@@ -482,7 +1173,9 @@ static int ApplyVerticalUnidirectionalControl_Up(int deltaMP, float errDeg)
         int out = base_rel + delta_limited;
 
         // No permitir invertir ni apagar
-        return clampi(out, MIN_OUT, 100);
+        out = clampi(out, MIN_OUT, 100);
+        if (appliedDelta) *appliedDelta = out - base_rel;
+        return PID4_LearnEquilibrium(out, measDeg, settled);
     }
 
     // 3) Si estamos por debajo (err > 0): empuja alrededor de targetBase
@@ -492,11 +1185,13 @@ static int ApplyVerticalUnidirectionalControl_Up(int deltaMP, float errDeg)
         // No permitir cruzar a negativo en este modo unidireccional
         if (out < 0) out = 0;
 
-        return clampi(out, 0, 100);
+        out = clampi(out, 0, 100);
+        if (appliedDelta) *appliedDelta = out - targetBase;
+        return PID4_LearnEquilibrium(out, measDeg, settled);
     }
 }
 
-static int ApplyVerticalUnidirectionalControl_Down(int deltaMP, float errDeg)
+int ApplyVerticalUnidirectionalControl_Down(int deltaMP, float errDeg, int *appliedDelta)
 {
     // Salida unidireccional: [-100..0]
     const int   MAX_DOWN_MAG  = 100;
@@ -504,20 +1199,21 @@ static int ApplyVerticalUnidirectionalControl_Down(int deltaMP, float errDeg)
     const float ERR_DB        = V_ERR_DB_DEG_DOWN;
 
     // Base adaptativa
-    const int   BASE_MIN      = -60;   // límite más negativo al que puede llegar la base
+    const int   BASE_MIN      = V_DOWN_BASE_MIN;   // límite más negativo al que puede llegar la base
     const int   BASE_MAX      = 0;     // nunca positiva
 
-    // Ganancia de “adaptación” de la base (cuánto cambia por grado y por iteración)
-    const float Kbase_down    = 0.15f; // cuando err<0: más negativo (0.05..0.3)
-    const float Kbase_up      = 0.05f; // cuando err>0: hacia 0 más rápido (0.1..0.8)
+    // Ganancia de “adaptación” de la base (cuánto cambia por grado y por iteración, tabla SHAPE_V)
+    const float Kbase_down    = s_vShape.kBaseDown; // cuando err<0: más negativo
+    const float Kbase_up      = s_vShape.kBaseUp;   // cuando err>0: hacia 0
 
     // Limita el cambio por iteración (evita saltos)
     const int   STEP_LIMIT    = 4;     // máx cambio de targetBase por ciclo
 
-    static int targetBase = 0;         // empieza suelto
+    int &targetBase = s_shapeDown.targetBase;   // empieza suelto
 
     // Deadband: suelta (o deja base tal cual; recomiendo soltar)
     if (fabsf(errDeg) < ERR_DB) {
+        if (appliedDelta) *appliedDelta = deltaMP;   // zona muerta: no es saturación
         return 0;
     }
 
@@ -541,18 +1237,22 @@ static int ApplyVerticalUnidirectionalControl_Down(int deltaMP, float errDeg)
     // --- Salida final: base + PID (solo si ayuda a bajar) ---
     if (deltaMP > 0) deltaMP = 0;       // nunca permitimos “subida” desde el PID
 
-    int out = targetBase + deltaMP/2;
+    int outReq = targetBase + deltaMP/2;
+    int out = outReq;
 
     // si toca bajar (err<0), asegura mínimo de bajada
     if (errDeg < 0.0f && out > -MIN_DOWN_MAG) out = -MIN_DOWN_MAG;
 
     // unidireccional estricto
     out = clampi(out, -MAX_DOWN_MAG, 0);
+
+    // El PID entra con ganancia 1/2: lo recortado se devuelve en unidades de deltaMP
+    if (appliedDelta) *appliedDelta = deltaMP + 2 * (out - outReq);
     return out;
 }
 
 
-static int ApplyVerticalBandHold(int deltaMP, float errDeg, float measVertDeg)
+int ApplyVerticalBandHold(int deltaMP, float errDeg, float measVertDeg, int *appliedDelta)
 {
     // Nota: el modo está “latcheado” como REST_BAND, pero dentro de él
     // decidimos qué acción usar en función de dónde esté la medida.
@@ -560,23 +1260,24 @@ static int ApplyVerticalBandHold(int deltaMP, float errDeg, float measVertDeg)
     if (measVertDeg > V_REST_HIGH_DEG) {
         // estamos por encima de -36 -> queremos bajar hasta banda
         // usar control UP (motor empuja arriba, pero al pasarte reduce y deja caer)
-        return ApplyVerticalUnidirectionalControl_Up(deltaMP, errDeg);
+        return ApplyVerticalUnidirectionalControl_Up(deltaMP, errDeg, appliedDelta);
     }
 
     if (measVertDeg < V_REST_LOW_DEG) {
         // estamos por debajo de -37 -> queremos subir hasta banda
         // usar control DOWN (motor empuja abajo, y al “pasarte” reduce dejando subir por gravedad)
-        return ApplyVerticalUnidirectionalControl_Down(deltaMP, errDeg);
+        return ApplyVerticalUnidirectionalControl_Down(deltaMP, errDeg, appliedDelta);
     }
 
     // ya estamos en la banda -> mantener según consigna actual
     // (si quieres fijarlo al centro de banda, cambia errDeg a (center - meas))
-    return ApplyVerticalUnidirectionalControl_Up(deltaMP, errDeg);
+    return ApplyVerticalUnidirectionalControl_Up(deltaMP, errDeg, appliedDelta);
 }
 
-static int ApplyHorizontalBidirectionalControl(int deltaRDC,
-                                              float errDeg,
-                                              float refH_deg)
+int ApplyHorizontalBidirectionalControl(int deltaRDC,
+                                       float errDeg,
+                                       float refH_deg,
+                                       int  *appliedDelta)
 {
     // --- Tuning knobs ---
     const float ERR_DB         = 0.15f;  // deg: deadband para “no cazar”
@@ -594,10 +1295,10 @@ static int ApplyHorizontalBidirectionalControl(int deltaRDC,
     // Limita cuánto puede cambiar el base por iteración (evita saltos)
     const int   BASE_STEP_LIMIT = 2;
 
-    static int   baseH        = 0;       // base adaptativa (trim), arranca en 0
-    static float lastRefH     = 0.0f;
-    static bool  inited       = false;
-    static int   stableCount  = 0;
+    int   &baseH       = s_shapeH.baseH;       // base adaptativa (trim), arranca en 0
+    float &lastRefH    = s_shapeH.lastRefH;
+    bool  &inited      = s_shapeH.inited;
+    int   &stableCount = s_shapeH.stableCount;
 
     if (!inited) {
         lastRefH = refH_deg;
@@ -647,6 +1348,7 @@ static int ApplyHorizontalBidirectionalControl(int deltaRDC,
         }
 
         // En deadband: salida = base (sin delta) para evitar caza
+        if (appliedDelta) *appliedDelta = deltaRDC;   // zona muerta: no es saturación
         int out = baseH;
         if (out > OUT_MAX) out = OUT_MAX;
         if (out < OUT_MIN) out = OUT_MIN;
@@ -660,6 +1362,7 @@ static int ApplyHorizontalBidirectionalControl(int deltaRDC,
     if (out > OUT_MAX) out = OUT_MAX;
     if (out < OUT_MIN) out = OUT_MIN;
 
+    if (appliedDelta) *appliedDelta = out - baseH;
     return out;
 }
 
@@ -668,6 +1371,128 @@ static int ApplyHorizontalBidirectionalControl(int deltaRDC,
 // Steps (con encoders y con medidas externas)
 // =====================================================
 
+/**
+ * @brief
+ * Un paso de un lazo de velocidad: consigna [%] -> registro.
+ * @note
+ * Sin rpmMax (<= 0) el lazo no hace nada y el registro es la consigna.
+ */
+static int SpeedLoop_step(SpeedLoop &l, int sp, float rpm, float dt)
+{
+    if (l.rpmMax <= 0.0f) return sp;
+
+    const float meas = rpm * 100.0f / l.rpmMax;
+    if (l.first || s_speedTf <= 0.0f) {
+        l.filt  = meas;
+        l.first = false;
+    } else {
+        l.filt += dt / (s_speedTf + dt) * (meas - l.filt);
+    }
+
+    const float req = (float)sp + l.pi.update(l.g, (float)sp - l.filt, dt);
+    int reg = (int)lroundf(req);
+    reg = clampi(reg, -100, 100);
+    l.pi.track(l.g, (float)reg - req, dt);
+    return reg;
+}
+
+/**
+ * @brief
+ * Modo CASCADE: convierte las consignas de velocidad en registros.
+ * @note
+ * Llamar con el lock tomado, después de la transferencia (el offset se suma a
+ * la consigna, no al registro final). En los demás modos no hace nada.
+ */
+static void PID4_ApplyCascadeUnlocked(int &regMP, int &regRDC, float dt)
+{
+    if (s_pidMode != PIDMode::CASCADE) return;
+    regMP  = SpeedLoop_step(s_speedMP,  regMP,  s_rpmMeasMP,  dt);
+    regRDC = SpeedLoop_step(s_speedRDC, regRDC, s_rpmMeasRDC, dt);
+}
+
+/**
+ * @brief
+ * Suma a los registros el offset de transferencia pendiente y lo desvanece.
+ * @note
+ * El primer paso tras PID4_BumplessUnlocked fija el offset como la diferencia
+ * entre los registros aplicados antes y los que da el PID. Las salidas que el
+ * modo fuerza a 0 no lo llevan. Llamar con el lock tomado, tras forzar por modo.
+ */
+static void PID4_ApplyTransferUnlocked(int &regMP, int &regRDC, float dt)
+{
+    if (s_transfer.pending) {
+        s_transfer.pending = false;
+        s_transfer.offMP   = (s_pidMode == PIDMode::HORIZONTAL_ONLY) ? 0.0f : (float)(s_transfer.fromMP  - regMP);
+        s_transfer.offRDC  = (s_pidMode == PIDMode::VERTICAL_ONLY)   ? 0.0f : (float)(s_transfer.fromRDC - regRDC);
+    }
+    if (s_transfer.offMP == 0.0f && s_transfer.offRDC == 0.0f) return;
+
+    if (s_pidMode == PIDMode::HORIZONTAL_ONLY) s_transfer.offMP  = 0.0f;
+    if (s_pidMode == PIDMode::VERTICAL_ONLY)   s_transfer.offRDC = 0.0f;
+
+    regMP  += (int)lroundf(s_transfer.offMP);
+    regRDC += (int)lroundf(s_transfer.offRDC);
+    if (regMP  >  100) regMP  =  100;
+    if (regMP  < -100) regMP  = -100;
+    if (regRDC >  100) regRDC =  100;
+    if (regRDC < -100) regRDC = -100;
+
+    // Primer orden con constante TRANSFER_TAU_S
+    const float k = dt / (TRANSFER_TAU_S + dt);
+    s_transfer.offMP  -= s_transfer.offMP  * k;
+    s_transfer.offRDC -= s_transfer.offRDC * k;
+    if (fabsf(s_transfer.offMP)  < 0.5f) s_transfer.offMP  = 0.0f;
+    if (fabsf(s_transfer.offRDC) < 0.5f) s_transfer.offRDC = 0.0f;
+}
+
+/**
+ * @brief
+ * Modo STATE_FEEDBACK: salidas y registros del LQI para el paso en curso.
+ * @note
+ * Llamar con el lock tomado y una estimación del observador válida. La
+ * entrada de equilibrio del rotor principal es la del mapa de equilibrio en
+ * la consigna (la misma base que la lógica de subida), en U. No hay lógicas
+ * de salida: los registros salen de U_to_Register con Uv_max / Uh_max.
+ */
+static void PID4_StateFeedbackUnlocked(float dt, float &Uh, float &Uv, int &regMP, int &regRDC,
+                                       float &trackUh, float &trackUv)
+{
+    const float uEqMain = EqMap_lookup(PID4_FeedforwardMapUnlocked(), s_refVertDeg) *
+                          s_pid4_params.Uv_max * 0.01f;
+    SfOutput o;
+    StateFeedback_step(s_sf, s_obsEst, s_refVertDeg, s_refHorDeg, uEqMain, dt,
+                       s_pid4_params.Uv_max, s_pid4_params.Uh_max, o);
+    Uh      = o.Uh;
+    Uv      = o.Uv;
+    trackUh = o.cutH;
+    trackUv = o.cutV;
+    regRDC  = U_to_Register(Uh, s_pid4_params.Uh_max);
+    regMP   = U_to_Register(Uv, s_pid4_params.Uv_max);
+}
+
+// Resultado del paso para la telemetría (con el lock tomado)
+static void PID4_FillResultUnlocked(PID4StepResult &r, const PID4Partials &parts, float Uh, float Uv,
+                                    int regMP, int regRDC, float trackUh, float trackUv,
+                                    int spMP, int spRDC)
+{
+    r.enabled    = true;
+    r.refVertDeg = s_refVertDeg;
+    r.refHorDeg  = s_refHorDeg;
+    r.parts      = parts;
+    r.Uh         = Uh;
+    r.Uv         = Uv;
+    r.regMP      = regMP;
+    r.regRDC     = regRDC;
+    r.trackUh    = trackUh;
+    r.trackUv    = trackUv;
+    r.gainGen    = s_gainApplied.load(std::memory_order_relaxed);
+    r.spMP       = spMP;
+    r.spRDC      = spRDC;
+    const bool cascade = (s_pidMode == PIDMode::CASCADE);
+    r.rpmMP      = cascade ? s_speedMP.filt  * s_speedMP.rpmMax  * 0.01f : 0.0f;
+    r.rpmRDC     = cascade ? s_speedRDC.filt * s_speedRDC.rpmMax * 0.01f : 0.0f;
+}
+
 /**
  * @brief
  * Ejecuta un paso del controlador PID-4.
@@ -676,11 +1501,11 @@ static int ApplyHorizontalBidirectionalControl(int deltaRDC,
  * - Convierte a radianes
  * - Calcula errores eh/ev
  * - Ejecuta PID4_Update (que en SISO queda efectivamente con los PIDs anulados)
- * - Convierte a registros y aplica MotorControl_update
+ * - Convierte a registros y escribe los DACs (MotorControl_writeOutputs)
  *
  * Además:
- *  - Si modo vertical-only -> fuerza Registro_RDC=0
- *  - Si modo horizontal-only -> fuerza Registro_MP=0
+ *  - Si modo vertical-only -> fuerza regRDC=0
+ *  - Si modo horizontal-only -> fuerza regMP=0
  */
 void PID4_Step(float dt)
 {
@@ -702,38 +1527,78 @@ void PID4_Step(float dt)
     float eh = refH_rad - measH_rad;
 
     // 4) Ejecutar PID-4
+    PID_LOCK();
     float Uh, Uv;
-    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv);
+    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv, nullptr, measH_rad, measV_rad);
 
     // 5) Registro horizontal (igual que antes)
-    Registro_RDC = U_to_Register(Uh, s_pid4_params.Uh_max);
+    int regRDC = U_to_Register(Uh, s_pid4_params.Uh_max);
 
     // 6) Registro vertical: aplicar "Opción B"
     int deltaMP = U_to_Register(Uv, s_pid4_params.Uv_max);
-    Registro_MP = ApplyVerticalUnidirectionalControl_Up(deltaMP, s_refVertDeg);
+    int regMP = ApplyVerticalUnidirectionalControl_Up(deltaMP, s_refVertDeg);
 
     // 7) Forzar salidas según modo SISO
     if (s_pidMode == PIDMode::VERTICAL_ONLY) {
-        Registro_RDC = 0;
+        regRDC = 0;
     } else if (s_pidMode == PIDMode::HORIZONTAL_ONLY) {
-        Registro_MP = 0;
+        regMP = 0;
     }
+    PID4_ApplyTransferUnlocked(regMP, regRDC, dt);
+    PID4_ApplyCascadeUnlocked(regMP, regRDC, dt);
+    PID_UNLOCK();
 
-    // 8) Aplicar a los DACs / sliders
-    MotorControl_update(Registro_MP, Registro_RDC);
+    // 8) Aplicar a los DACs (la parte gráfica la refresca la tarea de interfaz)
+    MotorControl_writeOutputs(regMP, regRDC);
 }
 
 /**
  * @brief
- * Igual que PID4_Step, pero usando medidas ya proporcionadas (en grados).
+ * Paso común de PID4_StepWithCounts y PID4_StepWithMeasurements.
  * @note
- * Útil si las lecturas vienen de otro lugar o quieres simular.
+ * Las lógicas de salida trabajan en grados; las cuentas solo las usa el
+ * PID-4 en coma fija (PID_FIXED_POINT = 1).
+ * Si result no es nulo, se rellena con lo necesario para la telemetría
+ * (consignas, salidas parciales, Uh/Uv y registros) sin formatear nada.
  */
-void PID4_StepWithMeasurements(float dt, float measVertDeg, float measHorDeg)
+static void PID4_StepImpl(float dt, float measVertDeg, float measHorDeg,
+                          int16_t countV, int16_t countH, PID4StepResult *result)
 {
+    if (result) result->enabled = false;
+    s_lastMeasVertDeg = measVertDeg;
+    s_lastMeasHorDeg  = measHorDeg;
+    s_lastCountV      = countV;
+    s_lastCountH      = countH;
     if (!s_pid4_enabled) return;
     if (dt <= 0.0f) dt = 1e-3f;
 
+    PID_LOCK();
+
+    // 0) Ganancias publicadas desde la interfaz (entre muestras, sin reset)
+    //    y consignas de la trayectoria
+    PID4_TakeGainsUnlocked();
+    s_stepSample++;
+    PID4_AdvanceReferencesUnlocked(dt);
+
+    // Realimentación del estado: el LQI sustituye al PID-4 y a las lógicas de salida
+    if (s_pidMode == PIDMode::STATE_FEEDBACK && s_obsEst.valid) {
+        (void)countV;
+        (void)countH;
+        float Uh, Uv, trackUh, trackUv;
+        int regMP, regRDC;
+        PID4_StateFeedbackUnlocked(dt, Uh, Uv, regMP, regRDC, trackUh, trackUv);
+        PID4_ApplyTransferUnlocked(regMP, regRDC, dt);
+        if (result) {
+            PID4_FillResultUnlocked(*result, PID4Partials{}, Uh, Uv, regMP, regRDC, trackUh, trackUv,
+                                    regMP, regRDC);
+        }
+        PID_UNLOCK();
+
+        PROF_SCOPE(PROF_DAC);
+        MotorControl_writeOutputs(regMP, regRDC);
+        return;
+    }
+
     // 1) Convertir a RAD (PID interno trabaja en rad)
     float refV_rad  = s_refVertDeg * DEG_TO_RAD;
     float refH_rad  = s_refHorDeg  * DEG_TO_RAD;
@@ -747,198 +1612,177 @@ void PID4_StepWithMeasurements(float dt, float measVertDeg, float measHorDeg)
 
     float eh = refH_rad - measH_rad;   // horizontal
 
-    // 3) PID-4
-    float Uh, Uv;
-    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv);
-
-    // 4) Registro horizontal (con reducción si la consigna es negativa)
-    int deltaRDC = U_to_Register(Uh, s_pid4_params.Uh_max);
+    // Medida que ve la derivada: los ángulos filtrados del observador, si se piden
+    const bool obsDeriv = s_obsDerivative && s_obsEst.valid;
 
-    // --- Reducción cerca de cero (|ref| <= 35 deg) ---
-    static constexpr float H_NEAR0_DEG = 35.0f;
-    static constexpr float K_RDC_NEAR0 = 0.80f; // prueba 0.75..0.90
-    static constexpr float K_RDC_NEG = 0.65f;
+    // 3) PID-4 y conversión a registro (con las tablas PID_* si las hay)
+    float Uh, Uv;
+    PID4Partials parts;
+    int deltaRDC, deltaMP;
+#if PID_FIXED_POINT
+    const PID4FixedParams *fp = &s_pid4_fixed_params;
+    PID4FixedParams schedParams;
+    if (s_schedPidActive) {
+        PID4_ScheduleGains(s_pid4_fixed_params, schedParams, measVertDeg, measHorDeg);
+        fp = &schedParams;
+    }
 
-    // 1) Si la consigna está cerca de cero, reduce en ambos sentidos
-    if (fabsf(s_refHorDeg) <= H_NEAR0_DEG) {
-        // entre -35 y +35
-        deltaRDC = (int)lroundf((float)deltaRDC * K_RDC_NEAR0);
+    // Errores en cuentas, salidas ya en unidades de registro (ev / eh no se usan)
+    (void)ev;
+    (void)eh;
+    const Q16 cV = Q16::fromInt(countV);
+    const Q16 cH = Q16::fromInt(countH);
+    Q16 Rh, Rv;
+    PID4FixedPartials fparts;
+    const Q16 dH = obsDeriv ? Q16::fromFloat(s_obsEst.angleHDeg / s_degPerCountH) : cH;
+    const Q16 dV = obsDeriv ? Q16::fromFloat(s_obsEst.angleVDeg / s_degPerCountV) : cV;
+    PID4Fixed_Update(*fp, s_pid4_fixed_state,
+                     s_refHorCounts - cH, s_refVertCounts - cV, Q16::fromFloat(dt),
+                     Rh, Rv, &fparts, dH, dV);
+    deltaRDC = PID4Fixed_ToRegister(Rh);
+    deltaMP  = PID4Fixed_ToRegister(Rv);
+
+    // Telemetría en U, como el camino en float
+    if (result) {
+        Uh = PID4Fixed_ToU(Rh, s_pid4_params.Uh_max);
+        Uv = PID4Fixed_ToU(Rv, s_pid4_params.Uv_max);
+        parts.u_hh = PID4Fixed_ToU(fparts.u_hh, s_pid4_params.Uh_max);
+        parts.u_hv = PID4Fixed_ToU(fparts.u_hv, s_pid4_params.Uv_max);
+        parts.u_vh = PID4Fixed_ToU(fparts.u_vh, s_pid4_params.Uh_max);
+        parts.u_vv = PID4Fixed_ToU(fparts.u_vv, s_pid4_params.Uv_max);
+    }
+#else
+    (void)countV;
+    (void)countH;
+    const PID4Params *pp = &s_pid4_params;
+    PID4Params schedParams;
+    if (s_schedPidActive) {
+        PID4_ScheduleGains(s_pid4_params, schedParams, measVertDeg, measHorDeg);
+        pp = &schedParams;
     }
-    else if (s_refHorDeg < -H_NEAR0_DEG) {
-        // por debajo de -35
-        deltaRDC = (int)lroundf((float)deltaRDC * K_RDC_NEG);
+    const float dH = obsDeriv ? s_obsEst.angleHDeg * DEG_TO_RAD : measH_rad;
+    const float dV = obsDeriv ? s_obsEst.angleVDeg * DEG_TO_RAD : measV_rad;
+    PID4_Update(*pp, s_pid4_state, eh, ev, dt, Uh, Uv, &parts, dH, dV);
+    deltaRDC = U_to_Register(Uh, s_pid4_params.Uh_max);
+    deltaMP  = U_to_Register(Uv, s_pid4_params.Uv_max);
+#endif
+
+    // 4) Registro horizontal: escala de deltaRDC según la tabla SHAPE_H (por
+    //    defecto reduce cerca de cero y más con la consigna por debajo de -35°).
+    //    El anti-windup no trata esta escala como recorte.
+    const float kRdc = PID4_RdcScale(measVertDeg, measHorDeg);
+    if (s_sched[GS_SHAPE_H].n) deltaRDC = (int)lroundf((float)deltaRDC * kRdc);
+    const int deltaRDCReq = deltaRDC;
+
+    // Parámetros de las lógicas verticales (tabla SHAPE_V)
+    if (s_sched[GS_SHAPE_V].n) {
+        const GsTable &t = s_sched[GS_SHAPE_V];
+        float gs[GS_COLS];
+        GainSchedule_lookup(t, PID4_ScheduleX(t.index, measVertDeg, measHorDeg), gs);
+        s_vShape = { (int)lroundf(gs[0]), gs[1], gs[2], gs[3] };
     }
-    
+
     // Clamp final por seguridad
     if (deltaRDC > 100)  deltaRDC = 100;
     if (deltaRDC < -100) deltaRDC = -100;
 
-    Registro_RDC = deltaRDC;
-
-    // 5) Registro vertical: convertir Uv a delta y aplicar Opción B
-    
-    int deltaMP = U_to_Register(Uv, s_pid4_params.Uv_max);
-
+    // 5) Registro vertical: aplicar Opción B sobre deltaMP
+    int regMP   = 0;
+    int appliedMP = deltaMP, appliedRDC = deltaRDC;
 
-
-    Registro_RDC = ApplyHorizontalBidirectionalControl(deltaRDC, errH_deg, s_refHorDeg);
+    int regRDC = ApplyHorizontalBidirectionalControl(deltaRDC, errH_deg, s_goalHorDeg, &appliedRDC);
 
     switch (s_vertZone) {
     case VertRefZone::ABOVE_REST:
         // ref > -37
-        Registro_MP = ApplyVerticalUnidirectionalControl_Up(deltaMP, errDeg);
+        regMP = ApplyVerticalUnidirectionalControl_Up(deltaMP, errDeg, &appliedMP);
         break;
 
     case VertRefZone::BELOW_REST:
         // ref < -36
-        Registro_MP = ApplyVerticalUnidirectionalControl_Down(deltaMP, errDeg);
+        regMP = ApplyVerticalUnidirectionalControl_Down(deltaMP, errDeg, &appliedMP);
         break;
 
     case VertRefZone::REST_BAND:
     default:
         // -37 <= ref <= -36
-        Registro_MP = ApplyVerticalBandHold(deltaMP, errDeg, measVertDeg);
+        regMP = ApplyVerticalBandHold(deltaMP, errDeg, measVertDeg, &appliedMP);
         break;
     }
-    
-    // 6) Forzar salidas según modo
+
+    // 6) Anti-windup: lo que se ha quedado sin aplicar (Uh/Uv_max y lógicas de
+    //    salida, referido a la salida del PID-4) vuelve a los integradores
+    const float cutRegH = (kRdc != 0.0f) ? (float)(appliedRDC - deltaRDCReq) / kRdc : 0.0f;
+    const float cutRegV = (float)(appliedMP - deltaMP);
+    float trackUh, trackUv;
+#if PID_FIXED_POINT
+    const Q16 trackRh = (Rh - (fparts.u_hh + fparts.u_vh)) + Q16::fromFloat(cutRegH);
+    const Q16 trackRv = (Rv - (fparts.u_hv + fparts.u_vv)) + Q16::fromFloat(cutRegV);
+    s_pid4_fixed_state.track(*fp, trackRh, trackRv, Q16::fromFloat(dt));
+    trackUh = PID4Fixed_ToU(trackRh, s_pid4_params.Uh_max);
+    trackUv = PID4Fixed_ToU(trackRv, s_pid4_params.Uv_max);
+#else
+    trackUh = (Uh - (parts.u_hh + parts.u_vh)) + cutRegH * s_pid4_params.Uh_max * 0.01f;
+    trackUv = (Uv - (parts.u_hv + parts.u_vv)) + cutRegV * s_pid4_params.Uv_max * 0.01f;
+    PID4_Track(*pp, s_pid4_state, trackUh, trackUv, dt);
+#endif
+
+    // 7) Forzar salidas según modo
     if (s_pidMode == PIDMode::VERTICAL_ONLY) {
-        Registro_RDC = 0;
+        regRDC = 0;
     } else if (s_pidMode == PIDMode::HORIZONTAL_ONLY) {
-        Registro_MP = 0;
+        regMP = 0;
     }
-/*
-    // DEBUG: modo actual antes de aplicar motores
-        static uint32_t lastModePrint = 0;
-        uint32_t nowMode = millis();
-        if (nowMode - lastModePrint > 500) {   // cada 500 ms
-            lastModePrint = nowMode;
-
-            const char* modeStr =
-                (s_pidMode == PIDMode::MIMO_FULL)       ? "MIMO_FULL" :
-                (s_pidMode == PIDMode::VERTICAL_ONLY)   ? "VERTICAL_ONLY" :
-                (s_pidMode == PIDMode::HORIZONTAL_ONLY) ? "HORIZONTAL_ONLY" :
-                                                        "UNKNOWN";
-
-            Serial.printf(
-                "[PID MODE] %s | MP=%d | RDC=%d\n",
-                modeStr, Registro_MP, Registro_RDC
-            );
-        }
-*/
-    // 7) Aplicar
-    MotorControl_update(Registro_MP, Registro_RDC);
-
-    // ------------------------------------------------------------
-    // 8) DEBUG mínimo: ref/meas/err + Uv + Uvmax + deltaMP + registros
-    // ------------------------------------------------------------
-    static uint32_t lastPrintMs = 0;
-    uint32_t now = millis();
-
-    if (now - lastPrintMs >= 500) { // cada 500 ms
-        lastPrintMs = now;
-        char buf[256];
-
-        //float errDeg = (s_refVertDeg - measVertDeg);
-
-        if (s_pidMode == PIDMode::VERTICAL_ONLY) {
-            // Solo vv (ev -> Uv)
-            /*snprintf(buf, sizeof(buf),
-                "PID V-ONLY\n"
-                "vv: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "Uvmax=%.3f",
-                s_pid4_params.vv.Kp, s_pid4_params.vv.Ki, s_pid4_params.vv.Kd, s_pid4_params.vv.I_sat,
-                s_pid4_params.Uv_max ); */
-/*
-            if (logger_start && millis() - last >= 50) {
-                last += 50;            // mantiene periodo estable
-                Serial.print(measVertDeg);
-                Serial.print(" ");
-                Serial.println(s_refVertDeg);
-        } */
-    /*    
-
-        Serial.printf(
-            "[PID V] refV=%.2f | measV=%.2f | err=%.2f || "
-            "Uv=%.5f/Uvmax=%.5f || deltaMP=%d -> Reg_MP=%d (bias=%d)\n",
-            s_refVertDeg, measVertDeg, errDeg,
-            Uv, s_pid4_params.Uv_max,
-            deltaMP, Registro_MP, s_MP_eq
-        );
-    
-
-        Serial.printf("measVertDeg=%.2f deg | measV_rad=%.4f rad\n",
-              measVertDeg, measV_rad); */
-
-        } else if (s_pidMode == PIDMode::HORIZONTAL_ONLY) {
-            /* //Solo hh (eh -> Uh)
-            snprintf(buf, sizeof(buf),
-                "PID H-ONLY\n"
-                "hh: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "Uhmax=%.3f",
-                s_pid4_params.hh.Kp, s_pid4_params.hh.Ki, s_pid4_params.hh.Kd, s_pid4_params.hh.I_sat,
-                s_pid4_params.Uh_max
-            );*/
-        } 
+    PID4_ApplyTransferUnlocked(regMP, regRDC, dt);
+    const int spMP = regMP, spRDC = regRDC;
+    PID4_ApplyCascadeUnlocked(regMP, regRDC, dt);
+
+    if (result) {
+        PID4_FillResultUnlocked(*result, parts, Uh, Uv, regMP, regRDC, trackUh, trackUv, spMP, spRDC);
     }
-        
-}
-
-
-
-    /*
-    // ------------------------------------------------------------
-    // DEBUG extendido: imprimir SOLO constantes usadas por el PID
-    // (Deja esto comentado y actívalo si lo necesitas)
-    // ------------------------------------------------------------
-    static uint32_t lastPrintMs2 = 0;
-    uint32_t now2 = millis();
-
-    if (now2 - lastPrintMs2 >= 500) { // cada 500 ms
-        lastPrintMs2 = now2;
-
-        char buf[256];
-
-        if (s_pidMode == PIDMode::VERTICAL_ONLY) {
-            // Solo vv (ev -> Uv)
-            snprintf(buf, sizeof(buf),
-                "PID V-ONLY\n"
-                "vv: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "Uvmax=%.3f",
-                s_pid4_params.vv.Kp, s_pid4_params.vv.Ki, s_pid4_params.vv.Kd, s_pid4_params.vv.I_sat,
-                s_pid4_params.Uv_max
-            );
-
-        } else if (s_pidMode == PIDMode::HORIZONTAL_ONLY) {
-            // Solo hh (eh -> Uh)
-            snprintf(buf, sizeof(buf),
-                "PID H-ONLY\n"
-                "hh: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "Uhmax=%.3f",
-                s_pid4_params.hh.Kp, s_pid4_params.hh.Ki, s_pid4_params.hh.Kd, s_pid4_params.hh.I_sat,
-                s_pid4_params.Uh_max
-            );
-
-        } else {
-            // MIMO completo
-            snprintf(buf, sizeof(buf),
-                "PID MIMO\n"
-                "hh: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "hv: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "vh: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "vv: Kp=%.4f Ki=%.4f Kd=%.4f Isat=%.4f\n"
-                "Uhmax=%.3f Uvmax=%.3f",
-                s_pid4_params.hh.Kp, s_pid4_params.hh.Ki, s_pid4_params.hh.Kd, s_pid4_params.hh.I_sat,
-                s_pid4_params.hv.Kp, s_pid4_params.hv.Ki, s_pid4_params.hv.Kd, s_pid4_params.hv.I_sat,
-                s_pid4_params.vh.Kp, s_pid4_params.vh.Ki, s_pid4_params.vh.Kd, s_pid4_params.vh.I_sat,
-                s_pid4_params.vv.Kp, s_pid4_params.vv.Ki, s_pid4_params.vv.Kd, s_pid4_params.vv.I_sat,
-                s_pid4_params.Uh_max, s_pid4_params.Uv_max
-            );
-        }
+    PID_UNLOCK();
 
-        Serial.println(buf);
+    // 8) Aplicar (solo DAC: la tarea de interfaz se encarga de flechas y labels)
+    {
+        PROF_SCOPE(PROF_DAC);
+        MotorControl_writeOutputs(regMP, regRDC);
     }
-    */
+}
+
+/**
+ * @brief
+ * Ejecuta un paso con las cuentas de los encoders.
+ * @note
+ * Los grados para las lógicas de salida se obtienen con la escala de
+ * PID4_SetEncoderScale (mismo cálculo que hacía ControlCycle).
+ */
+void PID4_StepWithCounts(float dt, int16_t countV, int16_t countH,
+                         PID4StepResult *result)
+{
+    float measVertDeg = (float)countV * s_degPerCountV;
+    float measHorDeg  = (float)countH * s_degPerCountH;
+    PID4_StepImpl(dt, measVertDeg, measHorDeg, countV, countH, result);
+}
+
+/**
+ * @brief
+ * Igual que PID4_Step, pero usando medidas ya proporcionadas (en grados).
+ * @note
+ * Útil si las lecturas vienen de otro lugar o quieres simular. En coma fija
+ * las cuentas se reconstruyen a partir de los grados.
+ */
+void PID4_StepWithMeasurements(float dt, float measVertDeg, float measHorDeg,
+                               PID4StepResult *result)
+{
+#if PID_FIXED_POINT
+    int16_t countV = (int16_t)lroundf(measVertDeg / s_degPerCountV);
+    int16_t countH = (int16_t)lroundf(measHorDeg  / s_degPerCountH);
+#else
+    int16_t countV = 0;
+    int16_t countH = 0;
+#endif
+    PID4_StepImpl(dt, measVertDeg, measHorDeg, countV, countH, result);
+}
 
 /* ------------------------------------------------------------------------------------
    FUNCIONES “ANTIGUAS” (compatibilidad)
@@ -964,8 +1808,9 @@ void PID4_Vertical_Step(float dt, float measVertDeg, float measHorDeg)
     float ev = refV_rad - measV_rad;
     float eh = refH_rad - measH_rad;
 
+    PID_LOCK();
     float Uh, Uv;
-    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv);
+    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv, nullptr, measH_rad, measV_rad);
 
     // Horizontal a 0
     int rdc_zero = 0;
@@ -973,8 +1818,9 @@ void PID4_Vertical_Step(float dt, float measVertDeg, float measHorDeg)
     // Vertical con Opción B
     int deltaMP = U_to_Register(Uv, s_pid4_params.Uv_max);
     int mp = ApplyVerticalUnidirectionalControl_Up(deltaMP, s_refVertDeg);
+    PID_UNLOCK();
 
-    MotorControl_update(mp, rdc_zero);
+    MotorControl_writeOutputs(mp, rdc_zero);
 }
 
 void PID4_Horizontal_Step(float dt, float measVertDeg, float measHorDeg)
@@ -990,18 +1836,21 @@ void PID4_Horizontal_Step(float dt, float measVertDeg, float measHorDeg)
     float ev = refV_rad - measV_rad;
     float eh = refH_rad - measH_rad;
 
+    PID_LOCK();
     float Uh, Uv;
-    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv);
+    PID4_Update(s_pid4_params, s_pid4_state, eh, ev, dt, Uh, Uv, nullptr, measH_rad, measV_rad);
 
     // Vertical a 0
     int mp_zero = 0;
 
     // Horizontal normal
     int rdc = U_to_Register(Uh, s_pid4_params.Uh_max);
+    PID_UNLOCK();
 
-    MotorControl_update(mp_zero, rdc);
+    MotorControl_writeOutputs(mp_zero, rdc);
 }
 
+#ifndef TRMS_NATIVE
 // Actualización de las series de referencia en la gráfica del UI
 void Chart_UpdateReferences(float refH_deg, float refV_deg)
 {
@@ -1015,10 +1864,70 @@ void Chart_UpdateReferences(float refH_deg, float refV_deg)
     lv_chart_refresh(ui_GraphEncoder3);
 }
 
-// Función para ajustar el registro de equilibrio vertical
+void Chart_PushReferences(float refH_deg, float refV_deg)
+{
+    lv_chart_set_next_value(ui_GraphEncoder3, ui_GraphEncoder3_series_refH, (lv_coord_t)refH_deg);
+    lv_chart_set_next_value(ui_GraphEncoder3, ui_GraphEncoder3_series_refV, (lv_coord_t)refV_deg);
+}
+#endif // TRMS_NATIVE
+
+// =====================================================
+// Feedforward vertical (mapa de equilibrio)
+// =====================================================
+
+// Rehace con la nueva recta los puntos que aún no han aprendido nada
+static void PID4_SetFeedforwardPrior(const EqMapPrior &prior)
+{
+    PID_LOCK();
+    s_ffPrior = prior;
+    EqMap_reset(PID4_FeedforwardMapUnlocked(), s_ffPrior, true);
+    PID_UNLOCK();
+}
+
+void PID4_SetVerticalFeedforwardAtThreshold(int mp_at_threshold)
+{
+    if (mp_at_threshold > 100) mp_at_threshold = 100;
+    if (mp_at_threshold < 0)   mp_at_threshold = 0;
+    EqMapPrior p = s_ffPrior;
+    p.mpAtThreshold = (float)mp_at_threshold;
+    PID4_SetFeedforwardPrior(p);
+}
+
+void PID4_SetVerticalFeedforwardSlopes(float slope_up, float slope_down)
+{
+    EqMapPrior p = s_ffPrior;
+    p.slopeUp   = slope_up;
+    p.slopeDown = slope_down;
+    PID4_SetFeedforwardPrior(p);
+}
+
+// Función para ajustar el registro de equilibrio vertical (antiguo bias fijo: recta plana)
 void PID4_SetVerticalEquilibriumRegister(int mp_eq)
 {
     if (mp_eq > 100)  mp_eq = 100;
     if (mp_eq < -100) mp_eq = -100;
-    s_MP_eq = mp_eq;
+    PID4_SetFeedforwardPrior({ (float)mp_eq, 0.0f, 0.0f });
+}
+
+void PID4_ResetVerticalFeedforward()
+{
+    PID_LOCK();
+    EqMap_reset(s_ffMap, s_ffPrior);
+    PID_UNLOCK();
+}
+
+void PID4_GetVerticalFeedforwardMap(EqMap &out)
+{
+    PID_LOCK();
+    out = PID4_FeedforwardMapUnlocked();
+    PID_UNLOCK();
+}
+
+bool PID4_SetVerticalFeedforwardMap(const EqMap &map)
+{
+    if (!EqMap_isValid(map)) return false;
+    PID_LOCK();
+    s_ffMap = map;
+    PID_UNLOCK();
+    return true;
 }
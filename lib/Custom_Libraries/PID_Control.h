@@ -1,28 +1,52 @@
 #pragma once
-#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
 #include "PID_Parameters.h"
 #include "MotorControl.h"
+#include "PID_Template.h"
+#include "GainSchedule.h"
+#include "EquilibriumMap.h"
+#include "RefTrajectory.h"
+#include "StateObserver.h"
+
+// =====================================================
+// Variante del PID (se elige al compilar, ver "PID_Template.h")
+// -----------------------------------------------------
+// Se puede cambiar con build_flags sin tocar el código, p. ej.:
+//   -D PID_DERIVATIVE_POLICY=DerivativeOnMeasurement
+//   '-D PID_FILTER_POLICY=LowPassFilter<5000>'   (entre comillas por los < >)
+// Por defecto: derivada del error o de la medida y filtro de la derivada según
+// PID_CURR (DerivOnMeasCurr, TfvCurr, TfhCurr) e integrador saturado con
+// seguimiento de la salida aplicada (Kt**Curr). Con DerivOnMeasCurr = false,
+// Tf = 0 y Kt = 0 es el algoritmo original.
+// =====================================================
+#ifndef PID_DERIVATIVE_POLICY
+#define PID_DERIVATIVE_POLICY DerivativeSelectable
+#endif
+#ifndef PID_ANTIWINDUP_POLICY
+#define PID_ANTIWINDUP_POLICY BackCalculation
+#endif
+#ifndef PID_FILTER_POLICY
+#define PID_FILTER_POLICY LowPassRuntime
+#endif
+
+// PID-4 en coma fija Q16.16 sobre cuentas de encoder (ver "PID_Fixed.h").
+// 0 = float (por defecto), 1 = coma fija: -D PID_FIXED_POINT=1
+#ifndef PID_FIXED_POINT
+#define PID_FIXED_POINT 0
+#endif
 
 /**
  * Estructura de parámetros de un PID
  * (equivalente a un bloque de Simulink: Kp, Ki, Kd, Isat).
  */
-struct PIDParams {
-    float Kp;      // Kp* u
-    float Ki;      // Ki* u -> integrado
-    float Kd;      // Kd* du/dt
-    float I_sat;   // saturación de la PARTE INTEGRAL (±I_sat)
-};
+typedef PidGains<float> PIDParams;
 
 /**
  * Estado interno del PID.
  * Un objeto de estos por cada PID (PIDvv, PIDvh, PIDhv, PIDhh).
  */
-struct PIDState {
-    float integrator;  // estado del integrador (ya incluye Ki)
-    float prevInput;   // u[k-1]
-    bool  firstRun;    // para inicializar derivada la primera vez
-};
+typedef Pid<float, PID_DERIVATIVE_POLICY, PID_ANTIWINDUP_POLICY, PID_FILTER_POLICY> PIDState;
 
 /**
  * Inicializa el estado del PID.
@@ -37,43 +61,82 @@ void PID_Reset(PIDState &state);
  * @param state   Estado interno del PID (integrador, memoria)
  * @param input   Entrada u (normalmente el error: ref - medida)
  * @param dt      Tiempo de muestreo [s]
+ * @param meas    Medida (para la derivada de la medida)
  *
  * @return salida del PID (antes de Umax/Uhmax/Uvmax, eso va aparte)
  */
 float PID_Update(const PIDParams &params,
                  PIDState        &state,
                  float            input,
-                 float            dt);
+                 float            dt,
+                 float            meas = 0.0f);
 
 // =====================================================
 // Bloque PID-4 (MIMO 2x2) para el TRMS
 // =====================================================
 
-struct PID4Params {
-    PIDParams hh;   // PIDhh: in_1 -> out_1
-    PIDParams hv;   // PIDhv: in_1 -> out_2
-    PIDParams vh;   // PIDvh: in_2 -> out_1
-    PIDParams vv;   // PIDvv: in_2 -> out_2
-
-    float Uh_max;   // saturación simétrica para out_1 (±Uh_max)
-    float Uv_max;   // saturación simétrica para out_2 (±Uv_max)
-};
+typedef Pid4Gains<float>    PID4Params;
+typedef Pid4<PIDState>      PID4State;
+typedef Pid4Partials<float> PID4Partials;
 
-struct PID4State {
-    PIDState hh;
-    PIDState hv;
-    PIDState vh;
-    PIDState vv;
+/**
+ * Resultado de un paso del PID-4, para publicar en la telemetría.
+ * Lo rellena PID4_StepWithMeasurements si se le pasa un puntero.
+ */
+struct PID4StepResult {
+    bool         enabled;      // false => el paso no ha hecho nada (resto sin significado)
+    float        refVertDeg;   // consignas usadas en el paso
+    float        refHorDeg;
+    PID4Partials parts;        // (a 0 en STATE_FEEDBACK)
+    float        Uh;           // salidas MIMO saturadas
+    float        Uv;
+    int          regMP;        // registros aplicados a los DAC
+    int          regRDC;
+    float        trackUh;      // aplicada - pedida por los PID (Uh_max, lógicas de salida) [U]
+    float        trackUv;      // (0 = salida sin recortar; es lo que sigue el anti-windup)
+    uint32_t     gainGen;      // generación de ganancias usada (ver PID4GainEvent)
+    int          spMP;         // consignas de velocidad [% de rpmMax] (CASCADE; si no, = reg*)
+    int          spRDC;
+    float        rpmMP;        // velocidades filtradas de los tacómetros (CASCADE; si no, 0)
+    float        rpmRDC;
 };
 
+/**
+ * Modos de control.
+ * CASCADE usa el PID-4 completo (como MIMO_FULL), pero sus registros son
+ * consignas de velocidad de los rotores: un PI por motor sobre el tacómetro
+ * (PID_CASCADE) da el registro final. Necesita PID4_SetRotorSpeeds en cada paso.
+ * STATE_FEEDBACK sustituye el PID-4 por un LQI sobre la estimación del
+ * observador (ver "StateFeedback.h"), con los mismos Uh_max / Uv_max y registros.
+ * Necesita PID4_SetObserverEstimate en cada paso; sin estimación válida el paso
+ * usa el PID-4 completo, como MIMO_FULL.
+ */
 enum class PIDMode {
     MIMO_FULL,
     VERTICAL_ONLY,
-    HORIZONTAL_ONLY
+    HORIZONTAL_ONLY,
+    CASCADE,
+    STATE_FEEDBACK
 };
 
-// Selección de modo (MIMO / SISO)
+// Selección de modo (MIMO / SISO / cascada / realimentación del estado)
 void PID4_SetMode(PIDMode mode);
+PIDMode PID4_GetMode();
+
+// Parámetros de los lazos internos de velocidad (modo CASCADE). Resetea sus estados.
+void PID4_SetCascadeParams(const PID_CASCADE &cas);
+
+// Velocidades medidas de los rotores [rpm, con signo] para el próximo paso
+// (desde la tarea de control, antes de PID4_StepWithCounts; ver Tacho_readRpm)
+void PID4_SetRotorSpeeds(float rpmMP, float rpmRDC);
+
+// Estimación del observador para el próximo paso (desde la tarea de control, la
+// pasa ControlCycle; valid = false si no hay observador)
+void PID4_SetObserverEstimate(const ObserverEstimate &est);
+
+// Derivada de la medida sobre los ángulos filtrados del observador en lugar de
+// las cuentas (0.18° por cuenta). Sin estimación válida se usan las cuentas.
+void PID4_SetObserverDerivative(bool enable);
 
 /**
  * Resetea todos los integradores y memorias del bloque PID-4.
@@ -90,6 +153,9 @@ void PID4_Reset(PID4State &state);
  * @param dt      Tiempo de muestreo [s]
  * @param out1    out_1 (Uh) → señal para motor horizontal
  * @param out2    out_2 (Uv) → señal para motor vertical
+ * @param parts   (opcional) salidas parciales de cada PID
+ * @param meas1   medida horizontal (para la derivada de la medida)
+ * @param meas2   medida vertical   (para la derivada de la medida)
  */
 void PID4_Update(const PID4Params &params,
                  PID4State        &state,
@@ -97,7 +163,24 @@ void PID4_Update(const PID4Params &params,
                  float             in2,
                  float             dt,
                  float            &out1,
-                 float            &out2);
+                 float            &out2,
+                 PID4Partials     *parts = nullptr,
+                 float             meas1 = 0.0f,
+                 float             meas2 = 0.0f);
+
+/**
+ * Anti-windup por seguimiento: informa al PID-4 de lo que se aplicó realmente.
+ * Se llama después de PID4_Update, cuando ya se conocen los registros finales.
+ *
+ * @param excess1  Uh aplicada - (u_hh + u_vh) pedida  → a PIDhh y PIDvh
+ * @param excess2  Uv aplicada - (u_hv + u_vv) pedida  → a PIDhv y PIDvv
+ * @param dt       Tiempo de muestreo [s] (el mismo del paso)
+ */
+void PID4_Track(const PID4Params &params,
+                PID4State        &state,
+                float             excess1,
+                float             excess2,
+                float             dt);
 
 // ======================================
 // Módulo global de control PID-4 (TRMS)
@@ -106,9 +189,43 @@ void PID4_Update(const PID4Params &params,
 // Inicializa los parámetros del PID-4 a partir de g_pidCurr
 void PID4_LoadFromCurr(const PID_CURR &curr);
 
+/**
+ * Cambio de ganancias aplicado por el paso de control (registro de eventos).
+ * La telemetría lleva la generación de cada paso; con estos eventos se sabe
+ * qué ganancias estaban activas en cada muestra.
+ */
+struct PID4GainEvent {
+    uint32_t sample;   // primer paso (con el PID habilitado, desde el arranque) que las usa
+    int64_t  tUs;      // Clock_nowUs() al aplicarlas
+    uint32_t gen;      // generación
+    bool     reload;   // true = PID4_LoadFromCurr (con reset), false = cambio en marcha
+    PID_CURR gains;
+};
+
+// Eventos pendientes como máximo (potencia de 2); si se llena se pierden los nuevos
+static const size_t PID4_GAIN_LOG_CAPACITY = 8;
+
+// Publica ganancias para el PID en marcha, sin lock ni reset (desde la interfaz).
+// Devuelve false si el paso aún no ha aplicado la anterior: reintentar más tarde.
+bool PID4_PublishGains(const PID_CURR &curr);
+
+// Generación de ganancias aplicada por el paso de control
+uint32_t PID4_GetGainGeneration();
+
+// Extrae el evento de ganancias más antiguo (solo desde la tarea de interfaz)
+bool PID4_PopGainEvent(PID4GainEvent &ev);
+
 // Establece referencias (procedentes del display) en GRADOS
 void PID4_SetReferences(float refVertDeg, float refHorDeg);
 
+// Trayectoria de consigna por eje (curva en S, ver "RefTrajectory.h"). Desactivada por
+// defecto; vMax <= 0 la desactiva. La consigna de cada paso va en la telemetría (refVDeg/refHDeg)
+static const TrajLimits PID4_TRAJ_DEFAULT_VERT = { 10.0f, 20.0f, 100.0f };   // deg/s, deg/s^2, deg/s^3
+static const TrajLimits PID4_TRAJ_DEFAULT_HOR  = { 40.0f, 80.0f, 400.0f };
+
+void PID4_SetTrajectoryLimits(const TrajLimits &vert, const TrajLimits &hor);
+void PID4_GetTrajectoryLimits(TrajLimits &vert, TrajLimits &hor);
+
 // Habilita / deshabilita el control PID-4
 void PID4_SetEnabled(bool enable);
 bool PID4_IsEnabled();
@@ -116,25 +233,74 @@ bool PID4_IsEnabled();
 // Ejecuta un paso de control con lectura de encoders
 void PID4_Step(float dt);
 
-// Ejecuta un paso usando medidas externas (en GRADOS)
-void PID4_StepWithMeasurements(float dt, float measVertDeg, float measHorDeg);
+// Grados por cuenta de cada eje (para PID4_StepWithCounts y el PID-4 en coma fija)
+void PID4_SetEncoderScale(float degPerCountV, float degPerCountH);
+
+// Ejecuta un paso con las cuentas de los encoders (lo usa ControlCycle).
+// Con PID_FIXED_POINT = 1 el PID-4 trabaja directamente sobre las cuentas.
+void PID4_StepWithCounts(float dt, int16_t countV, int16_t countH,
+                         PID4StepResult *result = nullptr);
+
+// Ejecuta un paso usando medidas externas (en GRADOS).
+// Si result != nullptr devuelve consignas, parciales, salidas y registros del paso.
+void PID4_StepWithMeasurements(float dt, float measVertDeg, float measHorDeg,
+                               PID4StepResult *result = nullptr);
 void PID4_Vertical_Step(float dt, float measVertDeg, float measHorDeg);
 void PID4_Horizontal_Step(float dt, float measVertDeg, float measHorDeg);
 
+#ifndef TRMS_NATIVE
 // Actualiza las series de datos de las consignas del PID en la gráfica
 void Chart_UpdateReferences(float refH_deg, float refV_deg);
 
+// Añade un punto a las series de consigna (junto a la medida: muestra la trayectoria)
+void Chart_PushReferences(float refH_deg, float refV_deg);
+#endif
+
 // Reset global de estados internos (integradores/derivadas)
 void PID4_ResetStates();
 
+// Aviso de cambio de consigna desde la interfaz: con la derivada del error
+// resetea los estados (evita el pico de derivada); con la derivada de la
+// medida (DerivOnMeasCurr) no hace nada y los integradores se conservan.
+void PID4_HandleReferenceChange();
+
+// Reset de las bases aprendidas por las lógicas de salida (arranque en frío)
+void PID4_ResetShapingState();
 
 // =====================================================
-// NUEVO (opcional): ajuste de feedforward vertical
+// Tablas de ganancias por punto de funcionamiento (ver "GainSchedule.h")
+// -----------------------------------------------------
+// Multiplicadores de Kp/Ki/Kd/Isat de cada PID y parámetros de las lógicas
+// de salida en función de la consigna o de la medida. Las tablas por defecto
+// equivalen a las constantes fijas de antes (sin tablas PID_*).
+// =====================================================
+
+// Instala las tablas con n > 0; las demás vuelven a las de por defecto.
+// Devuelve false si alguna no es válida (esa también queda por defecto).
+bool PID4_LoadSchedules(const GsTableSpec specs[GS_TABLE_COUNT]);
+
+// Vuelve a las tablas por defecto
+void PID4_ResetSchedules();
+
+
+// =====================================================
+// Feedforward vertical: mapa de equilibrio (ver "EquilibriumMap.h")
 // (sustituye al antiguo "bias" fijo s_MP_eq)
 // -----------------------------------------------------
-// Umbral interno: ref = -30º
-// - mp_at_threshold: magnitud base (0..100) cuando ref = -30º
-// - slopes: pendiente por grado arriba/abajo del umbral
+// La lógica de subida parte del registro de equilibrio del mapa en la consigna
+// y el PID solo corrige el residuo. El mapa se aprende con la viga asentada y
+// arranca de una recta a tramos con el umbral en ref = -30º:
+// - mp_at_threshold: registro (0..100) cuando ref = -30º
+// - slopes: pendiente [reg/deg] por encima / por debajo del umbral
+// Cambiar la recta solo rehace los puntos que aún no han aprendido nada.
 // =====================================================
 void PID4_SetVerticalFeedforwardAtThreshold(int mp_at_threshold);
 void PID4_SetVerticalFeedforwardSlopes(float slope_up, float slope_down);
+
+// Olvida lo aprendido (vuelve a la recta). No lo hace PID4_ResetShapingState.
+void PID4_ResetVerticalFeedforward();
+
+// Copia / instala el mapa completo (para guardarlo en NVS y recuperarlo al arrancar).
+// PID4_SetVerticalFeedforwardMap devuelve false si el mapa no es válido.
+void PID4_GetVerticalFeedforwardMap(EqMap &out);
+bool PID4_SetVerticalFeedforwardMap(const EqMap &map);
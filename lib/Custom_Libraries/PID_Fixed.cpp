@@ -0,0 +1,74 @@
+/* Esta librería, junto con su correspondiente "PID_Fixed.h", implementa el PID-4 en coma fija
+Q16.16 (cuentas de encoder -> unidades de registro) */
+
+// PID_Fixed.cpp
+#include "PID_Fixed.h"
+
+#ifndef DEG_TO_RAD
+#define DEG_TO_RAD 0.01745329251994329577f   // pi/180
+#endif
+
+// Escala de registro: U = Umax -> 100
+static const float   REG_FULL_SCALE = 100.0f;
+static constexpr Q16 REG_MAX_Q      = Q16(100.0);
+
+static PidGains<Q16> gainsToFixed(const PIDParams &g, float radPerCount, float regPerU)
+{
+    PidGains<Q16> q;
+    q.Kp    = Q16::fromFloat(g.Kp * radPerCount * regPerU);
+    q.Ki    = Q16::fromFloat(g.Ki * radPerCount * regPerU);
+    q.Kd    = Q16::fromFloat(g.Kd * radPerCount * regPerU);
+    q.I_sat = Q16::fromFloat(g.I_sat * regPerU);
+    q.Tf    = Q16::fromFloat(g.Tf);
+    q.derivOnMeas = g.derivOnMeas;
+    q.Kt    = Q16::fromFloat(g.Kt);   // [1/s]: no depende de las unidades
+    return q;
+}
+
+/**
+ * @brief
+ * Reescala los parámetros del PID-4 al dominio cuentas -> registro.
+ * @note
+ * Se llama al cargar ganancias o cambiar de modo, nunca en el paso de control.
+ */
+void PID4Fixed_FromFloat(const PID4Params &p, float degPerCountV, float degPerCountH,
+                         PID4FixedParams &out)
+{
+    const float radPerCountH = degPerCountH * DEG_TO_RAD;
+    const float radPerCountV = degPerCountV * DEG_TO_RAD;
+    const float regPerUh = (p.Uh_max > 0.0f) ? REG_FULL_SCALE / p.Uh_max : 0.0f;
+    const float regPerUv = (p.Uv_max > 0.0f) ? REG_FULL_SCALE / p.Uv_max : 0.0f;
+
+    out.hh = gainsToFixed(p.hh, radPerCountH, regPerUh);   // in_1 -> out_1
+    out.hv = gainsToFixed(p.hv, radPerCountH, regPerUv);   // in_1 -> out_2
+    out.vh = gainsToFixed(p.vh, radPerCountV, regPerUh);   // in_2 -> out_1
+    out.vv = gainsToFixed(p.vv, radPerCountV, regPerUv);   // in_2 -> out_2
+
+    out.Uh_max = REG_MAX_Q;
+    out.Uv_max = REG_MAX_Q;
+}
+
+void PID4Fixed_Update(const PID4FixedParams &p, PID4FixedState &s,
+                      Q16 eh, Q16 ev, Q16 dt, Q16 &Rh, Q16 &Rv,
+                      PID4FixedPartials *parts, Q16 measH, Q16 measV)
+{
+    s.update(p, eh, ev, dt, Rh, Rv, parts, measH, measV);
+}
+
+/**
+ * @brief
+ * Convierte la salida en unidades de registro a registro entero.
+ * @note
+ * Equivale a U_to_Register: limita a ±100 y trunca hacia cero.
+ */
+int PID4Fixed_ToRegister(Q16 R)
+{
+    if (R >  REG_MAX_Q) R =  REG_MAX_Q;
+    if (R < -REG_MAX_Q) R = -REG_MAX_Q;
+    return (int)R.toIntTrunc();
+}
+
+float PID4Fixed_ToU(Q16 R, float Umax)
+{
+    return R.toFloat() * Umax / REG_FULL_SCALE;
+}
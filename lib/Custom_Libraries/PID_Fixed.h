@@ -0,0 +1,67 @@
+/* Esta librería, junto con su correspondiente "PID_Fixed.cpp", define la variante en coma fija
+(Q16.16, ver "FixedPoint.h") del bloque PID-4 y de la conversión a registro. Trabaja directamente
+con cuentas de encoder y saca las salidas ya en unidades de registro (-100..100): las ganancias se
+reescalan una vez al cargarlas y el paso de control es solo aritmética entera.
+
+El firmware la usa en lugar del PID-4 en float si se compila con -D PID_FIXED_POINT=1 */
+
+// PID_Fixed.h
+#pragma once
+
+#include <stdint.h>
+#include "FixedPoint.h"
+#include "PID_Control.h"
+
+/**
+ * @brief Diferencia máxima admitida frente al camino en float [cuentas de registro].
+ *
+ * Con las mismas cuentas, consignas y dt, el registro de cada eje (antes de las
+ * lógicas de salida) coincide con U_to_Register del PID-4 en float salvo en
+ * los bordes de truncado: la cuantificación de las ganancias (1/65536 en
+ * unidades de registro por cuenta) y del dt (1/65536 s, 0.1 % a 200 Hz) mueve
+ * la salida hasta ~0.25 unidades de registro en los ensayos de trms_fixed_compare
+ * (host/), que lo comprueba.
+ */
+static const int PID_FIXED_REG_TOLERANCE = 1;
+
+// Un PID, el bloque PID-4 y sus parámetros en Q16.16 (mismas políticas que PIDState)
+typedef Pid<Q16, PID_DERIVATIVE_POLICY, PID_ANTIWINDUP_POLICY, PID_FILTER_POLICY> PIDFixedState;
+typedef Pid4Gains<Q16>    PID4FixedParams;
+typedef Pid4<PIDFixedState> PID4FixedState;
+typedef Pid4Partials<Q16> PID4FixedPartials;
+
+/**
+ * @brief Convierte los parámetros en float (error en rad -> U) al dominio fijo.
+ *
+ * Entrada en cuentas y salida en unidades de registro: cada ganancia se
+ * multiplica por los rad/cuenta de su entrada y por 100/Umax de su salida;
+ * I_sat por 100/Umax y las saturaciones quedan en ±100. Con Umax <= 0 la
+ * salida se anula (como U_to_Register, que devuelve 0).
+ *
+ * @param p             Parámetros del PID-4 en float
+ * @param degPerCountV  Grados por cuenta del eje vertical (in_2)
+ * @param degPerCountH  Grados por cuenta del eje horizontal (in_1)
+ * @param out           Parámetros en Q16.16
+ */
+void PID4Fixed_FromFloat(const PID4Params &p, float degPerCountV, float degPerCountH,
+                         PID4FixedParams &out);
+
+/**
+ * @brief Evalúa el bloque PID-4 en coma fija.
+ *
+ * @param eh, ev        Errores horizontal y vertical [cuentas]
+ * @param dt            Tiempo de muestreo [s]
+ * @param Rh, Rv        Salidas saturadas [unidades de registro, ±100]
+ * @param parts         (opcional) salidas parciales
+ * @param measH, measV  Medidas [cuentas] (para la derivada de la medida)
+ */
+void PID4Fixed_Update(const PID4FixedParams &p, PID4FixedState &s,
+                      Q16 eh, Q16 ev, Q16 dt, Q16 &Rh, Q16 &Rv,
+                      PID4FixedPartials *parts = nullptr,
+                      Q16 measH = Q16(), Q16 measV = Q16());
+
+// Salida en unidades de registro -> registro entero -100..100 (trunca como U_to_Register)
+int PID4Fixed_ToRegister(Q16 R);
+
+// Salida en unidades de registro -> U equivalente del camino en float (solo telemetría)
+float PID4Fixed_ToU(Q16 R, float Umax);
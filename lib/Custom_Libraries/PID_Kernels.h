@@ -0,0 +1,27 @@
+/* Núcleos internos del PID-4 (conversión a registro y lógicas de salida vertical/horizontal).
+Se implementan en "PID_Control.cpp"; se declaran aquí solo para poder medirlos por separado
+(PID_Bench y el micro-benchmark de host/). La interfaz y el resto del firmware no deben llamarlos */
+
+// PID_Kernels.h
+#pragma once
+
+// Normaliza U respecto a Umax, limita a [-1,1] y escala a [-100,100]
+int U_to_Register(float U, float Umax);
+
+// Las lógicas de salida devuelven el registro final. Si appliedDelta no es nulo, escriben ahí la
+// parte del delta del PID que ha llegado a la salida (en unidades del delta): es igual al delta
+// salvo que algún límite lo recorte. En la zona muerta se devuelve el delta tal cual (no es
+// saturación). El anti-windup por seguimiento usa la diferencia.
+
+// Lógica vertical unidireccional hacia arriba (consigna por encima del reposo). Devuelve 15..100
+int ApplyVerticalUnidirectionalControl_Up(int deltaMP, float errDeg, int *appliedDelta = nullptr);
+
+// Lógica vertical unidireccional hacia abajo (consigna por debajo del reposo). Devuelve -100..0
+int ApplyVerticalUnidirectionalControl_Down(int deltaMP, float errDeg, int *appliedDelta = nullptr);
+
+// Consigna dentro de la banda de reposo: elige Up/Down según la medida
+int ApplyVerticalBandHold(int deltaMP, float errDeg, float measVertDeg, int *appliedDelta = nullptr);
+
+// Lógica horizontal bidireccional con base (trim) aprendida en equilibrio
+int ApplyHorizontalBidirectionalControl(int deltaRDC, float errDeg, float refH_deg,
+                                        int *appliedDelta = nullptr);
@@ -3,15 +3,17 @@
 */
 
 #include "PID_Parameters.h"
+#include "PID_Control.h"
+#include "HAL.h"
 #include <stdio.h>
+#ifndef TRMS_NATIVE
 #include "ui.h"
 #include <Preferences.h>
 
 // NAMESPACE/NOMBRE en NVS para estos parámetros
 static const char * PID_NVS_NAMESPACE = "pid_params";
-
-// Prototipo helper interno
-static void PID_SyncUIFromCurr();
+static const char * PID_FF_NVS_NAMESPACE = "pid_vff";   // mapa de equilibrio vertical
+#endif
 
 // ==============================
 // Valores iniciales (CURR)
@@ -38,7 +40,16 @@ PID_CURR g_pidCurr = {
     .IsathhCurr = 0.0f,
 
     .UvmaxCurr = 0.0f,
-    .UhmaxCurr = 0.0f
+    .UhmaxCurr = 0.0f,
+
+    .DerivOnMeasCurr = false,
+    .TfvCurr = 0.0f,
+    .TfhCurr = 0.0f,
+
+    .KtvvCurr = 0.0f,
+    .KtvhCurr = 0.0f,
+    .KthvCurr = 0.0f,
+    .KthhCurr = 0.0f
 };
 
 
@@ -99,6 +110,26 @@ PID_MAX g_pidMax = {
     .UhmaxMax = 3.3f
 };
 
+
+// ==============================
+// Lazos de velocidad (CASCADE)
+// ==============================
+
+PID_CASCADE g_pidCascade = {
+    .KpMPCurr = 0.0f,
+    .KiMPCurr = 0.0f,
+    .IsatMPCurr = 0.0f,
+    .RpmMaxMPCurr = 0.0f,
+
+    .KpRDCCurr = 0.0f,
+    .KiRDCCurr = 0.0f,
+    .IsatRDCCurr = 0.0f,
+    .RpmMaxRDCCurr = 0.0f,
+
+    .TfCurr = 0.0f,
+    .KtCurr = 0.0f
+};
+
 // ------------------------------------------------------
 // Función para establecer parámetros predeterminados
 // ------------------------------------------------------
@@ -108,7 +139,7 @@ PID_MAX g_pidMax = {
  * Carga los parámetros PID predeterminados.
  * @note
  * Establece valores por defecto
- * para g_pidCurr, g_pidMin y g_pidMax,
+ * para g_pidCurr, g_pidMin, g_pidMax y g_pidCascade,
  * y sincroniza la UI con g_pidCurr.
  */
 
@@ -136,7 +167,18 @@ void PID_LoadDefaults() {
         .IsathhCurr = 1.87f,
 
         .UvmaxCurr = 1.0f,
-        .UhmaxCurr = 1.0f
+        .UhmaxCurr = 1.0f,
+
+        .DerivOnMeasCurr = false,
+        .TfvCurr = 0.0f,
+        .TfhCurr = 0.0f,
+
+        // Seguimiento solo en Uh: en Uv los recortes son los de las lógicas
+        // unidireccionales (buscados), y seguirlos empeora los ensayos verticales
+        .KtvvCurr = 0.0f,
+        .KtvhCurr = 0.5f,
+        .KthvCurr = 0.0f,
+        .KthhCurr = 0.5f
     };
 
     g_pidMin = {
@@ -187,10 +229,26 @@ void PID_LoadDefaults() {
         .UhmaxMax = 3.3f
     };
 
+    // Lazos de velocidad: 6000 rpm con registro 100 (tacómetros de 0.52 V / 1000 rpm)
+    g_pidCascade = {
+        .KpMPCurr = 1.0f,
+        .KiMPCurr = 4.0f,
+        .IsatMPCurr = 30.0f,
+        .RpmMaxMPCurr = 6000.0f,
+
+        .KpRDCCurr = 1.0f,
+        .KiRDCCurr = 4.0f,
+        .IsatRDCCurr = 30.0f,
+        .RpmMaxRDCCurr = 6000.0f,
+
+        .TfCurr = 0.02f,
+        .KtCurr = 2.0f
+    };
+
     // 2) Sincronizar sliders + labels con los valores CURR/MIN/MAX
     PID_SyncUIFromCurr();
 
-    Serial.println("PID parameters loaded with default values.");
+    HAL_logf("PID parameters loaded with default values.\n");
 }
 
 /**
@@ -210,6 +268,7 @@ void PID_LoadDefaults() {
  * @param maxVal 
  */
 
+#ifndef TRMS_NATIVE
 void PID_UpdateParamLabel(lv_obj_t * label, float minVal, float currVal, float maxVal)
 {
     if (!label) return;
@@ -237,7 +296,7 @@ void PID_UpdateParamLabel(lv_obj_t * label, float minVal, float currVal, float m
  * de g_pidMin y g_pidMax.
  */
 
-static void PID_SyncUIFromCurr()
+void PID_SyncUIFromCurr()
 {
     // -------- SLIDERS (0..100 → valor = param*10) --------
     lv_slider_set_value(ui_SliderKpvv,   (int)(g_pidCurr.KpvvCurr   * 10.0f), LV_ANIM_OFF);
@@ -304,7 +363,7 @@ void PID_SaveToNVS()
 {
     Preferences prefs;
     if (!prefs.begin(PID_NVS_NAMESPACE, false)) {
-        Serial.println("[PID] ERROR: no se pudo abrir NVS para escritura");
+        HAL_logf("[PID] ERROR: no se pudo abrir NVS para escritura\n");
         return;
     }
 
@@ -333,6 +392,15 @@ void PID_SaveToNVS()
     prefs.putFloat("UvmaxCurr",  g_pidCurr.UvmaxCurr);
     prefs.putFloat("UhmaxCurr",  g_pidCurr.UhmaxCurr);
 
+    prefs.putBool ("DerivOnMeas", g_pidCurr.DerivOnMeasCurr);
+    prefs.putFloat("TfvCurr",    g_pidCurr.TfvCurr);
+    prefs.putFloat("TfhCurr",    g_pidCurr.TfhCurr);
+
+    prefs.putFloat("KtvvCurr",   g_pidCurr.KtvvCurr);
+    prefs.putFloat("KtvhCurr",   g_pidCurr.KtvhCurr);
+    prefs.putFloat("KthvCurr",   g_pidCurr.KthvCurr);
+    prefs.putFloat("KthhCurr",   g_pidCurr.KthhCurr);
+
     // --- MIN ---
     prefs.putFloat("KpvvMin",    g_pidMin.KpvvMin);
     prefs.putFloat("KpvhMin",    g_pidMin.KpvhMin);
@@ -379,9 +447,21 @@ void PID_SaveToNVS()
     prefs.putFloat("UvmaxMax",   g_pidMax.UvmaxMax);
     prefs.putFloat("UhmaxMax",   g_pidMax.UhmaxMax);
 
+    // --- CASCADE ---
+    prefs.putFloat("KpMPCas",    g_pidCascade.KpMPCurr);
+    prefs.putFloat("KiMPCas",    g_pidCascade.KiMPCurr);
+    prefs.putFloat("IsatMPCas",  g_pidCascade.IsatMPCurr);
+    prefs.putFloat("RpmMPCas",   g_pidCascade.RpmMaxMPCurr);
+    prefs.putFloat("KpRDCCas",   g_pidCascade.KpRDCCurr);
+    prefs.putFloat("KiRDCCas",   g_pidCascade.KiRDCCurr);
+    prefs.putFloat("IsatRDCCas", g_pidCascade.IsatRDCCurr);
+    prefs.putFloat("RpmRDCCas",  g_pidCascade.RpmMaxRDCCurr);
+    prefs.putFloat("TfCas",      g_pidCascade.TfCurr);
+    prefs.putFloat("KtCas",      g_pidCascade.KtCurr);
+
     prefs.end();
 
-    Serial.println("[PID] Configuración guardada en NVS");
+    HAL_logf("[PID] Configuración guardada en NVS\n");
 }
 
 /**
@@ -398,7 +478,7 @@ void PID_LoadFromNVS()
 {
     Preferences prefs;
     if (!prefs.begin(PID_NVS_NAMESPACE, true)) {
-        Serial.println("[PID] ERROR: no se pudo abrir NVS para lectura");
+        HAL_logf("[PID] ERROR: no se pudo abrir NVS para lectura\n");
         return;
     }
 
@@ -407,7 +487,7 @@ void PID_LoadFromNVS()
         // Primera vez: guardamos los valores actuales (defaults)
         prefs.end();
         PID_SaveToNVS();
-        Serial.println("[PID] NVS vacío, guardando valores por defecto");
+        HAL_logf("[PID] NVS vacío, guardando valores por defecto\n");
         return;
     }
 
@@ -434,6 +514,15 @@ void PID_LoadFromNVS()
     g_pidCurr.UvmaxCurr  = prefs.getFloat("UvmaxCurr",  g_pidCurr.UvmaxCurr);
     g_pidCurr.UhmaxCurr  = prefs.getFloat("UhmaxCurr",  g_pidCurr.UhmaxCurr);
 
+    // Ausentes en configuraciones guardadas antes de añadirlos: se quedan los actuales
+    g_pidCurr.DerivOnMeasCurr = prefs.getBool("DerivOnMeas", g_pidCurr.DerivOnMeasCurr);
+    g_pidCurr.TfvCurr    = prefs.getFloat("TfvCurr",    g_pidCurr.TfvCurr);
+    g_pidCurr.TfhCurr    = prefs.getFloat("TfhCurr",    g_pidCurr.TfhCurr);
+    g_pidCurr.KtvvCurr   = prefs.getFloat("KtvvCurr",   g_pidCurr.KtvvCurr);
+    g_pidCurr.KtvhCurr   = prefs.getFloat("KtvhCurr",   g_pidCurr.KtvhCurr);
+    g_pidCurr.KthvCurr   = prefs.getFloat("KthvCurr",   g_pidCurr.KthvCurr);
+    g_pidCurr.KthhCurr   = prefs.getFloat("KthhCurr",   g_pidCurr.KthhCurr);
+
     // --- MIN ---
     g_pidMin.KpvvMin     = prefs.getFloat("KpvvMin",    g_pidMin.KpvvMin);
     g_pidMin.KpvhMin     = prefs.getFloat("KpvhMin",    g_pidMin.KpvhMin);
@@ -480,10 +569,81 @@ void PID_LoadFromNVS()
     g_pidMax.UvmaxMax    = prefs.getFloat("UvmaxMax",   g_pidMax.UvmaxMax);
     g_pidMax.UhmaxMax    = prefs.getFloat("UhmaxMax",   g_pidMax.UhmaxMax);
 
+    // --- CASCADE --- (ausentes en configuraciones antiguas: se quedan los actuales)
+    g_pidCascade.KpMPCurr      = prefs.getFloat("KpMPCas",    g_pidCascade.KpMPCurr);
+    g_pidCascade.KiMPCurr      = prefs.getFloat("KiMPCas",    g_pidCascade.KiMPCurr);
+    g_pidCascade.IsatMPCurr    = prefs.getFloat("IsatMPCas",  g_pidCascade.IsatMPCurr);
+    g_pidCascade.RpmMaxMPCurr  = prefs.getFloat("RpmMPCas",   g_pidCascade.RpmMaxMPCurr);
+    g_pidCascade.KpRDCCurr     = prefs.getFloat("KpRDCCas",   g_pidCascade.KpRDCCurr);
+    g_pidCascade.KiRDCCurr     = prefs.getFloat("KiRDCCas",   g_pidCascade.KiRDCCurr);
+    g_pidCascade.IsatRDCCurr   = prefs.getFloat("IsatRDCCas", g_pidCascade.IsatRDCCurr);
+    g_pidCascade.RpmMaxRDCCurr = prefs.getFloat("RpmRDCCas",  g_pidCascade.RpmMaxRDCCurr);
+    g_pidCascade.TfCurr        = prefs.getFloat("TfCas",      g_pidCascade.TfCurr);
+    g_pidCascade.KtCurr        = prefs.getFloat("KtCas",      g_pidCascade.KtCurr);
+
     prefs.end();
 
     // Aplicar a la interfaz
     PID_SyncUIFromCurr();
 
-    Serial.println("[PID] Configuración cargada desde NVS");
+    HAL_logf("[PID] Configuración cargada desde NVS\n");
+}
+
+// Muestras aprendidas del mapa en la última carga/guardado (para no reescribir la flash sin cambios)
+static uint32_t s_ffSavedUpdates = 0;
+
+/**
+ * @brief
+ * Guarda el mapa de equilibrio vertical en NVS.
+ * @note
+ * Se llama desde la tarea de interfaz (al parar el PID y de vez en cuando con
+ * el PID en marcha), no desde el lazo: solo escribe si el mapa ha aprendido
+ * algo desde la última vez.
+ */
+void PID_SaveFeedforwardToNVS()
+{
+    EqMap map;
+    PID4_GetVerticalFeedforwardMap(map);
+    if (map.updates == s_ffSavedUpdates) return;
+
+    Preferences prefs;
+    if (!prefs.begin(PID_FF_NVS_NAMESPACE, false)) {
+        HAL_logf("[PID] ERROR: no se pudo abrir NVS para el feedforward\n");
+        return;
+    }
+    prefs.putBytes("map", &map, sizeof(map));
+    prefs.end();
+
+    s_ffSavedUpdates = map.updates;
+    HAL_logf("[PID] Mapa de equilibrio guardado en NVS (%lu muestras)\n", (unsigned long)map.updates);
+}
+
+/**
+ * @brief
+ * Recupera el mapa de equilibrio vertical desde NVS.
+ * @note
+ * Si no hay mapa, o es de otra versión, se queda la recta de partida.
+ */
+void PID_LoadFeedforwardFromNVS()
+{
+    Preferences prefs;
+    if (!prefs.begin(PID_FF_NVS_NAMESPACE, true)) return;   // aún no se ha guardado nunca
+
+    EqMap map;
+    size_t got = prefs.getBytes("map", &map, sizeof(map));
+    prefs.end();
+
+    if (got != sizeof(map) || !PID4_SetVerticalFeedforwardMap(map)) {
+        HAL_logf("[PID] Sin mapa de equilibrio válido en NVS, se usa la recta por defecto\n");
+        return;
+    }
+    s_ffSavedUpdates = map.updates;
+    HAL_logf("[PID] Mapa de equilibrio cargado desde NVS\n");
 }
+
+#else // TRMS_NATIVE
+
+// Sin interfaz ni NVS en la compilación nativa: los parámetros viven solo en RAM
+void PID_SyncUIFromCurr() {}
+
+#endif // TRMS_NATIVE
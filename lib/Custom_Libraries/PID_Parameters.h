@@ -3,9 +3,11 @@ funcionamiento del control PID*/
 
 #pragma once
 
-#include <Arduino.h>
+#include <stdint.h>
+#ifndef TRMS_NATIVE
 #include <lvgl.h>
 #include "ui.h"
+#endif
 
 // ==============================
 // Estructuras de parámetros PID
@@ -34,6 +36,35 @@ struct PID_CURR {
 
     float UvmaxCurr;
     float UhmaxCurr;
+
+    // Derivada: de la medida (sin pico al cambiar la consigna) o del error,
+    // y constante de tiempo del filtro paso bajo por eje de entrada [s] (0 = sin filtro)
+    bool  DerivOnMeasCurr;
+    float TfvCurr;      // PIDvv, PIDvh (entrada vertical)
+    float TfhCurr;      // PIDhh, PIDhv (entrada horizontal)
+
+    // Anti-windup: ganancia de seguimiento de la salida aplicada [1/s] (0 = solo Isat)
+    float KtvvCurr;
+    float KtvhCurr;
+    float KthvCurr;
+    float KthhCurr;
+};
+
+// Lazos internos de velocidad del modo en cascada (PIDMode::CASCADE): un PI por motor
+// sobre la velocidad del tacómetro, en % de rpmMax (las mismas unidades que los registros)
+struct PID_CASCADE {
+    float KpMPCurr;       // motor principal [reg/%]
+    float KiMPCurr;       // [reg/(% s)]
+    float IsatMPCurr;     // límite del integrador [reg]
+    float RpmMaxMPCurr;   // velocidad con registro 100 [rpm] (escala de la consigna)
+
+    float KpRDCCurr;      // rotor de cola
+    float KiRDCCurr;
+    float IsatRDCCurr;
+    float RpmMaxRDCCurr;
+
+    float TfCurr;         // filtro paso bajo de los tacómetros [s] (0 = sin filtro)
+    float KtCurr;         // seguimiento del anti-windup con el registro recortado [1/s]
 };
 
 // Valores mínimos (MIN)
@@ -94,11 +125,24 @@ struct PID_MAX {
 extern PID_CURR g_pidCurr;
 extern PID_MIN  g_pidMin;
 extern PID_MAX  g_pidMax;
+extern PID_CASCADE g_pidCascade;
 
 void PID_LoadDefaults();
+
+// Pasa g_pidCurr a los sliders y etiquetas de la pantalla de parámetros
+// (sin efecto en la compilación nativa)
+void PID_SyncUIFromCurr();
+
+#ifndef TRMS_NATIVE
 void PID_UpdateParamLabel(lv_obj_t * label, float minVal, float currVal, float maxVal);
 
 // Manejo de la EEPROM
 
 void PID_SaveToNVS();
 void PID_LoadFromNVS();
+
+// Mapa de equilibrio vertical (feedforward aprendido, ver PID4_GetVerticalFeedforwardMap).
+// Solo escribe si el mapa ha aprendido algo desde la última carga/guardado.
+void PID_SaveFeedforwardToNVS();
+void PID_LoadFeedforwardFromNVS();
+#endif
@@ -0,0 +1,528 @@
+/* PID genérico compuesto en tiempo de compilación: Pid<Scalar, Derivada, AntiWindup, Filtro> y el
+bloque MIMO Pid4<...> formado por cuatro de ellos. Cada variante se elige con parámetros de plantilla
+(sin punteros a función ni ramas en tiempo de ejecución); el API C de "PID_Control.h" (PID_Update,
+PID4_Update, PID4_*) es una capa fina sobre la variante seleccionada en la compilación */
+
+// PID_Template.h
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Ganancias de un PID (equivalente a un bloque de Simulink: Kp, Ki, Kd, Isat).
+ *
+ * @param Kp           Kp* u
+ * @param Ki           Ki* u -> integrado
+ * @param Kd           Kd* du/dt
+ * @param I_sat        saturación de la PARTE INTEGRAL (±I_sat, 0 = sin límite)
+ * @param Tf           constante de tiempo del filtro de la derivada [s] (LowPassRuntime, 0 = sin filtro)
+ * @param derivOnMeas  derivada de la medida en lugar del error (DerivativeSelectable)
+ * @param Kt           ganancia de seguimiento del anti-windup [1/s] (BackCalculation, 0 = sin seguimiento)
+ *
+ * Tf, derivOnMeas y Kt valen 0/false si se inicializa solo con {Kp, Ki, Kd, I_sat}.
+ */
+template <typename Scalar>
+struct PidGains {
+    Scalar Kp;
+    Scalar Ki;
+    Scalar Kd;
+    Scalar I_sat;
+    Scalar Tf;
+    bool   derivOnMeas;
+    Scalar Kt;
+};
+
+// =====================================================
+// Políticas de derivada
+// =====================================================
+//  rate(st, g, input, meas, dt) devuelve la pendiente que multiplica Kd.
+//  La primera muestra tras reset() devuelve 0 (no hay muestra anterior).
+
+/**
+ * @brief Derivada del error (algoritmo original): du/dt.
+ * @note Un escalón de consigna produce un pico de derivada ("derivative kick").
+ */
+struct DerivativeOnError {
+    template <typename S>
+    struct State {
+        S    prev;
+        bool first;
+    };
+
+    template <typename S>
+    static void reset(State<S> &st)
+    {
+        st.prev  = S(0);
+        st.first = true;
+    }
+
+    template <typename S>
+    static S rate(State<S> &st, const PidGains<S> &g, S input, S meas, S dt)
+    {
+        (void)g;
+        (void)meas;
+        S d = S(0);
+        if (!st.first) {
+            d = (input - st.prev) / dt;
+        } else {
+            st.first = false;
+        }
+        st.prev = input;
+        return d;
+    }
+};
+
+/**
+ * @brief Derivada de la medida: -dy/dt.
+ * @note Igual que la del error con consigna fija, pero sin pico en los escalones.
+ */
+struct DerivativeOnMeasurement {
+    template <typename S>
+    struct State {
+        S    prev;
+        bool first;
+    };
+
+    template <typename S>
+    static void reset(State<S> &st)
+    {
+        st.prev  = S(0);
+        st.first = true;
+    }
+
+    template <typename S>
+    static S rate(State<S> &st, const PidGains<S> &g, S input, S meas, S dt)
+    {
+        (void)g;
+        (void)input;
+        S d = S(0);
+        if (!st.first) {
+            d = -(meas - st.prev) / dt;
+        } else {
+            st.first = false;
+        }
+        st.prev = meas;
+        return d;
+    }
+};
+
+/**
+ * @brief Derivada del error o de la medida según g.derivOnMeas (se puede cambiar en marcha).
+ * @note Guarda las dos muestras anteriores, así que cambiar de modo no produce un pico.
+ */
+struct DerivativeSelectable {
+    template <typename S>
+    struct State {
+        S    prevInput;
+        S    prevMeas;
+        bool first;
+    };
+
+    template <typename S>
+    static void reset(State<S> &st)
+    {
+        st.prevInput = S(0);
+        st.prevMeas  = S(0);
+        st.first     = true;
+    }
+
+    template <typename S>
+    static S rate(State<S> &st, const PidGains<S> &g, S input, S meas, S dt)
+    {
+        S d = S(0);
+        if (!st.first) {
+            d = g.derivOnMeas ? -(meas - st.prevMeas) / dt
+                              : (input - st.prevInput) / dt;
+        } else {
+            st.first = false;
+        }
+        st.prevInput = input;
+        st.prevMeas  = meas;
+        return d;
+    }
+};
+
+// =====================================================
+// Políticas anti-windup
+// =====================================================
+//  integrate(I, g, u, dt) devuelve el nuevo integrador (ya multiplicado por Ki).
+//  track(I, g, excess, dt) lo corrige con lo que los límites han recortado de la
+//  salida (excess = aplicada - pedida, en unidades de salida) después del paso.
+
+/**
+ * @brief Integrador con saturación simétrica ±I_sat (algoritmo original).
+ */
+struct ClampIntegrator {
+    template <typename S>
+    static S integrate(S I, const PidGains<S> &g, S u, S dt)
+    {
+        I += g.Ki * u * dt;
+        if (g.I_sat > S(0)) {
+            if (I >  g.I_sat) I =  g.I_sat;
+            if (I < -g.I_sat) I = -g.I_sat;
+        }
+        return I;
+    }
+
+    template <typename S>
+    static S track(S I, const PidGains<S> &g, S excess, S dt)
+    {
+        (void)g;
+        (void)excess;
+        (void)dt;
+        return I;
+    }
+};
+
+/**
+ * @brief Integrador saturado ±I_sat + seguimiento de la salida aplicada (back-calculation).
+ * @note I += Kt * (aplicada - pedida) * dt. Con Kt = 0 es ClampIntegrator.
+ */
+struct BackCalculation {
+    template <typename S>
+    static S integrate(S I, const PidGains<S> &g, S u, S dt)
+    {
+        return ClampIntegrator::integrate(I, g, u, dt);
+    }
+
+    template <typename S>
+    static S track(S I, const PidGains<S> &g, S excess, S dt)
+    {
+        I += g.Kt * excess * dt;
+        if (g.I_sat > S(0)) {
+            if (I >  g.I_sat) I =  g.I_sat;
+            if (I < -g.I_sat) I = -g.I_sat;
+        }
+        return I;
+    }
+};
+
+/**
+ * @brief Integrador libre (ignora I_sat). Solo para comparar.
+ */
+struct NoAntiWindup {
+    template <typename S>
+    static S integrate(S I, const PidGains<S> &g, S u, S dt)
+    {
+        return I + g.Ki * u * dt;
+    }
+
+    template <typename S>
+    static S track(S I, const PidGains<S> &g, S excess, S dt)
+    {
+        (void)g;
+        (void)excess;
+        (void)dt;
+        return I;
+    }
+};
+
+// =====================================================
+// Políticas de filtrado (sobre la pendiente de la derivada)
+// =====================================================
+
+/**
+ * @brief Sin filtro (algoritmo original).
+ */
+struct NoFilter {
+    template <typename S>
+    struct State {};
+
+    template <typename S>
+    static void reset(State<S> &) {}
+
+    template <typename S>
+    static S apply(State<S> &, const PidGains<S> &g, S x, S dt)
+    {
+        (void)g;
+        (void)dt;
+        return x;
+    }
+};
+
+/**
+ * @brief Paso bajo de primer orden con constante de tiempo fija TfUs [us].
+ * @note y += dt/(Tf+dt) * (x - y). La primera muestra se copia tal cual.
+ */
+template <uint32_t TfUs>
+struct LowPassFilter {
+    template <typename S>
+    struct State {
+        S    y;
+        bool first;
+    };
+
+    template <typename S>
+    static void reset(State<S> &st)
+    {
+        st.y     = S(0);
+        st.first = true;
+    }
+
+    template <typename S>
+    static S apply(State<S> &st, const PidGains<S> &g, S x, S dt)
+    {
+        (void)g;
+        if (st.first) {
+            st.first = false;
+            st.y = x;
+            return x;
+        }
+        const S tf = S(TfUs * 1e-6);
+        st.y += dt / (tf + dt) * (x - st.y);
+        return st.y;
+    }
+};
+
+/**
+ * @brief Paso bajo de primer orden con la constante de tiempo de g.Tf [s].
+ * @note Con Tf <= 0 deja pasar la entrada (y la sigue, para activarlo sin salto).
+ */
+struct LowPassRuntime {
+    template <typename S>
+    struct State {
+        S y;
+    };
+
+    template <typename S>
+    static void reset(State<S> &st)
+    {
+        st.y = S(0);
+    }
+
+    template <typename S>
+    static S apply(State<S> &st, const PidGains<S> &g, S x, S dt)
+    {
+        if (g.Tf <= S(0)) {
+            st.y = x;
+            return x;
+        }
+        st.y += dt / (g.Tf + dt) * (x - st.y);
+        return st.y;
+    }
+};
+
+// =====================================================
+// PID
+// =====================================================
+
+/**
+ * @brief PID de una entrada compuesto por políticas.
+ *
+ * out = Kp*u + I + Kd*F(D(u, y))
+ *
+ * @tparam Scalar      Tipo numérico (float en el ESP32)
+ * @tparam Derivative  DerivativeOnError / DerivativeOnMeasurement / DerivativeSelectable
+ * @tparam AntiWindup  ClampIntegrator / BackCalculation / NoAntiWindup
+ * @tparam Filter      NoFilter / LowPassFilter<TfUs> / LowPassRuntime
+ */
+template <typename Scalar,
+          typename Derivative = DerivativeOnError,
+          typename AntiWindup = ClampIntegrator,
+          typename Filter     = NoFilter>
+class Pid {
+public:
+    typedef Scalar           ScalarType;
+    typedef PidGains<Scalar> Params;
+
+    Pid() { reset(); }
+
+    // Pone a cero el integrador y las memorias de derivada y filtro
+    void reset()
+    {
+        _integrator = Scalar(0);
+        Derivative::reset(_deriv);
+        Filter::reset(_filter);
+    }
+
+    /**
+     * @brief Calcula la salida para una muestra.
+     *
+     * @param g      Ganancias
+     * @param input  Entrada u (normalmente el error: ref - medida)
+     * @param dt     Tiempo de muestreo [s] (<= 0 -> 1 ms)
+     * @param meas   Medida (para la derivada de la medida)
+     */
+    Scalar update(const Params &g, Scalar input, Scalar dt, Scalar meas = Scalar(0))
+    {
+        if (dt <= Scalar(0)) dt = Scalar(0.001);
+
+        Scalar du_dt = Filter::apply(_filter, g, Derivative::rate(_deriv, g, input, meas, dt), dt);
+        _integrator  = AntiWindup::integrate(_integrator, g, input, dt);
+
+        Scalar outP = g.Kp * input;
+        Scalar outI = _integrator;
+        Scalar outD = g.Kd * du_dt;
+
+        return (outP + outI + outD);
+    }
+
+    /**
+     * @brief Seguimiento del anti-windup con la salida que realmente se aplicó.
+     *
+     * @param excess  aplicada - pedida (0 si ningún límite ha recortado la salida)
+     */
+    void track(const Params &g, Scalar excess, Scalar dt)
+    {
+        if (dt <= Scalar(0)) dt = Scalar(0.001);
+        _integrator = AntiWindup::track(_integrator, g, excess, dt);
+    }
+
+    Scalar integrator() const { return _integrator; }
+
+    /**
+     * @brief Carga el integrador con un valor (transferencia sin salto).
+     *
+     * @return lo que no cabe: todo si Ki = 0 (el integrador queda a cero), o el
+     *         exceso sobre ±I_sat
+     */
+    Scalar preload(const Params &g, Scalar I)
+    {
+        if (g.Ki == Scalar(0)) {
+            _integrator = Scalar(0);
+            return I;
+        }
+        _integrator = I;
+        if (g.I_sat > Scalar(0)) {
+            if (_integrator >  g.I_sat) _integrator =  g.I_sat;
+            if (_integrator < -g.I_sat) _integrator = -g.I_sat;
+        }
+        return I - _integrator;
+    }
+
+private:
+    Scalar _integrator;
+    typename Derivative::template State<Scalar> _deriv;
+    typename Filter::template State<Scalar>     _filter;
+};
+
+// =====================================================
+// Bloque PID-4 (MIMO 2x2)
+// =====================================================
+
+/**
+ * @brief Ganancias del PID-4 + saturaciones simétricas de las salidas.
+ */
+template <typename Scalar>
+struct Pid4Gains {
+    PidGains<Scalar> hh;   // PIDhh: in_1 -> out_1
+    PidGains<Scalar> hv;   // PIDhv: in_1 -> out_2
+    PidGains<Scalar> vh;   // PIDvh: in_2 -> out_1
+    PidGains<Scalar> vv;   // PIDvv: in_2 -> out_2
+
+    Scalar Uh_max;         // saturación simétrica para out_1 (±Uh_max, 0 = sin límite)
+    Scalar Uv_max;         // saturación simétrica para out_2 (±Uv_max, 0 = sin límite)
+};
+
+/**
+ * @brief Salidas parciales de los 4 PID en un paso (antes de sumar y saturar).
+ */
+template <typename Scalar>
+struct Pid4Partials {
+    Scalar u_hh;
+    Scalar u_hv;
+    Scalar u_vh;
+    Scalar u_vv;
+};
+
+/**
+ * @brief PID-4: cuatro PID (pueden ser variantes distintas con el mismo Scalar).
+ *
+ *  out_1 (Uh) = sat(hh(in_1) + vh(in_2), Uh_max)
+ *  out_2 (Uv) = sat(hv(in_1) + vv(in_2), Uv_max)
+ */
+template <typename PidHH,
+          typename PidHV = PidHH,
+          typename PidVH = PidHH,
+          typename PidVV = PidHH>
+class Pid4 {
+public:
+    typedef typename PidHH::ScalarType S;
+    typedef Pid4Gains<S>               Params;
+    typedef Pid4Partials<S>            Partials;
+
+    PidHH hh;
+    PidHV hv;
+    PidVH vh;
+    PidVV vv;
+
+    void reset()
+    {
+        hh.reset();
+        hv.reset();
+        vh.reset();
+        vv.reset();
+    }
+
+    /**
+     * @brief Evalúa el bloque.
+     *
+     * @param in1, in2      Errores horizontal y vertical
+     * @param dt            Tiempo de muestreo [s]
+     * @param out1, out2    Uh, Uv saturadas
+     * @param parts         (opcional) salidas parciales
+     * @param meas1, meas2  Medidas horizontal y vertical (derivada de la medida)
+     */
+    void update(const Params &p, S in1, S in2, S dt, S &out1, S &out2,
+                Partials *parts = nullptr, S meas1 = S(0), S meas2 = S(0))
+    {
+        S u_hh = hh.update(p.hh, in1, dt, meas1);
+        S u_hv = hv.update(p.hv, in1, dt, meas1);
+        S u_vh = vh.update(p.vh, in2, dt, meas2);
+        S u_vv = vv.update(p.vv, in2, dt, meas2);
+
+        if (parts) {
+            parts->u_hh = u_hh;
+            parts->u_hv = u_hv;
+            parts->u_vh = u_vh;
+            parts->u_vv = u_vv;
+        }
+
+        out1 = saturate(u_hh + u_vh, p.Uh_max);
+        out2 = saturate(u_hv + u_vv, p.Uv_max);
+    }
+
+    /**
+     * @brief Reparte el recorte de cada salida entre los dos PID que la forman.
+     *
+     * @param excess1, excess2  aplicada - pedida en out_1 / out_2 (mismas unidades)
+     * @note  Cada PID aplica su propia ganancia Kt (ver BackCalculation).
+     */
+    void track(const Params &p, S excess1, S excess2, S dt)
+    {
+        hh.track(p.hh, excess1, dt);
+        vh.track(p.vh, excess1, dt);
+        hv.track(p.hv, excess2, dt);
+        vv.track(p.vv, excess2, dt);
+    }
+
+    /**
+     * @brief Carga los integradores para que la próxima salida sea out1/out2 (sin salto).
+     *
+     * Descuenta la parte proporcional con los errores actuales y carga el
+     * resto en el PID directo de cada salida (hh, vv); los cruzados quedan a
+     * cero, porque su integrador sigue al error del otro eje y no podría
+     * deshacer lo cargado. La derivada no cuenta (tras reset() la primera
+     * muestra no tiene derivada). Lo que no quepa (Ki = 0 o ±I_sat) queda
+     * para quien llama.
+     */
+    void preload(const Params &p, S in1, S in2, S out1, S out2)
+    {
+        S rest1 = out1 - (p.hh.Kp * in1 + p.vh.Kp * in2);
+        S rest2 = out2 - (p.hv.Kp * in1 + p.vv.Kp * in2);
+        hh.preload(p.hh, rest1);
+        vv.preload(p.vv, rest2);
+        vh.preload(p.vh, S(0));
+        hv.preload(p.hv, S(0));
+    }
+
+private:
+    static S saturate(S u, S umax)
+    {
+        if (umax > S(0)) {
+            if (u >  umax) u =  umax;
+            if (u < -umax) u = -umax;
+        }
+        return u;
+    }
+};
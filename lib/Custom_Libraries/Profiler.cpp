@@ -0,0 +1,178 @@
+/* Esta librería, junto con su correspondiente "Profiler.h", permite medir cuánto tarda cada etapa
+del lazo (LVGL, táctil, tacómetros, IR, encoders, PID, DAC...). Cada medida se hace con el contador
+de ciclos de la CPU y se acumula en un histograma estático por etapa (min/media/max/p99) */
+
+// Profiler.cpp
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Acumuladores por etapa (memoria estática, sin reservas)
+struct ProfStageData {
+    uint32_t count;
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint64_t sumTicks;
+    uint32_t buckets[PROF_BUCKETS];
+};
+
+static ProfStageData s_stages[PROF_STAGE_COUNT];
+
+// Petición de reset pendiente por etapa (la escribe el lector, la consume el escritor)
+static volatile bool s_resetReq[PROF_STAGE_COUNT];
+
+static const char *const s_stageNames[PROF_STAGE_COUNT] = {
+    "ui_loop",
+    "lvgl",
+    "touch",
+    "tacho",
+    "ir",
+    "ctrl_cycle",
+    "encoders",
+    "pid",
+    "dac",
+};
+
+/**
+ * @brief
+ * Índice del cubo para una duración.
+ * @note
+ * 0..3 exactos; a partir de ahí, 4 cubos por octava usando los 2 bits
+ * siguientes al bit más significativo.
+ */
+static uint8_t bucketIndex(uint32_t v)
+{
+    if (v < 4) return (uint8_t)v;
+
+    int msb = 31 - __builtin_clz(v);
+    uint32_t sub = (v >> (msb - 2)) & 3u;
+    uint32_t idx = (uint32_t)(msb - 1) * 4u + sub;
+
+    return (idx < PROF_BUCKETS) ? (uint8_t)idx : (uint8_t)(PROF_BUCKETS - 1);
+}
+
+// Valor máximo (en ticks) que cae en un cubo
+static uint32_t bucketUpper(uint8_t idx)
+{
+    if (idx < 4) return idx;
+
+    uint32_t msb = idx / 4u + 1u;
+    uint32_t sub = idx % 4u;
+    return ((5u + sub) << (msb - 2u)) - 1u;
+}
+
+static void clearStage(ProfStageData &d)
+{
+    memset(&d, 0, sizeof(d));
+    d.minTicks = UINT32_MAX;
+}
+
+float Profiler_ticksPerUs()
+{
+#ifdef ARDUINO
+    return (float)ESP.getCpuFreqMHz();
+#else
+    return 1000.0f;   // ns
+#endif
+}
+
+void Profiler_record(ProfStage stage, uint32_t ticks)
+{
+    if (stage >= PROF_STAGE_COUNT) return;
+
+    ProfStageData &d = s_stages[stage];
+
+    if (s_resetReq[stage] || d.count == 0) {
+        s_resetReq[stage] = false;
+        clearStage(d);
+    }
+
+    d.count++;
+    d.sumTicks += ticks;
+    if (ticks < d.minTicks) d.minTicks = ticks;
+    if (ticks > d.maxTicks) d.maxTicks = ticks;
+    d.buckets[bucketIndex(ticks)]++;
+}
+
+/**
+ * @brief
+ * Copia el resumen de una etapa en microsegundos.
+ * @note
+ * Se lee sin bloquear al escritor: si coincide con una medida, la copia puede
+ * mezclar una muestra de más o de menos, que es irrelevante para diagnóstico.
+ */
+void Profiler_getStageStats(ProfStage stage, ProfStageStats &out)
+{
+    memset(&out, 0, sizeof(out));
+    if (stage >= PROF_STAGE_COUNT) return;
+
+    out.name = s_stageNames[stage];
+
+    const ProfStageData &d = s_stages[stage];
+    uint32_t n = d.count;
+    if (n == 0 || s_resetReq[stage]) return;
+
+    const float k = 1.0f / Profiler_ticksPerUs();
+
+    out.count = n;
+    out.minUs = (float)d.minTicks * k;
+    out.maxUs = (float)d.maxTicks * k;
+    out.avgUs = (float)((double)d.sumTicks / (double)n) * k;
+
+    // p99: primer cubo cuya frecuencia acumulada alcanza el 99 %
+    uint32_t target = n - n / 100;
+    uint32_t acc = 0;
+    uint32_t p99Ticks = d.maxTicks;
+    for (uint8_t i = 0; i < PROF_BUCKETS; i++) {
+        acc += d.buckets[i];
+        if (acc >= target) {
+            p99Ticks = bucketUpper(i);
+            break;
+        }
+    }
+    if (p99Ticks > d.maxTicks) p99Ticks = d.maxTicks;
+    out.p99Us = (float)p99Ticks * k;
+}
+
+void Profiler_reset()
+{
+    for (uint8_t i = 0; i < PROF_STAGE_COUNT; i++) {
+        s_resetReq[i] = true;
+    }
+}
+
+size_t Profiler_formatReport(char *buf, size_t len)
+{
+    if (!buf || len == 0) return 0;
+
+    size_t used = 0;
+    int w = snprintf(buf, len, "%-11s %8s %9s %9s %9s %9s  (us)\n",
+                     "etapa", "n", "min", "media", "max", "p99");
+    if (w > 0) used = ((size_t)w < len) ? (size_t)w : len - 1;
+
+    for (uint8_t i = 0; i < PROF_STAGE_COUNT && used < len - 1; i++) {
+        ProfStageStats st;
+        Profiler_getStageStats((ProfStage)i, st);
+        if (st.count == 0) continue;
+
+        w = snprintf(buf + used, len - used, "%-11s %8lu %9.1f %9.1f %9.1f %9.1f\n",
+                     st.name, (unsigned long)st.count,
+                     st.minUs, st.avgUs, st.maxUs, st.p99Us);
+        if (w <= 0) break;
+        used += ((size_t)w < len - used) ? (size_t)w : len - used - 1;
+    }
+    return used;
+}
+
+void Profiler_printReport()
+{
+    char buf[PROF_STAGE_COUNT * 64 + 96];
+    Profiler_formatReport(buf, sizeof(buf));
+
+#ifdef ARDUINO
+    Serial.print(buf);
+#else
+    fputs(buf, stdout);
+#endif
+}
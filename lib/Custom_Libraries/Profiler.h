@@ -0,0 +1,114 @@
+/* Esta librería, junto con su correspondiente "Profiler.cpp", permite medir cuánto tarda cada etapa
+del lazo (LVGL, táctil, tacómetros, IR, encoders, PID, DAC...). Cada medida se hace con el contador
+de ciclos de la CPU y se acumula en un histograma estático por etapa (min/media/max/p99) */
+
+// Profiler.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Activar/desactivar la instrumentación (se puede forzar con -DPROFILER_ENABLED=0 en build_flags).
+// Con 0, PROF_SCOPE no genera código.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * @brief Etapas medidas.
+ *
+ * IMPORTANTE: cada etapa debe medirse siempre desde la misma tarea
+ * (un único escritor por etapa), así no hace falta ninguna sección crítica.
+ *  - Tarea de interfaz: UI_LOOP, LVGL, TOUCH, TACHO, IR
+ *  - Tarea de control:  CTRL_CYCLE, ENCODERS, PID, DAC
+ */
+enum ProfStage : uint8_t {
+    PROF_UI_LOOP = 0,   // iteración completa de la tarea de interfaz
+    PROF_LVGL,          // DisplayTouch_taskHandler (lv_timer_handler + flush)
+    PROF_TOUCH,         // tft.getTouch dentro del callback de LVGL
+    PROF_TACHO,         // Tacho_update
+    PROF_IR,            // IRControl_poll
+    PROF_CTRL_CYCLE,    // paso completo de la tarea de control
+    PROF_ENCODERS,      // Encoders_readSample (I2C)
+    PROF_PID,           // PID4_StepWithCounts (incluye DAC)
+    PROF_DAC,           // MotorControl_writeOutputs desde el PID
+    PROF_STAGE_COUNT
+};
+
+// Histograma logarítmico: 4 sub-cubos por octava (error relativo < 25%)
+// 96 cubos cubren hasta 2^24 ticks (~70 ms a 240 MHz); lo que pase va al último
+static const uint8_t PROF_BUCKETS = 96;
+
+/**
+ * @brief Resumen de una etapa, ya convertido a microsegundos.
+ */
+struct ProfStageStats {
+    const char *name;
+    uint32_t    count;
+    float       minUs;
+    float       avgUs;
+    float       maxUs;
+    float       p99Us;   // cota superior del cubo que contiene el percentil 99
+};
+
+// Lectura del contador de alta resolución (ticks)
+//  - ESP32: ciclos de CPU del núcleo actual
+//  - Host:  nanosegundos de std::chrono::steady_clock
+static inline uint32_t Profiler_now()
+{
+#ifdef ARDUINO
+    return ESP.getCycleCount();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Ticks por microsegundo del contador de Profiler_now() (MHz de la CPU / 1000 en host)
+float Profiler_ticksPerUs();
+
+// Registra una duración (en ticks) para una etapa
+void Profiler_record(ProfStage stage, uint32_t ticks);
+
+// Copia el resumen de una etapa
+void Profiler_getStageStats(ProfStage stage, ProfStageStats &out);
+
+// Pide poner a cero todas las etapas (lo aplica cada escritor en su siguiente medida)
+void Profiler_reset();
+
+// Escribe una tabla de texto con todas las etapas medidas. Devuelve los caracteres escritos.
+size_t Profiler_formatReport(char *buf, size_t len);
+
+// Imprime la tabla por Serial (ESP32) o stdout (host)
+void Profiler_printReport();
+
+/**
+ * @brief Temporizador de ámbito: mide desde su construcción hasta su destrucción.
+ */
+class ProfScope {
+public:
+    explicit ProfScope(ProfStage stage) : _stage(stage), _t0(Profiler_now()) {}
+    ~ProfScope() { Profiler_record(_stage, Profiler_now() - _t0); }
+
+    ProfScope(const ProfScope &) = delete;
+    ProfScope &operator=(const ProfScope &) = delete;
+
+private:
+    ProfStage _stage;
+    uint32_t  _t0;
+};
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b)  PROF_CONCAT_(a, b)
+
+#if PROFILER_ENABLED
+#define PROF_SCOPE(stage) ProfScope PROF_CONCAT(_profScope_, __LINE__)(stage)
+#else
+#define PROF_SCOPE(stage) ((void)0)
+#endif
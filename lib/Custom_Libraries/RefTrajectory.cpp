@@ -0,0 +1,104 @@
+/* Esta librería, junto con su correspondiente "RefTrajectory.h", genera trayectorias suaves entre
+consignas (curva en S con velocidad, aceleración y jerk limitados) */
+
+// RefTrajectory.cpp
+#include "RefTrajectory.h"
+
+#include <math.h>
+
+void Traj_reset(TrajAxis &t, float pos)
+{
+    t.goal  = pos;
+    t.pos   = pos;
+    t.vel   = 0.0f;
+    t.out   = pos;
+    t.sum   = 0.0f;
+    t.n     = 0;
+    t.head  = 0;
+    t.still = 0;
+}
+
+// Longitud de la media móvil para jMax (una inversión de +aMax a -aMax da 2 * aMax de salto)
+static uint16_t windowFor(const TrajLimits &lim, float dt)
+{
+    if (lim.jMax <= 0.0f || lim.aMax <= 0.0f) return 1;
+    float n = ceilf(2.0f * lim.aMax / (lim.jMax * dt));
+    if (n < 1.0f) n = 1.0f;
+    if (n > (float)TRAJ_WINDOW_MAX) n = (float)TRAJ_WINDOW_MAX;
+    return (uint16_t)n;
+}
+
+/**
+ * @brief
+ * Perfil trapezoidal: acelera hacia la velocidad con la que aún se puede parar
+ * en el objetivo.
+ * @note
+ * vb es la versión discreta de sqrt(2 * aMax * |e|) (frenando aMax * dt por
+ * paso se llega al objetivo sin pasarse). En el último paso se engancha al
+ * objetivo con velocidad 0.
+ */
+static void profileStep(TrajAxis &t, const TrajLimits &lim, float dt)
+{
+    const float e = t.goal - t.pos;
+    if (e == 0.0f && t.vel == 0.0f) return;
+
+    float vd;
+    if (lim.aMax > 0.0f) {
+        const float h  = lim.aMax * dt;
+        const float vb = sqrtf(0.25f * h * h + 2.0f * lim.aMax * fabsf(e)) - 0.5f * h;
+        vd = copysignf(fminf(lim.vMax, vb), e);
+
+        float dv = vd - t.vel;
+        if (dv >  h) dv =  h;
+        if (dv < -h) dv = -h;
+        t.vel += dv;
+    } else {
+        vd = copysignf(fminf(lim.vMax, fabsf(e) / dt), e);
+        t.vel = vd;
+    }
+
+    if (fabsf(e) <= fabsf(t.vel) * dt) {
+        t.pos = t.goal;
+        t.vel = 0.0f;
+    } else {
+        t.pos += t.vel * dt;
+    }
+}
+
+float Traj_step(TrajAxis &t, const TrajLimits &lim, float dt)
+{
+    if (!Traj_enabled(lim)) {
+        Traj_reset(t, t.goal);
+        return t.out;
+    }
+
+    profileStep(t, lim, dt);
+    const bool atGoal = (t.pos == t.goal && t.vel == 0.0f);
+
+    // Ventana: se fija en reposo (con la salida ya en el perfil, sin saltos)
+    const uint16_t n = windowFor(lim, dt);
+    if (t.n == 0 || (n != t.n && atGoal && t.out == t.goal)) {
+        t.n    = n;
+        t.head = 0;
+        for (uint16_t i = 0; i < n; i++) t.win[i] = t.out;
+        t.sum  = t.out * (float)n;
+    }
+
+    t.sum += t.pos - t.win[t.head];
+    t.win[t.head] = t.pos;
+    if (++t.head >= t.n) t.head = 0;
+
+    // Ventana llena del objetivo: salida exacta (y la suma sin error acumulado)
+    if (atGoal) {
+        if (t.still < t.n) t.still++;
+    } else {
+        t.still = 0;
+    }
+    if (t.still >= t.n) {
+        t.out = t.goal;
+        t.sum = t.goal * (float)t.n;
+    } else {
+        t.out = t.sum / (float)t.n;
+    }
+    return t.out;
+}
@@ -0,0 +1,63 @@
+/* Esta librería, junto con su correspondiente "RefTrajectory.cpp", genera trayectorias suaves entre
+consignas: en lugar de pasarle al PID un escalón cada vez que se toca la cuadrícula o se escribe un
+ángulo, la consigna recorre una curva en S con velocidad, aceleración y jerk limitados.
+
+Cada eje es un perfil trapezoidal (velocidad y aceleración limitadas, sin sobrepasar el objetivo)
+seguido de una media móvil de longitud 2 * aMax / jMax, que deja la aceleración en rampas (jerk
+limitado) sin cambiar la posición final. Cada paso cuesta O(1): la media se lleva con una suma
+acumulada. PID_Control.cpp la avanza en cada paso de control */
+
+// RefTrajectory.h
+#pragma once
+
+#include <stdint.h>
+
+// Muestras máximas de la media móvil (a 200 Hz: 0.64 s; por encima el jerk pasa de jMax)
+static const int TRAJ_WINDOW_MAX = 128;
+
+/**
+ * @brief Límites de un eje (grados, segundos).
+ *
+ * vMax <= 0 desactiva el generador: la consigna salta al objetivo, como antes.
+ * jMax <= 0 deja solo el límite de aceleración (perfil trapezoidal).
+ */
+struct TrajLimits {
+    float vMax;   // [deg/s]
+    float aMax;   // [deg/s^2]
+    float jMax;   // [deg/s^3]
+};
+
+/**
+ * @brief Estado de un eje.
+ */
+struct TrajAxis {
+    float    goal;                    // objetivo [deg]
+    float    pos;                     // perfil trapezoidal [deg]
+    float    vel;                     // [deg/s]
+    float    out;                     // consigna suavizada (lo que ve el PID) [deg]
+    float    sum;                     // suma de la ventana
+    float    win[TRAJ_WINDOW_MAX];    // últimas posiciones del perfil
+    uint16_t n;                       // longitud de la ventana (0 = aún sin fijar)
+    uint16_t head;
+    uint16_t still;                   // pasos seguidos con el perfil parado en el objetivo
+};
+
+// true si los límites activan el generador
+static inline bool Traj_enabled(const TrajLimits &lim) { return lim.vMax > 0.0f; }
+
+// Deja el eje parado en pos (objetivo incluido)
+void Traj_reset(TrajAxis &t, float pos);
+
+// Nuevo objetivo: el perfil sigue desde donde esté, sin saltos
+static inline void Traj_setGoal(TrajAxis &t, float goal) { t.goal = goal; }
+
+/**
+ * @brief Avanza un paso y devuelve la consigna suavizada.
+ *
+ * La ventana de la media se dimensiona con el dt de los pasos en reposo y no
+ * cambia durante un movimiento. Al terminar, la salida vale exactamente goal.
+ */
+float Traj_step(TrajAxis &t, const TrajLimits &lim, float dt);
+
+// true mientras la consigna suavizada no ha llegado al objetivo
+static inline bool Traj_isMoving(const TrajAxis &t) { return t.out != t.goal; }
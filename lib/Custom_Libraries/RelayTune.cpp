@@ -0,0 +1,279 @@
+/* Esta librería, junto con su correspondiente "RelayTune.h", hace el auto-ajuste por realimentación
+con relé de PIDvv y PIDhh (ver RelayTune.h) */
+
+// RelayTune.cpp
+#include "RelayTune.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// La interfaz arranca y lee; la tarea de control avanza el ensayo.
+// En la compilación nativa todo corre en un solo hilo y el lock no hace nada.
+#ifdef ARDUINO
+static portMUX_TYPE s_tuneMux = portMUX_INITIALIZER_UNLOCKED;
+#define TUNE_LOCK()   portENTER_CRITICAL(&s_tuneMux)
+#define TUNE_UNLOCK() portEXIT_CRITICAL(&s_tuneMux)
+#else
+#define TUNE_LOCK()   do {} while (0)
+#define TUNE_UNLOCK() do {} while (0)
+#endif
+
+static const float RAD_TO_DEG_F = 57.29577951f;
+
+// Ganancia de la corrección del bias por ciclo (fracción de d por unidad de asimetría)
+static const float BIAS_GAIN = 0.5f;
+
+// ------------------------------------------------------------
+// ESTADO
+// ------------------------------------------------------------
+static RelayTuneConfig s_cfg;
+static RelayTuneResult s_res;        // protegido por el lock
+static volatile bool   s_active = false;
+static volatile bool   s_abortReq = false;
+
+// Solo la tarea de control (se inicializan en RelayTune_start, antes de s_active)
+static int   s_holdMP, s_holdRDC;
+static int   s_sign;              // salida del relé: +1 / -1
+static float s_t;                 // tiempo desde el arranque [s]
+static bool  s_cycleOpen;         // hay un ciclo empezado (primer paso a +d visto)
+static float s_tCycle;            // inicio del ciclo en curso (paso a +d)
+static float s_tLow;              // paso a -d dentro del ciclo
+static float s_yMax, s_yMin;
+static uint8_t s_count;           // ciclos completos
+static float s_periods[RELAY_TUNE_MAX_CYCLES];
+static float s_amps[RELAY_TUNE_MAX_CYCLES];
+
+static float clampf(float v, float lo, float hi)
+{
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+bool RelayTune_start(TuneAxis axis, float setpointDeg, float biasReg,
+                     int holdMP, int holdRDC, const RelayTuneConfig &cfg)
+{
+    if (s_active) return false;
+    if (!(cfg.amplitudeReg > 0.0f) || cfg.amplitudeReg > 100.0f) return false;
+    if (cfg.cycles == 0 || cfg.cycles > RELAY_TUNE_MAX_CYCLES) return false;
+
+    s_cfg      = cfg;
+    s_holdMP   = holdMP;
+    s_holdRDC  = holdRDC;
+    s_sign     = 0;
+    s_t        = 0.0f;
+    s_cycleOpen = false;
+    s_count    = 0;
+    s_abortReq = false;
+
+    RelayTuneResult r = {};
+    r.state       = RelayTuneState::RUNNING;
+    r.fail        = RelayTuneFail::NONE;
+    r.axis        = axis;
+    r.setpointDeg = setpointDeg;
+    r.biasReg     = clampf(biasReg, -100.0f + cfg.amplitudeReg, 100.0f - cfg.amplitudeReg);
+
+    TUNE_LOCK();
+    s_res = r;
+    TUNE_UNLOCK();
+    s_active = true;
+    return true;
+}
+
+void RelayTune_abort()
+{
+    if (s_active) s_abortReq = true;
+}
+
+bool RelayTune_isActive()
+{
+    return s_active;
+}
+
+// Media y dispersión relativa ((max - min) / media) de los últimos n valores
+static float meanSpread(const float *v, uint8_t n, float &spread)
+{
+    float sum = 0.0f, lo = v[0], hi = v[0];
+    for (uint8_t i = 0; i < n; i++) {
+        sum += v[i];
+        if (v[i] < lo) lo = v[i];
+        if (v[i] > hi) hi = v[i];
+    }
+    const float mean = sum / (float)n;
+    spread = (mean > 0.0f) ? (hi - lo) / mean : 1.0f;
+    return mean;
+}
+
+/**
+ * @brief
+ * Cierra un ciclo (nuevo paso a +d): periodo, amplitud y corrección del bias.
+ * @note
+ * Si el relé pasa más tiempo arriba que abajo, el registro medio que hace falta
+ * es mayor que el bias: se sube. Los periodos y amplitudes van a un buffer
+ * circular; cuando los últimos cfg.cycles (tras los descartados) son
+ * parecidos el ensayo termina.
+ */
+static void closeCycle(RelayTuneResult &r)
+{
+    const float period = s_t - s_tCycle;
+    const float tHigh  = s_tLow - s_tCycle;
+    const float tLow   = s_t - s_tLow;
+    const float d      = s_cfg.amplitudeReg;
+
+    if (period > 0.0f) {
+        r.biasReg += BIAS_GAIN * d * (tHigh - tLow) / period;
+        r.biasReg  = clampf(r.biasReg, -100.0f + d, 100.0f - d);
+    }
+
+    s_count++;
+    r.cycles = s_count;
+    if (s_count <= s_cfg.settleCycles) return;
+
+    const uint8_t slot = (uint8_t)((s_count - s_cfg.settleCycles - 1) % s_cfg.cycles);
+    s_periods[slot] = period;
+    s_amps[slot]    = 0.5f * (s_yMax - s_yMin);
+    if (s_count < s_cfg.settleCycles + s_cfg.cycles) return;
+
+    float spreadT, spreadA;
+    const float Tu = meanSpread(s_periods, s_cfg.cycles, spreadT);
+    const float a  = meanSpread(s_amps, s_cfg.cycles, spreadA);
+    r.periodS      = Tu;
+    r.amplitudeDeg = a;
+    if (spreadT > s_cfg.maxSpread || spreadA > s_cfg.maxSpread) return;
+
+    const float eps = s_cfg.hysteresisDeg;
+    if (a <= eps) {
+        r.state = RelayTuneState::FAILED;
+        r.fail  = RelayTuneFail::NO_AMPLITUDE;
+        return;
+    }
+    r.Ku    = 4.0f * d / ((float)M_PI * sqrtf(a * a - eps * eps));
+    r.state = RelayTuneState::DONE;
+}
+
+bool RelayTune_step(float dt, float measVDeg, float measHDeg, int &regMP, int &regRDC)
+{
+    if (!s_active) return false;
+
+    RelayTuneResult r;
+    TUNE_LOCK();
+    r = s_res;
+    TUNE_UNLOCK();
+
+    const bool vert = (r.axis == TuneAxis::VERTICAL);
+    const float y = vert ? measVDeg : measHDeg;
+    if (isnan(r.setpointDeg)) r.setpointDeg = y;
+    const float e = r.setpointDeg - y;
+    s_t += dt;
+    r.elapsedS = s_t;
+
+    // Relé con histéresis (el primer paso elige el lado según el error)
+    const int prev = s_sign;
+    if (e > s_cfg.hysteresisDeg)       s_sign = 1;
+    else if (e < -s_cfg.hysteresisDeg) s_sign = -1;
+    else if (s_sign == 0)              s_sign = (e >= 0.0f) ? 1 : -1;
+
+    if (s_cycleOpen) {
+        if (y > s_yMax) s_yMax = y;
+        if (y < s_yMin) s_yMin = y;
+    }
+    if (prev != 0 && s_sign != prev) {
+        if (s_sign > 0) {
+            if (s_cycleOpen) closeCycle(r);
+            s_cycleOpen = true;
+            s_tCycle = s_t;
+            s_yMax = s_yMin = y;
+        } else {
+            s_tLow = s_t;
+        }
+    }
+
+    if (r.state == RelayTuneState::RUNNING) {
+        if (s_abortReq) {
+            r.state = RelayTuneState::FAILED;
+            r.fail  = RelayTuneFail::ABORTED;
+        } else if (fabsf(e) > s_cfg.maxErrDeg) {
+            r.state = RelayTuneState::FAILED;
+            r.fail  = RelayTuneFail::RUNAWAY;
+        } else if (s_t > s_cfg.timeoutS) {
+            r.state = RelayTuneState::FAILED;
+            r.fail  = RelayTuneFail::TIMEOUT;
+        }
+    }
+
+    // Terminado (bien o mal): el motor del eje se queda en el bias
+    const bool running = (r.state == RelayTuneState::RUNNING);
+    const int axisReg = (int)lroundf(r.biasReg + (running ? (float)s_sign * s_cfg.amplitudeReg : 0.0f));
+    regMP  = vert ? axisReg : s_holdMP;
+    regRDC = vert ? s_holdRDC : axisReg;
+
+    TUNE_LOCK();
+    s_res = r;
+    TUNE_UNLOCK();
+    if (!running) s_active = false;
+    return true;
+}
+
+void RelayTune_getResult(RelayTuneResult &out)
+{
+    TUNE_LOCK();
+    out = s_res;
+    TUNE_UNLOCK();
+}
+
+bool RelayTune_computeGains(const RelayTuneResult &r, TuneRule rule, float umax,
+                            float &Kp, float &Ki, float &Kd)
+{
+    if (r.state != RelayTuneState::DONE || !(r.Ku > 0.0f) || !(r.periodS > 0.0f)) return false;
+
+    // reg/deg -> U/rad (reg = 100 * U / Umax)
+    const float ku = r.Ku * RAD_TO_DEG_F * umax * 0.01f;
+    const float Tu = r.periodS;
+
+    float Ti, Td;
+    if (rule == TuneRule::TYREUS_LUYBEN) {
+        Kp = ku / 2.2f;
+        Ti = 2.2f * Tu;
+        Td = Tu / 6.3f;
+    } else {
+        Kp = 0.6f * ku;
+        Ti = 0.5f * Tu;
+        Td = 0.125f * Tu;
+    }
+    Ki = Kp / Ti;
+    Kd = Kp * Td;
+    return true;
+}
+
+bool RelayTune_applyToCurr(const RelayTuneResult &r, TuneRule rule, PID_CURR &curr,
+                           const PID_MIN &mn, const PID_MAX &mx)
+{
+    const bool vert = (r.axis == TuneAxis::VERTICAL);
+    float Kp, Ki, Kd;
+    if (!RelayTune_computeGains(r, rule, vert ? curr.UvmaxCurr : curr.UhmaxCurr, Kp, Ki, Kd)) return false;
+
+    if (vert) {
+        curr.KpvvCurr = clampf(Kp, mn.KpvvMin, mx.KpvvMax);
+        curr.KivvCurr = clampf(Ki, mn.KivvMin, mx.KivvMax);
+        curr.KdvvCurr = clampf(Kd, mn.KdvvMin, mx.KdvvMax);
+    } else {
+        curr.KphhCurr = clampf(Kp, mn.KphhMin, mx.KphhMax);
+        curr.KihhCurr = clampf(Ki, mn.KihhMin, mx.KihhMax);
+        curr.KdhhCurr = clampf(Kd, mn.KdhhMin, mx.KdhhMax);
+    }
+    return true;
+}
+
+const char *RelayTune_failName(RelayTuneFail fail)
+{
+    switch (fail) {
+    case RelayTuneFail::NONE:         return "ninguno";
+    case RelayTuneFail::ABORTED:      return "cancelado";
+    case RelayTuneFail::TIMEOUT:      return "sin ciclo estable";
+    case RelayTuneFail::RUNAWAY:      return "error excesivo";
+    case RelayTuneFail::NO_AMPLITUDE: return "ciclo menor que la histeresis";
+    }
+    return "?";
+}
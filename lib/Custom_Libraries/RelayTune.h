@@ -0,0 +1,149 @@
+/* Esta librería, junto con su correspondiente "RelayTune.cpp", hace el auto-ajuste por realimentación
+con relé (Åström–Hägglund) de PIDvv y PIDhh, un eje cada vez. Con el PID parado, la tarea de control
+aplica al motor del eje un relé con histéresis alrededor de un registro de equilibrio:
+
+   reg = bias + d  si  e = consigna - ángulo > eps
+   reg = bias - d  si  e < -eps              (entre medias se mantiene)
+
+y el eje entra en un ciclo límite. Los cruces de e por la histéresis marcan el periodo y el máximo y
+mínimo de cada ciclo su amplitud a; el bias se corrige ciclo a ciclo para que los dos semiperiodos
+duren lo mismo (sin eso la gravedad o el cable deforman el ciclo). De la ganancia crítica
+
+   Ku = 4 d / (pi * sqrt(a^2 - eps^2))      [reg/deg]
+
+y el periodo Tu salen las ganancias por Ziegler–Nichols o Tyreus–Luyben, en las unidades de PID_CURR
+(U/rad, ver U_to_Register). El otro motor se queda con el registro que tenía al empezar */
+
+// RelayTune.h
+#pragma once
+
+#include <stdint.h>
+#include "PID_Parameters.h"
+
+enum class TuneAxis : uint8_t {
+    VERTICAL,      // motor principal, PIDvv
+    HORIZONTAL     // rotor de cola, PIDhh
+};
+
+enum class TuneRule : uint8_t {
+    ZIEGLER_NICHOLS,   // Kp = 0.6 Ku,  Ti = Tu / 2,   Td = Tu / 8
+    TYREUS_LUYBEN      // Kp = Ku / 2.2, Ti = 2.2 Tu,  Td = Tu / 6.3 (más amortiguado)
+};
+
+/**
+ * @brief Configuración del ensayo.
+ *
+ * @param amplitudeReg   Amplitud d del relé [reg]
+ * @param hysteresisDeg  Histéresis eps [deg] (por encima de la cuantificación del encoder)
+ * @param cycles         Ciclos que se promedian (los últimos)
+ * @param settleCycles   Ciclos que se descartan al principio
+ * @param maxSpread      Dispersión relativa máxima de periodos y amplitudes para darlo por bueno
+ * @param timeoutS       Duración máxima del ensayo [s]
+ * @param maxErrDeg      Error máximo respecto a la consigna antes de abortar [deg]
+ */
+struct RelayTuneConfig {
+    float   amplitudeReg;
+    float   hysteresisDeg;
+    uint8_t cycles;
+    uint8_t settleCycles;
+    float   maxSpread;
+    float   timeoutS;
+    float   maxErrDeg;
+};
+
+static const RelayTuneConfig RELAY_TUNE_DEFAULT_CONFIG = {
+    15.0f,    // reg
+    0.5f,     // deg
+    4,
+    3,
+    0.15f,
+    90.0f,    // s
+    50.0f     // deg
+};
+
+// Máximo de ciclos promediados
+static const uint8_t RELAY_TUNE_MAX_CYCLES = 8;
+
+enum class RelayTuneState : uint8_t {
+    IDLE,
+    RUNNING,
+    DONE,
+    FAILED
+};
+
+enum class RelayTuneFail : uint8_t {
+    NONE,
+    ABORTED,          // RelayTune_abort
+    TIMEOUT,          // sin ciclo límite estable en timeoutS
+    RUNAWAY,          // el error pasó de maxErrDeg
+    NO_AMPLITUDE      // ciclo más pequeño que la histéresis
+};
+
+/**
+ * @brief Estado y resultado del ensayo (RelayTune_getResult).
+ */
+struct RelayTuneResult {
+    RelayTuneState state;
+    RelayTuneFail  fail;
+    TuneAxis       axis;
+    float          setpointDeg;
+    float          elapsedS;
+    uint8_t        cycles;       // ciclos completos hasta ahora
+    float          biasReg;      // bias corregido
+    float          amplitudeDeg; // a (media de los últimos ciclos)
+    float          periodS;      // Tu
+    float          Ku;           // [reg/deg]
+};
+
+/**
+ * @brief Arranca el ensayo (desde la interfaz, con el PID deshabilitado).
+ *
+ * @param axis          Eje a ensayar
+ * @param setpointDeg   Consigna alrededor de la que oscila (NAN: el ángulo del eje en el primer paso)
+ * @param biasReg       Registro de equilibrio de partida del motor del eje
+ * @param holdMP, holdRDC  Registros que se mantienen (el del eje ensayado se ignora)
+ * @param cfg           Configuración
+ * @return false si ya hay un ensayo en marcha o la configuración no vale
+ */
+bool RelayTune_start(TuneAxis axis, float setpointDeg, float biasReg,
+                     int holdMP, int holdRDC, const RelayTuneConfig &cfg = RELAY_TUNE_DEFAULT_CONFIG);
+
+// Detiene el ensayo en marcha (los motores se quedan en el bias y el registro mantenido)
+void RelayTune_abort();
+
+// true mientras el ensayo está en marcha (la tarea de control no ejecuta el PID)
+bool RelayTune_isActive();
+
+/**
+ * @brief Un paso del relé (desde la tarea de control, en lugar del PID).
+ *
+ * @param dt                  Tiempo desde la muestra anterior [s]
+ * @param measVDeg, measHDeg  Ángulos medidos
+ * @param regMP, regRDC       Registros que hay que escribir
+ * @return false si no hay ensayo en marcha (no toca los registros)
+ */
+bool RelayTune_step(float dt, float measVDeg, float measHDeg, int &regMP, int &regRDC);
+
+// Copia el estado del ensayo (desde cualquier tarea)
+void RelayTune_getResult(RelayTuneResult &out);
+
+/**
+ * @brief Ganancias de un PID a partir de Ku y Tu.
+ *
+ * @param umax  Uv_max / Uh_max del eje (escala de U a registro)
+ * @return false si el resultado no es válido (state != DONE)
+ */
+bool RelayTune_computeGains(const RelayTuneResult &r, TuneRule rule, float umax,
+                            float &Kp, float &Ki, float &Kd);
+
+/**
+ * @brief Escribe las ganancias en curr (Kpvv/Kivv/Kdvv o Kphh/Kihh/Kdhh).
+ *
+ * Recorta cada ganancia al rango de sus sliders (mn, mx). No toca la interfaz
+ * ni el PID en marcha. Devuelve false si el resultado no es válido.
+ */
+bool RelayTune_applyToCurr(const RelayTuneResult &r, TuneRule rule, PID_CURR &curr,
+                           const PID_MIN &mn, const PID_MAX &mx);
+
+// Nombre corto del motivo de fallo (para mensajes)
+const char *RelayTune_failName(RelayTuneFail fail);
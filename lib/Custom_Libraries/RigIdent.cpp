@@ -0,0 +1,416 @@
+/* Esta librería, junto con su correspondiente "RigIdent.h", identifica en marcha la dinámica del TRMS
+por mínimos cuadrados recursivos con factor de olvido (ver RigIdent.h) */
+
+// RigIdent.cpp
+#include "RigIdent.h"
+#include "EquilibriumMap.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// Un solo escritor (la tarea de control); la interfaz lee la copia publicada.
+// En la compilación nativa todo corre en un solo hilo y el lock no hace nada.
+#ifdef ARDUINO
+static portMUX_TYPE s_identMux = portMUX_INITIALIZER_UNLOCKED;
+#define IDENT_LOCK()   portENTER_CRITICAL(&s_identMux)
+#define IDENT_UNLOCK() portEXIT_CRITICAL(&s_identMux)
+#else
+#define IDENT_LOCK()   do {} while (0)
+#define IDENT_UNLOCK() do {} while (0)
+#endif
+
+static const uint8_t N_AXIS  = 6;
+static const uint8_t N_ROTOR = 3;
+
+/**
+ * @brief Estimador RLS de tamaño fijo (se usan los n primeros regresores).
+ */
+struct Rls {
+    uint8_t n;
+    float   theta[RIG_IDENT_MAX_N];
+    float   P[RIG_IDENT_MAX_N][RIG_IDENT_MAX_N];
+    float   errSq;   // media exponencial del error de predicción al cuadrado
+};
+
+// Parámetros publicados para las otras tareas
+struct IdentSnapshot {
+    uint32_t samples;
+    float    Ts;
+    float    vert[N_AXIS + 1];   // theta + fitRms
+    float    hor[N_AXIS + 1];
+    float    main[N_ROTOR + 1];
+    float    tail[N_ROTOR + 1];
+};
+
+// ------------------------------------------------------------
+// ESTADO (solo la tarea de control, salvo s_pub y las peticiones)
+// ------------------------------------------------------------
+static RigIdentConfig s_cfg = RIG_IDENT_DEFAULT_CONFIG;
+
+static Rls s_vert, s_hor, s_main, s_tail;
+
+// Ventana de decimación en curso
+static uint8_t  s_winCount;
+static float    s_winDt;
+static float    s_winMP, s_winRDC;
+static float    s_winQMain, s_winQTail;
+
+// Historia del modelo: [0] = k-1, [1] = k-2
+static uint8_t  s_hist;           // muestras válidas en la historia (0..2)
+static float    s_v[2], s_h[2];
+static float    s_qMain[2], s_qTail[2];
+static float    s_wMain, s_wTail;
+
+static uint32_t s_samples;
+static float    s_sumTs;
+
+static IdentSnapshot s_pub;
+
+static volatile bool s_enabled;
+static volatile bool s_resetReq = true;   // volver a los parámetros de partida (también al arrancar)
+static volatile bool s_restartReq;   // descartar ventana e historia (hueco en los datos)
+
+// ------------------------------------------------------------
+// RLS
+// ------------------------------------------------------------
+
+static void rlsInit(Rls &r, uint8_t n, float p0)
+{
+    memset(&r, 0, sizeof(r));
+    r.n = n;
+    for (uint8_t i = 0; i < n; i++) r.P[i][i] = p0;
+}
+
+/**
+ * @brief
+ * Un paso de RLS con factor de olvido.
+ * @note
+ * Solo se calcula el triángulo superior de P y se copia al inferior, así P
+ * sigue siendo simétrica pese al redondeo. Si la traza supera el tope se
+ * escala P entera. Si algo deja de ser finito (datos absurdos) el estimador
+ * vuelve a los parámetros de partida.
+ */
+static void rlsUpdate(Rls &r, const float *phi, float y)
+{
+    const uint8_t n = r.n;
+    const float lambda = s_cfg.lambda;
+
+    float Pphi[RIG_IDENT_MAX_N];
+    float phiPphi = 0.0f;
+    float yHat = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        float s = 0.0f;
+        for (uint8_t j = 0; j < n; j++) s += r.P[i][j] * phi[j];
+        Pphi[i] = s;
+        phiPphi += phi[i] * s;
+        yHat    += r.theta[i] * phi[i];
+    }
+
+    const float e = y - yHat;
+    const float denom = lambda + phiPphi;
+    if (!(denom > 0.0f) || !isfinite(e)) {
+        rlsInit(r, n, s_cfg.p0);
+        return;
+    }
+    const float inv = 1.0f / denom;
+
+    for (uint8_t i = 0; i < n; i++) r.theta[i] += Pphi[i] * inv * e;
+
+    float trace = 0.0f;
+    for (uint8_t i = 0; i < n; i++) {
+        for (uint8_t j = i; j < n; j++) {
+            const float p = (r.P[i][j] - Pphi[i] * Pphi[j] * inv) / lambda;
+            r.P[i][j] = p;
+            r.P[j][i] = p;
+        }
+        trace += r.P[i][i];
+    }
+    if (!isfinite(trace) || !(trace > 0.0f)) {
+        rlsInit(r, n, s_cfg.p0);
+        return;
+    }
+    if (trace > s_cfg.maxTrace) {
+        const float k = s_cfg.maxTrace / trace;
+        for (uint8_t i = 0; i < n; i++) {
+            for (uint8_t j = 0; j < n; j++) r.P[i][j] *= k;
+        }
+    }
+
+    r.errSq = lambda * r.errSq + (1.0f - lambda) * e * e;
+}
+
+// ------------------------------------------------------------
+// ESTADO INTERNO
+// ------------------------------------------------------------
+
+static void restartWindow()
+{
+    s_winCount = 0;
+    s_winDt    = 0.0f;
+    s_winMP    = 0.0f;
+    s_winRDC   = 0.0f;
+    s_winQMain = 0.0f;
+    s_winQTail = 0.0f;
+    s_hist     = 0;
+}
+
+static void resetEstimators()
+{
+    rlsInit(s_vert, N_AXIS,  s_cfg.p0);
+    rlsInit(s_hor,  N_AXIS,  s_cfg.p0);
+    rlsInit(s_main, N_ROTOR, s_cfg.p0);
+    rlsInit(s_tail, N_ROTOR, s_cfg.p0);
+    s_samples = 0;
+    s_sumTs   = 0.0f;
+    restartWindow();
+}
+
+static void copyOut(const Rls &r, float *dst)
+{
+    for (uint8_t i = 0; i < r.n; i++) dst[i] = r.theta[i];
+    dst[r.n] = sqrtf(r.errSq);
+}
+
+static void publish()
+{
+    IdentSnapshot snap;
+    snap.samples = s_samples;
+    snap.Ts      = (s_samples > 0) ? s_sumTs / (float)s_samples : 0.0f;
+    copyOut(s_vert, snap.vert);
+    copyOut(s_hor,  snap.hor);
+    copyOut(s_main, snap.main);
+    copyOut(s_tail, snap.tail);
+
+    IDENT_LOCK();
+    s_pub = snap;
+    IDENT_UNLOCK();
+}
+
+// ------------------------------------------------------------
+// API
+// ------------------------------------------------------------
+
+void RigIdent_init(const RigIdentConfig &cfg)
+{
+    s_cfg = cfg;
+    if (s_cfg.decimation == 0) s_cfg.decimation = 1;
+    if (!(s_cfg.lambda > 0.0f) || s_cfg.lambda > 1.0f) s_cfg.lambda = RIG_IDENT_DEFAULT_CONFIG.lambda;
+    RigIdent_reset();
+}
+
+void RigIdent_reset()
+{
+    IDENT_LOCK();
+    memset(&s_pub, 0, sizeof(s_pub));
+    IDENT_UNLOCK();
+    s_resetReq = true;
+}
+
+void RigIdent_setEnabled(bool enable)
+{
+    if (enable && !s_enabled) s_restartReq = true;
+    s_enabled = enable;
+}
+
+bool RigIdent_isEnabled()
+{
+    return s_enabled;
+}
+
+// Empuje relativo de un rotor: w * |w| en krpm^2
+static float thrust(float rpm)
+{
+    const float k = rpm * 1e-3f;
+    return k * fabsf(k);
+}
+
+/**
+ * @brief
+ * Acumula una muestra de control y, al cerrar la ventana de decimación,
+ * avanza los cuatro estimadores.
+ * @note
+ * La salida de cada modelo es la medida al final de la ventana y la entrada
+ * u[k-1] la media durante ella (del registro aplicado o del empuje). Los
+ * modelos de la viga necesitan dos muestras de historia y los de los rotores una.
+ */
+void RigIdent_update(float dt, float measVDeg, float measHDeg,
+                     float rpmMain, float rpmTail, int regMP, int regRDC)
+{
+    if (!s_enabled) return;
+    if (s_resetReq) {
+        s_resetReq   = false;
+        s_restartReq = false;
+        resetEstimators();
+    }
+    if (s_restartReq) {
+        s_restartReq = false;
+        restartWindow();
+    }
+
+    s_winDt  += dt;
+    s_winMP  += (float)regMP;
+    s_winRDC += (float)regRDC;
+    s_winQMain += thrust(rpmMain);
+    s_winQTail += thrust(rpmTail);
+    if (++s_winCount < s_cfg.decimation) return;
+
+    const float mp  = s_winMP  / (float)s_winCount;
+    const float rdc = s_winRDC / (float)s_winCount;
+    const float qM  = s_winQMain / (float)s_winCount;
+    const float qT  = s_winQTail / (float)s_winCount;
+    const float Ts  = s_winDt;
+    s_winCount = 0;
+    s_winDt    = 0.0f;
+    s_winMP    = 0.0f;
+    s_winRDC   = 0.0f;
+    s_winQMain = 0.0f;
+    s_winQTail = 0.0f;
+
+    if (s_hist >= 1) {
+        const float phiMain[N_ROTOR] = { s_wMain, mp, 1.0f };
+        const float phiTail[N_ROTOR] = { s_wTail, rdc, 1.0f };
+        rlsUpdate(s_main, phiMain, rpmMain);
+        rlsUpdate(s_tail, phiTail, rpmTail);
+    }
+    if (s_hist >= 2) {
+        const float phiV[N_AXIS] = { s_v[0], s_v[1], qM, s_qMain[0], qT, 1.0f };
+        const float phiH[N_AXIS] = { s_h[0], s_h[1], qT, s_qTail[0], qM, 1.0f };
+        rlsUpdate(s_vert, phiV, measVDeg);
+        rlsUpdate(s_hor,  phiH, measHDeg);
+        s_samples++;
+        s_sumTs += Ts;
+    }
+
+    s_v[1]   = s_v[0];   s_v[0]   = measVDeg;
+    s_h[1]   = s_h[0];   s_h[0]   = measHDeg;
+    s_qMain[1] = s_qMain[0]; s_qMain[0] = qM;
+    s_qTail[1] = s_qTail[0]; s_qTail[0] = qT;
+    s_wMain  = rpmMain;
+    s_wTail  = rpmTail;
+    if (s_hist < 2) s_hist++;
+
+    publish();
+}
+
+static void axisModel(const float *p, RigAxisModel &m)
+{
+    m.a1 = p[0];
+    m.a2 = p[1];
+    m.b1 = p[2];
+    m.b2 = p[3];
+    m.c  = p[4];
+    m.d  = p[5];
+    m.fitRms = p[6];
+
+    const float s = 1.0f - m.a1 - m.a2;
+    const bool stable = fabsf(s) > 1e-4f;
+    m.dcGain    = stable ? (m.b1 + m.b2) / s : 0.0f;
+    m.crossGain = stable ? m.c / s : 0.0f;
+    m.restDeg   = stable ? m.d / s : 0.0f;
+}
+
+static void rotorModel(const float *p, float Ts, RigRotorModel &m)
+{
+    m.a = p[0];
+    m.b = p[1];
+    m.c = p[2];
+    m.fitRms = p[3];
+
+    m.tauS        = (m.a > 0.0f && m.a < 1.0f && Ts > 0.0f) ? -Ts / logf(m.a) : 0.0f;
+    m.rpmPerReg   = (fabsf(1.0f - m.a) > 1e-4f) ? m.b / (1.0f - m.a) : 0.0f;
+    m.deadbandReg = (fabsf(m.b) > 1e-6f) ? -m.c / m.b : 0.0f;
+}
+
+void RigIdent_getModel(RigIdentModel &out)
+{
+    IdentSnapshot snap;
+    IDENT_LOCK();
+    snap = s_pub;
+    IDENT_UNLOCK();
+
+    out.enabled = s_enabled;
+    out.samples = snap.samples;
+    out.Ts      = snap.Ts;
+    out.lambda  = s_cfg.lambda;
+    axisModel(snap.vert, out.vert);
+    axisModel(snap.hor,  out.hor);
+    rotorModel(snap.main, snap.Ts, out.main);
+    rotorModel(snap.tail, snap.Ts, out.tail);
+}
+
+/**
+ * @brief
+ * Registro del motor principal que sostiene la viga en vDeg.
+ * @note
+ * Empuje necesario según el modelo vertical -> velocidad del rotor (raíz con
+ * signo) -> registro según el modelo del rotor (incluida su zona muerta).
+ */
+bool RigIdent_equilibriumRegister(const RigIdentModel &m, float vDeg, float rpmTail, float &regMP)
+{
+    if (fabsf(m.vert.dcGain) < 1e-6f || fabsf(m.main.rpmPerReg) < 1e-3f) return false;
+    const float q   = (vDeg - m.vert.restDeg - m.vert.crossGain * thrust(rpmTail)) / m.vert.dcGain;
+    const float rpm = copysignf(sqrtf(fabsf(q)), q) * 1e3f;
+    regMP = rpm / m.main.rpmPerReg + m.main.deadbandReg;
+    return true;
+}
+
+// Añade texto con formato a buf (sin pasarse de len)
+static void appendf(char *buf, size_t len, size_t &pos, const char *fmt, ...)
+{
+    if (pos >= len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(buf + pos, len - pos, fmt, ap);
+    va_end(ap);
+    if (w > 0) pos += ((size_t)w < len - pos) ? (size_t)w : len - pos - 1;
+}
+
+static void formatAxis(char *buf, size_t len, size_t &pos, const char *section, const RigAxisModel &m)
+{
+    appendf(buf, len, pos, "[%s]\n", section);
+    appendf(buf, len, pos, "a1=%.6f\na2=%.6f\nb1=%.6f\nb2=%.6f\nc=%.6f\nd=%.6f\n",
+            m.a1, m.a2, m.b1, m.b2, m.c, m.d);
+    appendf(buf, len, pos, "dcGain=%.6f\ncrossGain=%.6f\nrestDeg=%.3f\nfitRms=%.4f\n",
+            m.dcGain, m.crossGain, m.restDeg, m.fitRms);
+}
+
+static void formatRotor(char *buf, size_t len, size_t &pos, const char *section, const RigRotorModel &m)
+{
+    appendf(buf, len, pos, "[%s]\n", section);
+    appendf(buf, len, pos, "a=%.6f\nb=%.6f\nc=%.6f\n", m.a, m.b, m.c);
+    appendf(buf, len, pos, "tauS=%.4f\nrpmPerReg=%.3f\ndeadbandReg=%.2f\nfitRms=%.1f\n",
+            m.tauS, m.rpmPerReg, m.deadbandReg, m.fitRms);
+}
+
+size_t RigIdent_format(const RigIdentModel &m, char *buf, size_t len)
+{
+    if (!buf || len == 0) return 0;
+    buf[0] = '\0';
+    size_t pos = 0;
+
+    appendf(buf, len, pos, "# IDENTIFICACION TRMS (RLS) ---------------\n");
+    appendf(buf, len, pos, "# muestras=%lu Ts=%.4f lambda=%.5f\n",
+            (unsigned long)m.samples, m.Ts, m.lambda);
+    formatAxis(buf, len, pos, "VERT", m.vert);
+    formatAxis(buf, len, pos, "HOR", m.hor);
+    formatRotor(buf, len, pos, "MAIN", m.main);
+    formatRotor(buf, len, pos, "TAIL", m.tail);
+
+    // Recta de partida del mapa de equilibrio (ver EqMapPrior), con la cola parada:
+    // registro en el umbral y pendientes hasta 20° por encima y por debajo
+    float mpAt, mpUp, mpDown;
+    const float span = 20.0f;
+    if (RigIdent_equilibriumRegister(m, EQMAP_THRESHOLD_DEG, 0.0f, mpAt) &&
+        RigIdent_equilibriumRegister(m, EQMAP_THRESHOLD_DEG + span, 0.0f, mpUp) &&
+        RigIdent_equilibriumRegister(m, EQMAP_THRESHOLD_DEG - span, 0.0f, mpDown)) {
+        appendf(buf, len, pos, "[FEEDFORWARD]\nmpAtThreshold=%.2f\nslopeUp=%.4f\nslopeDown=%.4f\n",
+                mpAt, (mpUp - mpAt) / span, (mpAt - mpDown) / span);
+    }
+    return pos;
+}
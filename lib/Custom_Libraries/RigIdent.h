@@ -0,0 +1,144 @@
+/* Esta librería, junto con su correspondiente "RigIdent.cpp", identifica en marcha la dinámica del TRMS
+por mínimos cuadrados recursivos (RLS) con factor de olvido, a partir de los registros aplicados a los
+DAC, los ángulos de los encoders y los tacómetros. Cada rig es algo distinto (zona muerta de los
+motores, contrapeso, ángulo de reposo) y así el ajuste y el feedforward pueden partir de números
+medidos en vez de los de otro equipo.
+
+Modelos (a la frecuencia de control dividida por cfg.decimation; registros en -100..100):
+  - Cada rotor: w[k] = a w[k-1] + b reg[k-1] + c   (w = rpm del tacómetro)
+  - Vertical:   v[k] = a1 v[k-1] + a2 v[k-2] + b1 qm[k-1] + b2 qm[k-2] + c qt[k-1] + d
+  - Horizontal: h[k] = a1 h[k-1] + a2 h[k-2] + b1 qt[k-1] + b2 qt[k-2] + c qm[k-1] + d
+qm, qt son el empuje relativo de cada rotor, w * |w| en krpm^2 (el empuje crece con el cuadrado
+de la velocidad: con el registro como entrada el modelo solo valdría cerca del punto de trabajo).
+c es el acoplamiento cruzado (el otro rotor) y d recoge la gravedad, el contrapeso y el cable.
+
+Cada actualización es un paso O(n^2) sobre matrices de tamaño fijo en memoria estática. La corre
+ControlCycle en la tarea de control si está activa (RigIdent_setEnabled); la pantalla de diagnóstico
+y el guardado en la SD leen una copia con RigIdent_getModel */
+
+// RigIdent.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Regresores del modelo más grande (ejes de la viga)
+static const uint8_t RIG_IDENT_MAX_N = 6;
+
+/**
+ * @brief Configuración del identificador.
+ *
+ * @param lambda      Factor de olvido (memoria ~ 1 / (1 - lambda) muestras del modelo)
+ * @param decimation  Ciclos de control por muestra del modelo (los registros se promedian)
+ * @param p0          Covarianza inicial (confianza en los parámetros de partida, que son 0)
+ * @param maxTrace    Tope de la traza de cada covarianza: sin excitación el olvido la haría crecer
+ *                    sin límite y el primer escalón movería los parámetros de golpe
+ */
+struct RigIdentConfig {
+    float   lambda;
+    uint8_t decimation;
+    float   p0;
+    float   maxTrace;
+};
+
+// Valores por defecto: 20 ms por muestra a 200 Hz, memoria de ~20 s
+static const RigIdentConfig RIG_IDENT_DEFAULT_CONFIG = {
+    0.999f,
+    4,
+    100.0f,
+    1.0e4f
+};
+
+/**
+ * @brief Modelo ARX de un eje de la viga (grados, empujes en krpm^2).
+ *
+ * @param dcGain   Grados por krpm^2 del rotor propio en régimen: (b1 + b2) / (1 - a1 - a2)
+ * @param crossGain  Igual con el otro rotor: c / (1 - a1 - a2)
+ * @param restDeg  Equilibrio con los dos rotores parados: d / (1 - a1 - a2)
+ * @param fitRms   Error de predicción a un paso (media exponencial con lambda) [deg]
+ */
+struct RigAxisModel {
+    float a1, a2;
+    float b1, b2;
+    float c;
+    float d;
+    float dcGain;
+    float crossGain;
+    float restDeg;
+    float fitRms;
+};
+
+/**
+ * @brief Modelo de primer orden de un rotor (rpm, registros).
+ *
+ * @param tauS         Constante de tiempo: -Ts / ln(a) [s]
+ * @param rpmPerReg    Ganancia en régimen: b / (1 - a)
+ * @param deadbandReg  Registro con el que el rotor no gira: -c / b
+ * @param fitRms       Error de predicción a un paso [rpm]
+ */
+struct RigRotorModel {
+    float a, b, c;
+    float tauS;
+    float rpmPerReg;
+    float deadbandReg;
+    float fitRms;
+};
+
+/**
+ * @brief Copia del modelo identificado (RigIdent_getModel).
+ *
+ * Los valores derivados (dcGain, restDeg, tauS...) valen 0 si el modelo no
+ * los define (polo en 1, ganancia nula).
+ */
+struct RigIdentModel {
+    bool          enabled;
+    uint32_t      samples;    // muestras del modelo desde el último reset
+    float         Ts;         // periodo de muestreo medio del modelo [s]
+    float         lambda;
+    RigAxisModel  vert;
+    RigAxisModel  hor;
+    RigRotorModel main;
+    RigRotorModel tail;
+};
+
+// Configura el identificador y lo resetea (no lo activa)
+void RigIdent_init(const RigIdentConfig &cfg);
+
+// Vuelve a los parámetros de partida (se puede llamar desde cualquier tarea)
+void RigIdent_reset();
+
+// Activa o pausa la identificación (al activarla se descarta la ventana a medias)
+void RigIdent_setEnabled(bool enable);
+bool RigIdent_isEnabled();
+
+/**
+ * @brief Añade una muestra de control (desde la tarea de control, con el lazo en marcha).
+ *
+ * @param dt            Tiempo desde la muestra anterior [s]
+ * @param measVDeg, measHDeg  Ángulos medidos
+ * @param rpmMain, rpmTail    Tacómetros (con signo)
+ * @param regMP, regRDC       Registros aplicados desde la muestra anterior
+ */
+void RigIdent_update(float dt, float measVDeg, float measHDeg,
+                     float rpmMain, float rpmTail, int regMP, int regRDC);
+
+// Copia el modelo actual con sus valores derivados (desde cualquier tarea)
+void RigIdent_getModel(RigIdentModel &out);
+
+/**
+ * @brief Registro del motor principal que sostiene la viga en vDeg según el modelo.
+ *
+ * Despeja el empuje del régimen permanente del modelo vertical con el rotor de
+ * cola a rpmTail y lo pasa a registro con el modelo del rotor principal.
+ * Devuelve false si algún modelo no tiene ganancia.
+ */
+bool RigIdent_equilibriumRegister(const RigIdentModel &m, float vDeg, float rpmTail, float &regMP);
+
+/**
+ * @brief Escribe el modelo como texto "clave=valor" por secciones ([VERT], [HOR], [MAIN], [TAIL]).
+ *
+ * Incluye la recta de feedforward vertical de partida (sección [FEEDFORWARD],
+ * campos de EqMapPrior). Es el formato del fichero que guarda ControlSD_SaveIdent.
+ * Devuelve los caracteres escritos.
+ */
+size_t RigIdent_format(const RigIdentModel &m, char *buf, size_t len);
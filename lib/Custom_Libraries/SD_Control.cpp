@@ -3,6 +3,10 @@
 #include <SD.h>
 #include <FS.h>
 #include "PID_Parameters.h"
+#include "PID_Control.h"
+#include "GainSchedule.h"
+#include "RigIdent.h"
+#include "FreqResp.h"
 #include "ui.h"
 #include <TFT_eSPI.h> // Esto arrastra User_Setup_Select.h -> User_Setup.h
 
@@ -198,7 +202,7 @@ static void PID_ApplyCurrToUI()
  * Asegura que la SD está montada,
  * abre el fichero en modo escritura,
  * y escribe los valores de g_pidCurr,
- * g_pidMin y g_pidMax en formato texto.
+ * g_pidMin, g_pidMax y g_pidCascade en formato texto.
  * @param path 
  * Ruta del fichero en la SD.
  * @return true 
@@ -277,6 +281,13 @@ static bool PID_SaveConfigToFile(const char *path)
     f.print("IsathhCurr="); f.println(g_pidCurr.IsathhCurr, 6);
     f.print("UvmaxCurr=");  f.println(g_pidCurr.UvmaxCurr,  6);
     f.print("UhmaxCurr=");  f.println(g_pidCurr.UhmaxCurr,  6);
+    f.print("DerivOnMeasCurr="); f.println(g_pidCurr.DerivOnMeasCurr ? 1 : 0);
+    f.print("TfvCurr=");    f.println(g_pidCurr.TfvCurr,    6);
+    f.print("TfhCurr=");    f.println(g_pidCurr.TfhCurr,    6);
+    f.print("KtvvCurr=");   f.println(g_pidCurr.KtvvCurr,   6);
+    f.print("KtvhCurr=");   f.println(g_pidCurr.KtvhCurr,   6);
+    f.print("KthvCurr=");   f.println(g_pidCurr.KthvCurr,   6);
+    f.print("KthhCurr=");   f.println(g_pidCurr.KthhCurr,   6);
     f.println();
 
     // ---------- BLOQUE MAX ----------
@@ -299,6 +310,20 @@ static bool PID_SaveConfigToFile(const char *path)
     f.print("IsathhMax="); f.println(g_pidMax.IsathhMax, 6);
     f.print("UvmaxMax=");  f.println(g_pidMax.UvmaxMax,  6);
     f.print("UhmaxMax=");  f.println(g_pidMax.UhmaxMax,  6);
+    f.println();
+
+    // ---------- BLOQUE CASCADA ----------
+    f.println("[PID_CASCADE]");
+    f.print("KpMPCurr=");      f.println(g_pidCascade.KpMPCurr,      6);
+    f.print("KiMPCurr=");      f.println(g_pidCascade.KiMPCurr,      6);
+    f.print("IsatMPCurr=");    f.println(g_pidCascade.IsatMPCurr,    6);
+    f.print("RpmMaxMPCurr=");  f.println(g_pidCascade.RpmMaxMPCurr,  6);
+    f.print("KpRDCCurr=");     f.println(g_pidCascade.KpRDCCurr,     6);
+    f.print("KiRDCCurr=");     f.println(g_pidCascade.KiRDCCurr,     6);
+    f.print("IsatRDCCurr=");   f.println(g_pidCascade.IsatRDCCurr,   6);
+    f.print("RpmMaxRDCCurr="); f.println(g_pidCascade.RpmMaxRDCCurr, 6);
+    f.print("TfCurr=");        f.println(g_pidCascade.TfCurr,        6);
+    f.print("KtCurr=");        f.println(g_pidCascade.KtCurr,        6);
     f.println("-------------------------------------------");
 
     f.close();
@@ -316,7 +341,8 @@ enum PIDSection {
     PID_SECTION_NONE = 0,
     PID_SECTION_MIN,
     PID_SECTION_CURR,
-    PID_SECTION_MAX
+    PID_SECTION_MAX,
+    PID_SECTION_CASCADE
 };
 
 /**
@@ -326,7 +352,7 @@ enum PIDSection {
  * Asegura que la SD está montada,
  * abre el fichero en modo lectura,
  * y lee los valores para g_pidCurr,
- * g_pidMin y g_pidMax.
+ * g_pidMin, g_pidMax y g_pidCascade.
  * @param path 
  * Ruta del fichero en la SD.
  * @return true 
@@ -366,6 +392,7 @@ static bool PID_LoadConfigFromFile(const char *path)
             if      (line == "[PID_MIN]")   section = PID_SECTION_MIN;
             else if (line == "[PID_CURR]")  section = PID_SECTION_CURR;
             else if (line == "[PID_MAX]")   section = PID_SECTION_MAX;
+            else if (line == "[PID_CASCADE]") section = PID_SECTION_CASCADE;
             else                            section = PID_SECTION_NONE;
             continue;
         }
@@ -425,6 +452,14 @@ static bool PID_LoadConfigFromFile(const char *path)
 
             else if (key == "UvmaxCurr")  g_pidCurr.UvmaxCurr  = v;
             else if (key == "UhmaxCurr")  g_pidCurr.UhmaxCurr  = v;
+
+            else if (key == "DerivOnMeasCurr") g_pidCurr.DerivOnMeasCurr = (v != 0.0f);
+            else if (key == "TfvCurr")    g_pidCurr.TfvCurr    = v;
+            else if (key == "TfhCurr")    g_pidCurr.TfhCurr    = v;
+            else if (key == "KtvvCurr")   g_pidCurr.KtvvCurr   = v;
+            else if (key == "KtvhCurr")   g_pidCurr.KtvhCurr   = v;
+            else if (key == "KthvCurr")   g_pidCurr.KthvCurr   = v;
+            else if (key == "KthhCurr")   g_pidCurr.KthhCurr   = v;
         }
         else if (section == PID_SECTION_MAX) {
             if      (key == "KpvvMax")   g_pidMax.KpvvMax   = v;
@@ -449,6 +484,19 @@ static bool PID_LoadConfigFromFile(const char *path)
             else if (key == "UvmaxMax")  g_pidMax.UvmaxMax  = v;
             else if (key == "UhmaxMax")  g_pidMax.UhmaxMax  = v;
         }
+        else if (section == PID_SECTION_CASCADE) {
+            // Las claves que falten (ficheros anteriores) conservan el valor actual
+            if      (key == "KpMPCurr")      g_pidCascade.KpMPCurr      = v;
+            else if (key == "KiMPCurr")      g_pidCascade.KiMPCurr      = v;
+            else if (key == "IsatMPCurr")    g_pidCascade.IsatMPCurr    = v;
+            else if (key == "RpmMaxMPCurr")  g_pidCascade.RpmMaxMPCurr  = v;
+            else if (key == "KpRDCCurr")     g_pidCascade.KpRDCCurr     = v;
+            else if (key == "KiRDCCurr")     g_pidCascade.KiRDCCurr     = v;
+            else if (key == "IsatRDCCurr")   g_pidCascade.IsatRDCCurr   = v;
+            else if (key == "RpmMaxRDCCurr") g_pidCascade.RpmMaxRDCCurr = v;
+            else if (key == "TfCurr")        g_pidCascade.TfCurr        = v;
+            else if (key == "KtCurr")        g_pidCascade.KtCurr        = v;
+        }
     }
 
     f.close();
@@ -494,6 +542,77 @@ static String buildConfigPath(uint8_t index)
  * @return false 
  */
 
+/**
+ * @brief
+ * Construye la ruta del fichero de tablas de ganancias
+ * para un índice dado.
+ * @note
+ * Va junto al de configuración:
+ * "/Config_PID/Sched_<index>.txt"
+ * @param index
+ * Índice de configuración (1..5).
+ * @return String
+ */
+
+static String buildSchedulePath(uint8_t index)
+{
+    String path = "/Config_PID/Sched_";
+    path += String(index);
+    path += ".txt";
+    return path;
+}
+
+/**
+ * @brief
+ * Carga las tablas de ganancias de un fichero (opcional).
+ * @note
+ * Si el fichero no existe se ponen las tablas por defecto
+ * (equivalen a las constantes fijas). Si tiene algún error
+ * también, y se indica la línea por el puerto serie.
+ * El formato está en GainSchedule.h.
+ * @param path
+ * Ruta del fichero en la SD.
+ * @return true
+ * @return false
+ */
+
+static bool PID_LoadScheduleFromFile(const char *path)
+{
+    // ~2 KB: estático para no cargarlo en la pila de la tarea de interfaz
+    static GsTableSpec specs[GS_TABLE_COUNT];
+
+    if (!SD.exists(path)) {
+        PID4_ResetSchedules();
+        return true;
+    }
+
+    File f = SD.open(path, FILE_READ);
+    if (!f) {
+        Serial.print("ERROR abriendo tablas de ganancias: ");
+        Serial.println(path);
+        PID4_ResetSchedules();
+        return false;
+    }
+    String text = f.readString();
+    f.close();
+
+    int badLine = GainSchedule_parse(text.c_str(), specs);
+    if (badLine) {
+        Serial.print("ERROR en las tablas de ganancias, linea ");
+        Serial.println(badLine);
+        PID4_ResetSchedules();
+        return false;
+    }
+    if (!PID4_LoadSchedules(specs)) {
+        Serial.println("Alguna tabla de ganancias no es valida: se usa la de por defecto");
+        return false;
+    }
+
+    Serial.print("Tablas de ganancias cargadas de: ");
+    Serial.println(path);
+    return true;
+}
+
 bool ControlSD_SaveConfig(uint8_t index)
 {
     // Asegurar que la SD está montada
@@ -509,6 +628,105 @@ bool ControlSD_SaveConfig(uint8_t index)
     return PID_SaveConfigToFile(path.c_str());
 }
 
+/**
+ * @brief
+ * Guarda el modelo identificado en la SD.
+ * @note
+ * Va junto a la configuración del mismo índice:
+ * "/Config_PID/Ident_<index>.txt", con el texto
+ * de RigIdent_format (secciones clave=valor).
+ * @param index
+ * Índice de configuración (1..5).
+ * @return true
+ * @return false
+ */
+
+bool ControlSD_SaveIdent(uint8_t index)
+{
+    // ~1.5 KB: estático para no cargarlo en la pila de la tarea de interfaz
+    static char text[1536];
+
+    if (!SD_EnsureMounted()) {
+        Serial.println("No se puede guardar: SD no montada");
+        return false;
+    }
+
+    RigIdentModel m;
+    RigIdent_getModel(m);
+    if (m.samples == 0) {
+        Serial.println("No se guarda la identificacion: aun no hay muestras");
+        return false;
+    }
+    RigIdent_format(m, text, sizeof(text));
+
+    String path = "/Config_PID/Ident_";
+    path += String(index);
+    path += ".txt";
+
+    File f = SD.open(path.c_str(), FILE_WRITE);
+    if (!f) {
+        Serial.print("ERROR abriendo fichero: ");
+        Serial.println(path);
+        return false;
+    }
+    f.print(text);
+    f.close();
+
+    Serial.print("Identificacion guardada en: ");
+    Serial.println(path);
+    return true;
+}
+
+/**
+ * @brief
+ * Guarda el último barrido de Bode en la SD.
+ * @note
+ * "/Config_PID/Bode_<index>.csv", con el texto de
+ * FreqResp_format (cabecera "# ..." y una fila por
+ * frecuencia medida). Un barrido fallido se guarda
+ * con los puntos que llegó a medir.
+ * @param index
+ * Índice de configuración (1..5).
+ * @return true
+ * @return false
+ */
+
+bool ControlSD_SaveBode(uint8_t index)
+{
+    // ~1.5 KB: estático para no cargarlo en la pila de la tarea de interfaz
+    static char text[1536];
+
+    if (!SD_EnsureMounted()) {
+        Serial.println("No se puede guardar: SD no montada");
+        return false;
+    }
+
+    FreqRespResult r;
+    FreqResp_getResult(r);
+    if (r.done == 0) {
+        Serial.println("No se guarda el Bode: aun no hay puntos medidos");
+        return false;
+    }
+    FreqResp_format(r, text, sizeof(text));
+
+    String path = "/Config_PID/Bode_";
+    path += String(index);
+    path += ".csv";
+
+    File f = SD.open(path.c_str(), FILE_WRITE);
+    if (!f) {
+        Serial.print("ERROR abriendo fichero: ");
+        Serial.println(path);
+        return false;
+    }
+    f.print(text);
+    f.close();
+
+    Serial.print("Bode guardado en: ");
+    Serial.println(path);
+    return true;
+}
+
 /**
  * @brief 
  * Carga la configuración PID desde la SD.
@@ -540,6 +758,9 @@ bool ControlSD_LoadConfig(uint8_t index)
         return false;
     }
 
+    // Tablas de ganancias (si no hay fichero, las de por defecto)
+    PID_LoadScheduleFromFile(buildSchedulePath(index).c_str());
+
     // Tras cargar, actualizar sliders + labels de UI
     PID_ApplyCurrToUI();
     lv_obj_clear_flag(ui_Label92, LV_OBJ_FLAG_HIDDEN);
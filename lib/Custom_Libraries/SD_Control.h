@@ -9,9 +9,16 @@
 bool ControlSD_SaveConfig(uint8_t index);
 
 // Carga g_pidMin, g_pidCurr y g_pidMax desde /Config_PID/Config_N
-// y actualiza sliders + labels
+// y actualiza sliders + labels. Si existe /Config_PID/Sched_N.txt carga
+// también las tablas de ganancias (si no, las de por defecto)
 bool ControlSD_LoadConfig(uint8_t index);
 
+// Guarda el modelo identificado en marcha (RigIdent) en /Config_PID/Ident_N.txt
+bool ControlSD_SaveIdent(uint8_t index);
+
+// Guarda el último barrido de Bode (FreqResp) en /Config_PID/Bode_N.csv
+bool ControlSD_SaveBode(uint8_t index);
+
 extern bool flag_Config_Message;
 extern bool flag_Save_Message;
 
@@ -4,7 +4,9 @@ SerialAnsiLogger::SerialAnsiLogger(Ansiterm& term, uint32_t samplePeriodMs)
 : _term(term),
   _period(samplePeriodMs),
   _lastTick(0),
-  _sampleNo(0)
+  _sampleNo(0),
+  _t0Us(-1),
+  _lastRecUs(0)
 {}
 
 void SerialAnsiLogger::setPeriod(uint32_t samplePeriodMs) {
@@ -24,6 +26,7 @@ void SerialAnsiLogger::begin(bool withHeader) {
 
     _lastTick = millis();
     _sampleNo = 0;
+    _t0Us     = -1;
 }
 
 void SerialAnsiLogger::printHeader() {
@@ -44,6 +47,37 @@ void SerialAnsiLogger::update(float degV, float degH, float refV, float refH) {
     float t = (_sampleNo * _period) / 1000.0f;
     _sampleNo++;
 
+    printRow(t, degV, degH, refV, refH);
+}
+
+// Misma fila, pero a partir de la telemetría de la tarea de control.
+// El diezmado se hace con el instante del propio registro (no con millis()),
+// así el eje de tiempo refleja cuándo se midió y no cuándo se imprimió.
+void SerialAnsiLogger::update(const TelemetryRecord &rec, float refV, float refH) {
+    if (!rec.encOk) return;
+
+    const int64_t periodUs = (int64_t)_period * 1000;
+
+    if (_t0Us < 0) {
+        _t0Us      = rec.tUs;
+        _lastRecUs = rec.tUs - periodUs;
+    }
+    if (rec.tUs - _lastRecUs < periodUs) return;
+    _lastRecUs += periodUs;
+    if (rec.tUs - _lastRecUs >= periodUs) _lastRecUs = rec.tUs;   // hueco largo: no recuperar filas
+
+    float t = (float)(rec.tUs - _t0Us) * 1e-6f;
+    _sampleNo++;
+
+    if (rec.pidEnabled) {
+        refV = rec.refVDeg;
+        refH = rec.refHDeg;
+    }
+
+    printRow(t, rec.measVDeg, rec.measHDeg, refV, refH);
+}
+
+void SerialAnsiLogger::printRow(float t, float degV, float degH, float refV, float refH) {
     char buf[32];
 
     // Tiempo
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <Ansiterm.h>
+#include "Telemetry.h"
 
 class SerialAnsiLogger {
 public:
@@ -17,14 +18,21 @@ public:
     // Imprime UNA FILA: medidas + consignas (scroll infinito)
     void update(float degV, float degH, float refV, float refH);
 
+    // Igual, a partir de un registro de telemetría (tiempo = instante de medida).
+    // refV/refH se usan solo si el PID no estaba habilitado en ese paso.
+    void update(const TelemetryRecord &rec, float refV, float refH);
+
 private:
     void printHeader();
+    void printRow(float t, float degV, float degH, float refV, float refH);
 
 private:
     Ansiterm& _term;
     uint32_t  _period;
     uint32_t  _lastTick;
     uint32_t  _sampleNo;
+    int64_t   _t0Us;        // instante del primer registro (-1 = sin empezar)
+    int64_t   _lastRecUs;   // último instante de muestreo emitido
 };
 
 #endif
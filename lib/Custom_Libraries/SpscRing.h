@@ -0,0 +1,79 @@
+/* Cola circular sin bloqueos para un productor y un consumidor (SPSC).
+Pensada para pasar registros de tamaño fijo desde la tarea de control a la interfaz:
+no reserva memoria, no usa mutex ni secciones críticas, y si la cola está llena
+descarta el registro nuevo (el productor nunca espera) */
+
+// SpscRing.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief Cola circular SPSC de capacidad fija.
+ *
+ * - Un único productor llama a push(); un único consumidor llama a pop().
+ * - N debe ser potencia de 2 (el índice se obtiene con una máscara).
+ * - head/tail son contadores libres (uint32_t): la ocupación es head - tail,
+ *   que sigue siendo correcta aunque den la vuelta.
+ * - Orden de memoria: el productor publica el dato con release sobre head y el
+ *   consumidor lo observa con acquire (y viceversa para tail), válido entre núcleos.
+ *
+ * @tparam T  Tipo del registro (se copia por valor, debe ser trivialmente copiable)
+ * @tparam N  Capacidad (potencia de 2)
+ */
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N debe ser potencia de 2");
+
+public:
+    SpscRing() : _head(0), _tail(0), _dropped(0) {}
+
+    // Productor: copia el registro. Devuelve false (y cuenta el descarte) si está llena.
+    bool push(const T &item)
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        const uint32_t tail = _tail.load(std::memory_order_acquire);
+
+        if ((uint32_t)(head - tail) >= N) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _buf[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: extrae el registro más antiguo. Devuelve false si está vacía.
+    bool pop(T &out)
+    {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        const uint32_t head = _head.load(std::memory_order_acquire);
+
+        if (head == tail) return false;
+
+        out = _buf[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Ocupación aproximada (exacta si se llama desde productor o consumidor)
+    size_t size() const
+    {
+        return (size_t)(_head.load(std::memory_order_acquire) -
+                        _tail.load(std::memory_order_acquire));
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    // Registros descartados por cola llena desde el arranque
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    T                     _buf[N];
+    std::atomic<uint32_t> _head;     // solo lo escribe el productor
+    std::atomic<uint32_t> _tail;     // solo lo escribe el consumidor
+    std::atomic<uint32_t> _dropped;  // solo lo escribe el productor
+};
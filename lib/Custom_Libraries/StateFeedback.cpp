@@ -0,0 +1,76 @@
+/* Esta librería, junto con su correspondiente "StateFeedback.h", implementa el LQI del modo
+STATE_FEEDBACK con las ganancias precalculadas de "StateFeedbackGains.h" */
+
+// StateFeedback.cpp
+#include "StateFeedback.h"
+#include "StateFeedbackGains.h"
+
+void StateFeedback_reset(SfState &s)
+{
+    s.zV = 0.0f;
+    s.zH = 0.0f;
+}
+
+static inline float clampU(float u, float uMax)
+{
+    if (u >  uMax) return  uMax;
+    if (u < -uMax) return -uMax;
+    return u;
+}
+
+/**
+ * @brief
+ * Paso del LQI.
+ * @note
+ * Las velocidades de los rotores entran normalizadas (rpm / SF_RPM_AT_UNIT),
+ * como en el diseño. Si una salida satura y la integral de su eje la empuja
+ * hacia fuera, ese avance se deshace (y su aportación a las dos salidas).
+ */
+void StateFeedback_step(SfState &s, const ObserverEstimate &est,
+                        float refVDeg, float refHDeg, float uEqMain, float dt,
+                        float UvMax, float UhMax, SfOutput &out)
+{
+    const float uEqTail = SF_U_EQ_TAIL * uEqMain / SF_U_EQ_MAIN;
+
+    const float eV = est.angleVDeg - refVDeg;
+    const float eH = est.angleHDeg - refHDeg;
+    const float dx[6] = {
+        eV, est.rateVDegS,
+        eH, est.rateHDegS,
+        est.rpmMain / SF_RPM_AT_UNIT - uEqMain,
+        est.rpmTail / SF_RPM_AT_UNIT - uEqTail
+    };
+
+    const float zV = s.zV + eV * dt;
+    const float zH = s.zH + eH * dt;
+
+    float reqV = uEqMain - SF_KZ[0][0] * zV - SF_KZ[0][1] * zH;
+    float reqH = uEqTail - SF_KZ[1][0] * zV - SF_KZ[1][1] * zH;
+    for (int j = 0; j < 6; j++) {
+        reqV -= SF_KX[0][j] * dx[j];
+        reqH -= SF_KX[1][j] * dx[j];
+    }
+
+    // Integración condicional: dz * Kz es lo que el avance de este paso suma a u
+    const float dV = -SF_KZ[0][0] * eV * dt;
+    const float dH = -SF_KZ[1][1] * eH * dt;
+    const bool holdV = (reqV > UvMax && dV > 0.0f) || (reqV < -UvMax && dV < 0.0f);
+    const bool holdH = (reqH > UhMax && dH > 0.0f) || (reqH < -UhMax && dH < 0.0f);
+    if (holdV) {
+        reqV += SF_KZ[0][0] * eV * dt;
+        reqH += SF_KZ[1][0] * eV * dt;
+    } else {
+        s.zV = zV;
+    }
+    if (holdH) {
+        reqV += SF_KZ[0][1] * eH * dt;
+        reqH += SF_KZ[1][1] * eH * dt;
+    } else {
+        s.zH = zH;
+    }
+
+    out.Uv   = clampU(reqV, UvMax);
+    out.Uh   = clampU(reqH, UhMax);
+    out.cutV = out.Uv - reqV;
+    out.cutH = out.Uh - reqH;
+}
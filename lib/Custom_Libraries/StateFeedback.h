@@ -0,0 +1,54 @@
+/* Esta librería, junto con su correspondiente "StateFeedback.cpp", implementa el modo de control por
+realimentación del estado (PIDMode::STATE_FEEDBACK): un LQI, es decir, un LQR sobre el estado estimado
+por el observador ("StateObserver.h") más la integral de los errores de ángulo.
+
+Las ganancias se calculan fuera de línea (host/LqiDesign.cpp) con el modelo linealizado del TRMS y se
+incluyen como arrays constexpr ("StateFeedbackGains.h"): cada paso es un producto de una matriz 2x8 por
+un vector, sin tablas ni memoria dinámica. PID_Control.cpp lo llama en lugar del PID-4 y sus salidas
+siguen el mismo camino (U_max, U_to_Register y MotorControl_writeOutputs) */
+
+// StateFeedback.h
+#pragma once
+
+#include "StateObserver.h"
+
+/**
+ * @brief Integrales de los errores de ángulo [deg*s].
+ */
+struct SfState {
+    float zV;
+    float zH;
+};
+
+/**
+ * @brief Salidas de un paso.
+ *
+ * @param Uv, Uh      Salidas saturadas a ±U_max [U]
+ * @param cutV, cutH  Aplicada - pedida (0 = sin recortar)
+ */
+struct SfOutput {
+    float Uv;
+    float Uh;
+    float cutV;
+    float cutH;
+};
+
+// Integrales a cero
+void StateFeedback_reset(SfState &s);
+
+/**
+ * @brief Un paso del LQI: u = u_eq - Kx * (x - x_ref) - Kz * z.
+ *
+ * x_ref es la viga quieta en la consigna con los rotores en la velocidad de
+ * equilibrio. La entrada de equilibrio del rotor principal la da el que llama
+ * (el mapa de equilibrio en la consigna); la del rotor de cola se escala con
+ * ella desde el punto de diseño. Las integrales solo avanzan si no empujan
+ * más allá de una salida saturada (integración condicional).
+ *
+ * @param est       Estimación del observador (ángulos, velocidades, rpm)
+ * @param uEqMain   Entrada de equilibrio del rotor principal en la consigna [U]
+ * @param dt        Periodo del paso [s]
+ */
+void StateFeedback_step(SfState &s, const ObserverEstimate &est,
+                        float refVDeg, float refHDeg, float uEqMain, float dt,
+                        float UvMax, float UhMax, SfOutput &out);
@@ -0,0 +1,30 @@
+/* Ganancias del modo STATE_FEEDBACK (LQI, ver "StateFeedback.h"). Generado por trms_lqi_design
+(host/LqiDesign.cpp) a partir del modelo del simulador; no editar a mano, volver a generar:
+
+   trms_lqi_design --out lib/Custom_Libraries/StateFeedbackGains.h --theta 0 --rate 200 --rpm 6000
+                   --angv 2 --angh 4 --ratev 40 --rateh 60 --intv 1 --inth 2 --umain 0.5 --utail 0.5
+
+Equilibrio de diseño: cabeceo 0 deg, guiñada 0 deg, rotores w = 0.5308 / -0.3426.
+Radio espectral del lazo cerrado lineal: 0.9928 */
+
+// StateFeedbackGains.h
+#pragma once
+
+static constexpr float SF_DESIGN_DT    = 0.005f;   // periodo de diseño [s]
+static constexpr float SF_DESIGN_THETA = 0.0f;   // cabeceo de diseño [deg]
+static constexpr float SF_RPM_AT_UNIT  = 6000.0f;   // rpm con velocidad normalizada 1
+static constexpr float SF_U_EQ_MAIN    = 0.530776539f;   // entradas de equilibrio [U]
+static constexpr float SF_U_EQ_TAIL    = -0.342614776f;
+
+// u = u_eq - SF_KX * (x - x_ref) - SF_KZ * z
+// x = [cabeceo deg, deg/s, guiñada deg, deg/s, w principal, w cola], z = integrales [deg*s]
+// Filas: Uv (rotor principal), Uh (rotor de cola)
+static constexpr float SF_KX[2][6] = {
+    { 0.333732676f, 0.0495340229f, 0.0112909444f, 0.00334386173f, 3.65425195f, 0.0332922391f },
+    { -0.0226589004f, -0.0050265791f, 0.27452934f, 0.115300832f, 0.0505528854f, 0.896745993f }
+};
+
+static constexpr float SF_KZ[2][2] = {
+    { 0.484016276f, 0.0135494155f },
+    { -0.0280587954f, 0.246799269f }
+};
@@ -0,0 +1,123 @@
+/* Esta librería, junto con su correspondiente "StateObserver.h", estima ángulos, velocidades angulares
+y velocidades de los rotores del TRMS con un filtro de Kalman estacionario */
+
+// StateObserver.cpp
+#include "StateObserver.h"
+
+#include <math.h>
+
+/**
+ * @brief
+ * Ganancias alfa-beta del Kalman estacionario con velocidad constante.
+ * @note
+ * Índice de maniobra lambda = sigma_a * dt^2 / sigma_m (Kalata); alfa corrige
+ * el ángulo y beta / dt la velocidad.
+ */
+static void alphaBeta(float accelStd, float measStd, float dt, float &alpha, float &beta)
+{
+    if (measStd <= 0.0f || accelStd <= 0.0f) {
+        // Sin ruido de medida: sigue a la medida; sin maniobras: no corrige
+        alpha = (measStd <= 0.0f) ? 1.0f : 0.0f;
+        beta  = (measStd <= 0.0f) ? 1.0f / dt : 0.0f;
+        return;
+    }
+    const double l  = (double)accelStd * dt * dt / measStd;
+    const double s  = sqrt(l * l + 8.0 * l);
+    alpha = (float)(-(l * l + 8.0 * l - (l + 4.0) * s) / 8.0);
+    beta  = (float)((l * l + 4.0 * l - l * s) / 4.0) / dt;
+}
+
+/**
+ * @brief
+ * Modelo y ganancia estacionaria de un rotor.
+ * @note
+ * P es la varianza a priori que cumple la ecuación de Riccati escalar
+ * P = a^2 * P * R / (P + R) + Q.
+ */
+static void rotorGains(float tau, float rpmMax, float rotorStd, float tachoStd, float dt,
+                       float &a, float &b, float &k)
+{
+    a = (tau > 0.0f) ? expf(-dt / tau) : 0.0f;
+    b = (1.0f - a) * rpmMax * 0.01f;
+
+    if (tachoStd <= 0.0f) {
+        k = 1.0f;
+        return;
+    }
+    const double Q = (double)rotorStd * rotorStd * dt;
+    const double R = (double)tachoStd * tachoStd;
+    const double c = R * (1.0 - (double)a * a) - Q;
+    const double P = 0.5 * (-c + sqrt(c * c + 4.0 * Q * R));
+    k = (float)(P / (P + R));
+}
+
+void Observer_init(StateObserver &obs, const ObserverConfig &cfg, float dt,
+                   float degPerCountV, float degPerCountH)
+{
+    if (dt <= 0.0f) dt = 1e-3f;
+    obs.cfg  = cfg;
+    obs.g.dt = dt;
+
+    // Cuantificación uniforme: q / sqrt(12)
+    const float measV = (cfg.angleStdV > 0.0f) ? cfg.angleStdV : degPerCountV * 0.288675f;
+    const float measH = (cfg.angleStdH > 0.0f) ? cfg.angleStdH : degPerCountH * 0.288675f;
+    alphaBeta(cfg.accelStdV, measV, dt, obs.g.alphaV, obs.g.betaV);
+    alphaBeta(cfg.accelStdH, measH, dt, obs.g.alphaH, obs.g.betaH);
+
+    rotorGains(cfg.tauMain, cfg.rpmMaxMain, cfg.rotorStd, cfg.tachoStd, dt,
+               obs.g.aMain, obs.g.bMain, obs.g.kMain);
+    rotorGains(cfg.tauTail, cfg.rpmMaxTail, cfg.rotorStd, cfg.tachoStd, dt,
+               obs.g.aTail, obs.g.bTail, obs.g.kTail);
+
+    Observer_reset(obs);
+}
+
+void Observer_reset(StateObserver &obs)
+{
+    obs.x = {};
+}
+
+// Predicción y corrección de un eje (velocidad constante)
+static inline void axisStep(float &angle, float &rate, float meas, float dt, float alpha, float beta)
+{
+    angle += rate * dt;
+    const float r = meas - angle;
+    angle += alpha * r;
+    rate  += beta * r;
+}
+
+// Predicción con el registro y corrección con el tacómetro
+static inline float rotorStep(float w, float rpm, int reg, float a, float b, float k)
+{
+    w = a * w + b * (float)reg;
+    return w + k * (rpm - w);
+}
+
+const ObserverEstimate &Observer_update(StateObserver &obs, float dt,
+                                        float measVDeg, float measHDeg,
+                                        float rpmMain, float rpmTail,
+                                        int regMP, int regRDC)
+{
+    ObserverEstimate &x = obs.x;
+    const ObserverGains &g = obs.g;
+
+    if (!x.valid) {
+        x.valid     = true;
+        x.angleVDeg = measVDeg;
+        x.angleHDeg = measHDeg;
+        x.rateVDegS = 0.0f;
+        x.rateHDegS = 0.0f;
+        x.rpmMain   = rpmMain;
+        x.rpmTail   = rpmTail;
+        return x;
+    }
+    if (dt <= 0.0f) dt = g.dt;
+
+    axisStep(x.angleVDeg, x.rateVDegS, measVDeg, dt, g.alphaV, g.betaV);
+    axisStep(x.angleHDeg, x.rateHDegS, measHDeg, dt, g.alphaH, g.betaH);
+
+    // Modelo del rotor discretizado con el periodo nominal
+    x.rpmMain = rotorStep(x.rpmMain, rpmMain, regMP,  g.aMain, g.bMain, g.kMain);
+    x.rpmTail = rotorStep(x.rpmTail, rpmTail, regRDC, g.aTail, g.bTail, g.kTail);
+    return x;
+}
@@ -0,0 +1,105 @@
+/* Esta librería, junto con su correspondiente "StateObserver.cpp", estima el estado del TRMS en cada
+paso de control: ángulos filtrados, velocidades angulares de la viga y velocidades de los rotores,
+a partir de las cuentas de los encoders (0.18° por cuenta), los tacómetros y los registros aplicados.
+
+Es un filtro de Kalman en régimen permanente con ganancias precalculadas al configurarlo:
+  - Cada eje de la viga: modelo de velocidad constante [ángulo, velocidad] (filtro alfa-beta, con
+    alfa y beta del Kalman estacionario para la aceleración y el ruido de cuantificación dados).
+  - Cada rotor: primer orden tau * dw/dt = rpmMax * reg / 100 - w, corregido con el tacómetro.
+Por paso solo hay unas pocas multiplicaciones y sumas. Lo avanza ControlCycle y lo consumen el
+PID-4 (derivada de la medida, ver PID4_SetObserverEstimate) y los modos por realimentación del estado */
+
+// StateObserver.h
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Configuración del observador.
+ *
+ * @param accelStdV, accelStdH  Aceleración angular típica de la viga [deg/s^2] (ruido del modelo)
+ * @param angleStdV, angleStdH  Ruido de la medida de ángulo [deg] (<= 0: cuantificación, q / sqrt(12))
+ * @param tauMain, tauTail      Constante de tiempo de cada rotor [s]
+ * @param rpmMaxMain, rpmMaxTail  Velocidad de régimen con registro 100 [rpm]
+ * @param rotorStd              Variación de velocidad no explicada por el modelo, por segundo [rpm/s^0.5]
+ * @param tachoStd              Ruido de los tacómetros [rpm] (<= 0: el rotor sigue solo al tacómetro)
+ */
+struct ObserverConfig {
+    float accelStdV;
+    float accelStdH;
+    float angleStdV;
+    float angleStdH;
+    float tauMain;
+    float tauTail;
+    float rpmMaxMain;
+    float rpmMaxTail;
+    float rotorStd;
+    float tachoStd;
+};
+
+// Valores por defecto (TRMS de laboratorio, tacómetros de 0.52 V / 1000 rpm)
+static const ObserverConfig OBSERVER_DEFAULT_CONFIG = {
+    500.0f, 500.0f,      // deg/s^2
+    0.0f, 0.0f,          // cuantificación del encoder
+    0.30f, 0.20f,        // s
+    6000.0f, 6000.0f,    // rpm
+    2000.0f,             // rpm/s^0.5
+    30.0f                // rpm
+};
+
+/**
+ * @brief Estimación del estado (grados, grados/s, rpm con signo).
+ */
+struct ObserverEstimate {
+    bool  valid;        // false hasta la primera medida (o con el observador apagado)
+    float angleVDeg;
+    float angleHDeg;
+    float rateVDegS;
+    float rateHDegS;
+    float rpmMain;
+    float rpmTail;
+};
+
+/**
+ * @brief Ganancias estacionarias precalculadas (Observer_init).
+ */
+struct ObserverGains {
+    float dt;           // periodo para el que se calcularon [s]
+    float alphaV, betaV;   // corrección de ángulo y de velocidad (beta ya dividida por dt) [1, 1/s]
+    float alphaH, betaH;
+    float aMain, bMain;    // w+ = a * w + b * reg
+    float aTail, bTail;
+    float kMain, kTail;    // ganancia del tacómetro
+};
+
+struct StateObserver {
+    ObserverConfig   cfg;
+    ObserverGains    g;
+    ObserverEstimate x;
+};
+
+/**
+ * @brief Calcula las ganancias para el periodo dt y deja el observador sin estimación.
+ *
+ * @param degPerCountV, degPerCountH  Resolución de los encoders (ruido de cuantificación)
+ */
+void Observer_init(StateObserver &obs, const ObserverConfig &cfg, float dt,
+                   float degPerCountV, float degPerCountH);
+
+// Olvida la estimación (la siguiente medida la reinicia, con velocidades de la viga a 0)
+void Observer_reset(StateObserver &obs);
+
+/**
+ * @brief Un paso: predicción con los registros del paso anterior y corrección con las medidas.
+ *
+ * Predice con el dt real (por si el lazo se ha retrasado); las ganancias son
+ * las del periodo nominal.
+ *
+ * @param measVDeg, measHDeg  Ángulos medidos [deg]
+ * @param rpmMain, rpmTail    Tacómetros [rpm]
+ * @param regMP, regRDC       Registros aplicados desde la medida anterior (-100..100)
+ */
+const ObserverEstimate &Observer_update(StateObserver &obs, float dt,
+                                        float measVDeg, float measHDeg,
+                                        float rpmMain, float rpmTail,
+                                        int regMP, int regRDC);
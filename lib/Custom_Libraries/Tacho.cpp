@@ -5,6 +5,9 @@ a la que están girando los mismos a partir de estos */
 // Tacho.cpp
 #include "Tacho.h"
 #include "MotorControl.h"   // Para comprobar cambios en los DAC antes de publicar promedios
+#include "HAL.h"
+
+#include <stdio.h>
 
 // Almacenamos configuración global del módulo
 static TachoConfig s_cfg;
@@ -35,7 +38,7 @@ static float adcToVolts(uint16_t raw)
   Según el circuito de adaptación utilizado.
  * @param volts
  * @return float
- * /
+ */
 
 
 /*El voltaje que recibe el ESP32 es un voltaje adaptado después de pasar por un circuito de adaptación. 
@@ -105,7 +108,7 @@ static inline float absf(float x) { return (x < 0.0f) ? -x : x; }
  */
 static float pushAvgWithSpikeRejectAndDacGate(float sampleRpm, RpmAvgState &st)
 {
-    const uint32_t now = millis();
+    const uint32_t now = HAL_millis();
 
     // Rechazo de saltos: >300 rpm en menos de 200 ms
     if (st.hasLast) {
@@ -171,10 +174,10 @@ void Tacho_begin(const TachoConfig &config)
     s_cfg = config;
 
     // Configurar pines como entrada analógica
-    pinMode(s_cfg.pinRotor, INPUT);
-    pinMode(s_cfg.pinMotor, INPUT);
+    HAL_pinMode(s_cfg.pinRotor, HAL_PIN_INPUT);
+    HAL_pinMode(s_cfg.pinMotor, HAL_PIN_INPUT);
 
-    Serial.println("Tacho inicializado (ADC y conversión RPM listos).");
+    HAL_logf("Tacho inicializado (ADC y conversión RPM listos).\n");
 }
 
 /**
@@ -193,10 +196,10 @@ void Tacho_begin(const TachoConfig &config)
 void Tacho_update()
 {
     // Leer ADC
-    uint16_t raw_rotor = analogRead(s_cfg.pinRotor);
+    uint16_t raw_rotor = HAL_adcRead(s_cfg.pinRotor);
     //Serial.print("Tacho_rotor -> DAC = ");
     //Serial.println(raw_rotor); 
-    uint16_t raw_motor = analogRead(s_cfg.pinMotor);
+    uint16_t raw_motor = HAL_adcRead(s_cfg.pinMotor);
     //Serial.print("Tacho_m.p -> DAC = ");
     //Serial.println(raw_motor); 
 
@@ -234,18 +237,36 @@ void Tacho_update()
     float rpm_rotor = pushAvgWithSpikeRejectAndDacGate(rpm_rotor_raw, s_rotorAvg);
     float rpm_motor = pushAvgWithSpikeRejectAndDacGate(rpm_motor_raw, s_motorAvg);
 
-    // Mostrar en LVGL (bloque EXACTO que pediste)
+#ifndef TRMS_NATIVE
+    // Mostrar en LVGL: V.mp = pinMotor (G36), V.rotor = pinRotor (G39), igual que Tacho_readRpm
     char buf[32];
 
-    snprintf(buf, sizeof(buf), "        V.mp = %.0f rpm", rpm_rotor);
+    snprintf(buf, sizeof(buf), "        V.mp = %.0f rpm", rpm_motor);
     lv_label_set_text(ui_V_motor_principal_1, buf);
 
-    snprintf(buf, sizeof(buf), "        V.rotor = %.0f rpm", rpm_motor);
+    snprintf(buf, sizeof(buf), "        V.rotor = %.0f rpm", rpm_rotor);
     lv_label_set_text(ui_V_rotor_1, buf);
 
-    snprintf(buf, sizeof(buf), "        V.mp = %.0f rpm", rpm_rotor);
+    snprintf(buf, sizeof(buf), "        V.mp = %.0f rpm", rpm_motor);
     lv_label_set_text(ui_V_motor_principal_2, buf);
 
-    snprintf(buf, sizeof(buf), "        V.rotor = %.0f rpm", rpm_motor);
+    snprintf(buf, sizeof(buf), "        V.rotor = %.0f rpm", rpm_rotor);
     lv_label_set_text(ui_V_rotor_2, buf);
+#else
+    (void)rpm_rotor;
+    (void)rpm_motor;
+#endif
+}
+
+/**
+ * @brief
+ * Lectura rápida de los tacómetros para el lazo en cascada.
+ * @note
+ * Misma conversión que Tacho_update (ADC -> voltios -> voltaje real -> RPM),
+ * pero sin promedio ni zona muerta y sin tocar las etiquetas.
+ */
+void Tacho_readRpm(float &rpmMain, float &rpmTail)
+{
+    rpmMain = voltsToRpm(voltsAdapter(adcToVolts(HAL_adcRead(s_cfg.pinMotor))));
+    rpmTail = voltsToRpm(voltsAdapter(adcToVolts(HAL_adcRead(s_cfg.pinRotor))));
 }
@@ -5,15 +5,17 @@ a la que están girando los mismos a partir de estos */
 // Tacho.h
 #pragma once
 
-#include <Arduino.h>
+#include <stdint.h>
+#ifndef TRMS_NATIVE
 #include <lvgl.h>
 #include "ui.h"   // Para acceder a ui_V_rotor y ui_V_motor_principal
+#endif
 
 /**
  * @brief Configuración de tacómetro
  *
- * @param pinRotor  GPIO ADC del tacómetro del rotor
- * @param pinMotor  GPIO ADC del tacómetro del motor principal
+ * @param pinRotor  GPIO ADC del tacómetro del rotor de cola (G39 en la placa)
+ * @param pinMotor  GPIO ADC del tacómetro del motor principal (G36 en la placa)
  * @param voltsPer1000RPM  Voltaje de salida del tacómetro para 1000 RPM
  */
 struct TachoConfig {
@@ -42,3 +44,16 @@ void Tacho_begin(const TachoConfig &config);
  *    un rango (max-min) de 100 rpm.
  */
 void Tacho_update();
+
+/**
+ * @brief Lectura rápida de los dos tacómetros en RPM (con signo), para el lazo de control.
+ *
+ * Una sola muestra por motor, sin promedio, sin rechazo de saltos y sin la zona
+ * muerta de 0.25 V de la pantalla (en el lazo sería un escalón de ~500 rpm): el
+ * filtrado lo hace quien la usa. No toca LVGL, así que se puede llamar desde la
+ * tarea de control.
+ *
+ * @param rpmMain  Motor principal (pinMotor)
+ * @param rpmTail  Rotor de cola (pinRotor)
+ */
+void Tacho_readRpm(float &rpmMain, float &rpmTail);
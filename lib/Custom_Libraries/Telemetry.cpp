@@ -0,0 +1,30 @@
+/* Esta librería, junto con su correspondiente "Telemetry.h", define el canal de telemetría entre
+la tarea de control y la interfaz: la tarea de control publica un registro por paso en una cola
+SPSC sin bloqueos y la interfaz, el logger serie o cualquier grabador la vacían a su ritmo */
+
+// Telemetry.cpp
+#include "Telemetry.h"
+#include "SpscRing.h"
+
+// Cola única: productor = ControlTask (núcleo 1), consumidor = tarea de interfaz (núcleo 0)
+static SpscRing<TelemetryRecord, TELEMETRY_CAPACITY> s_ring;
+
+bool Telemetry_push(const TelemetryRecord &rec)
+{
+    return s_ring.push(rec);
+}
+
+bool Telemetry_pop(TelemetryRecord &rec)
+{
+    return s_ring.pop(rec);
+}
+
+size_t Telemetry_pending()
+{
+    return s_ring.size();
+}
+
+uint32_t Telemetry_getDropped()
+{
+    return s_ring.dropped();
+}
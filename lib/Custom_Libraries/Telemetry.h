@@ -0,0 +1,94 @@
+/* Esta librería, junto con su correspondiente "Telemetry.cpp", define el canal de telemetría entre
+la tarea de control y la interfaz: la tarea de control publica un registro por paso en una cola
+SPSC sin bloqueos y la interfaz, el logger serie o cualquier grabador la vacían a su ritmo */
+
+// Telemetry.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Registro de telemetría de un paso de control (tamaño fijo, sin punteros).
+ *
+ * @param tUs                   Instante de la lectura de encoders [us, esp_timer]
+ * @param dtS                   Periodo usado por el PID en este paso [s]
+ * @param countV, countH        Cuentas crudas de los encoders
+ * @param measVDeg, measHDeg    Medidas en grados
+ * @param refVDeg, refHDeg      Consignas activas en grados
+ * @param u_hh..u_vv            Salidas parciales de los cuatro PID (antes de sumar y saturar)
+ * @param Uh, Uv                Salidas MIMO ya saturadas (±Uh_max / ±Uv_max)
+ * @param regMP, regRDC         Registros aplicados (-100..100)
+ * @param dacG1, dacG2          Códigos escritos en los DAC (0..255)
+ * @param gainGen               Generación de ganancias del PID-4 (PID4_PopGainEvent)
+ * @param spMP, spRDC           Consignas de velocidad de los rotores [% de rpmMax] (modo CASCADE;
+ *                              en los demás, iguales a regMP/regRDC)
+ * @param rpmMP, rpmRDC         Velocidades filtradas de los tacómetros (modo CASCADE; si no, 0)
+ * @param rateVDegS, rateHDegS  Velocidades de la viga estimadas por el observador [deg/s] (0 sin él)
+ * @param encOk                 Lectura de encoders correcta
+ * @param pidEnabled            PID-4 habilitado en este paso
+ * @param satMP, satRDC         Salida del PID recortada por algún límite (Uv/Uh_max o las
+ *                              lógicas de salida): es lo que sigue el anti-windup
+ */
+struct TelemetryRecord {
+    int64_t tUs;
+    float   dtS;
+
+    int16_t countV;
+    int16_t countH;
+
+    float   measVDeg;
+    float   measHDeg;
+    float   refVDeg;
+    float   refHDeg;
+
+    float   u_hh;
+    float   u_hv;
+    float   u_vh;
+    float   u_vv;
+    float   Uh;
+    float   Uv;
+
+    int16_t regMP;
+    int16_t regRDC;
+    uint8_t dacG1;
+    uint8_t dacG2;
+
+    uint32_t gainGen;
+
+    int16_t spMP;
+    int16_t spRDC;
+    float   rpmMP;
+    float   rpmRDC;
+    float   rateVDegS;
+    float   rateHDegS;
+
+    bool    encOk;
+    bool    pidEnabled;
+    bool    satMP;
+    bool    satRDC;
+};
+
+// Capacidad de la cola (potencia de 2): 128 registros = 640 ms a 200 Hz
+static const size_t TELEMETRY_CAPACITY = 128;
+
+/**
+ * @brief Publica un registro (solo desde la tarea de control).
+ *
+ * No reserva memoria ni bloquea. Si la cola está llena el registro se descarta
+ * y se cuenta en Telemetry_getDropped().
+ *
+ * @return true si se ha encolado
+ */
+bool Telemetry_push(const TelemetryRecord &rec);
+
+/**
+ * @brief Extrae el registro más antiguo (solo desde la tarea de interfaz).
+ *
+ * @return true si había algún registro
+ */
+bool Telemetry_pop(TelemetryRecord &rec);
+
+// Registros pendientes y descartados desde el arranque
+size_t   Telemetry_pending();
+uint32_t Telemetry_getDropped();
@@ -99,6 +99,9 @@ lv_obj_t * ui_Label57;
 void ui_event_Button14(lv_event_t * e);
 lv_obj_t * ui_Button14;
 lv_obj_t * ui_Label20;
+void ui_event_Button28(lv_event_t * e);
+lv_obj_t * ui_Button28;
+lv_obj_t * ui_Label93;
 void ui_event_SliderKpvv(lv_event_t * e);
 lv_obj_t * ui_SliderKpvv;
 void ui_event_SliderKivv(lv_event_t * e);
@@ -535,6 +538,15 @@ void ui_event_Button14(lv_event_t * e)
     }
 }
 
+void ui_event_Button28(lv_event_t * e)
+{
+    lv_event_code_t event_code = lv_event_get_code(e);
+
+    if(event_code == LV_EVENT_CLICKED) {
+        function_AutoTune(e);
+    }
+}
+
 void ui_event_SliderKpvv(lv_event_t * e)
 {
     lv_event_code_t event_code = lv_event_get_code(e);
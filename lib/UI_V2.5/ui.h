@@ -107,6 +107,9 @@ extern lv_obj_t * ui_Label57;
 void ui_event_Button14(lv_event_t * e);
 extern lv_obj_t * ui_Button14;
 extern lv_obj_t * ui_Label20;
+void ui_event_Button28(lv_event_t * e);
+extern lv_obj_t * ui_Button28;
+extern lv_obj_t * ui_Label93;
 void ui_event_SliderKpvv(lv_event_t * e);
 extern lv_obj_t * ui_SliderKpvv;
 void ui_event_SliderKivv(lv_event_t * e);
@@ -165,9 +165,9 @@ void ui_Screen4_screen_init(void)
     lv_obj_set_style_text_font(ui_Label57, &ui_font_Montserrat_14_Latin_2, LV_PART_MAIN | LV_STATE_DEFAULT);
 
     ui_Button14 = lv_btn_create(ui_Screen4);
-    lv_obj_set_width(ui_Button14, 239);
+    lv_obj_set_width(ui_Button14, 130);
     lv_obj_set_height(ui_Button14, 18);
-    lv_obj_set_x(ui_Button14, 115);
+    lv_obj_set_x(ui_Button14, 61);
     lv_obj_set_y(ui_Button14, -150);
     lv_obj_set_align(ui_Button14, LV_ALIGN_CENTER);
     lv_obj_add_flag(ui_Button14, LV_OBJ_FLAG_SCROLL_ON_FOCUS);     /// Flags
@@ -177,9 +177,25 @@ void ui_Screen4_screen_init(void)
     lv_obj_set_width(ui_Label20, LV_SIZE_CONTENT);   /// 1
     lv_obj_set_height(ui_Label20, LV_SIZE_CONTENT);    /// 1
     lv_obj_set_align(ui_Label20, LV_ALIGN_CENTER);
-    lv_label_set_text(ui_Label20, "Parámetros predeterminados");
+    lv_label_set_text(ui_Label20, "Predeterminados");
     lv_obj_set_style_text_font(ui_Label20, &ui_font_Montserrat_14_Latin_2, LV_PART_MAIN | LV_STATE_DEFAULT);
 
+    ui_Button28 = lv_btn_create(ui_Screen4);
+    lv_obj_set_width(ui_Button28, 105);
+    lv_obj_set_height(ui_Button28, 18);
+    lv_obj_set_x(ui_Button28, 182);
+    lv_obj_set_y(ui_Button28, -150);
+    lv_obj_set_align(ui_Button28, LV_ALIGN_CENTER);
+    lv_obj_add_flag(ui_Button28, LV_OBJ_FLAG_SCROLL_ON_FOCUS);     /// Flags
+    lv_obj_clear_flag(ui_Button28, LV_OBJ_FLAG_SCROLLABLE);      /// Flags
+
+    ui_Label93 = lv_label_create(ui_Button28);
+    lv_obj_set_width(ui_Label93, LV_SIZE_CONTENT);   /// 1
+    lv_obj_set_height(ui_Label93, LV_SIZE_CONTENT);    /// 1
+    lv_obj_set_align(ui_Label93, LV_ALIGN_CENTER);
+    lv_label_set_text(ui_Label93, "Auto-ajuste");
+    lv_obj_set_style_text_font(ui_Label93, &ui_font_Montserrat_14_Latin_2, LV_PART_MAIN | LV_STATE_DEFAULT);
+
     ui_SliderKpvv = lv_slider_create(ui_Screen4);
     lv_slider_set_value(ui_SliderKpvv, 0, LV_ANIM_OFF);
     if(lv_slider_get_mode(ui_SliderKpvv) == LV_SLIDER_MODE_RANGE) lv_slider_set_left_value(ui_SliderKpvv, 0, LV_ANIM_OFF);
@@ -419,6 +435,7 @@ void ui_Screen4_screen_init(void)
 
     lv_obj_add_event_cb(ui_Button13, ui_event_Button13, LV_EVENT_ALL, NULL);
     lv_obj_add_event_cb(ui_Button14, ui_event_Button14, LV_EVENT_ALL, NULL);
+    lv_obj_add_event_cb(ui_Button28, ui_event_Button28, LV_EVENT_ALL, NULL);
     lv_obj_add_event_cb(ui_SliderKpvv, ui_event_SliderKpvv, LV_EVENT_ALL, NULL);
     lv_obj_add_event_cb(ui_SliderKivv, ui_event_SliderKivv, LV_EVENT_ALL, NULL);
     lv_obj_add_event_cb(ui_SliderKdvh, ui_event_SliderKdvh, LV_EVENT_ALL, NULL);
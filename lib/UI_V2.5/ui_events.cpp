@@ -14,6 +14,9 @@
 #include "Ang_Select.h"
 #include "Encoders.h"
 #include "PID_Control.h"
+#include "RelayTune.h"
+#include "FreqResp.h"
+#include "EquilibriumMap.h"
 
 extern PID_CURR g_pidCurr;
 extern PID_MIN  g_pidMin;
@@ -74,7 +77,7 @@ static void mostrar_grafica_encoder(void) {
     lv_obj_clear_flag(ui_GraphEncoder, LV_OBJ_FLAG_HIDDEN);
 }
 
-// Guarda los tres bloques de parámetros en el fichero solicitado
+// Guarda los bloques de parámetros (MIN, CURR, MAX y cascada) en el fichero solicitado
 static bool PID_SaveConfigToFile(const char *path)
 {
     File f = SD.open(path, FILE_WRITE);
@@ -161,6 +164,22 @@ static bool PID_SaveConfigToFile(const char *path)
     f.printf("IsathhMax=%.6f\n", g_pidMax.IsathhMax);
     f.printf("UvmaxMax=%.6f\n",  g_pidMax.UvmaxMax);
     f.printf("UhmaxMax=%.6f\n",  g_pidMax.UhmaxMax);
+    f.println();
+
+    // ======================
+    // BLOQUE CASCADA
+    // ======================
+    f.println("[PID_CASCADE]");
+    f.printf("KpMPCurr=%.6f\n",      g_pidCascade.KpMPCurr);
+    f.printf("KiMPCurr=%.6f\n",      g_pidCascade.KiMPCurr);
+    f.printf("IsatMPCurr=%.6f\n",    g_pidCascade.IsatMPCurr);
+    f.printf("RpmMaxMPCurr=%.6f\n",  g_pidCascade.RpmMaxMPCurr);
+    f.printf("KpRDCCurr=%.6f\n",     g_pidCascade.KpRDCCurr);
+    f.printf("KiRDCCurr=%.6f\n",     g_pidCascade.KiRDCCurr);
+    f.printf("IsatRDCCurr=%.6f\n",   g_pidCascade.IsatRDCCurr);
+    f.printf("RpmMaxRDCCurr=%.6f\n", g_pidCascade.RpmMaxRDCCurr);
+    f.printf("TfCurr=%.6f\n",        g_pidCascade.TfCurr);
+    f.printf("KtCurr=%.6f\n",        g_pidCascade.KtCurr);
     f.println("-------------------------------------------");
 
     f.close();
@@ -205,7 +224,9 @@ void Initiate_Modo_Manual(lv_event_t * e)
 void Initiate_Control_PID(lv_event_t * e)
 {
 	SetupScreen3Nav();
-    Reset_Encoders_Registros();
+    // Sin poner los motores a cero: se refrescan flechas y labels con los registros
+    // manuales, que son los que recoge PID4_SetEnabled para arrancar sin salto
+    MotorControl_update(Registro_MP, Registro_RDC);
 
     digitalWrite(LED,HIGH);
     BuzzerWrite(HIGH);    
@@ -273,9 +294,11 @@ void function_Start_Control_PID(lv_event_t * e)
     }
     else {
         SetupScreen6Nav();
+        // Sin poner los motores a cero: PID4_SetEnabled parte de los registros
+        // aplicados en modo manual y el arranque es sin salto
         PID4_LoadFromCurr(g_pidCurr);
+        PID4_SetCascadeParams(g_pidCascade);
         PID4_SetEnabled(true);
-        Reset_Encoders_Registros();
         digitalWrite(LED,HIGH);
         BuzzerWrite(HIGH);    
         delay(500);
@@ -340,12 +363,110 @@ void function_Predeterminate_parameters(lv_event_t * e)
 	PID_LoadDefaults();
 }
 
+// Auto-ajuste por relé (RelayTune): horizontal pendiente tras el vertical y regla usada
+static bool s_tuneThenHorizontal = false;
+static const TuneRule AUTOTUNE_RULE = TuneRule::TYREUS_LUYBEN;
+
+/**
+ * @brief
+ * Arranca el ensayo de relé de un eje (con el PID parado).
+ * @note
+ * El vertical oscila alrededor de 0° partiendo del registro de equilibrio del
+ * mapa de feedforward; el horizontal alrededor del ángulo que tenga al empezar,
+ * con el registro del rotor de cola a 0. El otro motor mantiene su registro.
+ */
+bool AutoTune_Start(bool vertical, bool thenHorizontal)
+{
+    if (flag_calibration == false) {
+        Serial.println("[TUNE] Calibra los encoders antes del auto-ajuste");
+        return false;
+    }
+    if (RelayTune_isActive() || FreqResp_isActive()) return false;
+
+    PID4_SetEnabled(false);
+    int holdMP, holdRDC;
+    MotorControl_getLastRegisters(holdMP, holdRDC);
+
+    bool ok;
+    if (vertical) {
+        EqMap map;
+        PID4_GetVerticalFeedforwardMap(map);
+        ok = RelayTune_start(TuneAxis::VERTICAL, 0.0f, EqMap_lookup(map, 0.0f), holdMP, holdRDC);
+    } else {
+        ok = RelayTune_start(TuneAxis::HORIZONTAL, NAN, 0.0f, holdMP, holdRDC);
+    }
+    if (!ok) return false;
+
+    s_tuneThenHorizontal = vertical && thenHorizontal;
+    lv_label_set_text(ui_Label93, "Cancelar");
+    Serial.printf("[TUNE] Ensayo de rele %s en marcha\n", vertical ? "vertical" : "horizontal");
+    return true;
+}
+
+void AutoTune_Stop()
+{
+    s_tuneThenHorizontal = false;
+    RelayTune_abort();
+}
+
+void function_AutoTune(lv_event_t * e)
+{
+    if (RelayTune_isActive()) AutoTune_Stop();
+    else AutoTune_Start(true, true);
+}
+
+/**
+ * @brief
+ * Recoge el resultado del ensayo cuando termina (desde la tarea de interfaz).
+ * @note
+ * Con un ciclo límite válido escribe las ganancias del eje en g_pidCurr y en
+ * los sliders; tras el vertical arranca el horizontal si estaba pedido. Al
+ * acabar la secuencia (o si falla) los motores vuelven a 0.
+ */
+void HandleAutoTune()
+{
+    static bool wasActive = false;
+    const bool active = RelayTune_isActive();
+    if (active || !wasActive) {
+        wasActive = active;
+        return;
+    }
+    wasActive = false;
+
+    RelayTuneResult r;
+    RelayTune_getResult(r);
+    const bool vert = (r.axis == TuneAxis::VERTICAL);
+    const bool done = RelayTune_applyToCurr(r, AUTOTUNE_RULE, g_pidCurr, g_pidMin, g_pidMax);
+    if (done) {
+        PID_SyncUIFromCurr();
+        Serial.printf("[TUNE] %s: Ku=%.3f reg/deg Tu=%.2f s a=%.2f deg bias=%.1f -> "
+                      "Kp=%.3f Ki=%.3f Kd=%.3f\n",
+                      vert ? "vertical" : "horizontal", r.Ku, r.periodS, r.amplitudeDeg, r.biasReg,
+                      vert ? g_pidCurr.KpvvCurr : g_pidCurr.KphhCurr,
+                      vert ? g_pidCurr.KivvCurr : g_pidCurr.KihhCurr,
+                      vert ? g_pidCurr.KdvvCurr : g_pidCurr.KdhhCurr);
+    } else {
+        Serial.printf("[TUNE] %s: fallo (%s) tras %.1f s y %u ciclos\n",
+                      vert ? "vertical" : "horizontal", RelayTune_failName(r.fail),
+                      r.elapsedS, (unsigned)r.cycles);
+    }
+
+    if (done && s_tuneThenHorizontal && AutoTune_Start(false, false)) return;
+
+    s_tuneThenHorizontal = false;
+    lv_label_set_text(ui_Label93, "Auto-ajuste");
+    Registro_MP = 0;
+    Registro_RDC = 0;
+    MotorControl_update(Registro_MP, Registro_RDC);
+}
+
 void function_Kpvv(lv_event_t * e)
 {
     g_pidCurr.KpvvCurr = lv_slider_get_value(ui_SliderKpvv) / 10.0f;
     Serial.print("KpvvCurr = ");
     Serial.println(g_pidCurr.KpvvCurr, 3);
     PID_UpdateParamLabel(ui_Kpvv, g_pidMin.KpvvMin, g_pidCurr.KpvvCurr, g_pidMax.KpvvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kpvh(lv_event_t * e)
@@ -354,6 +475,7 @@ void function_Kpvh(lv_event_t * e)
     Serial.print("KpvhCurr = ");
     Serial.println(g_pidCurr.KpvhCurr, 3);
     PID_UpdateParamLabel(ui_Kpvh, g_pidMin.KpvhMin, g_pidCurr.KpvhCurr, g_pidMax.KpvhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kivv(lv_event_t * e)
@@ -362,6 +484,7 @@ void function_Kivv(lv_event_t * e)
     Serial.print("KivvCurr = ");
     Serial.println(g_pidCurr.KivvCurr, 3);
     PID_UpdateParamLabel(ui_Kivv, g_pidMin.KivvMin, g_pidCurr.KivvCurr, g_pidMax.KivvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kivh(lv_event_t * e)
@@ -370,6 +493,7 @@ void function_Kivh(lv_event_t * e)
     Serial.print("KivhCurr = ");
     Serial.println(g_pidCurr.KivhCurr, 3);
     PID_UpdateParamLabel(ui_Kivh, g_pidMin.KivhMin, g_pidCurr.KivhCurr, g_pidMax.KivhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kdvv(lv_event_t * e)
@@ -378,6 +502,7 @@ void function_Kdvv(lv_event_t * e)
     Serial.print("KdvvCurr = ");
     Serial.println(g_pidCurr.KdvvCurr, 3);
     PID_UpdateParamLabel(ui_Kdvv, g_pidMin.KdvvMin, g_pidCurr.KdvvCurr, g_pidMax.KdvvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kdvh(lv_event_t * e)
@@ -386,6 +511,7 @@ void function_Kdvh(lv_event_t * e)
     Serial.print("KdvhCurr = ");
     Serial.println(g_pidCurr.KdvhCurr, 3);
     PID_UpdateParamLabel(ui_Kdvh, g_pidMin.KdvhMin, g_pidCurr.KdvhCurr, g_pidMax.KdvhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kphv(lv_event_t * e)
@@ -394,6 +520,7 @@ void function_Kphv(lv_event_t * e)
     Serial.print("KphvCurr = ");
     Serial.println(g_pidCurr.KphvCurr, 3);
     PID_UpdateParamLabel(ui_Kphv, g_pidMin.KphvMin, g_pidCurr.KphvCurr, g_pidMax.KphvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kphh(lv_event_t * e)
@@ -402,6 +529,7 @@ void function_Kphh(lv_event_t * e)
     Serial.print("KphhCurr = ");
     Serial.println(g_pidCurr.KphhCurr, 3);
     PID_UpdateParamLabel(ui_Kphh, g_pidMin.KphhMin, g_pidCurr.KphhCurr, g_pidMax.KphhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kihv(lv_event_t * e)
@@ -410,6 +538,7 @@ void function_Kihv(lv_event_t * e)
     Serial.print("KihvCurr = ");
     Serial.println(g_pidCurr.KihvCurr, 3);
     PID_UpdateParamLabel(ui_Kihv, g_pidMin.KihvMin, g_pidCurr.KihvCurr, g_pidMax.KihvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kihh(lv_event_t * e)
@@ -418,6 +547,7 @@ void function_Kihh(lv_event_t * e)
     Serial.print("KihhCurr = ");
     Serial.println(g_pidCurr.KihhCurr, 3);
     PID_UpdateParamLabel(ui_Kihh, g_pidMin.KihhMin, g_pidCurr.KihhCurr, g_pidMax.KihhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kdhv(lv_event_t * e)
@@ -426,6 +556,7 @@ void function_Kdhv(lv_event_t * e)
     Serial.print("KdhvCurr = ");
     Serial.println(g_pidCurr.KdhvCurr, 3);
     PID_UpdateParamLabel(ui_Kdhv, g_pidMin.KdhvMin, g_pidCurr.KdhvCurr, g_pidMax.KdhvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Kdhh(lv_event_t * e)
@@ -434,6 +565,7 @@ void function_Kdhh(lv_event_t * e)
     Serial.print("KdhhCurr = ");
     Serial.println(g_pidCurr.KdhhCurr, 3);
     PID_UpdateParamLabel(ui_Kdhh, g_pidMin.KdhhMin, g_pidCurr.KdhhCurr, g_pidMax.KdhhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Isatvv(lv_event_t * e)
@@ -442,6 +574,7 @@ void function_Isatvv(lv_event_t * e)
     Serial.print("IsatvvCurr = ");
     Serial.println(g_pidCurr.IsatvvCurr, 3);
     PID_UpdateParamLabel(ui_Isatvv, g_pidMin.IsatvvMin, g_pidCurr.IsatvvCurr, g_pidMax.IsatvvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Isatvh(lv_event_t * e)
@@ -450,6 +583,7 @@ void function_Isatvh(lv_event_t * e)
     Serial.print("IsatvhCurr = ");
     Serial.println(g_pidCurr.IsatvhCurr, 3);
     PID_UpdateParamLabel(ui_Isatvh, g_pidMin.IsatvhMin, g_pidCurr.IsatvhCurr, g_pidMax.IsatvhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Isathv(lv_event_t * e)
@@ -458,6 +592,7 @@ void function_Isathv(lv_event_t * e)
     Serial.print("IsathvCurr = ");
     Serial.println(g_pidCurr.IsathvCurr, 3);
     PID_UpdateParamLabel(ui_Isathv, g_pidMin.IsathvMin, g_pidCurr.IsathvCurr, g_pidMax.IsathvMax);
+    PID_MarkGainsPending();
 }
 
 void function_Isathh(lv_event_t * e)
@@ -466,6 +601,7 @@ void function_Isathh(lv_event_t * e)
     Serial.print("IsathhCurr = ");
     Serial.println(g_pidCurr.IsathhCurr, 3);
     PID_UpdateParamLabel(ui_Isathh, g_pidMin.IsathhMin, g_pidCurr.IsathhCurr, g_pidMax.IsathhMax);
+    PID_MarkGainsPending();
 }
 
 void function_Uvmax(lv_event_t * e)
@@ -474,6 +610,7 @@ void function_Uvmax(lv_event_t * e)
     Serial.print("UvmaxCurr = ");
     Serial.println(g_pidCurr.UvmaxCurr, 3);
     PID_UpdateParamLabel(ui_Uvmax, g_pidMin.UvmaxMin, g_pidCurr.UvmaxCurr, g_pidMax.UvmaxMax);
+    PID_MarkGainsPending();
 }
 
 void function_Uhmax(lv_event_t * e)
@@ -482,6 +619,7 @@ void function_Uhmax(lv_event_t * e)
     Serial.print("UhmaxCurr = ");
     Serial.println(g_pidCurr.UhmaxCurr, 3);
     PID_UpdateParamLabel(ui_Uhmax, g_pidMin.UhmaxMin, g_pidCurr.UhmaxCurr, g_pidMax.UhmaxMax);
+    PID_MarkGainsPending();
 }
 
 void function_Save_Config_1(lv_event_t * e)
@@ -539,7 +677,7 @@ void function_Change_Images(lv_event_t * e)
 void function_Control_PID_Menu_1(lv_event_t * e)
 {
 	SetupScreen3Nav();
-    PID4_SetEnabled(false);
+    PID4_SetEnabled(false);       // el mapa de equilibrio lo guarda uiStep al ver el PID parado
 }
 
 void function_Encoders_2(lv_event_t * e)
@@ -888,6 +1026,7 @@ void function_calibration_screen_out(lv_event_t * e)
         lv_obj_add_flag(ui_Label5y, LV_OBJ_FLAG_HIDDEN);
 
         PID4_LoadFromCurr(g_pidCurr);
+        PID4_SetCascadeParams(g_pidCascade);
         PID4_SetEnabled(true);
 
         _ui_screen_change(
@@ -52,6 +52,10 @@ void function_Reset_Encoders_And_Registers(lv_event_t * e);
 void function_General_Diagram_Model(lv_event_t * e);
 void function_Control_PID_Menu(lv_event_t * e);
 void function_Predeterminate_parameters(lv_event_t * e);
+void function_AutoTune(lv_event_t * e);
+bool AutoTune_Start(bool vertical, bool thenHorizontal);
+void AutoTune_Stop();
+void HandleAutoTune();
 void function_Kpvv(lv_event_t * e);
 void function_Kivv(lv_event_t * e);
 void function_Kdvh(lv_event_t * e);
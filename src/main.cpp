@@ -26,6 +26,14 @@
 #include "Ang_Select.h"
 #include "PID_Control.h"
 #include "SerialAnsiLogger.h"
+#include "ControlTask.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+#include "Diagnostics_Screen.h"
+#include "PID_Bench.h"
+#include "RigIdent.h"
+#include "RelayTune.h"
+#include "FreqResp.h"
 
 // Activa/desactiva trazas de depuración del TCA9539
 #define TCA_DEBUG 1
@@ -62,7 +70,9 @@ SerialAnsiLogger logger(term, 50); // 50ms
 #define G1_DAC_PIN  25  // DAC1 (GPIO 25) - Motor / G1
 #define G2_DAC_PIN  26  // DAC2 (GPIO 26) - Rotor / G2
 
-// Pines ADC (tacómetros)
+// Pines ADC (tacómetros). Motor principal (DAC1) -> G36, rotor de cola (DAC2) -> G39.
+// Tacho_update (labels V.mp / V.rotor) y Tacho_readRpm (cascada, observador, RigIdent)
+// usan este mismo reparto
 #define G39_PIN 39   // V rotor de cola
 #define G36_PIN 36   // V motor principal
 
@@ -97,6 +107,24 @@ static const float COUNTS_PER_REV = 2000.0f;
 // Frecuencia de impresión
 static const uint32_t PRINT_EVERY_MS = 50;
 
+// Tarea de control en tiempo real (lectura encoders -> PID-4 -> DAC)
+static const uint32_t CONTROL_RATE_HZ       = 200;   // 200..1000 Hz
+static const uint8_t  CONTROL_TASK_CORE     = 1;     // APP_CPU
+static const uint8_t  CONTROL_TASK_PRIO     = 20;    // por debajo de esp_timer (22)
+static const uint32_t CONTROL_TASK_STACK    = 4096;
+
+// Tarea de interfaz (LVGL + táctil + IR + tacómetros), en el otro núcleo y con menor prioridad
+static const uint8_t  UI_TASK_CORE          = 0;     // PRO_CPU
+static const uint8_t  UI_TASK_PRIO          = 1;
+static const uint32_t UI_TASK_STACK         = 16384;
+static const uint32_t UI_TASK_PERIOD_MS     = 5;
+
+// Iteraciones por caso del comando serie "bench"
+static const uint32_t PID_BENCH_ITERATIONS  = 10000;
+
+// Guardado del mapa de equilibrio en NVS con el PID en marcha (por si se apaga sin pararlo)
+static const uint32_t FF_SAVE_PERIOD_MS     = 300000;  // 5 min
+
 // ================================
 // Objetos y configuración global
 // ================================
@@ -109,6 +137,20 @@ static EncoderConfig g_cfg = {
   .countsPerRevHorizontal = COUNTS_PER_REV
 };
 
+// Configuración de la tarea de control
+static ControlTaskConfig g_ctrlCfg = {
+  .rateHz     = CONTROL_RATE_HZ,
+  .core       = CONTROL_TASK_CORE,
+  .priority   = CONTROL_TASK_PRIO,
+  .stackBytes = CONTROL_TASK_STACK,
+  .encoders   = { COUNTS_PER_REV, COUNTS_PER_REV },
+  .observer   = &OBSERVER_DEFAULT_CONFIG   // ángulos filtrados y velocidades en la telemetría
+};
+
+// Tarea de interfaz
+static TaskHandle_t g_uiTask = nullptr;
+static void uiTaskFn(void *arg);
+
 // Configuración de tacómetro
 TachoConfig g_tachoCfg = {
     .pinRotor        = G39_PIN,
@@ -364,9 +406,14 @@ void setup() {
     PID_LoadDefaults(); //Inicializar valores PID a sus valores predeterminados
     PID_LoadFromNVS(); // Si hay algo en EEPROM, lo sobreescribe y actualiza UI
     PID4_LoadFromCurr(g_pidCurr);    // copia a s_pid4_params y resetea estados
+    PID4_SetCascadeParams(g_pidCascade);   // lazos de velocidad (solo en PIDMode::CASCADE)
+    PID_LoadFeedforwardFromNVS();     // mapa de equilibrio vertical aprendido en sesiones anteriores
+    PID4_SetTrajectoryLimits(PID4_TRAJ_DEFAULT_VERT, PID4_TRAJ_DEFAULT_HOR);   // consignas en curva en S
     PID4_SetEnabled(false);           // habilita el control cuando quieras
 
     //Selección de modo de funcionamiento PID por defecto
+    //(PIDMode::CASCADE: el PID-4 manda consignas de velocidad a los lazos de los tacómetros)
+    //(PIDMode::STATE_FEEDBACK: LQI sobre el observador en lugar del PID-4, ver StateFeedback.h)
     PID4_SetMode(PIDMode::MIMO_FULL);
 
     //Inicialización con un valor nulo de las series de datos de las consignas del PID
@@ -400,6 +447,16 @@ void setup() {
     // Arrancamos contadores de actividad
     g_lastActivityMs = millis();
 
+    // Identificación en marcha de la dinámica del rig (comando "ident")
+    RigIdent_init(RIG_IDENT_DEFAULT_CONFIG);
+    RigIdent_setEnabled(true);
+
+    // Arrancar la tarea de control a frecuencia fija (núcleo 1, prioridad alta)
+    if (!ControlTask_begin(g_ctrlCfg)) {
+        Serial.println("[FATAL] ControlTask_begin fallo.");
+        while (true) delay(1000);
+    }
+
     Serial.println("Sistema listo (display + encoders + tacho + motores + IR).");
 
     //Hacemos sonar el Buzzer durante un segundo cuando el proceso de carga ha terminado por completo
@@ -411,6 +468,10 @@ void setup() {
 
     digitalWrite(LED, LOW);
 
+    // A partir de aquí LVGL, táctil, IR y tacómetros viven en su propia tarea (núcleo 0)
+    xTaskCreatePinnedToCore(uiTaskFn, "trms_ui", UI_TASK_STACK, nullptr,
+                            UI_TASK_PRIO, &g_uiTask, UI_TASK_CORE);
+
  }
 
 
@@ -419,18 +480,175 @@ void setup() {
 // ================================
 
 void loop() {
+    // Todo el trabajo se hace en la tarea de control y en la de interfaz
+    vTaskDelete(nullptr);
+}
+
+// ================================
+// Tarea de interfaz
+// ================================
+
+static void uiStep();
+static void handleSerialCommands();
+
+static void uiTaskFn(void *arg) {
+    (void)arg;
+    for (;;) {
+        {
+            PROF_SCOPE(PROF_UI_LOOP);
+            uiStep();
+        }
+        handleSerialCommands();
+        DiagScreen_Update();
+        vTaskDelay(pdMS_TO_TICKS(UI_TASK_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief
+ * Comandos de diagnóstico por el monitor serie (una palabra por línea).
+ * @note
+ *  - "prof"       -> tabla de tiempos por etapa + estadísticas de la tarea de control
+ *  - "prof reset" -> pone a cero los histogramas y las estadísticas de control
+ *  - "diag"       -> abre la pantalla de diagnóstico (se cierra tocándola)
+ *  - "bench"      -> micro-benchmark de los núcleos del PID (solo con el PID deshabilitado)
+ *  - "ident"      -> modelo identificado en marcha (Serial + pantalla de diagnóstico)
+ *  - "ident on" / "ident off" / "ident reset" / "ident save N" (N = 1..5, a la SD)
+ *  - "tune"       -> auto-ajuste por relé de PIDvv y después de PIDhh (como el botón de la pantalla)
+ *  - "tune v" / "tune h" (un solo eje) / "tune stop"
+ *  - "bode"       -> último barrido de Bode (CSV por Serial + gráfica en la pantalla de diagnóstico)
+ *  - "bode mp" / "bode rdc" -> barrido sobre ese motor alrededor de los registros manuales
+ *  - "bode stop" / "bode save N" (N = 1..5, a la SD)
+ */
+static void handleSerialCommands() {
+    static char line[32];
+    static uint8_t len = 0;
+
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c < 0) break;
+
+        if (c != '\n' && c != '\r') {
+            if (len < sizeof(line) - 1) line[len++] = (char)c;
+            continue;
+        }
+        if (len == 0) continue;
+        line[len] = '\0';
+        len = 0;
+
+        if (strcmp(line, "prof") == 0) {
+            Profiler_printReport();
+
+            ControlTaskStats cs;
+            ControlTask_getStats(cs);
+            Serial.printf("[CTRL] %lu Hz | ciclos %lu | overruns %lu | perdidos %lu | "
+                          "jitter muestreo %ld..%ld us | lectura I2C max %lu us | err %lu | "
+                          "telemetria descartada %lu\n",
+                          (unsigned long)ControlTask_getRateHz(), (unsigned long)cs.cycles,
+                          (unsigned long)cs.overruns, (unsigned long)cs.missedTicks,
+                          (long)cs.minSampleJitterUs, (long)cs.maxSampleJitterUs,
+                          (unsigned long)cs.maxReadUs, (unsigned long)cs.readErrors,
+                          (unsigned long)Telemetry_getDropped());
+        } else if (strcmp(line, "prof reset") == 0) {
+            Profiler_reset();
+            ControlTask_resetStats();
+            Serial.println("[PROF] Reset");
+        } else if (strcmp(line, "diag") == 0) {
+            RegisterActivity();
+            DiagScreen_Show();
+        } else if (strcmp(line, "bench") == 0) {
+            PIDBench_run(PID_BENCH_ITERATIONS);
+        } else if (strcmp(line, "ident") == 0) {
+            // Modelo identificado: por Serial y en la pantalla de diagnóstico
+            static char text[1536];
+            RigIdentModel m;
+            RigIdent_getModel(m);
+            RigIdent_format(m, text, sizeof(text));
+            Serial.print(text);
+            RegisterActivity();
+            DiagScreen_Show(DIAG_PAGE_IDENT);
+        } else if (strcmp(line, "ident on") == 0 || strcmp(line, "ident off") == 0) {
+            const bool on = (strcmp(line, "ident on") == 0);
+            RigIdent_setEnabled(on);
+            Serial.println(on ? "[IDENT] Activa" : "[IDENT] Pausada");
+        } else if (strcmp(line, "ident reset") == 0) {
+            RigIdent_reset();
+            Serial.println("[IDENT] Reset");
+        } else if (strncmp(line, "ident save ", 11) == 0) {
+            int index = atoi(line + 11);
+            if (index >= 1 && index <= 5) ControlSD_SaveIdent((uint8_t)index);
+            else Serial.println("[IDENT] Indice 1..5");
+        } else if (strcmp(line, "tune") == 0 || strcmp(line, "tune v") == 0 || strcmp(line, "tune h") == 0) {
+            const bool vertical = (strcmp(line, "tune h") != 0);
+            if (!AutoTune_Start(vertical, strcmp(line, "tune") == 0)) {
+                Serial.println("[TUNE] No se pudo arrancar (ensayo en marcha o sin calibrar)");
+            }
+        } else if (strcmp(line, "tune stop") == 0) {
+            AutoTune_Stop();
+            Serial.println("[TUNE] Cancelado");
+        } else if (strcmp(line, "bode") == 0) {
+            static char text[1536];
+            FreqRespResult r;
+            FreqResp_getResult(r);
+            FreqResp_format(r, text, sizeof(text));
+            Serial.print(text);
+            RegisterActivity();
+            DiagScreen_Show(DIAG_PAGE_BODE);
+        } else if (strcmp(line, "bode mp") == 0 || strcmp(line, "bode rdc") == 0) {
+            // En lazo abierto, sobre el punto de trabajo del modo manual
+            const FreqRespInput input = (strcmp(line, "bode mp") == 0) ? FreqRespInput::MAIN_ROTOR
+                                                                     : FreqRespInput::TAIL_ROTOR;
+            if (PID4_IsEnabled() || RelayTune_isActive()) {
+                Serial.println("[BODE] Para antes el PID o el auto-ajuste");
+            } else if (FreqResp_start(input, Registro_MP, Registro_RDC, (float)ControlTask_getRateHz())) {
+                Serial.printf("[BODE] Barrido en marcha alrededor de MP=%d RDC=%d\n", Registro_MP, Registro_RDC);
+                RegisterActivity();
+                DiagScreen_Show(DIAG_PAGE_BODE);
+            } else {
+                Serial.println("[BODE] Ya hay un barrido en marcha");
+            }
+        } else if (strcmp(line, "bode stop") == 0) {
+            FreqResp_abort();
+            Serial.println("[BODE] Cancelado");
+        } else if (strncmp(line, "bode save ", 10) == 0) {
+            int index = atoi(line + 10);
+            if (index >= 1 && index <= 5) ControlSD_SaveBode((uint8_t)index);
+            else Serial.println("[BODE] Indice 1..5");
+        } else {
+            Serial.printf("[CMD] Desconocido: %s (prof | prof reset | diag | bench | "
+                          "ident [on | off | reset | save N] | tune [v | h | stop] | "
+                          "bode [mp | rdc | stop | save N])\n", line);
+        }
+    }
+}
+
+/**
+ * @brief
+ * Una iteración de la tarea de interfaz (antiguo cuerpo de loop()).
+ * @note
+ * No ejecuta el PID: solo LVGL, táctil, IR, tacómetros, gráficas y consignas.
+ * El lazo de control corre en ControlTask a frecuencia fija.
+ */
+static void uiStep() {
     // ---------------------------
     // 1) Gestionar LVGL (display + táctil)
     // ---------------------------
-    DisplayTouch_taskHandler();
-    delay(5);
+    {
+        PROF_SCOPE(PROF_LVGL);
+        DisplayTouch_taskHandler();
+    }
 
     // ---------------------------
     // 2) Detectar actividad por TÁCTIL
     //    (cualquier toque en la pantalla cuenta como actividad)
     // ---------------------------
     uint16_t tx, ty;
-    if (tft.getTouch(&tx, &ty)) {
+    bool touchedNow;
+    {
+        PROF_SCOPE(PROF_TOUCH);
+        touchedNow = tft.getTouch(&tx, &ty);
+    }
+    if (touchedNow) {
         RegisterActivity();   // actualiza g_lastActivityMs
     }
 
@@ -440,6 +658,7 @@ void loop() {
     static uint32_t lastTachoUpdate = 0;
     uint32_t now = millis();
     if (now - lastTachoUpdate > 100) {
+        PROF_SCOPE(PROF_TACHO);
         Tacho_update();
         lastTachoUpdate = now;
     }
@@ -461,7 +680,11 @@ void loop() {
     // ---------------------------
     // 4) IR: leer mando y actuar
     // ---------------------------
-    IRControlEvent ev = IRControl_poll();
+    IRControlEvent ev;
+    {
+        PROF_SCOPE(PROF_IR);
+        ev = IRControl_poll();
+    }
     if (ev.hasEvent) {  
         
         // 4.1) Primero: si estamos en modo aprendizaje de la pantalla del mando,
@@ -513,6 +736,29 @@ void loop() {
             HandleNumericMinus();
         }
     }
+
+    // 4.7) Ganancias editadas con el PID en marcha (reintento si el paso no las ha recogido)
+    HandlePendingGains();
+
+    // 4.8) Auto-ajuste por relé: recoge el resultado y pasa al siguiente eje
+    HandleAutoTune();
+
+    // 4.9) Mapa de equilibrio: se guarda al parar el PID (menú, auto-ajuste o cualquier
+    // otra salida) y cada FF_SAVE_PERIOD_MS mientras está en marcha. Escribir la flash
+    // detiene un momento el otro núcleo, así que con el PID activo se hace poco a menudo;
+    // PID_SaveFeedforwardToNVS no escribe si el mapa no ha aprendido nada nuevo
+    static bool     pidWasEnabled = false;
+    static uint32_t lastFfSave    = 0;
+    const bool pidEnabled = PID4_IsEnabled();
+    if (pidWasEnabled && !pidEnabled) {
+        PID_SaveFeedforwardToNVS();
+        lastFfSave = now;
+    } else if (pidEnabled && now - lastFfSave >= FF_SAVE_PERIOD_MS) {
+        PID_SaveFeedforwardToNVS();
+        lastFfSave = now;
+    }
+    if (pidEnabled && !pidWasEnabled) lastFfSave = now;
+    pidWasEnabled = pidEnabled;
 /*
     //----------------------------------------------------
     // 5) TEST: 2 senoidales + actualizar charts
@@ -587,9 +833,8 @@ void loop() {
 */
 
     //----------------------------------------------------
-    // 5) Leer encoders (rápido) + actualizar charts (lento)
+    // 5) Vaciar telemetría (cada iteración) + actualizar charts (lento)
     //----------------------------------------------------
-    static uint32_t lastRead   = 0;
     static uint32_t lastChart1 = 0;
     static uint32_t lastChart2 = 0;
     static uint32_t lastPrint  = 0;
@@ -609,23 +854,37 @@ void loop() {
 
     bool chartsVisible = chart1Visible || chart2Visible;
 
-    // (A) Lectura rápida de encoders
-    static int16_t cH = 0, cV = 0;   // guardamos último valor
-    static bool lastOk = true;
-
-    if (now - lastRead >= 50) {      // 50 ms lectura
-        lastRead = now;
+    // (A) Vaciar la cola de telemetría de la tarea de control (sin volver a usar I2C aquí).
+    //     Se vacía entera en cada iteración para que no se llene; el logger recibe
+    //     todos los registros y se diezma él solo, el resto de la UI usa el último.
+    static TelemetryRecord lastRec = {};
+    static bool haveRec = false;
 
-        int16_t tmpV = 0, tmpH = 0;
-        bool ok = Encoders_readCounts(tmpV, tmpH);
-        lastOk = ok;
-
-        if (ok) {
-            cV = tmpV;
-            cH = tmpH;
+    TelemetryRecord rec;
+    while (Telemetry_pop(rec)) {
+        if (logger_start) {
+            logger.update(rec, AngSelect_GetRefVertical(), AngSelect_GetRefHorizontal());
         }
+        lastRec = rec;
+        haveRec = true;
+    }
+
+    //     Cambios de ganancias aplicados por el paso de control: la muestra y la
+    //     generación permiten casar cada registro de telemetría con sus ganancias
+    PID4GainEvent gev;
+    while (PID4_PopGainEvent(gev)) {
+        const PID_CURR &g = gev.gains;
+        Serial.printf("[PID] gen %u desde muestra %u (%s): "
+                      "vv %.3f/%.3f/%.3f vh %.3f/%.3f/%.3f hv %.3f/%.3f/%.3f hh %.3f/%.3f/%.3f\n",
+                      (unsigned)gev.gen, (unsigned)gev.sample, gev.reload ? "carga" : "en marcha",
+                      g.KpvvCurr, g.KivvCurr, g.KdvvCurr, g.KpvhCurr, g.KivhCurr, g.KdvhCurr,
+                      g.KphvCurr, g.KihvCurr, g.KdhvCurr, g.KphhCurr, g.KihhCurr, g.KdhhCurr);
     }
 
+    int16_t cH = lastRec.countH;     // la tarea de control conserva la última lectura buena
+    int16_t cV = lastRec.countV;
+    bool lastOk = haveRec && lastRec.encOk;
+
     // (B) Convertir a grados (con tu CPR)
     const float K = 360.0f / COUNTS_PER_REV;
     float degH = (float)cH * K;
@@ -649,6 +908,14 @@ void loop() {
         // Series del chart 2 (Screen6)
         lv_chart_set_next_value(ui_GraphEncoder3, ui_GraphEncoder3_series_1, (lv_coord_t)degH);
         lv_chart_set_next_value(ui_GraphEncoder3, ui_GraphEncoder3_series_2, (lv_coord_t)degV);
+
+        // Consignas: la trayectoria planificada que sigue el PID (la del mismo paso que la
+        // medida); con el PID parado, la consigna pedida
+        if (lastRec.pidEnabled) {
+            Chart_PushReferences(lastRec.refHDeg, lastRec.refVDeg);
+        } else {
+            Chart_PushReferences(AngSelect_GetRefHorizontal(), AngSelect_GetRefVertical());
+        }
         lv_chart_refresh(ui_GraphEncoder3);
     }
 
@@ -673,44 +940,37 @@ void loop() {
     }
     */
     //----------------------------------------------------
-    // 6) Control PID
+    // 6) Control PID: consignas (el paso de control lo ejecuta ControlTask)
     //----------------------------------------------------
 
-    // ---- PID timing ----
-    static uint32_t lastPidMs = 0;
-    uint32_t nowMs = millis();
-    float dt = (nowMs - lastPidMs) / 1000.0f;
-    if (dt < 0.001f) dt = 0.001f;       // seguridad
-    if (dt > 0.100f) dt = 0.100f;       // evita saltos grandes si la UI bloquea
-    lastPidMs = nowMs;
-
     // ---- 1) Consignas desde AngSelect (GRADOS) ----
     float refH = AngSelect_GetRefHorizontal();
     float refV = AngSelect_GetRefVertical();
     PID4_SetReferences(refV, refH); // ojo: tu PID4_SetReferences(refVertDeg, refHorDeg)
     const float Err = 0.1f;  // 0.1°
     if (fabsf(refH - refH_old) > Err || fabsf(refV - refV_old) > Err) {
-        Chart_UpdateReferences(refH, refV); 
-        PID4_ResetStates();
+        PID4_HandleReferenceChange();   // resetea integradores solo con derivada del error
         refH_old = refH;
         refV_old = refV;
     }
 
-    // ---- 2) Medidas desde el loop (GRADOS) ----
-    // degH = horizontal, degV = vertical
-
-    // ---- 3) Ejecutar PID SOLO si lectura ok ----
-    if (lastOk) {
-        PID4_StepWithMeasurements(dt, degV, degH);
+    // ---- 2) Reflejar en la UI los registros que aplica la tarea de control ----
+    //  (los globales Registro_MP / Registro_RDC solo los escribe la UI)
+    static int shownMP  = INT_MIN;
+    static int shownRDC = INT_MIN;
+    if (haveRec && lastRec.pidEnabled) {
+        if (lastRec.regMP != shownMP || lastRec.regRDC != shownRDC) {
+            shownMP      = lastRec.regMP;
+            shownRDC     = lastRec.regRDC;
+            Registro_MP  = shownMP;
+            Registro_RDC = shownRDC;
+            MotorControl_refreshUI(Registro_MP, Registro_RDC);
+        }
     } else {
-        // si falla encoder, opcional: parar motores por seguridad
-        // MotorControl_update(0, 0);
+        shownMP  = INT_MIN;   // al volver a habilitar se redibuja siempre
+        shownRDC = INT_MIN;
     }
 
-    //if (logger_start) {
-        //logger.update(degV, degH, refV, refH);
-    //}
-
     // ------------------------------------------------------------
     // 7) Comprobar INACTIVIDAD y activar salvapantallas (Screen10)
     // ------------------------------------------------------------